@@ -37,6 +37,7 @@ namespace xclemulation{
     mDontRun = false; 
     mSimDir = ""; 
     mPacketSize = 0x800000; 
+    mSharedMemSize = 0; 
     mMaxTraceCount = 1; 
     mPaddingFactor = 1; 
     mSuppressInfo = false ; 
@@ -48,6 +49,7 @@ namespace xclemulation{
     mVerbosity = 0; 
     mServerPort = 0; 
     mKeepRunDir=false; 
+    mAsyncRpc=false; 
   }
 
   static bool getBoolValue(std::string& value,bool defaultValue)
@@ -122,6 +124,10 @@ namespace xclemulation{
       {
         setKeepRunDir(getBoolValue(value,false));
       }
+      else if(name == "async_rpc")
+      {
+        enableAsyncRpc(getBoolValue(value,false));
+      }
       else if(name == "sim_dir")
       {
         setSimDir(value);
@@ -138,6 +144,11 @@ namespace xclemulation{
         if(packetSize > 0 )
           setPacketSize(packetSize);
       }
+      else if(name == "shared_mem_size")
+      {
+        unsigned int sharedMemSize = strtoll(value.c_str(),NULL,0);
+        setSharedMemSize(sharedMemSize);
+      }
       else if(name == "max_trace_count")
       {
         unsigned int maxTraceCount = strtoll(value.c_str(),NULL,0);
@@ -98,6 +98,7 @@ namespace xclemulation{
       inline void enableMemLogs (bool memLogs)                  { mMemLogs          = memLogs;       }
       inline void setDontRun( bool dontRun)                     { mDontRun          = dontRun;       }
       inline void setPacketSize( unsigned int packetSize)       { mPacketSize       = packetSize;    }
+      inline void setSharedMemSize( unsigned int sharedMemSize) { mSharedMemSize    = sharedMemSize; }
       inline void setMaxTraceCount( unsigned int maxTraceCount) { mMaxTraceCount    = maxTraceCount; }
       inline void setPaddingFactor( unsigned int paddingFactor) { mPaddingFactor    = paddingFactor; }
       inline void setSimDir( std::string& simDir)               { mSimDir           = simDir;        }
@@ -111,6 +112,7 @@ namespace xclemulation{
       inline void setVerbosityLevel(unsigned int verbosity)     { mVerbosity        = verbosity;     }
       inline void setServerPort(unsigned int serverPort)        { mServerPort       = serverPort;    }
       inline void setKeepRunDir(bool _mKeepRundir)              { mKeepRunDir = _mKeepRundir;        }    
+      inline void enableAsyncRpc(bool asyncRpc)                 { mAsyncRpc         = asyncRpc;      }
       
       inline bool isDiagnosticsEnabled()        const { return mDiagnostics;    }
       inline bool isUMRChecksEnabled()          const { return mUMRChecks;      }
@@ -118,6 +120,7 @@ namespace xclemulation{
       inline bool isMemLogsEnabled()            const { return mMemLogs;        }
       inline bool isDontRun()                   const { return mDontRun;        }
       inline unsigned int getPacketSize()       const { return mPacketSize;     }
+      inline unsigned int getSharedMemSize()    const { return mSharedMemSize;  }
       inline unsigned int getMaxTraceCount()    const { return mMaxTraceCount;  }
       inline unsigned int getPaddingFactor()    const { if(!mOOBChecks) return 0; return mPaddingFactor;  }
       inline std::string getSimDir()            const { return mSimDir;         }
@@ -127,6 +130,7 @@ namespace xclemulation{
       inline bool isErrorsSuppressed()          const { return mSuppressErrors;  }
       inline bool getVerbosityLevel()           const { return mVerbosity;       }    
       inline bool isKeepRunDirEnabled()         const { return mKeepRunDir;       }    
+      inline bool isAsyncRpcEnabled()           const { return mAsyncRpc;        }
       inline bool isInfosToBePrintedOnConsole() const { return mPrintInfosInConsole;   }  
       inline unsigned int getServerPort()       const { return mServerPort;      }
       inline bool isErrorsToBePrintedOnConsole()   const { return mPrintErrorsInConsole;  }
@@ -144,6 +148,7 @@ namespace xclemulation{
       LAUNCHWAVEFORM mLaunchWaveform;
       std::string mSimDir;
       unsigned int mPacketSize;
+      unsigned int mSharedMemSize;
       unsigned int mMaxTraceCount;
       unsigned int mPaddingFactor;
       bool mSuppressInfo;
@@ -155,6 +160,7 @@ namespace xclemulation{
       bool mVerbosity;
       unsigned int mServerPort;
       bool mKeepRunDir;
+      bool mAsyncRpc;
       
      
       config();
@@ -19,10 +19,10 @@
 namespace xclemulation {
   MemoryManager::MemoryManager(uint64_t size, uint64_t start,
       unsigned alignment) : mSize(size), mStart(start), mAlignment(alignment),
-  mCoalesceThreshold(4), mFreeSize(0)
+  mFreeSize(0)
   {
     assert(start % alignment == 0);
-    mFreeBufferList.push_back(std::make_pair(mStart, mSize));
+    insertFree(mStart, mSize);
     mFreeSize = mSize;
   }
 
@@ -31,12 +31,25 @@ namespace xclemulation {
 
   }
 
+  void MemoryManager::insertFree(uint64_t buf, uint64_t size)
+  {
+    if (size == 0)
+      return;
+    mFreeBufferMap.emplace(buf, size);
+    mFreeSizeSet.emplace(size, buf);
+  }
+
+  void MemoryManager::eraseFree(std::map<uint64_t, uint64_t>::iterator i)
+  {
+    mFreeSizeSet.erase(std::make_pair(i->second, i->first));
+    mFreeBufferMap.erase(i);
+  }
+
   uint64_t MemoryManager::alloc(size_t& origSize, unsigned int paddingFactor)
   {
     if (origSize == 0)
       origSize = mAlignment;
 
-    uint64_t result = mNull;
     const size_t mod_size = origSize % mAlignment;
     const size_t pad = (mod_size > 0) ? (mAlignment - mod_size) : 0;
     origSize += pad;
@@ -45,100 +58,67 @@ namespace xclemulation {
 
     std::lock_guard<std::mutex> lock(mMemManagerMutex);
 
-    for (PairList::iterator i = mFreeBufferList.begin(), e = mFreeBufferList.end(); i != e; ++i) 
+    // Best fit, lowest address among the smallest blocks that fit
+    auto fit = mFreeSizeSet.lower_bound(std::make_pair(uint64_t(size), uint64_t(0)));
+    if (fit == mFreeSizeSet.end())
+      return mNull;
+
+    uint64_t result = fit->second;
+    uint64_t blockSize = fit->first;
+    eraseFree(mFreeBufferMap.find(result));
+    if (blockSize > size) 
     {
-      if (i->second < size)
-        continue;
-      result = i->first;
-      if (i->second > size) 
-      {
-        // Resize the existing entry in freelist
-        i->first += size;
-        i->second -= size;
-      }
-      else 
-      {
-        // remove the exact match found
-        mFreeBufferList.erase(i);
-      }
-      mBusyBufferList.push_back(std::make_pair(result, size));
-      mFreeSize -= size;
-      break;
+      // Return the remainder of the block to the free list
+      insertFree(result + size, blockSize - size);
     }
+    mBusyBufferMap.emplace(result, size);
+    mFreeSize -= size;
     return result;
   }
 
   void MemoryManager::free(uint64_t buf)
   {
     std::lock_guard<std::mutex> lock(mMemManagerMutex);
-    PairList::iterator i = find(buf);
-    if (i == mBusyBufferList.end())
+    auto i = mBusyBufferMap.find(buf);
+    if (i == mBusyBufferMap.end())
       return;
-    mFreeSize += i->second;
-    mFreeBufferList.push_back(std::make_pair(i->first, i->second));
-    mBusyBufferList.erase(i);
-    if (mFreeBufferList.size() > mCoalesceThreshold) {
-      coalesce();
+    uint64_t size = i->second;
+    mFreeSize += size;
+    mBusyBufferMap.erase(i);
+
+    // Coalesce with the free neighbors of the block
+    auto next = mFreeBufferMap.lower_bound(buf);
+    if (next != mFreeBufferMap.end() && (buf + size) == next->first) {
+      size += next->second;
+      auto erase = next++;
+      eraseFree(erase);
     }
-  }
-
-
-  void MemoryManager::coalesce()
-  {
-    // First sort the free buffers and then attempt to coalesce the neighbors
-    mFreeBufferList.sort();
-
-    PairList::iterator curr = mFreeBufferList.begin();
-    PairList::iterator next = curr;
-    ++next;
-    PairList::iterator last = mFreeBufferList.end();
-    while (next != last) {
-      if ((curr->first + curr->second) != next->first) {
-        // Non contiguous blocks
-        curr = next;
-        ++next;
-        continue;
+    if (next != mFreeBufferMap.begin()) {
+      auto prev = std::prev(next);
+      if ((prev->first + prev->second) == buf) {
+        buf = prev->first;
+        size += prev->second;
+        eraseFree(prev);
       }
-      // Coalesce curr and next
-      curr->second += next->second;
-      mFreeBufferList.erase(next);
-      next = curr;
-      ++next;
     }
-  }
-
-
-  MemoryManager::PairList::iterator MemoryManager::find(uint64_t buf)
-  {
-#if GCC_VERSION >= 40800
-    PairList::iterator i = std::find_if(mBusyBufferList.begin(), mBusyBufferList.end(), [&] (const PairList::value_type& s)
-        { return s.first == buf; });
-#else
-    PairList::iterator i = mBusyBufferList.begin();
-    PairList::iterator last  = mBusyBufferList.end();
-    while(i != last) {
-      if (i->first == buf)
-        break;
-      ++i;
-    }
-#endif
-    return i;
+    insertFree(buf, size);
   }
 
   void MemoryManager::reset()
   {
     std::lock_guard<std::mutex> lock(mMemManagerMutex);
-    mFreeBufferList.clear();
-    mBusyBufferList.clear();
-    mFreeBufferList.push_back(std::make_pair(mStart, mSize));
-    mFreeSize = 0;
+    mFreeBufferMap.clear();
+    mFreeSizeSet.clear();
+    mBusyBufferMap.clear();
+    insertFree(mStart, mSize);
+    mFreeSize = mSize;
   }
 
   std::pair<uint64_t, uint64_t> MemoryManager::lookup(uint64_t buf)
   {
     std::lock_guard<std::mutex> lock(mMemManagerMutex);
-    PairList::iterator i = find(buf);
-    if (i != mBusyBufferList.end())
+    auto i = mBusyBufferMap.find(buf);
+    if (i != mBusyBufferMap.end())
       return *i;
     // Compiler bug -- Some versions of GCC C++11 compiler do not
     // like mNull directly inside std::make_pair, so capture mNull
@@ -146,5 +126,30 @@ namespace xclemulation {
     const uint64_t v = mNull;
     return std::make_pair(v, v);
   }
+
+  std::vector<size_t> MemoryManager::freeHistogram()
+  {
+    std::lock_guard<std::mutex> lock(mMemManagerMutex);
+    std::vector<size_t> histogram;
+    for (auto& block : mFreeBufferMap) {
+      size_t bin = 63 - __builtin_clzll(block.second);
+      if (bin >= histogram.size())
+        histogram.resize(bin + 1, 0);
+      ++histogram[bin];
+    }
+    return histogram;
+  }
+
+  uint64_t MemoryManager::largestFreeSize()
+  {
+    std::lock_guard<std::mutex> lock(mMemManagerMutex);
+    return mFreeSizeSet.empty() ? 0 : mFreeSizeSet.rbegin()->first;
+  }
+
+  size_t MemoryManager::freeBlockCount()
+  {
+    std::lock_guard<std::mutex> lock(mMemManagerMutex);
+    return mFreeBufferMap.size();
+  }
 }
 
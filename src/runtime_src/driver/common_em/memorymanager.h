@@ -18,28 +18,33 @@
 #define _HWEM_MEMORY_MANAGER_H_
 
 #include <mutex>
-#include <list>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
 #include <cassert>
 #include <algorithm>
+#include <iterator>
 
 #include "em_defines.h"
 #include "xclhal2.h"
 
 namespace xclemulation
 {
+    // Free blocks are indexed both by address, to coalesce a freed
+    // block with its neighbors, and by size, for best fit allocation.
+    // Busy blocks are hashed by address.
     class MemoryManager 
     {
         std::mutex mMemManagerMutex;
-        std::list<std::pair<uint64_t, uint64_t> > mFreeBufferList;
-        std::list<std::pair<uint64_t, uint64_t> > mBusyBufferList;
+        std::map<uint64_t, uint64_t> mFreeBufferMap;
+        std::set<std::pair<uint64_t, uint64_t> > mFreeSizeSet;
+        std::unordered_map<uint64_t, uint64_t> mBusyBufferMap;
         uint64_t mSize;
         uint64_t mStart;
         uint64_t mAlignment;
-        const unsigned mCoalesceThreshold;
         uint64_t mFreeSize;
 
-        typedef std::list<std::pair<uint64_t, uint64_t> > PairList;
-
     public:
         static const uint64_t mNull = 0xffffffffffffffffull;
 
@@ -57,9 +62,16 @@ namespace xclemulation
 
         std::pair<uint64_t, uint64_t>lookup(uint64_t buf);
 
+        // Fragmentation statistics
+        // Entry i of the histogram is the number of free blocks with
+        // size in [2^i, 2^(i+1))
+        std::vector<size_t> freeHistogram();
+        uint64_t largestFreeSize();
+        size_t freeBlockCount();
+
     private:
-        void coalesce();
-        PairList::iterator find(uint64_t buf);
+        void insertFree(uint64_t buf, uint64_t size);
+        void eraseFree(std::map<uint64_t, uint64_t>::iterator i);
     };
 }
 
@@ -0,0 +1,147 @@
+/**
+ * Copyright (C) 2016-2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#ifndef _WINDOWS
+
+#include "rpc_channel.h"
+
+#include <cassert>
+#include <iostream>
+
+rpc_channel::rpc_channel(unix_socket* s)
+  : sock(s), batch_calls(0), batch_depth(0), next_id(0), stop(false)
+{
+  reader_thread = std::thread(&rpc_channel::reader, this);
+}
+
+rpc_channel::~rpc_channel()
+{
+  drain();
+  {
+    std::lock_guard<std::mutex> lk(mtx);
+    stop = true;
+  }
+  work.notify_all();
+  reader_thread.join();
+}
+
+// Write the batch buffer to the socket.  Called with mtx held.
+void rpc_channel::flush()
+{
+  if (batch_buf.empty())
+    return;
+  sock->sk_write(batch_buf.data(), batch_buf.size());
+  batch_buf.clear();
+  batch_calls = 0;
+  work.notify_one();
+}
+
+// Serialize a call with its packet info into the batch buffer, the
+// buffer is written unless a batch is open.  Called with mtx held.
+uint64_t rpc_channel::submit(unsigned int api, const google::protobuf::Message& msg)
+{
+  call_packet_info ci_msg;
+  ci_msg.set_size(msg.ByteSize());
+  ci_msg.set_xcl_api(api);
+  if (!ci_msg.AppendToString(&batch_buf) || !msg.AppendToString(&batch_buf)) {
+    std::cerr<<"FATAL ERROR:protobuf SerializeToArray failed"<<std::endl;
+    exit(1);
+  }
+
+  uint64_t id = next_id++;
+  inflight.push_back(id);
+  ++batch_calls;
+  if (!batch_depth)
+    flush();
+  return id;
+}
+
+std::future<std::string> rpc_channel::call(unsigned int api, const google::protobuf::Message& msg)
+{
+  std::lock_guard<std::mutex> lk(mtx);
+  uint64_t id = submit(api, msg);
+  // A call that waits for its result closes the batch, earlier posted
+  // calls are written ahead of it
+  flush();
+  return completions[id].get_future();
+}
+
+void rpc_channel::post(unsigned int api, const google::protobuf::Message& msg)
+{
+  std::lock_guard<std::mutex> lk(mtx);
+  submit(api, msg);
+}
+
+void rpc_channel::begin_batch()
+{
+  std::lock_guard<std::mutex> lk(mtx);
+  ++batch_depth;
+}
+
+void rpc_channel::end_batch()
+{
+  std::lock_guard<std::mutex> lk(mtx);
+  if (batch_depth && --batch_depth)
+    return;
+  flush();
+}
+
+void rpc_channel::drain()
+{
+  std::unique_lock<std::mutex> lk(mtx);
+  flush();
+  done.wait(lk, [this] { return inflight.empty(); });
+}
+
+void rpc_channel::reader()
+{
+  response_packet_info ri_msg;
+  ri_msg.set_size(0);
+  const size_t ri_len = ri_msg.ByteSize();
+  std::string ri_buf(ri_len, 0);
+  std::string buf;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lk(mtx);
+      // Responses are read only for calls on the wire, batched calls
+      // are still in the buffer
+      work.wait(lk, [this] { return stop || inflight.size() > batch_calls; });
+      if (stop && inflight.empty())
+        return;
+    }
+
+    sock->sk_read(&ri_buf[0], ri_len);
+    bool rv = ri_msg.ParseFromString(ri_buf);
+    assert(true == rv);
+    buf.resize(ri_msg.size());
+    sock->sk_read(&buf[0], buf.size());
+
+    std::lock_guard<std::mutex> lk(mtx);
+    uint64_t id = inflight.front();
+    inflight.pop_front();
+    auto itr = completions.find(id);
+    if (itr != completions.end()) {
+      itr->second.set_value(buf);
+      completions.erase(itr);
+    }
+    if (inflight.empty())
+      done.notify_all();
+  }
+}
+
+#endif
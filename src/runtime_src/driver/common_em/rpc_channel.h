@@ -0,0 +1,76 @@
+/**
+ * Copyright (C) 2016-2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _WINDOWS
+
+#ifndef __XCLHOST_RPCCHANNEL__
+#define __XCLHOST_RPCCHANNEL__
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "unix_socket.h"
+#include "rpc_messages.pb.h"
+
+// Pipelined RPC over the device process socket.
+//
+// The device process serves calls in the order they are written, so
+// responses are matched to request ids by arrival order.  Calls are
+// written without waiting for earlier responses, a reader thread
+// dispatches responses to the completion table.  Calls posted while a
+// batch is open are written to the socket together when the batch is
+// closed.
+class rpc_channel {
+  private:
+    unix_socket* sock;
+    std::mutex mtx;
+    std::condition_variable work;
+    std::condition_variable done;
+    std::map<uint64_t, std::promise<std::string>> completions;
+    std::deque<uint64_t> inflight;
+    std::string batch_buf;
+    size_t batch_calls;
+    unsigned int batch_depth;
+    uint64_t next_id;
+    bool stop;
+    std::thread reader_thread;
+
+    uint64_t submit(unsigned int api, const google::protobuf::Message& msg);
+    void flush();
+    void reader();
+  public:
+    rpc_channel(unix_socket* s);
+    ~rpc_channel();
+
+    // Send a call, the response is returned through the future
+    std::future<std::string> call(unsigned int api, const google::protobuf::Message& msg);
+    // Send a call whose response is not needed
+    void post(unsigned int api, const google::protobuf::Message& msg);
+    // Group posted calls into one socket write
+    void begin_batch();
+    void end_batch();
+    // Wait for responses to all calls sent so far
+    void drain();
+};
+
+#endif
+
+#endif
@@ -0,0 +1,64 @@
+/**
+ * Copyright (C) 2016-2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#ifndef _WINDOWS
+
+#include "shared_memory.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+
+shared_memory::shared_memory(const std::string& sm_name, size_t size)
+  : name(sm_name), addr(nullptr), len(size)
+{
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0) {
+    perror("opening shared memory");
+    return;
+  }
+  if (ftruncate(fd, len) == 0) {
+    void* m = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (m != MAP_FAILED)
+      addr = m;
+  }
+  close(fd);
+  if (!addr) {
+    perror("mapping shared memory");
+    shm_unlink(name.c_str());
+  }
+}
+
+shared_memory::~shared_memory()
+{
+  if (!addr)
+    return;
+  munmap(addr, len);
+  unlink();
+}
+
+void shared_memory::unlink()
+{
+  if (name.empty())
+    return;
+  shm_unlink(name.c_str());
+  name.clear();
+}
+
+#endif
@@ -0,0 +1,45 @@
+/**
+ * Copyright (C) 2016-2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _WINDOWS
+
+#ifndef __XCLHOST_SHAREDMEMORY__
+#define __XCLHOST_SHAREDMEMORY__
+#include <string>
+#include <cstddef>
+
+// Data plane shared between a shim and its device process.  Buffer
+// contents are staged in the mapped region and the copy RPCs carry only
+// an offset and size into the region.
+class shared_memory {
+  private:
+    std::string name;
+    void* addr;
+    size_t len;
+  public:
+    shared_memory(const std::string& sm_name, size_t size);
+    ~shared_memory();
+    // Remove the name once the device process has mapped the region
+    void unlink();
+    bool valid() const { return addr != nullptr; }
+    std::string get_name() const { return name; }
+    size_t size() const { return len; }
+    unsigned char* data() const { return static_cast<unsigned char*>(addr); }
+};
+
+#endif
+
+#endif
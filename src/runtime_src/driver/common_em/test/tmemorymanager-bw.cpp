@@ -0,0 +1,87 @@
+/**
+ * Copyright (C) 2016-2017 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// 100k random alloc/free pairs against the emulation memory manager,
+// reports time per operation and free list fragmentation.
+
+#include <boost/test/unit_test.hpp>
+
+#include "memorymanager.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+const uint64_t bank_size = 16ULL << 30;
+const uint64_t page_size = 4096;
+const size_t ops = 100000;
+
+static void
+print_fragmentation(xclemulation::MemoryManager& mm)
+{
+  std::cout << "free size: " << mm.freeSize()
+            << " free blocks: " << mm.freeBlockCount()
+            << " largest free block: " << mm.largestFreeSize() << "\n";
+  auto histogram = mm.freeHistogram();
+  for (size_t bin = 0; bin < histogram.size(); ++bin)
+    if (histogram[bin])
+      std::cout << "  [2^" << bin << ",2^" << bin+1 << "): " << histogram[bin] << "\n";
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_memorymanager_bw )
+
+BOOST_AUTO_TEST_CASE( test_memorymanager_bw1 )
+{
+  xclemulation::MemoryManager mm(bank_size, 0, page_size);
+  std::mt19937_64 gen(1);
+  std::uniform_int_distribution<size_t> size_dist(1, 1 << 20);
+
+  // Keep a working set of live buffers, each step frees a random
+  // live buffer and allocates a new one
+  std::vector<uint64_t> live;
+  for (size_t i = 0; i < 10000; ++i) {
+    size_t size = size_dist(gen);
+    auto buf = mm.alloc(size);
+    BOOST_REQUIRE(buf != xclemulation::MemoryManager::mNull);
+    live.push_back(buf);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < ops; ++i) {
+    auto& slot = live[gen() % live.size()];
+    mm.free(slot);
+    size_t size = size_dist(gen);
+    slot = mm.alloc(size);
+    BOOST_REQUIRE(slot != xclemulation::MemoryManager::mNull);
+  }
+  auto end = std::chrono::steady_clock::now();
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  std::cout << ops << " alloc/free pairs: " << ns/ops << " ns/pair\n";
+  print_fragmentation(mm);
+
+  for (auto buf : live)
+    mm.free(buf);
+  BOOST_CHECK_EQUAL(mm.freeSize(), bank_size);
+  BOOST_CHECK_EQUAL(mm.freeBlockCount(), 1);
+  BOOST_CHECK_EQUAL(mm.largestFreeSize(), bank_size);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -43,6 +43,8 @@ namespace xclcpuemhal2 {
   {
     binaryCounter = 0;
     sock = NULL;
+    mSharedMem = NULL;
+    mRpc = NULL;
     ci_msg.set_size(0);
     ci_msg.set_xcl_api(0);
 
@@ -419,6 +421,9 @@ namespace xclcpuemhal2 {
       }
     }
     sock = new unix_socket;
+    if (xclemulation::config::getInstance()->isAsyncRpcEnabled())
+      mRpc = new rpc_channel(sock);
+    openSharedMemory();
   }
 
   int CpuemShim::xclLoadXclBin(const xclBin *header)
@@ -685,7 +690,7 @@ namespace xclcpuemhal2 {
     }
 
     fflush(stdout);
-    xclWriteAddrKernelCtrl_RPC_CALL(xclWriteAddrKernelCtrl,space,offset,hostBuf,size,kernelArgsInfo);
+    xclWriteAddrKernelCtrl_RPC_POST(xclWriteAddrKernelCtrl,space,offset,hostBuf,size,kernelArgsInfo);
     PRINTENDFUNC;
     return size;
   }
@@ -724,6 +729,65 @@ namespace xclcpuemhal2 {
 
   
 
+  // Map a region shared with the device process for buffer data when
+  // enabled with shared_mem_size.  Copies fall back to RPC messages if
+  // the device process does not accept the region.
+  void CpuemShim::openSharedMemory()
+  {
+    unsigned int size = xclemulation::config::getInstance()->getSharedMemSize();
+    if (!sock || mSharedMem || size == 0)
+      return;
+
+    std::string name = "/xcl_shm_" + std::to_string(getpid()) + "_" + deviceName;
+    mSharedMem = new shared_memory(name,size);
+    bool ack = false;
+    if (mSharedMem->valid()) {
+      xclSharedMemory_RPC_CALL(xclSharedMemory,name,size);
+    }
+    // The device process has the region mapped, drop the name
+    mSharedMem->unlink();
+    if (!ack)
+      closeSharedMemory();
+  }
+
+  void CpuemShim::closeSharedMemory()
+  {
+    delete mSharedMem;
+    mSharedMem = NULL;
+  }
+
+  size_t CpuemShim::copyHost2DeviceShm(uint64_t dest, const void *src, size_t size, size_t seek, uint32_t space)
+  {
+    void *handle = this;
+    std::lock_guard<std::mutex> lk(mSharedMemMtx);
+    size_t processed_bytes = 0;
+    while(processed_bytes < size){
+      size_t c_size = std::min(size - processed_bytes, mSharedMem->size());
+      std::memcpy(mSharedMem->data(), ((const unsigned char*)(src)) + processed_bytes, c_size);
+      uint64_t c_dest = dest + processed_bytes;
+      uint64_t shm_offset = 0;
+      xclCopyBufferHost2DeviceShm_RPC_CALL(xclCopyBufferHost2Device,handle,c_dest,shm_offset,c_size,seek,space);
+      processed_bytes += c_size;
+    }
+    return size;
+  }
+
+  size_t CpuemShim::copyDevice2HostShm(void *dest, uint64_t src, size_t size, size_t skip, uint32_t space)
+  {
+    void *handle = this;
+    std::lock_guard<std::mutex> lk(mSharedMemMtx);
+    size_t processed_bytes = 0;
+    while(processed_bytes < size){
+      size_t c_size = std::min(size - processed_bytes, mSharedMem->size());
+      uint64_t c_src = src + processed_bytes;
+      uint64_t shm_offset = 0;
+      xclCopyBufferDevice2HostShm_RPC_CALL(xclCopyBufferDevice2Host,handle,shm_offset,c_src,c_size,skip,space);
+      std::memcpy(((unsigned char*)(dest)) + processed_bytes, mSharedMem->data(), c_size);
+      processed_bytes += c_size;
+    }
+    return size;
+  }
+
   size_t CpuemShim::xclCopyBufferHost2Device(uint64_t dest, const void *src, size_t size, size_t seek) 
   {
     if (mLogStream.is_open()) {
@@ -742,6 +806,8 @@ namespace xclcpuemhal2 {
     unsigned int messageSize = get_messagesize();
     unsigned int c_size = messageSize;
     unsigned int processed_bytes = 0;
+    if (mSharedMem)
+      processed_bytes = copyHost2DeviceShm(dest,src,size,seek,0);
     while(processed_bytes < size){
       if((size - processed_bytes) < messageSize){
         c_size = size - processed_bytes;
@@ -778,6 +844,8 @@ namespace xclcpuemhal2 {
     unsigned int messageSize = get_messagesize();
     unsigned int c_size = messageSize;
     unsigned int processed_bytes = 0;
+    if (mSharedMem)
+      processed_bytes = copyDevice2HostShm(dest,src,size,skip,0);
 
     while(processed_bytes < size){
       if((size - processed_bytes) < messageSize){
@@ -913,6 +981,9 @@ namespace xclcpuemhal2 {
       while (-1 == waitpid(0, &status, 0));
     
     systemUtil::makeSystemCall(socketName, systemUtil::systemOperation::REMOVE);
+    closeSharedMemory();
+    delete mRpc;
+    mRpc = NULL;
     delete sock;
     sock = NULL;
     //clean up directories which are created inside the driver
@@ -18,6 +18,8 @@
 #define _SW_EMU_SHIM_H_
 
 #include "unix_socket.h"
+#include "shared_memory.h"
+#include "rpc_channel.h"
 #include "config.h"
 #include "em_defines.h"
 #include "memorymanager.h"
@@ -194,6 +196,16 @@ namespace xclcpuemhal2 {
       size_t buf_size;
       unsigned int binaryCounter;
       unix_socket* sock;
+      // pipelined calls over sock, null when calls wait for each response
+      rpc_channel* mRpc;
+      // buffer data plane shared with the device process, null when
+      // copies are sent in the RPC messages
+      shared_memory* mSharedMem;
+      std::mutex mSharedMemMtx;
+      void openSharedMemory();
+      void closeSharedMemory();
+      size_t copyHost2DeviceShm(uint64_t dest, const void *src, size_t size, size_t seek, uint32_t space);
+      size_t copyDevice2HostShm(void *dest, uint64_t src, size_t size, size_t skip, uint32_t space);
 
 
       uint64_t mRAMSize;
@@ -16,12 +16,24 @@
 
 #include "mem_model.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <algorithm>
+
 mem_model::~ mem_model()
 {
-  serialize();
+  // Mapped pages are shared with the file, unmapping leaves the
+  // memory image in place for a later model of the same device
+  for (auto page : pageTable)
+    if (page)
+      munmap(page,PAGESIZE);
+  if (mFd != -1)
+    close(mFd);
 }
 
 mem_model::mem_model(std::string deviceName):
+  mFd(-1),
+  mFileSize(0),
   mDeviceName(deviceName),
   module_name("dr_wrapper_dr_i_sdaccel_generic_pcie_0.sdaccel_generic_pcie_model.ddrx_top_tlm_model_0.axi_app_tlm_model_0")
 {
@@ -35,28 +47,9 @@ mem_model::mem_model(std::string deviceName):
       uint64_t written_bytes = 0;
       uint64_t addr = offset;
       while(written_bytes < size){
-          uint64_t src_offset = written_bytes;
-
-          unsigned char* page_ptr  = get_page(addr);
-          uint64_t       page_addr = addr & ~(-1 << ADDRBITS);
-
-          unsigned char* dest_buf_ptr = page_ptr + page_addr;
-          unsigned char* src_buf_ptr  = (unsigned char*)(src)      + src_offset;
-
-          uint64_t remaining_bytes_to_write = size - written_bytes;
-          uint64_t unaligned_bytes_in_addr = (addr & ~(-1 << ADDRBITS));
-          uint64_t bytes_upto_next_alignment = (0x1 << ADDRBITS) - unaligned_bytes_in_addr;
-
-          uint64_t buf_size = 0;
-          if(bytes_upto_next_alignment > remaining_bytes_to_write)
-          {
-              buf_size = remaining_bytes_to_write;
-          }else{
-              buf_size = bytes_upto_next_alignment;
-          }
-
-          memcpy(dest_buf_ptr,src_buf_ptr,buf_size);
-
+          uint64_t page_addr = addr & (PAGESIZE - 1);
+          uint64_t buf_size = std::min<uint64_t>(PAGESIZE - page_addr, size - written_bytes);
+          memcpy(get_page(addr) + page_addr,(const unsigned char*)(src) + written_bytes,buf_size);
           written_bytes += buf_size;
           addr += buf_size;
       }
@@ -82,26 +75,9 @@ mem_model::mem_model(std::string deviceName):
 	  uint64_t read_bytes = 0;
 	  uint64_t addr = offset;
 	  while(read_bytes < size){
-		  uint64_t dest_offset = read_bytes;
-
-		  unsigned char* page_ptr  = get_page(addr);
-		  uint64_t       page_addr = addr & ~(-1 << ADDRBITS);
-
-		  unsigned char* src_buf_ptr = page_ptr + page_addr;
-		  unsigned char* dest_buf_ptr  = (unsigned char*)(dest)      + dest_offset;
-
-		  uint64_t remaining_bytes_to_read = size - read_bytes;
-		  uint64_t unaligned_bytes_in_addr = (addr & ~(-1 << ADDRBITS));
-		  uint64_t bytes_upto_next_alignment = (0x1 << ADDRBITS) - unaligned_bytes_in_addr;
-
-		  uint64_t buf_size = 0;
-		  if(bytes_upto_next_alignment > remaining_bytes_to_read)
-		  {
-			  buf_size = remaining_bytes_to_read;
-		  }else{
-			  buf_size = bytes_upto_next_alignment;
-		  }
-	  memcpy(dest_buf_ptr,src_buf_ptr,buf_size);
+		  uint64_t page_addr = addr & (PAGESIZE - 1);
+		  uint64_t buf_size = std::min<uint64_t>(PAGESIZE - page_addr, size - read_bytes);
+		  memcpy((unsigned char*)(dest) + read_bytes,get_page(addr) + page_addr,buf_size);
 		  read_bytes += buf_size;
 		  addr += buf_size;
 	  }
@@ -118,66 +94,57 @@ mem_model::mem_model(std::string deviceName):
 
 	  return 0;
   }
+
   unsigned char* mem_model::get_page(uint64_t offset) {
 	  uint64_t page_idx = offset >> ADDRBITS;
-	  std::string file_name = get_mem_file_name(page_idx);
-	  if(pageCache.size() > N_1MBARRAYS)
-	  {
-		  std::cerr << "Out of Memory. DDR model does not support this much of memory\n";
-		  exit(1);
-	  } else {
-      FILE* pFile = NULL;
-		  if(pageCache.find(page_idx) != pageCache.end())
-		  {
-			  return pageCache[page_idx];
-		  } else if(((pFile = fopen(file_name.c_str(),"r")) != NULL)) {
-			  int fhandle = fileno(pFile);
-
-			  if (deserialize_msg.ParseFromFileDescriptor(fhandle) == false)
-        {
-          fclose(pFile);
-          exit(1);
-        }
-			  pageCache[page_idx] = new unsigned char[PAGESIZE];
-
-			  memcpy(pageCache[page_idx],deserialize_msg.data().c_str(),PAGESIZE);
-			  fclose(pFile);
-			  return pageCache[page_idx];
-		  } else {
-			  pageCache[page_idx] = new unsigned char[PAGESIZE];
-			  return pageCache[page_idx];
+	  std::lock_guard<std::mutex> lk(pageMutex);
+	  if(page_idx < pageTable.size() && pageTable[page_idx])
+		  return pageTable[page_idx];
+
+	  if(mFd == -1)
+		  open_mem_file();
+
+	  // Growing the file only extends the hole, no disk space is used
+	  // until a page is written
+	  uint64_t page_end = (page_idx + 1) << ADDRBITS;
+	  if(page_end > mFileSize) {
+		  if(ftruncate(mFd,page_end) == -1) {
+			  std::cerr << "Out of Memory. DDR model cannot grow memory file to " << page_end << " bytes\n";
+			  exit(1);
 		  }
+		  mFileSize = page_end;
 	  }
-  }
 
+	  void* page = mmap(NULL,PAGESIZE,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_NORESERVE,mFd,page_idx << ADDRBITS);
+	  if(page == MAP_FAILED) {
+		  std::cerr << "Out of Memory. DDR model cannot map memory at offset " << offset << "\n";
+		  exit(1);
+	  }
 
-  void mem_model::serialize() {
-     FILE *pFile;
-     int fhandle;
-     for (pageCacheItr=pageCache.begin(); pageCacheItr != pageCache.end(); ++pageCacheItr)
-     {
-        std::string file_name = get_mem_file_name(pageCacheItr->first);
-        pFile = fopen(file_name.c_str(),"w+");
-        if(!pFile)
-          continue;
-        fhandle = fileno(pFile);
-        if(fhandle == -1)
-        {
-          fclose(pFile);
-          exit(1);
-        }
-
-        serialize_msg.set_data(reinterpret_cast<const char*>(pageCacheItr->second),PAGESIZE);
-        if(serialize_msg.SerializeToFileDescriptor(fhandle) == false)
-        {
-          fclose(pFile);
-          exit(1);
-        }
-        fclose(pFile);
-     }
+	  if(page_idx >= pageTable.size())
+		  pageTable.resize(page_idx + 1,nullptr);
+	  pageTable[page_idx] = static_cast<unsigned char*>(page);
+	  return pageTable[page_idx];
+  }
+
+  // Open the memory image, an existing image from an earlier model of
+  // the same device is reused as is
+  void mem_model::open_mem_file() {
+	  std::string file_name = get_mem_file_name();
+	  mFd = open(file_name.c_str(),O_RDWR|O_CREAT,0666);
+	  if(mFd == -1) {
+		  std::cerr << "unable to open/create mem file " << file_name << std::endl;
+		  exit(1);
+	  }
+	  struct stat statBuf;
+	  if(fstat(mFd,&statBuf) == -1) {
+		  close(mFd);
+		  exit(1);
+	  }
+	  mFileSize = statBuf.st_size;
   }
 
- std::string mem_model::get_mem_file_name(uint64_t pageIdx)
+ std::string mem_model::get_mem_file_name()
  {
    std::string file_name("");
    std::string user("");
@@ -198,7 +165,7 @@ mem_model::mem_model(std::string deviceName):
      int rV = system(mkdirCommand.str().c_str());
      if(rV == -1) {std::cout<<"unable to open/create mem file"<<std::endl;}
    }
-    file_name = file_path + module_name + "_" + std::to_string(pageIdx);
+    file_name = file_path + module_name + ".mem";
 #ifdef DEBUGMSG
       cout<<"ddr fmodel file_name: "<< file_name<<endl;
 #endif
@@ -22,18 +22,18 @@
 #include <string.h> // memcpy
 #include <sstream> // memcpy
 #include <stdlib.h> //realloc
-#include <map> //realloc
+#include <mutex>
+#include <vector>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
-#include "rpc_messages.pb.h"
-
+// Device memory is a sparse file, mapped in windows of 1 << ADDRBITS bytes.
+// Regions never written are holes in the file and read back as zero.
 #define ONE_KB (0x400)
 #define ONE_MB (ONE_KB * ONE_KB)
-#define PAGESIZE (ONE_MB)
-#define ADDRBITS (20)
-#define N_1MBARRAYS 4096
+#define ADDRBITS (26)
+#define PAGESIZE (1ULL << ADDRBITS)
 
 class mem_model{
 public:
@@ -43,13 +43,15 @@ unsigned int readDevMem(uint64_t offset, void* dest, unsigned int size);
 protected:
 private:
   unsigned char* get_page(uint64_t offset);
-  std::string get_mem_file_name(uint64_t pageIdx);
-  std::map<uint64_t,unsigned char*> pageCache;
-  std::map<uint64_t,unsigned char*>::iterator pageCacheItr;
+  std::string get_mem_file_name();
+  void open_mem_file();
+
+  // flat page table indexed by offset >> ADDRBITS, nullptr until mapped
+  std::vector<unsigned char*> pageTable;
+  std::mutex pageMutex;
+  int mFd;
+  uint64_t mFileSize;
 
-  ddr_mem_msg serialize_msg;
-  ddr_mem_msg deserialize_msg;
-  void serialize();
   std::string mDeviceName;
   std::string module_name;
 public:
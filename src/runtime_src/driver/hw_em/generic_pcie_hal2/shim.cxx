@@ -596,6 +596,8 @@ namespace xclhwemhal2 {
       mEnvironmentNameValueMap["enable_pr"] = "false";
     }
     sock = new unix_socket;
+    if (xclemulation::config::getInstance()->isAsyncRpcEnabled())
+      mRpc = new rpc_channel(sock);
     if(sock && mEnvironmentNameValueMap.empty() == false)
     {
       //send environment information to device
@@ -606,6 +608,7 @@ namespace xclhwemhal2 {
         //std::cout<<"environment is not set properly"<<std::endl;
       }
     }
+    openSharedMemory();
 
     if(simMode)
     {
@@ -728,7 +731,7 @@ namespace xclhwemhal2 {
              std::string dMsg ="INFO: [SDx-EM 03-0] Configuring registers for the kernel " + kernelName +" Started";
              logMessage(dMsg,1);
            }
-           xclWriteAddrKernelCtrl_RPC_CALL(xclWriteAddrKernelCtrl,space,offset,hostBuf,size,offsetArgInfo);
+           xclWriteAddrKernelCtrl_RPC_POST(xclWriteAddrKernelCtrl,space,offset,hostBuf,size,offsetArgInfo);
            if(hostBuf32[0] & CONTROL_AP_START)
            {
              std::string dMsg ="INFO: [SDx-EM 04-1] Kernel " + kernelName +" is Started";
@@ -845,6 +848,66 @@ uint32_t HwEmShim::getAddressSpace (uint32_t topology)
   }
   return 1;
 }
+  // Map a region shared with the device process for buffer data when
+  // enabled with shared_mem_size.  Copies fall back to RPC messages if
+  // the device process does not accept the region.
+  void HwEmShim::openSharedMemory()
+  {
+    unsigned int size = xclemulation::config::getInstance()->getSharedMemSize();
+    if (!sock || mSharedMem || size == 0)
+      return;
+
+    std::string name = "/xcl_shm_" + std::to_string(getpid()) + "_" + deviceName;
+    mSharedMem = new shared_memory(name,size);
+    bool ack = false;
+    if (mSharedMem->valid()) {
+      xclSharedMemory_RPC_CALL(xclSharedMemory,name,size);
+    }
+    // The device process has the region mapped, drop the name
+    mSharedMem->unlink();
+    if (!ack)
+      closeSharedMemory();
+  }
+
+  void HwEmShim::closeSharedMemory()
+  {
+    delete mSharedMem;
+    mSharedMem = NULL;
+    mRpc = NULL;
+  }
+
+  size_t HwEmShim::copyHost2DeviceShm(uint64_t dest, const void *src, size_t size, size_t seek, uint32_t space)
+  {
+    void *handle = this;
+    std::lock_guard<std::mutex> lk(mSharedMemMtx);
+    size_t processed_bytes = 0;
+    while(processed_bytes < size){
+      size_t c_size = std::min(size - processed_bytes, mSharedMem->size());
+      std::memcpy(mSharedMem->data(), ((const unsigned char*)(src)) + processed_bytes, c_size);
+      uint64_t c_dest = dest + processed_bytes;
+      uint64_t shm_offset = 0;
+      xclCopyBufferHost2DeviceShm_RPC_CALL(xclCopyBufferHost2Device,handle,c_dest,shm_offset,c_size,seek,space);
+      processed_bytes += c_size;
+    }
+    return size;
+  }
+
+  size_t HwEmShim::copyDevice2HostShm(void *dest, uint64_t src, size_t size, size_t skip, uint32_t space)
+  {
+    void *handle = this;
+    std::lock_guard<std::mutex> lk(mSharedMemMtx);
+    size_t processed_bytes = 0;
+    while(processed_bytes < size){
+      size_t c_size = std::min(size - processed_bytes, mSharedMem->size());
+      uint64_t c_src = src + processed_bytes;
+      uint64_t shm_offset = 0;
+      xclCopyBufferDevice2HostShm_RPC_CALL(xclCopyBufferDevice2Host,handle,shm_offset,c_src,c_size,skip,space);
+      std::memcpy(((unsigned char*)(dest)) + processed_bytes, mSharedMem->data(), c_size);
+      processed_bytes += c_size;
+    }
+    return size;
+  }
+
   size_t HwEmShim::xclCopyBufferHost2Device(uint64_t dest, const void *src, size_t size, size_t seek, uint32_t topology)
   {
     if(!sock)
@@ -865,6 +928,8 @@ uint32_t HwEmShim::getAddressSpace (uint32_t topology)
     unsigned int messageSize = xclemulation::config::getInstance()->getPacketSize();
     unsigned int c_size = messageSize;
     unsigned int processed_bytes = 0;
+    if (mSharedMem)
+      processed_bytes = copyHost2DeviceShm(dest,src,size,seek,getAddressSpace(topology));
     while(processed_bytes < size){
       if((size - processed_bytes) < messageSize){
         c_size = size - processed_bytes;
@@ -912,6 +977,8 @@ uint32_t HwEmShim::getAddressSpace (uint32_t topology)
     unsigned int messageSize = xclemulation::config::getInstance()->getPacketSize();
     unsigned int c_size = messageSize;
     unsigned int processed_bytes = 0;
+    if (mSharedMem)
+      processed_bytes = copyDevice2HostShm(dest,src,size,skip,getAddressSpace(topology));
 
     while(processed_bytes < size){
       if((size - processed_bytes) < messageSize){
@@ -1272,6 +1339,9 @@ uint32_t HwEmShim::getAddressSpace (uint32_t topology)
       saveWaveDataBase();
     }
     //ProfilerStop();
+    closeSharedMemory();
+    delete mRpc;
+    mRpc = NULL;
     delete sock;
     sock = NULL;
     PRINTENDFUNC;
@@ -1380,6 +1450,7 @@ uint32_t HwEmShim::getAddressSpace (uint32_t topology)
     buf_size = 0;
     binaryCounter = 0;
     sock = NULL;
+    mSharedMem = NULL;
 
     deviceName = "device"+std::to_string(deviceIndex);
     deviceDirectory = xclemulation::getRunDirectory() +"/" + std::to_string(getpid())+"/hw_em/"+deviceName;
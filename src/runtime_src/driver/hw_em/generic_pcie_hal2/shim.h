@@ -19,6 +19,8 @@
 
 #ifndef _WINDOWS
 #include "unix_socket.h"
+#include "shared_memory.h"
+#include "rpc_channel.h"
 #include "config.h"
 #include "em_defines.h"
 #include "memorymanager.h"
@@ -121,6 +123,10 @@ using addr_type = uint64_t;
 
       // Raw read/write
       size_t xclWrite(xclAddressSpace space, uint64_t offset, const void *hostBuf, size_t size);
+      // Writes between begin and end are sent to the device process
+      // in one message when calls are pipelined
+      void beginRpcBatch() { if (mRpc) mRpc->begin_batch(); }
+      void endRpcBatch()   { if (mRpc) mRpc->end_batch(); }
       size_t xclRead(xclAddressSpace space, uint64_t offset, void *hostBuf, size_t size);
       size_t xclReadModifyWrite(uint64_t offset, const void *hostBuf, size_t size);
       size_t xclReadSkipCopy(uint64_t offset, void *hostBuf, size_t size);
@@ -243,6 +249,16 @@ using addr_type = uint64_t;
       static bool mFirstBinary;
       unsigned int binaryCounter;
       unix_socket* sock;
+      // pipelined calls over sock, null when calls wait for each response
+      rpc_channel* mRpc;
+      // buffer data plane shared with the device process, null when
+      // copies are sent in the RPC messages
+      shared_memory* mSharedMem;
+      std::mutex mSharedMemMtx;
+      void openSharedMemory();
+      void closeSharedMemory();
+      size_t copyHost2DeviceShm(uint64_t dest, const void *src, size_t size, size_t seek, uint32_t space);
+      size_t copyDevice2HostShm(void *dest, uint64_t src, size_t size, size_t skip, uint32_t space);
       std::string deviceName;
       xclDeviceInfo2 mDeviceInfo;
       unsigned int mDeviceIndex;
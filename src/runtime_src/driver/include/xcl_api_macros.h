@@ -27,14 +27,26 @@ mtx.unlock();
 
 #define RPC_PROLOGUE(func_name) \
     unix_socket* _s_inst = sock; \
+    rpc_channel* _s_rpc = mRpc; \
     func_name##_call c_msg; \
     func_name##_response r_msg; \
     AQUIRE_MUTEX()
 
+// With an rpc_channel the mutex is released while waiting for the
+// response so calls from other threads are pipelined behind this one
 #define SERIALIZE_AND_SEND_MSG(func_name)\
+    bool rv = true; \
+    if (_s_rpc) { \
+      auto _r_future = _s_rpc->call(func_name##_n, c_msg); \
+      RELEASE_MUTEX(); \
+      std::string _r_str = _r_future.get(); \
+      AQUIRE_MUTEX(); \
+      rv = r_msg.ParseFromString(_r_str); \
+      assert(true == rv); \
+    } else { \
      unsigned c_len = c_msg.ByteSize(); \
     buf_size = alloc_void(c_len); \
-    bool rv = c_msg.SerializeToArray(buf,c_len); \
+    rv = c_msg.SerializeToArray(buf,c_len); \
     if(rv == false){std::cerr<<"FATAL ERROR:protobuf SerializeToArray failed"<<std::endl;exit(1);} \
     \
     ci_msg.set_size(c_len); \
@@ -53,6 +65,7 @@ mtx.unlock();
     _s_inst->sk_read(buf,ri_msg.size()); \
     rv = r_msg.ParseFromArray(buf,ri_msg.size()); \
     assert(true == rv);\
+    }
 
 //RELEASE BUFFER MEMORIES
 #define FREE_BUFFERS() \
@@ -207,6 +220,20 @@ mtx.unlock();
     FREE_BUFFERS(); \
     xclWriteAddrKernelCtrl_RETURN();
 
+// Posted variant, with an rpc_channel the write does not wait for the
+// device process and its response is not checked
+#define xclWriteAddrKernelCtrl_RPC_POST(func_name,address_space,address,data,size,kernelArgsInfo) \
+    RPC_PROLOGUE(func_name); \
+    xclWriteAddrKernelCtrl_SET_PROTOMESSAGE(func_name,address_space,address,data,size,kernelArgsInfo); \
+    if (_s_rpc) { \
+      _s_rpc->post(func_name##_n, c_msg); \
+    } else { \
+      SERIALIZE_AND_SEND_MSG(func_name)\
+      xclWriteAddrKernelCtrl_SET_PROTO_RESPONSE(); \
+    } \
+    FREE_BUFFERS(); \
+    xclWriteAddrKernelCtrl_RETURN();
+
 //-----------------------xclReadAddrSpaceDeviceRam----------------------------
 //Generate call and info message
 #define xclReadAddrSpaceDeviceRam_SET_PROTOMESSAGE(func_name,address_space,addr,data,size) \
@@ -301,6 +328,23 @@ mtx.unlock();
     FREE_BUFFERS(); \
     xclCopyBufferHost2Device_RETURN();
 
+#define xclCopyBufferHost2DeviceShm_SET_PROTOMESSAGE(func_name,dev_handle,dest,shm_offset,size,seek,space) \
+    c_msg.set_xcldevicehandle((char*)dev_handle); \
+    c_msg.set_dest(dest); \
+    c_msg.set_src(""); \
+    c_msg.set_size(size); \
+    c_msg.set_seek(seek); \
+    c_msg.set_space(space); \
+    c_msg.set_shm_offset(shm_offset);
+
+#define xclCopyBufferHost2DeviceShm_RPC_CALL(func_name,dev_handle,dest,shm_offset,size,seek,space) \
+    RPC_PROLOGUE(func_name); \
+    xclCopyBufferHost2DeviceShm_SET_PROTOMESSAGE(func_name,dev_handle,dest,shm_offset,size,seek,space); \
+    SERIALIZE_AND_SEND_MSG(func_name)\
+    xclCopyBufferHost2Device_SET_PROTO_RESPONSE(); \
+    FREE_BUFFERS(); \
+    xclCopyBufferHost2Device_RETURN();
+
 //-----------xclCopyBufferDevice2Host-----------------
 #define xclCopyBufferDevice2Host_SET_PROTOMESSAGE(func_name,dev_handle,dest,src,size,skip,space) \
     c_msg.set_xcldevicehandle((char*)dev_handle); \
@@ -326,6 +370,36 @@ mtx.unlock();
     FREE_BUFFERS(); \
     xclCopyBufferDevice2Host_RETURN();
 
+#define xclCopyBufferDevice2HostShm_SET_PROTOMESSAGE(func_name,dev_handle,shm_offset,src,size,skip,space) \
+    c_msg.set_xcldevicehandle((char*)dev_handle); \
+    c_msg.set_dest(""); \
+    c_msg.set_src(src); \
+    c_msg.set_size(size); \
+    c_msg.set_skip(skip); \
+    c_msg.set_space(space); \
+    c_msg.set_shm_offset(shm_offset);
+
+#define xclCopyBufferDevice2HostShm_RPC_CALL(func_name,dev_handle,shm_offset,src,size,skip,space) \
+    RPC_PROLOGUE(func_name); \
+    xclCopyBufferDevice2HostShm_SET_PROTOMESSAGE(func_name,dev_handle,shm_offset,src,size,skip,space); \
+    SERIALIZE_AND_SEND_MSG(func_name)\
+    FREE_BUFFERS(); \
+    xclCopyBufferDevice2Host_RETURN();
+
+//----------xclSharedMemory-------------------
+#define xclSharedMemory_SET_PROTOMESSAGE(name,size) \
+    c_msg.set_name(name); \
+    c_msg.set_size(size);
+
+#define xclSharedMemory_SET_PROTO_RESPONSE() \
+  ack = r_msg.ack();
+
+#define xclSharedMemory_RPC_CALL(func_name,name,size) \
+  RPC_PROLOGUE(func_name); \
+  xclSharedMemory_SET_PROTOMESSAGE(name,size); \
+  SERIALIZE_AND_SEND_MSG(func_name) \
+  xclSharedMemory_SET_PROTO_RESPONSE(); \
+  FREE_BUFFERS();
 
 //----------xclPerfMonReadCounters------------
 #define xclPerfMonReadCounters_SET_PROTOMESSAGE() \
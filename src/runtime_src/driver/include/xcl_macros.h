@@ -53,5 +53,6 @@
 #define xclReadQueue_n 25
 #define xclDestroyQueue_n 26
 #define xclImportBO_n 27
+#define xclSharedMemory_n 28
 
 #endif
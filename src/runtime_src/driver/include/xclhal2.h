@@ -857,6 +857,21 @@ XCL_DRIVER_DLLESPEC size_t xclRead(xclDeviceHandle handle, xclAddressSpace space
  */
 XCL_DRIVER_DLLESPEC int xclExecBuf(xclDeviceHandle handle, unsigned int cmdBO);
 
+/**
+ * xclExecBufBatch() - Submit several execution requests to the embedded (or software) scheduler
+ *
+ * @handle:        Device handle
+ * @num_bo:        Number of BO handles in cmdBOs
+ * @cmdBOs:        BO handles containing command packets
+ * Return:         0 or standard error number
+ *
+ * Submit exec buffers for execution in the order given, same as calling
+ * xclExecBuf() for each BO but with fewer calls into the driver.  This
+ * API is optional, a driver library that does not export it is used
+ * through xclExecBuf().
+ */
+XCL_DRIVER_DLLESPEC int xclExecBufBatch(xclDeviceHandle handle, size_t num_bo, unsigned int *cmdBOs);
+
 /**
  * xclExecBufWithWaitList() - Submit an execution request to the embedded (or software) scheduler
  *
@@ -148,6 +148,8 @@ int xocl_info_ioctl(struct drm_device *dev,
         void *data, struct drm_file *filp);
 int xocl_execbuf_ioctl(struct drm_device *dev,
         void *data, struct drm_file *filp);
+int xocl_execbuf_batch_ioctl(struct drm_device *dev,
+        void *data, struct drm_file *filp);
 int xocl_ctx_ioctl(struct drm_device *dev, void *data,
                    struct drm_file *filp);
 int xocl_user_intr_ioctl(struct drm_device *dev, void *data,
@@ -48,18 +48,8 @@ int xocl_info_ioctl(struct drm_device *dev, void *data, struct drm_file *filp)
 	return 0;
 }
 
-int xocl_execbuf_ioctl(struct drm_device *dev,
-	void *data, struct drm_file *filp)
+static int xocl_execbuf_check(struct xocl_dev *xdev, struct client_ctx *client)
 {
-	struct drm_gem_object *obj;
-	struct drm_xocl_bo *xobj;
-	struct drm_xocl_execbuf *args = data;
-	struct xocl_dev *xdev = dev->dev_private;
-	struct drm_xocl_bo *deps[8] = {0};
-	struct client_ctx *client = filp->driver_priv;
-	int numdeps;
-	int ret = 0;
-
 	if (atomic_read(&xdev->needs_reset)) {
 		userpf_err(xdev, "device needs reset, use 'xbsak reset -h'");
 		return -EBUSY;
@@ -76,14 +66,31 @@ int xocl_execbuf_ioctl(struct drm_device *dev,
 		return -EPERM;
 	}
 
+	return 0;
+}
+
+/* Add one exec buffer with optional dependencies to the scheduler.
+ * @dep_handles is a 0 terminated array of at most 8 BO handles or NULL.
+ */
+static int xocl_execbuf_submit(struct drm_device *dev, struct drm_file *filp,
+	uint32_t exec_bo_handle, const uint32_t *dep_handles)
+{
+	struct drm_gem_object *obj;
+	struct drm_xocl_bo *xobj;
+	struct xocl_dev *xdev = dev->dev_private;
+	struct drm_xocl_bo *deps[8] = {0};
+	struct client_ctx *client = filp->driver_priv;
+	int numdeps;
+	int ret = 0;
+
 	/* Look up the gem object corresponding to the BO handle.
 	 * This adds a reference to the gem object.  The refernece is
 	 * passed to kds or released here if errors occur.
 	 */
-	obj = xocl_gem_object_lookup(dev, filp, args->exec_bo_handle);
+	obj = xocl_gem_object_lookup(dev, filp, exec_bo_handle);
 	if (!obj) {
 		userpf_err(xdev, "Failed to look up GEM BO %d\n",
-			args->exec_bo_handle);
+			exec_bo_handle);
 		return -ENOENT;
 	}
 
@@ -105,11 +112,11 @@ int xocl_execbuf_ioctl(struct drm_device *dev,
 	 * handle.  Convert gem object to xocl_bo extension.  Note that the
 	 * gem lookup acquires a reference to the drm object, this reference
 	 * is passed on to the the scheduler via xocl_exec_add_buffer. */
-	for (numdeps=0; numdeps<8 && args->deps[numdeps]; ++numdeps) {
-		struct drm_gem_object *gobj = xocl_gem_object_lookup(dev,filp,args->deps[numdeps]);
+	for (numdeps=0; dep_handles && numdeps<8 && dep_handles[numdeps]; ++numdeps) {
+		struct drm_gem_object *gobj = xocl_gem_object_lookup(dev,filp,dep_handles[numdeps]);
 		struct drm_xocl_bo *xbo = gobj ? to_xocl_bo(gobj) : NULL;
 		if (!gobj)
-			userpf_err(xdev,"Failed to look up GEM BO %d\n",args->deps[numdeps]);
+			userpf_err(xdev,"Failed to look up GEM BO %d\n",dep_handles[numdeps]);
 		if (!xbo) {
 			ret = -EINVAL;
 			goto out;
@@ -138,6 +145,52 @@ out:
 	return ret;
 }
 
+int xocl_execbuf_ioctl(struct drm_device *dev,
+	void *data, struct drm_file *filp)
+{
+	struct drm_xocl_execbuf *args = data;
+	struct xocl_dev *xdev = dev->dev_private;
+	int ret;
+
+	ret = xocl_execbuf_check(xdev, filp->driver_priv);
+	if (ret)
+		return ret;
+
+	return xocl_execbuf_submit(dev, filp, args->exec_bo_handle, args->deps);
+}
+
+int xocl_execbuf_batch_ioctl(struct drm_device *dev,
+	void *data, struct drm_file *filp)
+{
+	struct drm_xocl_execbuf_batch *args = data;
+	struct xocl_dev *xdev = dev->dev_private;
+	uint32_t handles[DRM_XOCL_EXECBUF_BATCH_MAX];
+	int ret;
+
+	args->submitted = 0;
+
+	if (!args->num_bos || args->num_bos > DRM_XOCL_EXECBUF_BATCH_MAX)
+		return -EINVAL;
+
+	ret = xocl_execbuf_check(xdev, filp->driver_priv);
+	if (ret)
+		return ret;
+
+	if (copy_from_user(handles, (void __user *)(uintptr_t)args->bo_handles,
+		args->num_bos * sizeof(uint32_t)))
+		return -EFAULT;
+
+	/* The device state and client xclbin are checked once for the
+	 * whole batch, the exec buffers are validated one by one */
+	for (; args->submitted < args->num_bos; ++args->submitted) {
+		ret = xocl_execbuf_submit(dev, filp, handles[args->submitted], NULL);
+		if (ret)
+			break;
+	}
+
+	return ret;
+}
+
 /*
  * Create a context (ony shared supported today) on a CU. Take a lock on xclbin if
  * it has not been acquired before. Shared the same lock for all context requests
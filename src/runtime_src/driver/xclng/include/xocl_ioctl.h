@@ -69,6 +69,8 @@
  *      interrupt
  * 12   Write buffer from device to peer FPGA  DRM_IOCTL_XOCL_COPY_BO         drm_xocl_copy_bo
  *      buffer
+ * 13   Submit several exec buffers to the     DRM_IOCTL_XOCL_EXECBUF_BATCH   drm_xocl_execbuf_batch
+ *      scheduler in one call
  * ==== ====================================== ============================== ==================================
  */
 
@@ -139,6 +141,8 @@ enum drm_xocl_ops {
 	DRM_XOCL_READ_AXLF,
 	/* Copy buffer to Destination buffer by using DMA */
 	DRM_XOCL_COPY_BO,
+	/* Commands to run on one or more CUs, submitted together */
+	DRM_XOCL_EXECBUF_BATCH,
 
 	DRM_XOCL_NUM_IOCTLS
 };
@@ -454,6 +458,31 @@ struct drm_xocl_execbuf {
         uint32_t deps[8];
 };
 
+#define DRM_XOCL_EXECBUF_BATCH_MAX 64
+
+/**
+ * struct drm_xocl_execbuf_batch - Submit several exec buffers to the scheduler
+ * used with DRM_IOCTL_XOCL_EXECBUF_BATCH ioctl
+ *
+ * @ctx_id:        Pass 0
+ * @num_bos:       Number of exec buffer handles, at most DRM_XOCL_EXECBUF_BATCH_MAX
+ * @bo_handles:    User pointer to array of exec buffer handles
+ * @submitted:     On return, number of exec buffers added to the scheduler
+ * @pad:           Pass 0
+ *
+ * Exec buffers are added to the scheduler in array order, same as
+ * calling DRM_IOCTL_XOCL_EXECBUF without dependencies for each handle.
+ * Submission stops at the first exec buffer that fails, the ioctl then
+ * returns the error and @submitted is the index of the failing handle.
+ */
+struct drm_xocl_execbuf_batch {
+        uint32_t ctx_id;
+        uint32_t num_bos;
+        uint64_t bo_handles;
+        uint32_t submitted;
+        uint32_t pad;
+};
+
 /**
  * struct drm_xocl_user_intr - Register user's eventfd for MSIX interrupt
  * used with DRM_IOCTL_XOCL_USER_INTR ioctl
@@ -504,6 +533,8 @@ struct drm_xocl_user_intr {
 					       DRM_XOCL_DEBUG, struct drm_xocl_debug)
 #define DRM_IOCTL_XOCL_EXECBUF        DRM_IOWR(DRM_COMMAND_BASE +	\
 					       DRM_XOCL_EXECBUF, struct drm_xocl_execbuf)
+#define DRM_IOCTL_XOCL_EXECBUF_BATCH  DRM_IOWR(DRM_COMMAND_BASE +	\
+					       DRM_XOCL_EXECBUF_BATCH, struct drm_xocl_execbuf_batch)
 #define DRM_IOCTL_XOCL_USER_INTR      DRM_IOWR(DRM_COMMAND_BASE +	\
 					       DRM_XOCL_USER_INTR, struct drm_xocl_user_intr)
 
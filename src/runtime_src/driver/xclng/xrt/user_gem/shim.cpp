@@ -1173,6 +1173,37 @@ int xocl::XOCLShim::xclExecBuf(unsigned int cmdBO, size_t num_bo_in_wait_list, u
     return ret ? -errno : ret;
 }
 
+/*
+ * xclExecBufBatch()
+ *
+ * Exec buffers are submitted DRM_XOCL_EXECBUF_BATCH_MAX at a time.  A
+ * driver without the batch ioctl rejects it before submitting anything,
+ * the remaining exec buffers are then submitted one by one.
+ */
+int xocl::XOCLShim::xclExecBufBatch(size_t num_bo, unsigned int *cmdBOs)
+{
+    if (mLogStream.is_open()) {
+        mLogStream << __func__ << ", " << std::this_thread::get_id() << ", "
+                   << num_bo << ", " << cmdBOs << std::endl;
+    }
+    size_t idx = 0;
+    while (idx < num_bo) {
+        uint32_t count = std::min<size_t>(num_bo - idx, DRM_XOCL_EXECBUF_BATCH_MAX);
+        drm_xocl_execbuf_batch exec = {0, count, reinterpret_cast<uint64_t>(cmdBOs + idx), 0, 0};
+        int ret = ioctl(mUserHandle, DRM_IOCTL_XOCL_EXECBUF_BATCH, &exec);
+        if (!ret) {
+            idx += count;
+            continue;
+        }
+        if (exec.submitted || (errno != EINVAL && errno != ENOTTY))
+            return -errno;
+        for (; idx < num_bo; ++idx)
+            if ((ret = xclExecBuf(cmdBOs[idx])))
+                return ret;
+    }
+    return 0;
+}
+
 /*
  * xclRegisterEventNotify()
  */
@@ -1825,6 +1856,12 @@ int xclExecBufWithWaitList(xclDeviceHandle handle, unsigned int cmdBO, size_t nu
     return drv ? drv->xclExecBuf(cmdBO,num_bo_in_wait_list,bo_wait_list) : -ENODEV;
 }
 
+int xclExecBufBatch(xclDeviceHandle handle, size_t num_bo, unsigned int *cmdBOs)
+{
+    xocl::XOCLShim *drv = xocl::XOCLShim::handleCheck(handle);
+    return drv ? drv->xclExecBufBatch(num_bo,cmdBOs) : -ENODEV;
+}
+
 int xclRegisterEventNotify(xclDeviceHandle handle, unsigned int userInterrupt, int fd)
 {
     xocl::XOCLShim *drv = xocl::XOCLShim::handleCheck(handle);
@@ -236,6 +236,7 @@ public:
     // Execute and interrupt abstraction
     int xclExecBuf(unsigned int cmdBO);
     int xclExecBuf(unsigned int cmdBO,size_t numdeps, unsigned int* bo_wait_list);
+    int xclExecBufBatch(size_t num_bo, unsigned int* cmdBOs);
     int xclRegisterEventNotify(unsigned int userInterrupt, int fd);
     int xclExecWait(int timeoutMilliSec);
     int xclOpenContext(uuid_t xclbinId, unsigned int ipIndex, bool shared) const;
@@ -0,0 +1,86 @@
+/**
+ * Copyright (C) 2016-2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Expand a binary timeline trace (Debug.timeline_trace_binary) to the
+// csv timeline trace format
+//
+// % xtrace2csv sdaccel_timeline_trace.xtrace [sdaccel_timeline_trace.csv]
+
+#include "xdp/profile/rt_timeline_trace.h"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+static void
+usage(const char* prog)
+{
+  std::cout << "usage: " << prog << " <trace.xtrace> [<trace.csv>]\n"
+            << "  default output is the input file name with .csv extension\n";
+}
+
+static std::string
+default_output(const std::string& input)
+{
+  auto pos = input.find_last_of('.');
+  auto slash = input.find_last_of('/');
+  if (pos == std::string::npos || (slash != std::string::npos && pos < slash))
+    return input + ".csv";
+  return input.substr(0,pos) + ".csv";
+}
+
+static int
+run(int argc, char** argv)
+{
+  if (argc < 2 || argc > 3 || std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help") {
+    usage(argv[0]);
+    return argc == 2 ? 0 : 1;
+  }
+
+  std::string input = argv[1];
+  std::string output = (argc == 3) ? argv[2] : default_output(input);
+  if (output == input)
+    throw std::runtime_error("output file would overwrite input file '" + input + "'");
+
+  std::ofstream ofs(output);
+  if (!ofs.is_open())
+    throw std::runtime_error("unable to open '" + output + "' for writing");
+
+  auto records = XCL::timeline::convertToCSV(input,ofs);
+  ofs.close();
+  if (!ofs)
+    throw std::runtime_error("error writing '" + output + "'");
+
+  std::cout << "Converted " << records << " records to " << output << "\n";
+  return 0;
+}
+
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    return run(argc,argv);
+  }
+  catch (const std::exception& ex) {
+    std::cerr << "ERROR: " << ex.what() << "\n";
+  }
+  return 1;
+}
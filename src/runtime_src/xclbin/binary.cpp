@@ -16,31 +16,93 @@
 
 #include "binary.h"
 
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace xclbin {
 
-std::unique_ptr<binary::impl>
-create_xclbin0(std::vector<char>&& xb);
+void
+check_xclbin2(const char* raw, size_t size);
 
 std::unique_ptr<binary::impl>
-create_xclbin2(std::vector<char>&& xb);
+create_xclbin2(std::shared_ptr<const char>&& xb, size_t size);
 
-binary::
-binary(std::vector<char>&& xb)
-  : m_content(nullptr)
+namespace {
+
+// Check magic version and that binary is well formed.  Throws
+// before any ownership of the binary data is transferred.
+static void
+check_binary(const char* raw, size_t size)
 {
-  if (xb.size()<8)
+  if (size<8)
     throw error("bad binary");
 
-  const char* raw = &xb[0];
-
   // magic version
   std::string v(raw,raw+7);
   if (v=="xclbin2")
-    m_content = create_xclbin2(std::move(xb));
-  else 
+    check_xclbin2(raw,size);
+  else
     throw error("bad binary version '" + v + "'");
 }
 
 }
 
+binary::
+binary(std::vector<char>&& xb)
+  : m_content(nullptr)
+{
+  check_binary(xb.data(),xb.size());
+
+  auto size = xb.size();
+  auto data = std::make_shared<const std::vector<char>>(std::move(xb));
+  m_content = create_xclbin2(std::shared_ptr<const char>(data,data->data()),size);
+}
 
+binary::
+binary(const std::string& filename)
+  : m_content(nullptr)
+{
+  auto fd = open(filename.c_str(),O_RDONLY);
+  if (fd<0)
+    throw error("cannot open '" + filename + "': " + std::strerror(errno));
+
+  struct stat st;
+  if (fstat(fd,&st)) {
+    auto err = errno;
+    close(fd);
+    throw error("cannot stat '" + filename + "': " + std::strerror(err));
+  }
+
+  size_t size = st.st_size;
+  if (size<8) {
+    close(fd);
+    throw error("bad binary");
+  }
+
+  // Populate the mapping up front, the entire xclbin is needed for
+  // download and reading it in one go beats faulting it in page by
+  // page.  The mapping is private and read-only, so the pages are
+  // those of the page cache and shared between processes.
+  auto addr = mmap(nullptr,size,PROT_READ,MAP_PRIVATE|MAP_POPULATE,fd,0);
+  auto err = errno;
+  close(fd);
+  if (addr==MAP_FAILED)
+    throw error("cannot map '" + filename + "': " + std::strerror(err));
+
+  std::shared_ptr<const char> data
+    (static_cast<const char*>(addr),[size](const char* p) { munmap(const_cast<char*>(p),size); });
+
+  // Failure to populate is not reported, ask for read-ahead of any
+  // pages still missing
+  madvise(addr,size,MADV_WILLNEED);
+
+  check_binary(data.get(),size);
+  m_content = create_xclbin2(std::move(data),size);
+}
+
+}
@@ -20,6 +20,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <stdexcept>
 
 /**
  * This file contains a class for an xclbin binary.  It captures
@@ -54,10 +55,11 @@ public:
  * an xclbin only.  If an invalid function is called, it will throw
  * an xclbin::error exception.
  *
- * Then entire xclbin binary data is copied into this class, any data
- * returned through APIs maybe referencing a range of the data
- * maintained by the class, so the binary object must stay alive while
- * anything is referencing and sharing xclbin data.
+ * Then entire xclbin binary data is either copied into this class
+ * or mapped read-only from a file, any data returned through APIs
+ * maybe referencing a range of the data maintained by the class, so
+ * the binary object must stay alive while anything is referencing
+ * and sharing xclbin data.
  */
 class binary
 {
@@ -100,6 +102,19 @@ public:
   explicit
   binary(std::vector<char>&& xb);
 
+  /**
+   * Construct from xclbin file.
+   *
+   * The file is mapped read-only into memory, all data ranges are
+   * views into the mapping.  Processes loading the same xclbin file
+   * share the page cache pages of the file.
+   *
+   * @param filename
+   *  Path to xclbin file
+   */
+  explicit
+  binary(const std::string& filename);
+
   binary&
   operator=(const binary& rhs)
   {
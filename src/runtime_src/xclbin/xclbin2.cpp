@@ -32,21 +32,20 @@ namespace xclbin {
  */
 struct xclbin2 : public binary::impl
 {
-  const std::vector<char> m_xclbin;
+  const std::shared_ptr<const char> m_xclbin;
   const char* m_raw = nullptr;
   const axlf* m_axlf = nullptr;
   const axlf_header* m_header = nullptr;
 
-  explicit
-  xclbin2(std::vector<char>&& xb)
-    : m_xclbin(std::move(xb)), m_raw(&m_xclbin[0])
+  xclbin2(std::shared_ptr<const char>&& xb, size_t size)
+    : m_xclbin(std::move(xb)), m_raw(m_xclbin.get())
     , m_axlf(reinterpret_cast<const axlf*>(m_raw))
     , m_header(&m_axlf->m_header)
   {
-    if (m_xclbin.size() < sizeof(axlf))
+    if (size < sizeof(axlf))
       throw error("bad axlf file");
 
-    if (m_xclbin.size() < m_header->m_length)
+    if (size < m_header->m_length)
       throw error ("axlf length mismatch");
   }
 
@@ -142,22 +141,24 @@ struct xclbin2 : public binary::impl
 };
 
 // exposed to binary.cpp
-std::unique_ptr<binary::impl>
-create_xclbin2(std::vector<char>&& xb)
+void
+check_xclbin2(const char* raw, size_t size)
 {
-  // Before moving do sanity checks for proper xclbin2
-  if (xb.size() < sizeof(axlf))
+  // Before taking ownership do sanity checks for proper xclbin2
+  if (size < sizeof(axlf))
     throw error("bad axlf file");
 
-  auto xb2 = reinterpret_cast<const axlf*>(&xb[0]);
+  auto xb2 = reinterpret_cast<const axlf*>(raw);
   auto hdr = &xb2->m_header;
-  if (xb.size() < hdr->m_length)
+  if (size < hdr->m_length)
     throw error ("axlf length mismatch");
+}
 
-  // Ok we are probably good, any throws now breaks
-  // strong exception safety guarantee as xb is being
-  // moved
-  return xrt::make_unique<xclbin2>(std::move(xb));
+// exposed to binary.cpp
+std::unique_ptr<binary::impl>
+create_xclbin2(std::shared_ptr<const char>&& xb, size_t size)
+{
+  return xrt::make_unique<xclbin2>(std::move(xb),size);
 }
 
 
@@ -39,6 +39,7 @@
 #include "xdp/rt_singleton.h"
 #include "driver/include/xclperf.h"
 #include "xrt/util/message.h"
+#include "xrt/util/config_reader.h"
 
 namespace Profiling {
 
@@ -80,6 +81,7 @@ namespace Profiling {
       // Before deleting, do a final read of counters and force flush of trace buffers
       endDeviceProfiling();
     }
+    stopTraceOffload();
   }
 
   // Start device profiling
@@ -99,6 +101,11 @@ namespace Profiling {
       xdp::profile::platform::start_device_trace(rts->getcl_platform_id(),XCL_PERF_MON_ACCEL, numComputeUnits);
 
     mProfileRunning = true;
+
+    // Offload trace in the background so FIFOs do not overflow
+    auto offloadMsec = xrt::config::get_trace_offload_interval_ms();
+    if (offloadMsec && (rts->deviceTraceProfilingOn() || rts->deviceOclProfilingOn()))
+      startTraceOffload(offloadMsec);
   }
 
   // End device profiling (for a given program)
@@ -109,6 +116,9 @@ namespace Profiling {
     if (mEndDeviceProfilingCalled)
    	  return;
 
+    // Final flush below must not race with periodic offload
+    stopTraceOffload();
+
     auto rts = XCL::RTSingleton::Instance();
 
     if (rts && rts->applicationProfilingOn()) {
@@ -139,6 +149,44 @@ namespace Profiling {
     }
   }
 
+  // Start thread that periodically offloads device trace
+  // NOTE: trace is only read when FIFO fill level exceeds the samples threshold
+  void Profiler::startTraceOffload(unsigned int intervalMsec)
+  {
+    if (mTraceOffloadThread.joinable())
+      return;
+
+    mStopTraceOffload = false;
+    mTraceOffloadThread = std::thread(&Profiler::traceOffloadLoop, this, intervalMsec);
+  }
+
+  void Profiler::stopTraceOffload()
+  {
+    if (!mTraceOffloadThread.joinable())
+      return;
+
+    {
+      std::lock_guard<std::mutex> lk(mTraceOffloadMutex);
+      mStopTraceOffload = true;
+    }
+    mTraceOffloadCondition.notify_all();
+    mTraceOffloadThread.join();
+  }
+
+  void Profiler::traceOffloadLoop(unsigned int intervalMsec)
+  {
+    std::unique_lock<std::mutex> lk(mTraceOffloadMutex);
+    while (!mStopTraceOffload) {
+      mTraceOffloadCondition.wait_for(lk, std::chrono::milliseconds(intervalMsec));
+      if (mStopTraceOffload)
+        break;
+
+      lk.unlock();
+      getDeviceTrace(false);
+      lk.lock();
+    }
+  }
+
   // Get timestamp difference in usec (used for debug)
   uint32_t
   Profiler::getTimeDiffUsec(std::chrono::steady_clock::time_point start,
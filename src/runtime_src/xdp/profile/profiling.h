@@ -27,6 +27,10 @@
 
 #include <CL/opencl.h>
 #include <string>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 // Use Profiling::Profiler::Instance() to get to the singleton runtime object
 // Runtime code base can access the singleton and make decisions based on the
@@ -61,11 +65,21 @@ namespace Profiling {
     uint32_t getTimeDiffUsec(std::chrono::steady_clock::time_point start,
                              std::chrono::steady_clock::time_point end);
 
+    // Background offload of device trace so FIFOs are read before they fill
+    void startTraceOffload(unsigned int intervalMsec);
+    void stopTraceOffload();
+    void traceOffloadLoop(unsigned int intervalMsec);
+
   private:
     bool mProfileRunning = false;
     bool mEndDeviceProfilingCalled = false;
     static Profiler* mRTInstance;
 
+    std::thread mTraceOffloadThread;
+    std::mutex mTraceOffloadMutex;
+    std::condition_variable mTraceOffloadCondition;
+    bool mStopTraceOffload = false;
+
   };
   /*
    * Callback functions called from xocl
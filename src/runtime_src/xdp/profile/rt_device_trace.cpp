@@ -0,0 +1,87 @@
+/**
+ * Copyright (C) 2016-2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "rt_device_trace.h"
+
+namespace {
+
+static const uint32_t file_version = 1;
+
+}
+
+namespace XCL {
+
+const char*
+DeviceTraceEvent::
+typeName(uint8_t type)
+{
+  switch (type) {
+  case READ:      return "Read";
+  case WRITE:     return "Write";
+  case KERNEL:    return "Kernel";
+  case STALL_INT: return "Intra-Kernel Dataflow Stall";
+  case STALL_STR: return "Inter-Kernel Pipe Stall";
+  case STALL_EXT: return "External Memory Stall";
+  default:        return "";
+  }
+}
+
+DeviceTraceFileSink::
+DeviceTraceFileSink(const std::string& fileName)
+  : mStream(fileName, std::ios::out | std::ios::binary | std::ios::trunc)
+{
+  if (!mStream.is_open())
+    return;
+
+  uint32_t eventSize = sizeof(DeviceTraceEvent);
+  mStream.write("XDPTRACE",8);
+  mStream.write(reinterpret_cast<const char*>(&file_version),sizeof(file_version));
+  mStream.write(reinterpret_cast<const char*>(&eventSize),sizeof(eventSize));
+}
+
+DeviceTraceFileSink::
+~DeviceTraceFileSink()
+{
+  if (mStream.is_open())
+    mStream.close();
+}
+
+void
+DeviceTraceFileSink::
+write(const std::string& deviceName, const DeviceTraceEvent* events, size_t count)
+{
+  if (!count || !mStream.is_open())
+    return;
+
+  std::lock_guard<std::mutex> lk(mMutex);
+  uint32_t nameLength = deviceName.size();
+  uint32_t eventCount = count;
+  mStream.write(reinterpret_cast<const char*>(&nameLength),sizeof(nameLength));
+  mStream.write(deviceName.data(),nameLength);
+  mStream.write(reinterpret_cast<const char*>(&eventCount),sizeof(eventCount));
+  mStream.write(reinterpret_cast<const char*>(events),count*sizeof(DeviceTraceEvent));
+}
+
+void
+DeviceTraceFileSink::
+flush()
+{
+  std::lock_guard<std::mutex> lk(mMutex);
+  if (mStream.is_open())
+    mStream.flush();
+}
+
+} // XCL
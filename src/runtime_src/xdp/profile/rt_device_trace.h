@@ -0,0 +1,106 @@
+/**
+ * Copyright (C) 2016-2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __XILINX_RT_DEVICE_TRACE_H
+#define __XILINX_RT_DEVICE_TRACE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+namespace XCL {
+
+  // **************************************************************************
+  // Decoded device trace events
+  // **************************************************************************
+  // A decoded device trace event is a fixed size record with no strings.
+  // Names of slots, compute units and ports are resolved by the consumer
+  // of the event, usually only when the event is written to a file.
+  struct DeviceTraceEvent {
+    enum e_event_type : uint8_t {
+      READ = 0,
+      WRITE,
+      KERNEL,
+      STALL_INT,
+      STALL_STR,
+      STALL_EXT
+    };
+
+    double Start;        // host time domain (msec)
+    double End;          // host time domain (msec)
+    double TraceStart;   // host time domain (msec)
+    uint64_t StartTime;  // device cycles
+    uint64_t EndTime;    // device cycles
+    uint16_t SlotNum;
+    uint16_t BurstLength;
+    uint16_t NumBytes;
+    uint8_t Type;        // e_event_type
+    uint8_t Kind;        // DeviceTrace::e_device_kind
+
+    bool isKernel() const { return Type >= KERNEL; }
+    bool isStall() const { return Type > KERNEL; }
+    bool isRead() const { return Type == READ; }
+
+    // Type name as used in summary and timeline files
+    static const char* typeName(uint8_t type);
+    const char* typeName() const { return typeName(Type); }
+  };
+
+  // **************************************************************************
+  // Destination of decoded device trace events
+  // **************************************************************************
+  // The decoder hands over events in batches, a batch is only valid
+  // for the duration of the call.
+  class DeviceTraceSink {
+  public:
+    virtual ~DeviceTraceSink() {}
+
+    virtual void
+    write(const std::string& deviceName, const DeviceTraceEvent* events, size_t count) = 0;
+
+    virtual void
+    flush() {}
+  };
+
+  // Append events in binary form to a file
+  //
+  // File layout is a header followed by one block per write:
+  //   header: "XDPTRACE" uint32_t version, uint32_t sizeof(DeviceTraceEvent)
+  //   block:  uint32_t name length, device name, uint32_t count, events
+  class DeviceTraceFileSink : public DeviceTraceSink {
+  public:
+    explicit DeviceTraceFileSink(const std::string& fileName);
+    ~DeviceTraceFileSink();
+
+    bool
+    isOpen() const { return mStream.is_open(); }
+
+    void
+    write(const std::string& deviceName, const DeviceTraceEvent* events, size_t count) override;
+
+    void
+    flush() override;
+
+  private:
+    std::mutex mMutex;
+    std::ofstream mStream;
+  };
+
+} // XCL
+
+#endif
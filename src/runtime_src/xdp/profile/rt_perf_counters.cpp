@@ -32,6 +32,24 @@
 #include <iomanip>
 #include <algorithm>
 #include <ctime>
+#include <atomic>
+
+namespace {
+
+// Every counter object gets a unique generation so that a thread's
+// cached statistics are never used with a counter object that reuses
+// the address of a deleted one.
+static std::atomic<uint64_t> s_generation {0};
+
+struct thread_stats
+{
+  uint64_t generation = 0;
+  void* stats = nullptr;
+};
+
+static thread_local thread_stats t_stats;
+
+}
 
 namespace XCL {
   // ****************
@@ -40,29 +58,30 @@ namespace XCL {
   template <typename T>
   void TimeTraceSortedTopUsage<T>::push(T* newElement)
   {
-    auto itr = Storage.begin();
-    while (itr != Storage.end()) {
-      if ((*itr)->getDuration() < newElement->getDuration()) {
-        break;
-      }
-      itr++;
-    }
-    if (itr == Storage.end()) {
+    if (Storage.size() < Limit) {
       Storage.push_back(newElement);
+      std::push_heap(Storage.begin(), Storage.end(), longer);
+      return;
     }
-    else {
-      Storage.insert(itr, newElement);
-    }
-    if (Storage.size() > Limit) {
-      T::recycle(Storage.back());
-      Storage.pop_back();
+
+    // Shortest element kept is at the front of the heap
+    if (Limit == 0 || !(Storage.front()->getDuration() < newElement->getDuration())) {
+      T::recycle(newElement);
+      return;
     }
+
+    std::pop_heap(Storage.begin(), Storage.end(), longer);
+    T::recycle(Storage.back());
+    Storage.back() = newElement;
+    std::push_heap(Storage.begin(), Storage.end(), longer);
   }
 
   template <typename T>
   void TimeTraceSortedTopUsage<T>::writeTopUsageSummary(WriterI* writer) const
   {
-    for (const auto &it : Storage) {
+    std::vector<T*> sorted(Storage);
+    std::sort(sorted.begin(), sorted.end(), longer);
+    for (const auto &it : sorted) {
       it->write(writer);
     }
   }
@@ -75,7 +94,77 @@ namespace XCL {
     TopKernelReadTimes(), TopKernelWriteTimes(),
     TopDeviceBufferReadTimes(), TopDeviceBufferWriteTimes()
   {
-    // do nothing
+    Generation = ++s_generation;
+  }
+
+  PerformanceCounter::ThreadStats& PerformanceCounter::getThreadStats(int threadIndex)
+  {
+    if (threadIndex < 0) {
+      if (t_stats.generation == Generation)
+        return *static_cast<ThreadStats*>(t_stats.stats);
+      return addThreadStats();
+    }
+
+    std::lock_guard<std::mutex> lock(ThreadStatsMutex);
+    if (static_cast<size_t>(threadIndex) >= IndexedThreadStats.size())
+      IndexedThreadStats.resize(threadIndex + 1, nullptr);
+    auto& stats = IndexedThreadStats[threadIndex];
+    if (!stats) {
+      AllThreadStats.emplace_back(new ThreadStats);
+      stats = AllThreadStats.back().get();
+    }
+    return *stats;
+  }
+
+  PerformanceCounter::ThreadStats& PerformanceCounter::addThreadStats()
+  {
+    // Statistics are owned by the counter object and outlive the thread
+    std::lock_guard<std::mutex> lock(ThreadStatsMutex);
+    AllThreadStats.emplace_back(new ThreadStats);
+    t_stats.generation = Generation;
+    t_stats.stats = AllThreadStats.back().get();
+    return *AllThreadStats.back();
+  }
+
+  const std::string* PerformanceCounter::internKernelName(const std::string& kernelName, uint32_t& kernelID)
+  {
+    std::lock_guard<std::mutex> lock(ThreadStatsMutex);
+    auto itr = KernelNameIds.find(kernelName);
+    if (itr == KernelNameIds.end()) {
+      itr = KernelNameIds.emplace(kernelName, KernelNames.size()).first;
+      KernelNames.push_back(kernelName);
+    }
+    kernelID = itr->second;
+    return &KernelNames[kernelID];
+  }
+
+  // Merge statistics of all threads, keyed by name
+  std::map<std::string, TimeStats> PerformanceCounter::getCallCount() const
+  {
+    std::map<std::string, TimeStats> callCount;
+    std::lock_guard<std::mutex> lock(ThreadStatsMutex);
+    for (auto& stats : AllThreadStats) {
+      std::lock_guard<std::mutex> lk(stats->Mutex);
+      for (auto& entry : stats->CallCount) {
+        if (entry.first)
+          callCount[entry.first].merge(entry.second);
+      }
+    }
+    return callCount;
+  }
+
+  std::map<std::string, TimeStats> PerformanceCounter::getKernelExecutionStats() const
+  {
+    std::map<std::string, TimeStats> kernelStats;
+    std::lock_guard<std::mutex> lock(ThreadStatsMutex);
+    for (auto& stats : AllThreadStats) {
+      std::lock_guard<std::mutex> lk(stats->Mutex);
+      for (auto& entry : stats->KernelExecutionStats) {
+        if (entry.first)
+          kernelStats[*entry.first].merge(entry.second);
+      }
+    }
+    return kernelStats;
   }
 
   void PerformanceCounter::logBufferRead(size_t size, double duration, uint32_t contextId, uint32_t numDevices) {
@@ -142,20 +231,44 @@ namespace XCL {
       DeviceKernelWriteSummaryStats[name].log(size, duration, bitWidth, clockFreqMhz);
   }
 
-  void PerformanceCounter::logFunctionCallStart(const std::string& functionName, double timePoint)
+  void PerformanceCounter::logFunctionCallStart(const char* functionName, unsigned int functionID,
+                                                double timePoint, int threadIndex)
   {
-    CallCount[functionName].logStart(timePoint);
+    auto& stats = getThreadStats(threadIndex);
+    std::lock_guard<std::mutex> lock(stats.Mutex);
+    if (functionID >= stats.CallCount.size())
+      stats.CallCount.resize(functionID + 1, {nullptr, TimeStats()});
+    auto& entry = stats.CallCount[functionID];
+    entry.first = functionName;
+    entry.second.logStart(timePoint);
   }
 
-  void PerformanceCounter::logFunctionCallEnd(const std::string& functionName, double timePoint)
+  void PerformanceCounter::logFunctionCallEnd(const char* functionName, unsigned int functionID,
+                                              double timePoint, int threadIndex)
   {
-    CallCount[functionName].logEnd(timePoint);
+    auto& stats = getThreadStats(threadIndex);
+    std::lock_guard<std::mutex> lock(stats.Mutex);
+    if (functionID >= stats.CallCount.size())
+      stats.CallCount.resize(functionID + 1, {nullptr, TimeStats()});
+    auto& entry = stats.CallCount[functionID];
+    entry.first = functionName;
+    entry.second.logEnd(timePoint);
   }
 
   void PerformanceCounter::logKernelExecutionStart(const std::string& kernelName, const std::string& deviceName,
                                                    double timePoint)
   {
-    KernelExecutionStats[kernelName].logStart(timePoint);
+    uint32_t kernelID = 0;
+    auto name = internKernelName(kernelName, kernelID);
+    {
+      auto& stats = getThreadStats();
+      std::lock_guard<std::mutex> lock(stats.Mutex);
+      if (kernelID >= stats.KernelExecutionStats.size())
+        stats.KernelExecutionStats.resize(kernelID + 1, {nullptr, TimeStats()});
+      auto& entry = stats.KernelExecutionStats[kernelID];
+      entry.first = name;
+      entry.second.logStart(timePoint);
+    }
 
     auto iter = DeviceStartTimes.find(deviceName);
     if (iter == DeviceStartTimes.end())
@@ -167,7 +280,17 @@ namespace XCL {
   void PerformanceCounter::logKernelExecutionEnd(const std::string& kernelName, const std::string& deviceName,
                                                  double timePoint)
   {
-    KernelExecutionStats[kernelName].logEnd(timePoint);
+    uint32_t kernelID = 0;
+    auto name = internKernelName(kernelName, kernelID);
+    {
+      auto& stats = getThreadStats();
+      std::lock_guard<std::mutex> lock(stats.Mutex);
+      if (kernelID >= stats.KernelExecutionStats.size())
+        stats.KernelExecutionStats.resize(kernelID + 1, {nullptr, TimeStats()});
+      auto& entry = stats.KernelExecutionStats[kernelID];
+      entry.first = name;
+      entry.second.logEnd(timePoint);
+    }
 
     auto iter = DeviceEndTimes.find(deviceName);
     if (iter == DeviceEndTimes.end())
@@ -366,7 +489,7 @@ namespace XCL {
 #else
     // FYI, method used pre-2015.4
     double totalTime = 0.0;
-    for (const auto &pair : KernelExecutionStats) {
+    for (const auto &pair : getKernelExecutionStats()) {
       TimeStats stats = pair.second;
       totalTime += stats.getTotalTime();
     }
@@ -414,7 +537,7 @@ namespace XCL {
 
   void PerformanceCounter::writeKernelSummary(WriterI* writer) const
   {
-    for (const auto &pair : KernelExecutionStats) {
+    for (const auto &pair : getKernelExecutionStats()) {
       auto fullName = pair.first;
       auto kernelName = fullName.substr(0, fullName.find_first_of("|"));
       writer->writeSummary(kernelName, pair.second);
@@ -448,8 +571,9 @@ namespace XCL {
     // Print it in sorted order of Total Time. To sort it by duration
     // populate a vector and then using lambda function sort it by duration
 
-    vector<pair<string, TimeStats>> callPairs(CallCount.begin(),
-        CallCount.end());
+    auto callCount = getCallCount();
+    vector<pair<string, TimeStats>> callPairs(callCount.begin(),
+        callCount.end());
     sort(callPairs.begin(), callPairs.end(),
         [](const pair<string, TimeStats>& A, const pair<string, TimeStats>& B) {
       return A.second.getTotalTime() > B.second.getTotalTime();
@@ -22,8 +22,12 @@
 #include <limits>
 #include <cstdint>
 #include <map>
-#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
+#include <deque>
 
 //#define BUFFER_STAT_PER_CONTEXT 1
 
@@ -33,9 +37,10 @@
 namespace XCL {
   class WriterI;
 
-  // Sorted list that keeps top 10 most time taking (end - start) Kernel/Buffer Trace
-  // A simple singly linked list where a linear search is done to ensure sorted
-  // list. This is expected to have at max 10 elements
+  // Keeps top 10 most time taking (end - start) Kernel/Buffer Trace
+  // Elements are kept in a min heap on duration so a new element is only
+  // compared against the shortest one kept. Elements are sorted by duration
+  // when the summary is written.
   template <typename T>
   class TimeTraceSortedTopUsage {
 
@@ -48,8 +53,12 @@ namespace XCL {
     void writeTopUsageSummary(WriterI* writer) const;
 
   private:
+    static bool longer(const T* a, const T* b) {
+      return a->getDuration() > b->getDuration();
+    }
+
     size_t Limit;   // Maximum numbers of elements allowed
-    std::list<T*> Storage;
+    std::vector<T*> Storage;
   };
 
   // Performance counters
@@ -77,8 +86,13 @@ namespace XCL {
     void logDeviceKernel(size_t size, double duration);
     void logDeviceKernelTransfer(std::string& deviceName, std::string& kernelName, size_t size, double duration,
                                  uint32_t bitWidth, double clockFreqMhz, bool isRead);
-    void logFunctionCallStart(const std::string& functionName, double timePoint);
-    void logFunctionCallEnd(const std::string& functionName, double timePoint);
+    // functionID is the interned ID of functionName, see xocl::profile::get_function_call_id.
+    // threadIndex identifies the thread that made the call when it is logged
+    // by another thread, by default the call was made by the calling thread.
+    void logFunctionCallStart(const char* functionName, unsigned int functionID, double timePoint,
+                              int threadIndex = -1);
+    void logFunctionCallEnd(const char* functionName, unsigned int functionID, double timePoint,
+                            int threadIndex = -1);
     void logKernelExecutionStart(const std::string& kernelName, const std::string& deviceName, double timePoint);
     void logKernelExecutionEnd(const std::string& kernelName, const std::string& deviceName, double timePoint);
     void logComputeUnitDeviceStart(const std::string& deviceName, double timePoint);
@@ -119,6 +133,21 @@ namespace XCL {
     void writeTopDataTransferSummary(WriterI* writer, bool isRead) const;
     void writeTopDeviceTransferSummary(WriterI* writer, bool isRead) const;
 
+  private:
+    // API call and kernel execution statistics of one logging thread,
+    // indexed by interned name ID and merged when the summary is written
+    struct ThreadStats {
+      std::mutex Mutex;
+      std::vector<std::pair<const char*, TimeStats>> CallCount;
+      std::vector<std::pair<const std::string*, TimeStats>> KernelExecutionStats;
+    };
+
+    ThreadStats& getThreadStats(int threadIndex = -1);
+    ThreadStats& addThreadStats();
+    const std::string* internKernelName(const std::string& kernelName, uint32_t& kernelID);
+    std::map<std::string, TimeStats> getCallCount() const;
+    std::map<std::string, TimeStats> getKernelExecutionStats() const;
+
   private:
 	void writeBufferStat(WriterI* writer, const std::string transferType,
 	    const BufferStats &bufferStat, double maxTransferRateMBps) const;
@@ -137,11 +166,15 @@ namespace XCL {
     std::map<std::string, double> DeviceCUStartTimes;
     std::map<std::string, double> DeviceStartTimes;
     std::map<std::string, double> DeviceEndTimes;
-    std::map<std::string, TimeStats> CallCount;
-    std::map<std::string, TimeStats> KernelExecutionStats;
     std::map<std::string, TimeStats> ComputeUnitExecutionStats;
     std::map<std::string, BufferStats> DeviceKernelReadSummaryStats;
     std::map<std::string, BufferStats> DeviceKernelWriteSummaryStats;
+    uint64_t Generation;
+    mutable std::mutex ThreadStatsMutex;
+    std::vector<std::unique_ptr<ThreadStats>> AllThreadStats;
+    std::vector<ThreadStats*> IndexedThreadStats;
+    std::unordered_map<std::string, uint32_t> KernelNameIds;
+    std::deque<std::string> KernelNames;   // stable addresses
     TimeTraceSortedTopUsage<KernelTrace> TopKernelTimes;
     TimeTraceSortedTopUsage<BufferTrace> TopBufferReadTimes;
     TimeTraceSortedTopUsage<BufferTrace> TopBufferWriteTimes;
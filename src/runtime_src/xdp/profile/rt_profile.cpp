@@ -27,6 +27,7 @@
 //#include <CL/opencl.h>
 #include "xocl/core/device.h"
 #include "xocl/xclbin/xclbin.h"
+#include "xrt/util/config_reader.h"
 #include "../../driver/include/xclperf.h"
 
 #include <iostream>
@@ -35,6 +36,7 @@
 #include <iomanip>
 #include <algorithm>
 #include <ctime>
+#include <cstring>
 #include <cassert>
 
 // Uncomment to use device-based timestamps in timeline trace
@@ -52,13 +54,30 @@ namespace XCL {
     MigrateMemCalls(0),
     FunctionStartLogged(false),
     DeviceTraceOption(DEVICE_TRACE_OFF),
-    StallTraceOption(STALL_TRACE_OFF)
+    StallTraceOption(STALL_TRACE_OFF),
+    ApiTraceBufferOn(xrt::config::get_api_trace_buffer())
   {
+    // Event IDs of API functions are resolved on first call
+    for (auto& id : FunctionEventIDs)
+      id = XCL_PERF_MON_PROGRAM_END;
+    FunctionMigrateMem.fill(0);
+
     // Create device profiler (may or may not be used during given run)
     DeviceProfile = new RTProfileDevice();
 
     // Profile rule checks
     RuleChecks = new ProfileRuleChecks();
+
+    // Decoded device trace events are also written to a binary file
+    auto traceFile = xrt::config::get_device_trace_file();
+    if (!traceFile.empty()) {
+      DeviceTraceFile.reset(new DeviceTraceFileSink(traceFile));
+      if (DeviceTraceFile->isOpen())
+        setDeviceTraceSink(DeviceTraceFile.get());
+      else
+        xrt::message::send(xrt::message::severity_level::WARNING,
+            "Unable to open device trace file " + traceFile);
+    }
     
     // Indeces are now same for HW and emulation
     OclSlotIndex  = XPAR_SPM0_FIRST_KERNEL_SLOT;
@@ -584,41 +603,92 @@ else if (functionName.find("clEnqueueMigrateMemObjects") != std::string::npos)
     return XCL_PERF_MON_IGNORE_EVENT;
   }
 
-  void RTProfile::logFunctionCallStart(const char* functionName, long long queueAddress)
+  xclPerfMonEventID
+  RTProfile::getFunctionEventID(const char* functionName, unsigned int functionID)
   {
-#ifdef USE_DEVICE_TIMELINE
-    double timeStamp = getDeviceTimeStamp(getTraceTime(), CurrentDeviceName);
-#else
-    double timeStamp = getTraceTime();
-#endif
+    if (functionID >= FunctionEventIDs.size())
+      return getFunctionEventID(std::string(functionName), 0LL);
+
+    // Concurrent first calls compute the same value
+    auto eventID = FunctionEventIDs[functionID].load(std::memory_order_relaxed);
+    if (eventID == XCL_PERF_MON_PROGRAM_END) {
+      eventID = getFunctionEventID(std::string(functionName), 0LL);
+      FunctionEventIDs[functionID].store(eventID, std::memory_order_relaxed);
+    }
+    return static_cast<xclPerfMonEventID>(eventID);
+  }
 
-    std::string name(functionName);
-    if (name.find("MigrateMem") != std::string::npos)
+  // LogMutex must be held
+  bool
+  RTProfile::isMigrateMemFunction(const char* functionName, unsigned int functionID)
+  {
+    if (functionID >= FunctionMigrateMem.size())
+      return std::strstr(functionName, "MigrateMem") != nullptr;
+
+    auto& migrate = FunctionMigrateMem[functionID];
+    if (!migrate)
+      migrate = std::strstr(functionName, "MigrateMem") ? 2 : 1;
+    return migrate == 2;
+  }
+
+  // Log function call to summary and timeline trace, LogMutex must be held
+  void RTProfile::logFunctionCall(const char* functionName, long long queueAddress,
+                                  unsigned int functionID, double timeStamp, bool start,
+                                  int threadIndex)
+  {
+    if (start && isMigrateMemFunction(functionName, functionID))
       MigrateMemCalls++;
 
+    if (start)
+      PerfCounters.logFunctionCallStart(functionName, functionID, timeStamp, threadIndex);
+    else
+      PerfCounters.logFunctionCallEnd(functionName, functionID, timeStamp, threadIndex);
+
+    if (!this->isTimelineTraceFileOn())
+      return;
+
+    std::string name(functionName);
     if (queueAddress == 0)
       name += "|General";
     else
       (name += "|") +=std::to_string(queueAddress);
-    std::lock_guard<std::mutex> lock(LogMutex);
-    PerfCounters.logFunctionCallStart(functionName, timeStamp);
-    writeTimelineTrace(timeStamp, name.c_str(), "START");
-    FunctionStartLogged = true;
+    writeTimelineTrace(timeStamp, name.c_str(), start ? "START" : "END");
+  }
+
+  void RTProfile::logFunctionCallStart(const char* functionName, long long queueAddress,
+                                       unsigned int functionID)
+  {
+#ifdef USE_DEVICE_TIMELINE
+    double timeStamp = getDeviceTimeStamp(getTraceTime(), CurrentDeviceName);
+#else
+    double timeStamp = getTraceTime();
+#endif
+
+    if (ApiTraceBufferOn) {
+      if (ApiTraceBuffer.log(timeStamp, functionName, queueAddress, functionID, true))
+        flushApiTrace();
+    }
+    else {
+      std::lock_guard<std::mutex> lock(LogMutex);
+      logFunctionCall(functionName, queueAddress, functionID, timeStamp, true);
+      FunctionStartLogged = true;
+    }
 
     // Write host event to trace buffer
-    xclPerfMonEventID eventID = getFunctionEventID(name, queueAddress);
+    xclPerfMonEventID eventID = getFunctionEventID(functionName, functionID);
     if (eventID != XCL_PERF_MON_IGNORE_EVENT) {
       xclPerfMonEventType eventType = XCL_PERF_MON_START_EVENT;
       xdp::profile::platform::write_host_event(XCL::RTSingleton::Instance()->getcl_platform_id(), eventType, eventID);
     }
   }
 
-  void RTProfile::logFunctionCallEnd(const char* functionName, long long queueAddress)
+  void RTProfile::logFunctionCallEnd(const char* functionName, long long queueAddress,
+                                     unsigned int functionID)
   {
     // Log function call start if not done so already
     // NOTE: this addresses a race condition when constructing the singleton (CR 963297)
-    if (!FunctionStartLogged)
-      logFunctionCallStart(functionName, queueAddress);
+    if (!ApiTraceBufferOn && !FunctionStartLogged)
+      logFunctionCallStart(functionName, queueAddress, functionID);
 
 #ifdef USE_DEVICE_TIMELINE
     double timeStamp = getDeviceTimeStamp(getTraceTime(), CurrentDeviceName);
@@ -626,24 +696,34 @@ else if (functionName.find("clEnqueueMigrateMemObjects") != std::string::npos)
     double timeStamp = getTraceTime();
 #endif
 
-    std::string name(functionName);
-    if (queueAddress == 0)
-      name += "|General";
-    else
-      (name += "|") +=std::to_string(queueAddress);
-
-    std::lock_guard<std::mutex> lock(LogMutex);
-    PerfCounters.logFunctionCallEnd(functionName, timeStamp);
-    writeTimelineTrace(timeStamp, name.c_str(), "END");
+    if (ApiTraceBufferOn) {
+      if (ApiTraceBuffer.log(timeStamp, functionName, queueAddress, functionID, false))
+        flushApiTrace();
+    }
+    else {
+      std::lock_guard<std::mutex> lock(LogMutex);
+      logFunctionCall(functionName, queueAddress, functionID, timeStamp, false);
+    }
 
     // Write host event to trace buffer
-    xclPerfMonEventID eventID = getFunctionEventID(name, queueAddress);
+    xclPerfMonEventID eventID = getFunctionEventID(functionName, functionID);
     if (eventID != XCL_PERF_MON_IGNORE_EVENT) {
       xclPerfMonEventType eventType = XCL_PERF_MON_END_EVENT;
       xdp::profile::platform::write_host_event(XCL::RTSingleton::Instance()->getcl_platform_id(), eventType, eventID);
     }
   }
 
+  // Format and log all API calls recorded in the trace buffer so far.
+  // Called when a thread fills a trace chunk and before writing summary.
+  void RTProfile::flushApiTrace()
+  {
+    std::lock_guard<std::mutex> lock(LogMutex);
+    ApiTraceRecords.clear();
+    ApiTraceBuffer.drain(ApiTraceRecords);
+    for (auto& r : ApiTraceRecords)
+      logFunctionCall(r.functionName, r.queueAddress, r.functionID, r.timestamp, r.start, r.threadIndex);
+  }
+
   // Write API call events to trace
   void RTProfile::writeTimelineTrace( double traceTime,
       const char* functionName, const char* eventName) const
@@ -770,20 +850,36 @@ else if (functionName.find("clEnqueueMigrateMemObjects") != std::string::npos)
 
   // Log device trace results
   void RTProfile::logDeviceTrace(std::string deviceName, std::string binaryName,
-      xclPerfMonType type, xclTraceResultsVector& traceVector) {
+      xclPerfMonType type, xclTraceResultsVector& traceVector, bool flush) {
     if (DeviceProfile == NULL || traceVector.mLength == 0)
       return;
 
-    std::lock_guard<std::mutex> lock(LogMutex);
-    RTProfileDevice::TraceResultVector resultVector;
-    DeviceProfile->logTrace(deviceName, type, traceVector, resultVector);
+    // Decoded events go to summary, timeline writers, and optional sink
+    class ProfileSink : public DeviceTraceSink {
+    public:
+      ProfileSink(RTProfile* profile, const std::string& binaryName)
+        : mProfile(profile), mBinaryName(binaryName) {}
+      void write(const std::string& deviceName, const DeviceTraceEvent* events, size_t count) override {
+        mProfile->logDeviceTraceEvents(deviceName, mBinaryName, events, count);
+      }
+    private:
+      RTProfile* mProfile;
+      const std::string& mBinaryName;
+    };
 
-    if (resultVector.empty())
-      return;
+    std::lock_guard<std::mutex> lock(LogMutex);
+    ProfileSink sink(this, binaryName);
+    DeviceProfile->logTrace(deviceName, type, traceVector, sink, flush);
+    if (flush && DeviceTraceOutput)
+      DeviceTraceOutput->flush();
+  }
 
+  // Log decoded device trace events
+  void RTProfile::logDeviceTraceEvents(const std::string& deviceName, const std::string& binaryName,
+      const DeviceTraceEvent* events, size_t count) {
     // Log for summary purposes
-    uint64_t index = 0;
-    for (auto it = resultVector.begin(); it != resultVector.end(); it++) {
+    for (size_t i = 0; i < count; i++) {
+      const DeviceTraceEvent& event = events[i];
       DeviceTrace* tr = DeviceTrace::reuse();
 
       // Copy trace results
@@ -791,22 +887,22 @@ else if (functionName.find("clEnqueueMigrateMemObjects") != std::string::npos)
       tr->DeviceName = deviceName;
       tr->Name = CurrentKernelName;
       tr->ContextId = CurrentContextId;
-      tr->SlotNum = (*it).SlotNum;
-      tr->Type = (*it).Type;
-      tr->Kind = (*it).Kind;
-      tr->BurstLength = (*it).BurstLength;
-      tr->NumBytes = (*it).NumBytes;
-      tr->StartTime = (*it).StartTime;
-      tr->EndTime = (*it).EndTime;
-      tr->TraceStart = (*it).TraceStart;
-      tr->Start = (*it).Start;
-      tr->End = (*it).End;
+      tr->SlotNum = event.SlotNum;
+      tr->Type = event.typeName();
+      tr->Kind = static_cast<DeviceTrace::e_device_kind>(event.Kind);
+      tr->BurstLength = event.BurstLength;
+      tr->NumBytes = event.NumBytes;
+      tr->StartTime = event.StartTime;
+      tr->EndTime = event.EndTime;
+      tr->TraceStart = event.TraceStart;
+      tr->Start = event.Start;
+      tr->End = event.End;
 
       double durationMsec = tr->End - tr->Start;
 
       // Log trace results
       bool isKernel = (tr->Type.find("Kernel") != std::string::npos);
-      bool isRead = (tr->Type == "Read");
+      bool isRead = event.isRead();
       bool isKernelTransfer = (tr->Kind == DeviceTrace::DEVICE_KERNEL);
       PerfCounters.logDeviceEvent(tr->DeviceName, tr->Name, tr->NumBytes, durationMsec,
           DeviceProfile->getGlobalMemoryBitWidth(), DeviceProfile->getGlobalMemoryClockFreqMHz(),
@@ -814,14 +910,15 @@ else if (functionName.find("clEnqueueMigrateMemObjects") != std::string::npos)
       PerfCounters.pushToSortedTopUsage(tr, isRead, isKernelTransfer);
     }
 
-    // Write trace results vector to files
+    // Write trace results to files
     if (this->isTimelineTraceFileOn()) {
       for (auto w : Writers) {
-        w->writeDeviceTrace(resultVector, deviceName, binaryName);
+        w->writeDeviceTrace(events, count, deviceName, binaryName);
       }
     }
 
-    resultVector.clear();
+    if (DeviceTraceOutput)
+      DeviceTraceOutput->write(deviceName, events, count);
   }
 
   uint32_t RTProfile::getCounterValue(xclPerfMonCounterType type, uint32_t slotnum,
@@ -1478,6 +1575,8 @@ else if (functionName.find("clEnqueueMigrateMemObjects") != std::string::npos)
     if(!this->isApplicationProfileOn())
       return;
 
+    flushApiTrace();
+
     for (auto w : Writers) {
       w->writeSummary(this);
     }
@@ -1576,6 +1675,13 @@ else if (functionName.find("clEnqueueMigrateMemObjects") != std::string::npos)
       mLoggingTrace[index] = value;
   }
 
+  bool RTProfile::tryLoggingTrace(int index)
+  {
+    if (index >= XCL_PERF_MON_TOTAL_PROFILE)
+      return false;
+    return !mLoggingTrace[index].exchange(true);
+  }
+
   uint64_t RTProfile::getLoggingTraceUsec() 
   {
     return mLoggingTraceUsec;
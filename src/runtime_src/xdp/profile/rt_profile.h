@@ -21,6 +21,7 @@
 #include "rt_profile_device.h"
 #include "rt_profile_results.h"
 #include "rt_profile_xocl.h"
+#include "rt_profile_api_trace.h"
 #include "xrt/util/time.h"
 //#include <chrono>
 //#include <time.h>
@@ -35,6 +36,9 @@
 #include <thread>
 #include <mutex>
 #include <queue>
+#include <array>
+#include <atomic>
+#include <memory>
 
 namespace XCL {
   class WriterI;
@@ -143,7 +147,9 @@ namespace XCL {
     uint32_t getTraceSamplesThreshold();
     uint32_t getSampleIntervalMsec();
     void logDeviceTrace(std::string deviceName, std::string binaryName, xclPerfMonType type,
-        xclTraceResultsVector& traceVector);
+        xclTraceResultsVector& traceVector, bool flush = true);
+    // Additional destination of decoded device trace events (not owned)
+    void setDeviceTraceSink(DeviceTraceSink* sink) { DeviceTraceOutput = sink; }
     void logDeviceCounters(std::string deviceName, std::string binaryName, xclPerfMonType type,
         xclCounterResults& counterResults, uint64_t timeNsec, bool firstReadAfterProgram);
 
@@ -172,8 +178,16 @@ namespace XCL {
       const std::string eventString, const std::string dependString);
 
     // log user or cl API function calls
-    void logFunctionCallStart(const char* functionName, long long queueAddress);
-    void logFunctionCallEnd(const char* functionName, long long queueAddress);
+    void logFunctionCallStart(const char* functionName, long long queueAddress,
+                              unsigned int functionID);
+    void logFunctionCallEnd(const char* functionName, long long queueAddress,
+                            unsigned int functionID);
+
+    // API trace buffer mode, function calls are logged as binary
+    // records and formatted when the trace is flushed
+    void setApiTraceBuffer(bool value) { ApiTraceBufferOn = value; }
+    bool isApiTraceBufferOn() const { return ApiTraceBufferOn; }
+    void flushApiTrace();
 
 
   public:
@@ -226,6 +240,13 @@ namespace XCL {
     void getKernelFromComputeUnit(const std::string& cuName, std::string& kernelName) const;
     void getTraceStringFromComputeUnit(const std::string& deviceName, const std::string& cuName, std::string& traceString) const;
 
+  public:
+    // Host event ID of API function, second form caches by function call id
+    xclPerfMonEventID getFunctionEventID(const std::string &functionName, long long queueAddress);
+    xclPerfMonEventID getFunctionEventID(const char* functionName, unsigned int functionID);
+    // Is API function a migration of memory objects, cached by function call id
+    bool isMigrateMemFunction(const char* functionName, unsigned int functionID);
+
   public:
     double getTraceTime();
 
@@ -247,10 +268,14 @@ namespace XCL {
 
     bool getLoggingTrace(int index);
     void setLoggingTrace(int index, bool value);
+    // Atomically claim logging of trace, false if already being logged
+    bool tryLoggingTrace(int index);
     uint64_t getLoggingTraceUsec();
     void setLoggingTraceUsec(uint64_t value);
 
   private:
+    void logDeviceTraceEvents(const std::string& deviceName, const std::string& binaryName,
+        const DeviceTraceEvent* events, size_t count);
     uint32_t getCounterValue(xclPerfMonCounterType type, uint32_t slotnum,
         xclCounterResults& results) const;
     double getDeviceTimeStamp(double hostTimeStamp, std::string& deviceName);
@@ -259,7 +284,9 @@ namespace XCL {
     void commandStageToString(e_profile_command_state objStage,
         std::string& stageString) const;
     void setTimeStamp(e_profile_command_state objStage, TimeTrace* traceObject, double timeStamp);
-    xclPerfMonEventID getFunctionEventID(const std::string &functionName, long long queueAddress);
+    void logFunctionCall(const char* functionName, long long queueAddress,
+                         unsigned int functionID, double timeStamp, bool start,
+                         int threadIndex = -1);
 
     void setArgumentsBank(const std::string& deviceName);
 
@@ -307,7 +334,15 @@ namespace XCL {
     std::map<uint64_t, BufferTrace*> BufferTraceMap;
     std::map<uint64_t, DeviceTrace*> DeviceTraceMap;
     std::mutex LogMutex;
+    bool ApiTraceBufferOn;
+    ApiTrace ApiTraceBuffer;
+    std::vector<ApiTrace::record> ApiTraceRecords;
+    std::array<std::atomic<unsigned int>, 256> FunctionEventIDs;
+    // 0: unknown, 1: not migrate, 2: migrate (LogMutex must be held)
+    std::array<uint8_t, 256> FunctionMigrateMem;
     RTProfileDevice* DeviceProfile;
+    DeviceTraceSink* DeviceTraceOutput = nullptr;
+    std::unique_ptr<DeviceTraceFileSink> DeviceTraceFile;
     ProfileRuleChecks* RuleChecks;
 
   private:
@@ -317,7 +352,7 @@ namespace XCL {
 
   // Platform data and Device data
   private:
-    bool mLoggingTrace[XCL_PERF_MON_TOTAL_PROFILE] = {false};
+    std::atomic<bool> mLoggingTrace[XCL_PERF_MON_TOTAL_PROFILE] = {};
     uint64_t mLoggingTraceUsec = 0;
 
   public:
@@ -0,0 +1,117 @@
+/**
+ * Copyright (C) 2016-2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "rt_profile_api_trace.h"
+
+#include <algorithm>
+
+namespace {
+
+// Every trace object gets a unique generation so that a thread's
+// cached buffer is never used with a trace object that reuses the
+// address of a deleted one.
+static std::atomic<uint64_t> s_generation {0};
+
+struct thread_buffer
+{
+  uint64_t generation = 0;
+  void* buffer = nullptr;
+};
+
+static thread_local thread_buffer t_buffer;
+
+}
+
+namespace XCL {
+
+ApiTrace::buffer::
+buffer()
+  : head(new chunk)
+{
+  tail = head.get();
+}
+
+ApiTrace::buffer::
+~buffer()
+{
+  auto c = head.release();
+  while (c) {
+    auto next = c->next.load();
+    delete c;
+    c = next;
+  }
+}
+
+ApiTrace::
+ApiTrace()
+  : m_generation(++s_generation)
+{}
+
+ApiTrace::buffer*
+ApiTrace::
+get_buffer()
+{
+  if (t_buffer.generation == m_generation)
+    return static_cast<buffer*>(t_buffer.buffer);
+  return add_buffer();
+}
+
+ApiTrace::buffer*
+ApiTrace::
+add_buffer()
+{
+  // Buffers are owned by the trace object and outlive the thread
+  // so records logged by exited threads are still drained.
+  std::lock_guard<std::mutex> lk(m_mutex);
+  m_buffers.emplace_back(new buffer);
+  t_buffer.generation = m_generation;
+  t_buffer.buffer = m_buffers.back().get();
+  return m_buffers.back().get();
+}
+
+void
+ApiTrace::
+drain(std::vector<record>& records)
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  auto first = records.size();
+  for (unsigned int idx=0; idx<m_buffers.size(); ++idx) {
+    auto& b = m_buffers[idx];
+    while (true) {
+      auto c = b->head.get();
+      auto count = c->count.load(std::memory_order_acquire);
+      auto start = records.size();
+      records.insert(records.end(),c->records.begin()+b->read_idx,c->records.begin()+count);
+      for (auto i=start; i<records.size(); ++i)
+        records[i].threadIndex = idx;
+      b->read_idx = count;
+      if (count < chunk_records)
+        break;
+      auto next = c->next.load(std::memory_order_acquire);
+      if (!next)
+        break;
+
+      // Consumed chunk is released, the producer has moved on
+      b->head.reset(next);
+      b->read_idx = 0;
+    }
+  }
+
+  std::stable_sort(records.begin()+first,records.end(),
+                   [](const record& r1, const record& r2) { return r1.timestamp < r2.timestamp; });
+}
+
+} // XCL
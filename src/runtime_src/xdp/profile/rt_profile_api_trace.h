@@ -0,0 +1,115 @@
+/**
+ * Copyright (C) 2016-2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __XILINX_RT_PROFILE_API_TRACE_H
+#define __XILINX_RT_PROFILE_API_TRACE_H
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace XCL {
+
+  // **************************************************************************
+  // Binary trace of OpenCL API calls
+  // **************************************************************************
+  // Each logging thread appends fixed size records to its own buffer
+  // without taking any lock.  A buffer is a list of fixed size chunks,
+  // the producer publishes a record by bumping the chunk count, so the
+  // trace can be drained by another thread while it is being appended.
+  // String formatting of records is left to the consumer of drain().
+  class ApiTrace {
+  public:
+    struct record {
+      double timestamp;
+      long long queueAddress;
+      const char* functionName;
+      unsigned int functionID;
+      bool start;
+      unsigned int threadIndex;  // set by drain, identifies the logging thread
+    };
+
+    static constexpr size_t chunk_records = 4096;
+
+  private:
+    struct chunk {
+      std::array<record,chunk_records> records;
+      std::atomic<size_t> count {0};
+      std::atomic<chunk*> next {nullptr};
+    };
+
+    struct buffer {
+      std::unique_ptr<chunk> head; // consumer
+      size_t read_idx = 0;         // consumer
+      chunk* tail = nullptr;       // producer
+      buffer();
+      ~buffer();
+    };
+
+  public:
+    ApiTrace();
+
+    /**
+     * Append a record to the calling thread's buffer
+     *
+     * @return
+     *   true when the record completed a chunk.  The caller should
+     *   then drain the trace to bound memory usage.
+     */
+    bool
+    log(double timestamp, const char* functionName, long long queueAddress,
+        unsigned int functionID, bool start)
+    {
+      auto b = get_buffer();
+      auto c = b->tail;
+      auto idx = c->count.load(std::memory_order_relaxed);
+      c->records[idx] = {timestamp,queueAddress,functionName,functionID,start};
+      c->count.store(idx+1,std::memory_order_release);
+      if (idx+1 < chunk_records)
+        return false;
+      auto n = new chunk;
+      c->next.store(n,std::memory_order_release);
+      b->tail = n;
+      return true;
+    }
+
+    /**
+     * Move all records published so far into @records
+     *
+     * Records are ordered by timestamp.  Calls to drain must be
+     * serialized by the caller.
+     */
+    void
+    drain(std::vector<record>& records);
+
+  private:
+    buffer*
+    get_buffer();
+
+    buffer*
+    add_buffer();
+
+    uint64_t m_generation;
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<buffer>> m_buffers;
+  };
+
+} // XCL
+
+#endif
@@ -88,59 +88,72 @@ namespace XCL {
       mTrainOffset[i] = 0.0;
     }
 
-    memset(&mPrevTimestamp, 0, XCL_PERF_MON_TOTAL_PROFILE*sizeof(uint32_t));
+    memset(&mPrevTimestamp, 0, XCL_PERF_MON_TOTAL_PROFILE*sizeof(uint64_t));
+
+    // Worst case number of events decoded from one read of the trace FIFO
+    mEvents.reserve(MAX_TRACE_NUMBER_SAMPLES);
+    mFrontEvents.reserve(XSAM_MAX_NUMBER_SLOTS);
   }
 
   // Destructor
   RTProfileDevice::~RTProfileDevice() {
     mDeviceFirstTimestamp.clear();
+  }
 
-    // Clear queues (i.e., swap with an empty one)
-    std::queue<uint64_t> empty64;
-    std::queue<uint32_t> empty32;
-    std::queue<uint16_t> empty16;
-    for (int i=0; i < XSPM_MAX_NUMBER_SLOTS; i++) {
-      std::swap(mWriteStarts[i], empty64);
-      std::swap(mHostWriteStarts[i], empty64);
-      std::swap(mReadStarts[i], empty64);
-      std::swap(mHostReadStarts[i], empty64);
-      std::swap(mWriteLengths[i], empty32);
-      std::swap(mReadLengths[i], empty32);
-      std::swap(mWriteBytes[i], empty16);
-      std::swap(mReadBytes[i], empty16);
-    }
+  // Add decoded event to current batch
+  void RTProfileDevice::addEvent(uint8_t eventType, uint32_t slot, uint64_t startTime, uint64_t endTime,
+      double start, double end, double traceStart, bool atFront) {
+    DeviceTraceEvent event;
+    event.Start = start;
+    event.End = end;
+    event.TraceStart = traceStart;
+    event.StartTime = startTime;
+    event.EndTime = endTime;
+    event.SlotNum = slot;
+    event.BurstLength = (eventType == DeviceTraceEvent::READ || eventType == DeviceTraceEvent::WRITE)
+                      ? (endTime - startTime + 1) : 0;
+    event.NumBytes = 0;
+    event.Type = eventType;
+    event.Kind = DeviceTrace::DEVICE_KERNEL;
+
+    if (atFront)
+      mFrontEvents.push_back(event);
+    else
+      mEvents.push_back(event);
   }
 
-  // Log device trace results: store in queues and report events as they are completed
-  void RTProfileDevice::logTrace(std::string deviceName, xclPerfMonType type,
-      xclTraceResultsVector& traceVector, TraceResultVector& resultVector) {
+  // Log device trace results: decode samples in a single pass and report
+  // events to sink as they are completed
+  void RTProfileDevice::logTrace(const std::string& deviceName, xclPerfMonType type,
+      const xclTraceResultsVector& traceVector, DeviceTraceSink& sink, bool flush) {
     if (mNumTraceEvents >= mMaxTraceEvents || traceVector.mLength == 0)
       return;
 
-    uint32_t numSlots = XCL::RTSingleton::Instance()->getProfileNumberSlots(XCL_PERF_MON_MEMORY, deviceName);
     bool isHwEmu = (XCL::RTSingleton::Instance()->getFlowMode() == XCL::RTSingleton::HW_EM);
-    uint8_t flags = 0;
-    uint32_t prevHostTimestamp = 0xFFFFFFFF;
+    uint64_t prevHostTimestamp = std::numeric_limits<uint64_t>::max();
     uint32_t slotID = 0;
-    uint32_t timestamp = 0;
-    uint64_t deviceStartTimestamp = 0;
+    uint64_t timestamp = 0;
     uint64_t hostTimestampNsec = 0;
-    uint64_t startTime = 0;
-    double y1, y2, x1, x2;
-    DeviceTrace kernelTrace;
-    
+    double y1 = 0.0, x1 = 0.0;
+
     XDP_LOG("[rt_device_profile] Logging %u device trace samples (total = %ld)...\n",
         traceVector.mLength, mNumTraceEvents);
     mNumTraceEvents += traceVector.mLength;
+    mEvents.clear();
+    mFrontEvents.clear();
 
     // Find and set minimum timestamp in case of multiple Kernels
-    if(isHwEmu) {
-      uint64_t minHostTimestampNsec = traceVector.mArray[0].HostTimestamp;
-      for (int i=0; i < traceVector.mLength; i++) {
-        if (traceVector.mArray[i].HostTimestamp < minHostTimestampNsec)
-          minHostTimestampNsec = traceVector.mArray[i].HostTimestamp;
+    // NOTE: only the very first samples define the origin of host timestamps
+    if (isHwEmu) {
+      if (!mFirstHostTimestampSet) {
+        uint64_t minHostTimestampNsec = traceVector.mArray[0].HostTimestamp;
+        for (unsigned int i=0; i < traceVector.mLength; i++) {
+          if (traceVector.mArray[i].HostTimestamp < minHostTimestampNsec)
+            minHostTimestampNsec = traceVector.mArray[i].HostTimestamp;
+        }
+        mFirstHostTimestampNsec = minHostTimestampNsec;
+        mFirstHostTimestampSet = true;
       }
-      getTimestampNsec(minHostTimestampNsec);
     }
     else {
       if (traceVector.mLength >= 8192)
@@ -148,12 +161,12 @@ namespace XCL {
 "Trace FIFO is full because of too many events. Timeline trace could be incomplete. \
 Please use 'coarse' option for data transfer trace or turn off Stall profiling");
     }
-  
+
     //
     // Parse recently offloaded trace results
     //
-    for (int i=0; i < traceVector.mLength; i++) {
-      xclTraceResults trace = traceVector.mArray[i];
+    for (unsigned int i=0; i < traceVector.mLength; i++) {
+      const xclTraceResults& trace = traceVector.mArray[i];
       XDP_LOG("[rt_device_profile] Parsing trace sample %d...\n", i);
 
       // ***************
@@ -166,12 +179,12 @@ Please use 'coarse' option for data transfer trace or turn off Stall profiling")
         mPrevTimestamp[type] = timestamp;
 
         if (trace.HostTimestamp == prevHostTimestamp && trace.Timestamp == 1) {
-          XDP_LOG("[rt_device_profile] Ignoring host timestamp: 0x%X\n",
+          XDP_LOG("[rt_device_profile] Ignoring host timestamp: 0x%llX\n",
                   trace.HostTimestamp);
           continue;
         }
         hostTimestampNsec = getTimestampNsec(trace.HostTimestamp);
-        XDP_LOG("[rt_device_profile] Timestamp pair: Device: 0x%X, Host: 0x%X\n",
+        XDP_LOG("[rt_device_profile] Timestamp pair: Device: 0x%llX, Host: 0x%llX\n",
                 timestamp, hostTimestampNsec);
         prevHostTimestamp = trace.HostTimestamp;
       }
@@ -185,15 +198,15 @@ Please use 'coarse' option for data transfer trace or turn off Stall profiling")
           continue;
         }
         if (i == 1) {
-          y2 = static_cast <double> (trace.HostTimestamp) + 1000;
-          x2 = static_cast <double> (trace.Timestamp);
+          double y2 = static_cast <double> (trace.HostTimestamp) + 1000;
+          double x2 = static_cast <double> (trace.Timestamp);
           mTrainSlope[type] = (y2 - y1) / (x2 - x1);
           mTrainOffset[type] = y2 - mTrainSlope[type] * x2;
           trainDeviceHostTimestamps(deviceName, type);
         }
-        if (trace.Overflow == 1)
-          trace.Timestamp += LOOP_ADD_TIME_SPM;
         timestamp = trace.Timestamp;
+        if (trace.Overflow == 1)
+          timestamp += LOOP_ADD_TIME_SPM;
         if (trace.TraceID >= 64 && trace.TraceID <= 544)
           slotID = ((trace.TraceID - 64) / 16);
         else
@@ -208,106 +221,70 @@ Please use 'coarse' option for data transfer trace or turn off Stall profiling")
 
       if (isHwEmu) {
         if (trace.TraceID < 61) {
-        s = trace.TraceID / 2;
-        flags = trace.EventFlags;
-        XDP_LOG("[rt_device_profile] slot %d event flags = %s @ timestamp %d\n",
-              s, dec2bin(flags, 7).c_str(), timestamp);
-        
-        // Write start
-        if (getBit(flags, XAPM_WRITE_FIRST)) {
-          mWriteStarts[s].push(timestamp);
-          mHostWriteStarts[s].push(hostTimestampNsec);
-        }
-  
-        // Write end
-        // NOTE: does not support out-of-order tranx
-        if (getBit(flags, XAPM_WRITE_LAST)) {
-          if (mWriteStarts[s].empty()) {
-            XDP_LOG("[rt_device_profile] WARNING: Found write end with write start queue empty @ %d\n", timestamp);
-            continue;
-          }
-  
-          uint64_t startTime = mWriteStarts[s].front();
-          uint64_t hostStartTime = mHostWriteStarts[s].front();  
-          mWriteStarts[s].pop();
-          mHostWriteStarts[s].pop();
-  
-          // Add write trace class to vector
-          DeviceTrace writeTrace;
-          writeTrace.SlotNum = s;
-          writeTrace.Type = "Write";
-          writeTrace.StartTime = startTime;
-          writeTrace.EndTime = timestamp;
-          writeTrace.Start = hostStartTime / 1e6;
-          writeTrace.End = hostTimestampNsec / 1e6;
-          if (writeTrace.Start == writeTrace.End) writeTrace.End += mEmuTraceMsecOneCycle;
-          writeTrace.BurstLength = timestamp - startTime + 1;
-  
-          // Only report tranx that make sense
-          if (writeTrace.End >= writeTrace.Start) {
-            writeTrace.TraceStart = hostStartTime / 1e6;
-            resultVector.push_back(writeTrace);
-          }
-        }
-  
-        // Read start
-        if (getBit(flags, XAPM_READ_FIRST)) {
-          mReadStarts[s].push(timestamp);
-          mHostReadStarts[s].push(hostTimestampNsec);
-        }
-  
-        // Read end
-        // NOTE: does not support out-of-order tranx
-        if (getBit(flags, XAPM_READ_LAST)) {
-          if (mReadStarts[s].empty()) {
-            XDP_LOG("[rt_device_profile] WARNING: Found read end with read start queue empty @ %d\n", timestamp);
-            continue;
+          s = trace.TraceID / 2;
+          uint8_t flags = trace.EventFlags;
+          XDP_LOG("[rt_device_profile] slot %d event flags = %s @ timestamp %llu\n",
+                s, dec2bin(flags, 7).c_str(), timestamp);
+
+          // Write start
+          if (getBit(flags, XAPM_WRITE_FIRST))
+            mWriteStarts[s].push(timestamp, hostTimestampNsec);
+
+          // Write end
+          // NOTE: does not support out-of-order tranx
+          if (getBit(flags, XAPM_WRITE_LAST)) {
+            if (mWriteStarts[s].empty()) {
+              XDP_LOG("[rt_device_profile] WARNING: Found write end with write start queue empty @ %llu\n", timestamp);
+              continue;
+            }
+
+            uint64_t startTime, hostStartTime;
+            mWriteStarts[s].pop(startTime, hostStartTime);
+
+            double start = hostStartTime / 1e6;
+            double end = hostTimestampNsec / 1e6;
+            if (start == end) end += mEmuTraceMsecOneCycle;
+
+            // Only report tranx that make sense
+            if (end >= start)
+              addEvent(DeviceTraceEvent::WRITE, s, startTime, timestamp, start, end, start);
           }
 
-          uint64_t startTime = mReadStarts[s].front();
-          uint64_t hostStartTime = mHostReadStarts[s].front();
-          mReadStarts[s].pop();
-          mHostReadStarts[s].pop();
-  
-          // Add read trace class to vector
-          DeviceTrace readTrace;
-          readTrace.SlotNum = s;
-          readTrace.Type = "Read";
-          readTrace.StartTime = startTime;
-          readTrace.EndTime = timestamp;
-          readTrace.Start = hostStartTime / 1e6;
-          readTrace.End = hostTimestampNsec / 1e6;
-          // Single Burst
-          if (readTrace.Start == readTrace.End) readTrace.End += mEmuTraceMsecOneCycle;
-          readTrace.BurstLength = timestamp - startTime + 1;
-  
-          // Only report tranx that make sense
-          if (readTrace.End >= readTrace.Start) {
-            readTrace.TraceStart = hostStartTime / 1e6;
-            resultVector.push_back(readTrace);
+          // Read start
+          if (getBit(flags, XAPM_READ_FIRST))
+            mReadStarts[s].push(timestamp, hostTimestampNsec);
+
+          // Read end
+          // NOTE: does not support out-of-order tranx
+          if (getBit(flags, XAPM_READ_LAST)) {
+            if (mReadStarts[s].empty()) {
+              XDP_LOG("[rt_device_profile] WARNING: Found read end with read start queue empty @ %llu\n", timestamp);
+              continue;
+            }
+
+            uint64_t startTime, hostStartTime;
+            mReadStarts[s].pop(startTime, hostStartTime);
+
+            double start = hostStartTime / 1e6;
+            double end = hostTimestampNsec / 1e6;
+            // Single Burst
+            if (start == end) end += mEmuTraceMsecOneCycle;
+
+            // Only report tranx that make sense
+            if (end >= start)
+              addEvent(DeviceTraceEvent::READ, s, startTime, timestamp, start, end, start);
           }
         }
-        }
         else if (trace.TraceID >= 64 && trace.TraceID <= 94) {
           uint32_t cuEvent = trace.EventFlags & XSAM_TRACE_CU_MASK;
           s = trace.TraceID - 64;
-          // Common Params for all event types
-          kernelTrace.SlotNum = s;
-          kernelTrace.Name = "OCL Region";
-          kernelTrace.Kind = DeviceTrace::DEVICE_KERNEL;
-          kernelTrace.EndTime = timestamp;
-          kernelTrace.End = hostTimestampNsec / 1e6;
-          kernelTrace.BurstLength = 0;
-          kernelTrace.NumBytes = 0;
           if (cuEvent) {
             if (mAccelMonStartedEvents[s] & XSAM_TRACE_CU_MASK) {
-              kernelTrace.Type = "Kernel";
-              startTime = mAccelMonCuHostTime[s];
-              kernelTrace.StartTime = mAccelMonCuTime[s];
-              kernelTrace.Start = mAccelMonCuHostTime[s] / 1e6;
-              resultVector.push_back(kernelTrace);
+              double start = mAccelMonCuHostTime[s] / 1e6;
+              double end = hostTimestampNsec / 1e6;
+              addEvent(DeviceTraceEvent::KERNEL, s, mAccelMonCuTime[s], timestamp, start, end, 0.0);
               // Divide by 2 just to be safe
-              mEmuTraceMsecOneCycle = (kernelTrace.End - kernelTrace.Start) / (2 *(kernelTrace.EndTime - kernelTrace.StartTime));
+              mEmuTraceMsecOneCycle = (end - start) / (2 *(timestamp - mAccelMonCuTime[s]));
             }
             else {
               mAccelMonCuHostTime[s] = hostTimestampNsec;
@@ -325,22 +302,11 @@ Please use 'coarse' option for data transfer trace or turn off Stall profiling")
           uint32_t stallIntEvent = trace.TraceID & XSAM_TRACE_STALL_INT_MASK;
           uint32_t stallStrEvent = trace.TraceID & XSAM_TRACE_STALL_STR_MASK;
           uint32_t stallExtEvent = trace.TraceID & XSAM_TRACE_STALL_EXT_MASK;
-          // Common Params for all event types
-          kernelTrace.SlotNum = s;
-          kernelTrace.Name = "OCL Region";
-          kernelTrace.Kind = DeviceTrace::DEVICE_KERNEL;
-          kernelTrace.EndTime = timestamp;
-          kernelTrace.BurstLength = 0;
-          kernelTrace.NumBytes = 0;
-          kernelTrace.End = convertDeviceToHostTimestamp(timestamp, type, deviceName);
+          double end = convertDeviceToHostTimestamp(timestamp, type, deviceName);
           if (cuEvent) {
             if (mAccelMonStartedEvents[s] & XSAM_TRACE_CU_MASK) {
-              kernelTrace.Type = "Kernel";
-              startTime = mAccelMonCuTime[s];
-              kernelTrace.StartTime = startTime;
-              kernelTrace.Start = convertDeviceToHostTimestamp(startTime, type, deviceName);
-              kernelTrace.TraceStart = kernelTrace.Start;
-              resultVector.insert(resultVector.begin(), kernelTrace);
+              double start = convertDeviceToHostTimestamp(mAccelMonCuTime[s], type, deviceName);
+              addEvent(DeviceTraceEvent::KERNEL, s, mAccelMonCuTime[s], timestamp, start, end, start, true);
             }
             else {
               mAccelMonCuTime[s] = timestamp;
@@ -348,12 +314,8 @@ Please use 'coarse' option for data transfer trace or turn off Stall profiling")
           }
           if (stallIntEvent) {
             if (mAccelMonStartedEvents[s] & XSAM_TRACE_STALL_INT_MASK) {
-              kernelTrace.Type = "Intra-Kernel Dataflow Stall";
-              startTime = mAccelMonStallIntTime[s];
-              kernelTrace.StartTime = startTime;
-              kernelTrace.Start = convertDeviceToHostTimestamp(startTime, type, deviceName);
-              kernelTrace.TraceStart = kernelTrace.Start;
-              resultVector.push_back(kernelTrace);
+              double start = convertDeviceToHostTimestamp(mAccelMonStallIntTime[s], type, deviceName);
+              addEvent(DeviceTraceEvent::STALL_INT, s, mAccelMonStallIntTime[s], timestamp, start, end, start);
             }
             else {
               mAccelMonStallIntTime[s] = timestamp;
@@ -361,12 +323,8 @@ Please use 'coarse' option for data transfer trace or turn off Stall profiling")
           }
           if (stallStrEvent) {
             if (mAccelMonStartedEvents[s] & XSAM_TRACE_STALL_STR_MASK) {
-              kernelTrace.Type = "Inter-Kernel Pipe Stall";
-              startTime = mAccelMonStallStrTime[s];
-              kernelTrace.StartTime = startTime;
-              kernelTrace.Start = convertDeviceToHostTimestamp(startTime, type, deviceName);
-              kernelTrace.TraceStart = kernelTrace.Start;
-              resultVector.push_back(kernelTrace);
+              double start = convertDeviceToHostTimestamp(mAccelMonStallStrTime[s], type, deviceName);
+              addEvent(DeviceTraceEvent::STALL_STR, s, mAccelMonStallStrTime[s], timestamp, start, end, start);
             }
             else {
               mAccelMonStallStrTime[s] = timestamp;
@@ -374,12 +332,8 @@ Please use 'coarse' option for data transfer trace or turn off Stall profiling")
           }
           if (stallExtEvent) {
             if (mAccelMonStartedEvents[s] & XSAM_TRACE_STALL_EXT_MASK) {
-              kernelTrace.Type = "External Memory Stall";
-              startTime = mAccelMonStallExtTime[s];
-              kernelTrace.StartTime = startTime;
-              kernelTrace.Start = convertDeviceToHostTimestamp(startTime, type, deviceName);
-              kernelTrace.TraceStart = kernelTrace.Start;
-              resultVector.push_back(kernelTrace);
+              double start = convertDeviceToHostTimestamp(mAccelMonStallExtTime[s], type, deviceName);
+              addEvent(DeviceTraceEvent::STALL_EXT, s, mAccelMonStallExtTime[s], timestamp, start, end, start);
             }
             else {
               mAccelMonStallExtTime[s] = timestamp;
@@ -390,86 +344,49 @@ Please use 'coarse' option for data transfer trace or turn off Stall profiling")
           mAccelMonLastTranx[s] = timestamp;
         }
         else // SPM Trace
-        if (IS_READ(trace.TraceID)) {
-          if (trace.EventType == XCL_PERF_MON_START_EVENT) {
-            mReadStarts[s].push(timestamp);
-          }
-          else if (trace.EventType == XCL_PERF_MON_END_EVENT) {
-             if (trace.Reserved == 1) {
-              startTime = timestamp;
-             }
-             else {
-              if(mReadStarts[s].empty()) {
-                startTime = timestamp;
-              } else {
-                startTime = mReadStarts[s].front();
-                mReadStarts[s].pop();
-              }
-             }
-            DeviceTrace readTrace;
-            readTrace.SlotNum = slotID;
-            readTrace.Type = "Read";
-            readTrace.StartTime = startTime;
-            readTrace.EndTime = timestamp;
-            readTrace.BurstLength = timestamp - startTime + 1;
-            readTrace.Start = convertDeviceToHostTimestamp(startTime, type, deviceName);
-            readTrace.End = convertDeviceToHostTimestamp(timestamp, type, deviceName);
-            resultVector.push_back(readTrace);
-            mPerfMonLastTranx[slotID] = timestamp;
-          }
-        }
-        else
-        if (IS_WRITE(trace.TraceID)) {
+        if (IS_READ(trace.TraceID) || IS_WRITE(trace.TraceID)) {
+          bool isRead = IS_READ(trace.TraceID);
+          SlotStarts& starts = isRead ? mReadStarts[s] : mWriteStarts[s];
           if (trace.EventType == XCL_PERF_MON_START_EVENT) {
-            mWriteStarts[s].push(timestamp);
+            starts.push(timestamp, 0);
           }
           else if (trace.EventType == XCL_PERF_MON_END_EVENT) {
-            if (trace.Reserved == 1) {
-              startTime = timestamp;
-            }
-            else {
-              if(mWriteStarts[s].empty()) {
-                startTime = timestamp;
-              } else {
-                startTime = mWriteStarts[s].front();
-                mWriteStarts[s].pop();
-              }
-            }
-            DeviceTrace writeTrace;
-            writeTrace.SlotNum = slotID;
-            writeTrace.Type = "Write";
-            writeTrace.StartTime = startTime;
-            writeTrace.EndTime = timestamp;
-            writeTrace.BurstLength = timestamp - startTime + 1;
-            writeTrace.Start = convertDeviceToHostTimestamp(startTime, type, deviceName);
-            writeTrace.End = convertDeviceToHostTimestamp(timestamp, type, deviceName);
-            resultVector.push_back(writeTrace);
+            uint64_t startTime = timestamp;
+            uint64_t hostStartTime = 0;
+            if (trace.Reserved != 1 && !starts.empty())
+              starts.pop(startTime, hostStartTime);
+
+            addEvent(isRead ? DeviceTraceEvent::READ : DeviceTraceEvent::WRITE, slotID, startTime, timestamp,
+                convertDeviceToHostTimestamp(startTime, type, deviceName),
+                convertDeviceToHostTimestamp(timestamp, type, deviceName), 0.0);
             mPerfMonLastTranx[slotID] = timestamp;
           }
         }
       } // Else Hardware
     } // for i
-    
-    // Try to approximate CU Ends from data transnfers
-    if(!isHwEmu) {
-      std::string cuPortName, cuNameSAM, cuNameSPM;
+
+    // Try to approximate CU Ends from data transfers
+    if (!isHwEmu && flush) {
+      std::string devName(deviceName);
+      std::string cuPortName, cuNameSAM;
+      std::string cuNamesSPM[XSPM_MAX_NUMBER_SLOTS];
+      bool cuNamesSPMValid = false;
       auto rts = XCL::RTSingleton::Instance();
       for (int i = 0; i < XSAM_MAX_NUMBER_SLOTS; i++) {
         if (mAccelMonStartedEvents[i] & XSAM_TRACE_CU_MASK) {
-          kernelTrace.SlotNum = i;
-          kernelTrace.Name = "OCL Region";
-          kernelTrace.Type = "Kernel";
-          kernelTrace.Kind = DeviceTrace::DEVICE_KERNEL;
-          kernelTrace.StartTime = mAccelMonCuTime[i];
-          kernelTrace.Start = convertDeviceToHostTimestamp(kernelTrace.StartTime, type, deviceName);
-          kernelTrace.BurstLength = 0;
-          kernelTrace.NumBytes = 0;
+          // Look up CU names of memory slots once per call
+          if (!cuNamesSPMValid) {
+            for (int j = 0; j < XSPM_MAX_NUMBER_SLOTS; j++) {
+              rts->getProfileSlotName(XCL_PERF_MON_MEMORY, devName, j, cuPortName);
+              cuNamesSPM[j] = cuPortName.substr(0, cuPortName.find_first_of("/"));
+            }
+            cuNamesSPMValid = true;
+          }
+
           uint64_t lastTimeStamp = 0;
-          rts->getProfileSlotName(XCL_PERF_MON_ACCEL, deviceName, i, cuNameSAM);
+          rts->getProfileSlotName(XCL_PERF_MON_ACCEL, devName, i, cuNameSAM);
           for (int j = 0; j < XSPM_MAX_NUMBER_SLOTS; j++) {
-            rts->getProfileSlotName(XCL_PERF_MON_MEMORY, deviceName, j, cuPortName);
-            cuNameSPM = cuPortName.substr(0, cuPortName.find_first_of("/"));
-            if (cuNameSAM == cuNameSPM && lastTimeStamp < mPerfMonLastTranx[j])
+            if (cuNameSAM == cuNamesSPM[j] && lastTimeStamp < mPerfMonLastTranx[j])
               lastTimeStamp = mPerfMonLastTranx[j];
           }
           if (lastTimeStamp < mAccelMonLastTranx[i])
@@ -477,16 +394,25 @@ Please use 'coarse' option for data transfer trace or turn off Stall profiling")
           if (lastTimeStamp) {
             xrt::message::send(xrt::message::severity_level::WARNING,
             "Incomplete CU profile trace detected. Timeline trace will have approximate CU End");
-            kernelTrace.EndTime = lastTimeStamp;
-            kernelTrace.End = convertDeviceToHostTimestamp(kernelTrace.EndTime, type, deviceName);
-            // Insert is needed in case there are only stalls
-            resultVector.insert(resultVector.begin(), kernelTrace);
+            double start = convertDeviceToHostTimestamp(mAccelMonCuTime[i], type, deviceName);
+            double end = convertDeviceToHostTimestamp(lastTimeStamp, type, deviceName);
+            // Ahead of other events is needed in case there are only stalls
+            addEvent(DeviceTraceEvent::KERNEL, i, mAccelMonCuTime[i], lastTimeStamp, start, end, start, true);
           }
         }
       }
     }
-    // Clear vectors
-    std::fill_n(mAccelMonStartedEvents,XSAM_MAX_NUMBER_SLOTS,0);
+
+    // Kernel ends are reported ahead of other events, most recent first
+    std::reverse(mFrontEvents.begin(), mFrontEvents.end());
+    if (!mFrontEvents.empty())
+      sink.write(deviceName, mFrontEvents.data(), mFrontEvents.size());
+    if (!mEvents.empty())
+      sink.write(deviceName, mEvents.data(), mEvents.size());
+
+    // Clear state of open CU events once the trace is flushed
+    if (flush)
+      std::fill_n(mAccelMonStartedEvents,XSAM_MAX_NUMBER_SLOTS,0);
     mDeviceTrainVector.clear();
     mHostTrainVector.clear();
 
@@ -33,12 +33,13 @@
 #include <cstdint>
 #include <set>
 #include <vector>
-#include <queue>
+#include <map>
 #include <string>
 #include <fstream>
 #include <CL/opencl.h>
 #include "../../driver/include/xclperf.h"
 #include "rt_profile_results.h"
+#include "rt_device_trace.h"
 #include "debug.h"
 
 namespace XCL {
@@ -49,8 +50,6 @@ namespace XCL {
       RTProfileDevice();
       ~RTProfileDevice();
 
-      typedef std::vector<DeviceTrace> TraceResultVector;
-
     public:
       // get functions
       uint32_t getTraceSamplesThreshold() {return mTraceSamplesThreshold;}
@@ -100,15 +99,49 @@ namespace XCL {
         mGlobalMemoryBitWidth = bitWidth;
       }
 
-      // log trace results
-      void logTrace(std::string deviceName, xclPerfMonType type,
-          xclTraceResultsVector& traceVector, TraceResultVector& resultVector);
+      // Decode trace results and hand the events to sink
+      // NOTE: state of open transactions and CUs is kept across calls,
+      //       a flush approximates the end of CUs that are still running
+      void logTrace(const std::string& deviceName, xclPerfMonType type,
+          const xclTraceResultsVector& traceVector, DeviceTraceSink& sink, bool flush);
 
       // Get slot name and kind
       void getSlotName(int slotnum, std::string& slotName) const;
       DeviceTrace::e_device_kind getSlotKind(std::string& slotName) const;
 
     private:
+      // Outstanding transaction starts of one monitor slot, oldest first
+      // NOTE: a start without matching end is dropped once a slot has
+      //       MAX_OUTSTANDING newer starts, this bounds memory usage
+      struct SlotStarts {
+        static const uint32_t MAX_OUTSTANDING = 256;
+        uint64_t Device[MAX_OUTSTANDING];
+        uint64_t Host[MAX_OUTSTANDING];
+        uint32_t Head = 0;
+        uint32_t Count = 0;
+
+        bool empty() const {return Count == 0;}
+        void push(uint64_t deviceTime, uint64_t hostTime) {
+          uint32_t idx = (Head + Count) % MAX_OUTSTANDING;
+          Device[idx] = deviceTime;
+          Host[idx] = hostTime;
+          if (Count < MAX_OUTSTANDING)
+            ++Count;
+          else
+            Head = (Head + 1) % MAX_OUTSTANDING;
+        }
+        void pop(uint64_t& deviceTime, uint64_t& hostTime) {
+          deviceTime = Device[Head];
+          hostTime = Host[Head];
+          Head = (Head + 1) % MAX_OUTSTANDING;
+          --Count;
+        }
+      };
+
+      // Add decoded event to current batch
+      void addEvent(uint8_t eventType, uint32_t slot, uint64_t startTime, uint64_t endTime,
+          double start, double end, double traceStart, bool atFront = false);
+
       // Convert binary to decimal
       uint32_t bin2dec(std::string str, int start, int number);
       uint32_t bin2dec(const char * str, int start, int number);
@@ -125,8 +158,7 @@ namespace XCL {
       // Get timestamp in nsec
       // NOTE: this is only used for HW emulation
       uint64_t getTimestampNsec(uint64_t timeNsec) {
-        static uint64_t firstTimeNsec = timeNsec;
-        return (timeNsec - firstTimeNsec + mStartTimeNsec);
+        return (timeNsec - mFirstHostTimestampNsec + mStartTimeNsec);
       }
 
     private:
@@ -146,7 +178,9 @@ namespace XCL {
       double mTrainSlope[XCL_PERF_MON_TOTAL_PROFILE];
       double mTrainOffset[XCL_PERF_MON_TOTAL_PROFILE];
       double mTrainProgramStart[XCL_PERF_MON_TOTAL_PROFILE];
-      uint32_t mPrevTimestamp[XCL_PERF_MON_TOTAL_PROFILE];
+      uint64_t mPrevTimestamp[XCL_PERF_MON_TOTAL_PROFILE];
+      bool mFirstHostTimestampSet = false;
+      uint64_t mFirstHostTimestampNsec = 0;
       uint64_t mAccelMonCuTime[XSAM_MAX_NUMBER_SLOTS]       = { 0 };
       uint64_t mAccelMonCuHostTime[XSAM_MAX_NUMBER_SLOTS]   = { 0 };
       uint64_t mAccelMonStallIntTime[XSAM_MAX_NUMBER_SLOTS] = { 0 };
@@ -158,14 +192,12 @@ namespace XCL {
       std::set<std::string> mDeviceFirstTimestamp;
       std::vector<uint32_t> mDeviceTrainVector;
       std::vector<uint64_t> mHostTrainVector;
-      std::queue<uint64_t> mWriteStarts[XSPM_MAX_NUMBER_SLOTS];
-      std::queue<uint64_t> mHostWriteStarts[XSPM_MAX_NUMBER_SLOTS];
-      std::queue<uint64_t> mReadStarts[XSPM_MAX_NUMBER_SLOTS];
-      std::queue<uint64_t> mHostReadStarts[XSPM_MAX_NUMBER_SLOTS];
-      std::queue<uint32_t> mWriteLengths[XSPM_MAX_NUMBER_SLOTS];
-      std::queue<uint32_t> mReadLengths[XSPM_MAX_NUMBER_SLOTS];
-      std::queue<uint16_t> mWriteBytes[XSPM_MAX_NUMBER_SLOTS];
-      std::queue<uint16_t> mReadBytes[XSPM_MAX_NUMBER_SLOTS];
+      SlotStarts mWriteStarts[XSPM_MAX_NUMBER_SLOTS];
+      SlotStarts mReadStarts[XSPM_MAX_NUMBER_SLOTS];
+      // Events of current call, kernel ends found in hardware trace
+      // are reported ahead of all other events
+      std::vector<DeviceTraceEvent> mEvents;
+      std::vector<DeviceTraceEvent> mFrontEvents;
       std::map<std::string, unsigned int> mDeviceKernelClockFreqMap;
   };
 };
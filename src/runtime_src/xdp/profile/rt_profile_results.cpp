@@ -98,6 +98,21 @@ namespace XCL {
     ClockFreqMhz = clockFreqMhz;
   }
 
+  // Combine completed calls of other into this
+  void TimeStats::merge(const TimeStats& other)
+  {
+    if (other.NoOfCalls == 0)
+      return;
+
+    TotalTime += other.TotalTime;
+    AveTime = (AveTime * NoOfCalls + other.AveTime * other.NoOfCalls) / (NoOfCalls + other.NoOfCalls);
+    NoOfCalls += other.NoOfCalls;
+    if (MaxTime < other.MaxTime)
+      MaxTime = other.MaxTime;
+    if (MinTime > other.MinTime)
+      MinTime = other.MinTime;
+  }
+
   //
   // Kernel Trace
   //
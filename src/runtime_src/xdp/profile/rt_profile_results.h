@@ -125,6 +125,7 @@ namespace XCL {
     void logEnd(double timePoint);
     void logStats(double totalTimeStat, double maxTimeStat, 
                   double minTimeStat, uint32_t totalCalls, uint32_t clockFreqMhz);
+    void merge(const TimeStats& other);
     inline double getTotalTime() const { return TotalTime; }
     inline double getAveTime() const {return AveTime; }
     inline double getMaxTime() const {return MaxTime; }
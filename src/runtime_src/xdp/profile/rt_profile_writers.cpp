@@ -714,7 +714,7 @@ namespace XCL {
   }
 
   // Functions for device trace
-  void WriterI::writeDeviceTrace(const RTProfileDevice::TraceResultVector &resultVector,
+  void WriterI::writeDeviceTrace(const DeviceTraceEvent* events, size_t count,
       std::string deviceName, std::string binaryName)
   {
     if (!Timeline_ofs.is_open())
@@ -728,13 +728,14 @@ namespace XCL {
       DeviceBinaryNameMap[deviceName] = binaryName;
 #endif
 
-    for (auto it = resultVector.begin(); it != resultVector.end(); it++) {
-      DeviceTrace tr = *it;
+    std::string traceName;
+    std::string argNames;
+    std::string workGroupSize;
 
-#ifndef XDP_VERBOSE
-      if (tr.Kind == DeviceTrace::DEVICE_BUFFER)
+    for (size_t i = 0; i < count; i++) {
+      const DeviceTraceEvent& tr = events[i];
+      if (!getDeviceTraceNames(tr, deviceName, binaryName, traceName, argNames, workGroupSize))
         continue;
-#endif
 
       auto rts = XCL::RTSingleton::Instance();
       double deviceClockDurationUsec = (1.0 / (rts->getProfileManager()->getKernelClockFreqMHz(deviceName)));
@@ -744,70 +745,7 @@ namespace XCL {
       std::stringstream endStr;
       endStr << std::setprecision(10) << tr.End;
 
-      bool showKernelCUNames = true;
-      bool showPortName = false;
-      std::string memoryName;
-      std::string traceName;
-      std::string cuName;
-      std::string argNames;
-
-      // Populate trace name string
-      if (tr.Kind == DeviceTrace::DEVICE_KERNEL) {
-        if (tr.Type == "Kernel") {
-          traceName = "KERNEL";
-        } else if (tr.Type.find("Stall") != std::string::npos) {
-          traceName = "Kernel_Stall";
-          showPortName = false;
-        } else if (tr.Type == "Write") {
-          showPortName = true;
-          traceName = "Kernel_Write";
-        } else {
-          showPortName = true;
-          traceName = "Kernel_Read";
-        }
-      }
-      else {
-        showKernelCUNames = false;
-        if (tr.Type == "Write")
-          traceName = "Host_Write";
-        else
-          traceName = "Host_Read";
-      }
-
-      traceName += ("|" + deviceName + "|" + binaryName);
-
-      if (showKernelCUNames || showPortName) {
-        std::string portName;
-        std::string cuPortName;
-        if (tr.Kind == DeviceTrace::DEVICE_KERNEL && (tr.Type == "Kernel" || tr.Type.find("Stall") != std::string::npos)) {
-          rts->getProfileSlotName(XCL_PERF_MON_ACCEL, deviceName, tr.SlotNum, cuName);
-        }
-        else {
-          rts->getProfileSlotName(XCL_PERF_MON_MEMORY, deviceName, tr.SlotNum, cuPortName);
-          cuName = cuPortName.substr(0, cuPortName.find_first_of("/"));
-          portName = cuPortName.substr(cuPortName.find_first_of("/")+1);
-          std::transform(portName.begin(), portName.end(), portName.begin(), ::tolower);
-        }
-        std::string kernelName;
-        XCL::RTSingleton::Instance()->getProfileKernelName(deviceName, cuName, kernelName);
-
-        if (showKernelCUNames)
-          traceName += ("|" + kernelName + "|" + cuName);
-
-        if (showPortName) {
-          rts->getProfileManager()->getArgumentsBank(deviceName, cuName, portName, argNames, memoryName);
-          traceName += ("|" + portName + "|" + memoryName);
-        }
-      }
-
-      if (tr.Type == "Kernel") {
-        std::string workGroupSize;
-        rts->getProfileManager()->getTraceStringFromComputeUnit(deviceName, cuName, traceName);
-        if (traceName.empty()) continue;
-        size_t pos = traceName.find_last_of("|");
-        workGroupSize = traceName.substr(pos + 1);
-        traceName = traceName.substr(0, pos);
-        
+      if (tr.Type == DeviceTraceEvent::KERNEL) {
         writeTableRowStart(getTimelineStream());
         writeTableCells(getTimelineStream(), startStr.str(), traceName, "START", "", workGroupSize);
         writeTableRowEnd(getTimelineStream());
@@ -822,13 +760,93 @@ namespace XCL {
       if (!(deviceDuration > 0.0)) deviceDuration = deviceClockDurationUsec;
       writeTableRowStart(getTimelineStream());
       writeTableCells(getTimelineStream(), startStr.str(), traceName,
-          tr.Type, argNames, tr.BurstLength, (tr.EndTime - tr.StartTime),
+          tr.typeName(), argNames, tr.BurstLength, (tr.EndTime - tr.StartTime),
           tr.StartTime, tr.EndTime, deviceDuration,
           startStr.str(), endStr.str());
       writeTableRowEnd(getTimelineStream());
     }
   }
 
+  // Names used in the timeline row(s) of a device trace event
+  // Returns false if the event is not written to the timeline
+  bool WriterI::getDeviceTraceNames(const DeviceTraceEvent& tr, std::string& deviceName,
+      const std::string& binaryName, std::string& traceName, std::string& argNames,
+      std::string& workGroupSize)
+  {
+#ifndef XDP_VERBOSE
+    if (tr.Kind == DeviceTrace::DEVICE_BUFFER)
+      return false;
+#endif
+
+    auto rts = XCL::RTSingleton::Instance();
+
+    bool showKernelCUNames = true;
+    bool showPortName = false;
+    std::string memoryName;
+    std::string cuName;
+    argNames.clear();
+    workGroupSize.clear();
+
+    // Populate trace name string
+    if (tr.Kind == DeviceTrace::DEVICE_KERNEL) {
+      if (tr.Type == DeviceTraceEvent::KERNEL) {
+        traceName = "KERNEL";
+      } else if (tr.isStall()) {
+        traceName = "Kernel_Stall";
+        showPortName = false;
+      } else if (tr.Type == DeviceTraceEvent::WRITE) {
+        showPortName = true;
+        traceName = "Kernel_Write";
+      } else {
+        showPortName = true;
+        traceName = "Kernel_Read";
+      }
+    }
+    else {
+      showKernelCUNames = false;
+      if (tr.Type == DeviceTraceEvent::WRITE)
+        traceName = "Host_Write";
+      else
+        traceName = "Host_Read";
+    }
+
+    traceName += ("|" + deviceName + "|" + binaryName);
+
+    if (showKernelCUNames || showPortName) {
+      std::string portName;
+      std::string cuPortName;
+      if (tr.Kind == DeviceTrace::DEVICE_KERNEL && tr.isKernel()) {
+        rts->getProfileSlotName(XCL_PERF_MON_ACCEL, deviceName, tr.SlotNum, cuName);
+      }
+      else {
+        rts->getProfileSlotName(XCL_PERF_MON_MEMORY, deviceName, tr.SlotNum, cuPortName);
+        cuName = cuPortName.substr(0, cuPortName.find_first_of("/"));
+        portName = cuPortName.substr(cuPortName.find_first_of("/")+1);
+        std::transform(portName.begin(), portName.end(), portName.begin(), ::tolower);
+      }
+      std::string kernelName;
+      XCL::RTSingleton::Instance()->getProfileKernelName(deviceName, cuName, kernelName);
+
+      if (showKernelCUNames)
+        traceName += ("|" + kernelName + "|" + cuName);
+
+      if (showPortName) {
+        rts->getProfileManager()->getArgumentsBank(deviceName, cuName, portName, argNames, memoryName);
+        traceName += ("|" + portName + "|" + memoryName);
+      }
+    }
+
+    if (tr.Type == DeviceTraceEvent::KERNEL) {
+      rts->getProfileManager()->getTraceStringFromComputeUnit(deviceName, cuName, traceName);
+      if (traceName.empty())
+        return false;
+      size_t pos = traceName.find_last_of("|");
+      workGroupSize = traceName.substr(pos + 1);
+      traceName = traceName.substr(0, pos);
+    }
+    return true;
+  }
+
   void WriterI::writeProfileRuleCheckSummary(RTProfile *profile,
       const ProfileRuleChecks::ProfileRuleCheckMap  &deviceExecTimesMap,
       const ProfileRuleChecks::ProfileRuleCheckMap  &computeUnitCallsMap,
@@ -1069,14 +1087,7 @@ namespace XCL {
       assert(!Timeline_ofs.is_open());
       TimelineFileName += FileExtension;
       openStream(Timeline_ofs, TimelineFileName);
-      writeDocumentHeader(Timeline_ofs, "SDAccel Timeline Trace");
-      std::vector<std::string> TimelineTraceColumnLabels = {
-          "Time_msec", "Name", "Event", "Address_Port", "Size",
-          "Latency_cycles", "Start_cycles", "End_cycles",
-          "Latency_usec", "Start_msec", "End_msec"
-      };
-      writeTableHeader(Timeline_ofs, "", TimelineTraceColumnLabels);
-
+      writeTimelineHeader(Timeline_ofs);
     }
   }
 
@@ -1139,6 +1150,11 @@ namespace XCL {
     if (!ofs.is_open())
       return;
 
+    writeHeaderText(ofs, docName);
+  }
+
+  void CSVWriter::writeHeaderText(std::ostream& ofs, const std::string& docName)
+  {
     // Header of document
     ofs << docName << "\n";
     ofs << "Generated on: " << WriterI::getCurrentDateTime() << "\n";
@@ -1187,11 +1203,24 @@ namespace XCL {
     }
   }
 
-  void CSVWriter::writeTimelineFooter(std::ofstream& ofs)
+  void CSVWriter::writeTimelineHeader(std::ostream& ofs)
   {
-    if (!ofs.is_open())
-      return;
+    writeHeaderText(ofs, "SDAccel Timeline Trace");
 
+    std::vector<std::string> TimelineTraceColumnLabels = {
+        "Time_msec", "Name", "Event", "Address_Port", "Size",
+        "Latency_cycles", "Start_cycles", "End_cycles",
+        "Latency_usec", "Start_msec", "End_msec"
+    };
+    ofs << "\n\n";
+    for (const auto& str : TimelineTraceColumnLabels) {
+      ofs << str << ",";
+    }
+    ofs << "\n";
+  }
+
+  void CSVWriter::writeTimelineFooter(std::ostream& ofs)
+  {
     auto rts = XCL::RTSingleton::Instance();
     auto profile = rts->getProfileManager();
 
@@ -1280,7 +1309,190 @@ namespace XCL {
 
     ofs << "Footer,end\n";
 
-    writeDocumentFooter(ofs);
+    // Close the document
+    ofs << "\n";
+  }
+
+  // *************
+  // Binary Writer
+  // *************
+  BinaryWriter::BinaryWriter(const std::string& timelineFileName,
+      const std::string& platformName, bool compress) :
+        CSVWriter("", "", platformName)
+  {
+    if (timelineFileName == "")
+      return;
+
+    std::stringstream header;
+    writeTimelineHeader(header);
+    TraceFile.reset(new TimelineTraceFile(timelineFileName + FileExtension, header.str(), compress));
+  }
+
+  BinaryWriter::~BinaryWriter()
+  {
+    if (!TraceFile)
+      return;
+
+    std::stringstream footer;
+    writeTimelineFooter(footer);
+    TraceFile->close(footer.str());
+  }
+
+  void BinaryWriter::writeTimeline(double time, const std::string& functionName,
+      const std::string& eventName)
+  {
+    if (!TraceFile)
+      return;
+
+    TimelineTraceFile::entry e = {timeline::API, time};
+    e.S[0] = &functionName;
+    e.S[1] = &eventName;
+    TraceFile->log(e);
+  }
+
+  void BinaryWriter::writeTimeline(double traceTime, const std::string& commandString,
+            const std::string& stageString, const std::string& eventString,
+            const std::string& dependString, uint64_t objId, size_t size)
+  {
+    if (!TraceFile)
+      return;
+
+    TimelineTraceFile::entry e = {timeline::KERNEL, traceTime, 0.0, 0.0, objId, size};
+    e.S[0] = &commandString;
+    e.S[1] = &stageString;
+    e.S[2] = &eventString;
+    e.S[3] = &dependString;
+    TraceFile->log(e);
+  }
+
+  void BinaryWriter::writeTimeline(double traceTime, const std::string& commandString,
+            const std::string& stageString, const std::string& eventString,
+            const std::string& dependString, size_t size, uint64_t address,
+            const std::string& bank, std::thread::id threadId)
+  {
+    if (!TraceFile)
+      return;
+
+    // Thread IDs are formatted once per thread
+    auto itr = ThreadIdNames.find(threadId);
+    if (itr == ThreadIdNames.end()) {
+      std::stringstream threadStr;
+      threadStr << std::showbase << std::hex << std::uppercase << threadId;
+      itr = ThreadIdNames.emplace(threadId, threadStr.str()).first;
+    }
+
+    TimelineTraceFile::entry e = {timeline::TRANSFER, traceTime, 0.0, 0.0, address, size};
+    e.S[0] = &commandString;
+    e.S[1] = &stageString;
+    e.S[2] = &eventString;
+    e.S[3] = &dependString;
+    e.S[4] = &bank;
+    e.S[5] = &itr->second;
+    TraceFile->log(e);
+  }
+
+  void BinaryWriter::writeTimeline(double traceTime, const std::string& commandString,
+            const std::string& stageString, const std::string& eventString,
+            const std::string& dependString)
+  {
+    if (!TraceFile)
+      return;
+
+    TimelineTraceFile::entry e = {timeline::DEPENDENCY, traceTime};
+    e.S[0] = &commandString;
+    e.S[1] = &stageString;
+    e.S[2] = &eventString;
+    e.S[3] = &dependString;
+    TraceFile->log(e);
+  }
+
+  void BinaryWriter::writeDeviceCounters(xclPerfMonType type, xclCounterResults& results,
+      double timestamp, uint32_t sampleNum, bool firstReadAfterProgram)
+  {
+    if (!TraceFile)
+      return;
+    if (firstReadAfterProgram) {
+      CountersPrev = results;
+      return;
+    }
+
+    static const std::string slotNames[] = {
+        XPAR_AXI_PERF_MON_0_SLOT0_NAME, XPAR_AXI_PERF_MON_0_SLOT1_NAME,
+        XPAR_AXI_PERF_MON_0_SLOT2_NAME, XPAR_AXI_PERF_MON_0_SLOT3_NAME,
+        XPAR_AXI_PERF_MON_0_SLOT4_NAME, XPAR_AXI_PERF_MON_0_SLOT5_NAME,
+        XPAR_AXI_PERF_MON_0_SLOT6_NAME, XPAR_AXI_PERF_MON_0_SLOT7_NAME
+    };
+
+    // Same values as WriterI::writeDeviceCounters
+    uint32_t numSlots = XPAR_AXI_PERF_MON_0_NUMBER_SLOTS;
+    for (uint32_t slot=0; slot < numSlots; slot++) {
+      uint32_t writeBytes = results.WriteBytes[slot] - CountersPrev.WriteBytes[slot];
+      double writeLatency = 0.0;
+      uint32_t numWriteTranx = results.WriteTranx[slot] - CountersPrev.WriteTranx[slot];
+      if (numWriteTranx > 0) {
+        writeLatency = (results.WriteLatency[slot] - CountersPrev.WriteLatency[slot]) /
+            numWriteTranx;
+      }
+
+      if (writeBytes != 0 || writeLatency != 0) {
+        TimelineTraceFile::entry e = {timeline::COUNTER_WRITE, timestamp, writeLatency, 0.0, writeBytes};
+        e.S[0] = &slotNames[slot];
+        TraceFile->log(e);
+      }
+
+      uint32_t readBytes = results.ReadBytes[slot] - CountersPrev.ReadBytes[slot];
+      double readLatency = 0.0;
+      uint32_t numReadTranx = results.ReadTranx[slot] - CountersPrev.ReadTranx[slot];
+      if (numReadTranx > 0) {
+        readLatency = (results.ReadLatency[slot] - CountersPrev.ReadLatency[slot]) /
+            numReadTranx;
+      }
+
+      if (readBytes != 0 || readLatency != 0) {
+        TimelineTraceFile::entry e = {timeline::COUNTER_READ, timestamp, readLatency, 0.0, readBytes};
+        e.S[0] = &slotNames[slot];
+        TraceFile->log(e);
+      }
+    }
+
+    CountersPrev = results;
+  }
+
+  // Trace names are still resolved here as they depend on the
+  // loaded binary, only the formatting of rows is deferred
+  void BinaryWriter::writeDeviceTrace(const DeviceTraceEvent* events, size_t count,
+      std::string deviceName, std::string binaryName)
+  {
+    if (!TraceFile || !count)
+      return;
+
+    auto rts = XCL::RTSingleton::Instance();
+    double deviceClockDurationUsec = (1.0 / (rts->getProfileManager()->getKernelClockFreqMHz(deviceName)));
+
+    for (size_t i = 0; i < count; i++) {
+      const DeviceTraceEvent& tr = events[i];
+      if (!getDeviceTraceNames(tr, deviceName, binaryName, TraceName, ArgNames, WorkGroupSize))
+        continue;
+
+      if (tr.Type == DeviceTraceEvent::KERNEL) {
+        TimelineTraceFile::entry e = {timeline::DEVICE_KERNEL, tr.Start, tr.End};
+        e.S[0] = &TraceName;
+        e.S[1] = &WorkGroupSize;
+        TraceFile->log(e);
+        continue;
+      }
+
+      double deviceDuration = 1000.0*(tr.End - tr.Start);
+      if (!(deviceDuration > 0.0)) deviceDuration = deviceClockDurationUsec;
+      TypeName = tr.typeName();
+
+      TimelineTraceFile::entry e = {timeline::DEVICE, tr.Start, tr.End, deviceDuration,
+          tr.BurstLength, tr.StartTime, tr.EndTime};
+      e.S[0] = &TraceName;
+      e.S[1] = &TypeName;
+      e.S[2] = &ArgNames;
+      TraceFile->log(e);
+    }
   }
   
   // ******************
@@ -31,9 +31,11 @@
 #include <cassert>
 #include <thread>
 #include <mutex>
+#include <memory>
 #include <CL/opencl.h>
 #include "rt_profile_device.h"
 #include "rt_profile_rule_checks.h"
+#include "rt_timeline_trace_file.h"
 
 // Use this class to build run time user services functions
 // such as debugging and profiling
@@ -94,27 +96,27 @@ namespace XCL {
 
 	    // Functions for timeline trace log
 	    // Write timeline trace of a function call such as cl API call
-	    void writeTimeline(double time, const std::string& functionName,
+	    virtual void writeTimeline(double time, const std::string& functionName,
 	        const std::string& eventName);
 	    // Write timeline trace of Kernel execution
-	    void writeTimeline(double traceTime, const std::string& commandString,
+	    virtual void writeTimeline(double traceTime, const std::string& commandString,
             const std::string& stageString, const std::string& eventString,
             const std::string& dependString, uint64_t objId, size_t size);
 	    // Write timeline trace of read/write of buffer
-	    void writeTimeline(double traceTime, const std::string& commandString,
+	    virtual void writeTimeline(double traceTime, const std::string& commandString,
             const std::string& stageString, const std::string& eventString,
             const std::string& dependString, size_t size, uint64_t address,
             const std::string& bank, std::thread::id threadId);
-	    void writeTimeline(double traceTime, const std::string& commandString,
+	    virtual void writeTimeline(double traceTime, const std::string& commandString,
             const std::string& stageString, const std::string& eventString,
             const std::string& dependString);
 
 	    // Functions for device counters
-	    void writeDeviceCounters(xclPerfMonType type, xclCounterResults& results,
+	    virtual void writeDeviceCounters(xclPerfMonType type, xclCounterResults& results,
 		      double timestamp, uint32_t sampleNum, bool firstReadAfterProgram);
 
 	    // Functions for device trace
-	    void writeDeviceTrace(const RTProfileDevice::TraceResultVector &resultVector,
+	    virtual void writeDeviceTrace(const DeviceTraceEvent* events, size_t count,
 	        std::string deviceName, std::string binaryName);
 
 	    // Function for profile rule checks
@@ -148,6 +150,11 @@ namespace XCL {
 		    writeTableCells(ofs, args...);
 		}
 
+	protected:
+	    bool getDeviceTraceNames(const DeviceTraceEvent& tr, std::string& deviceName,
+	        const std::string& binaryName, std::string& traceName, std::string& argNames,
+	        std::string& workGroupSize);
+
 	protected:
 	    void openStream(std::ofstream& ofs, const std::string& fileName);
 	    std::ofstream& getSummaryStream() {return Summary_ofs;}
@@ -202,7 +209,9 @@ namespace XCL {
 	    void writeTableRowEnd(std::ofstream& ofs) override { ofs << "\n";}
 	    void writeTableFooter(std::ofstream& ofs) override { ofs << "\n";};
 	    void writeDocumentFooter(std::ofstream& ofs) override;
-	    void writeTimelineFooter(std::ofstream& ofs);
+	    void writeHeaderText(std::ostream& ofs, const std::string& docName);
+	    void writeTimelineHeader(std::ostream& ofs);
+	    void writeTimelineFooter(std::ostream& ofs);
 
 	    // Cell and Row marking tokens
 	    const char* cellStart() override { return ""; }
@@ -218,6 +227,49 @@ namespace XCL {
 	    const std::string FileExtension = ".csv";
     };
 
+    //
+    // Binary Writer
+    //
+    // Writes the timeline trace only, in binary form to <timeline>.xtrace.
+    // Rows are not formatted, records are queued to a background thread
+    // that compresses and writes them (see rt_timeline_trace_file.h).
+    // The xtrace2csv tool expands the file to the csv timeline trace.
+    class BinaryWriter: public CSVWriter {
+
+	public:
+      BinaryWriter(const std::string& timelineFileName, const std::string& platformName,
+                   bool compress);
+	    ~BinaryWriter();
+
+	    void writeSummary(RTProfile* profile) override {}
+
+	    void writeTimeline(double time, const std::string& functionName,
+	        const std::string& eventName) override;
+	    void writeTimeline(double traceTime, const std::string& commandString,
+            const std::string& stageString, const std::string& eventString,
+            const std::string& dependString, uint64_t objId, size_t size) override;
+	    void writeTimeline(double traceTime, const std::string& commandString,
+            const std::string& stageString, const std::string& eventString,
+            const std::string& dependString, size_t size, uint64_t address,
+            const std::string& bank, std::thread::id threadId) override;
+	    void writeTimeline(double traceTime, const std::string& commandString,
+            const std::string& stageString, const std::string& eventString,
+            const std::string& dependString) override;
+	    void writeDeviceCounters(xclPerfMonType type, xclCounterResults& results,
+		      double timestamp, uint32_t sampleNum, bool firstReadAfterProgram) override;
+	    void writeDeviceTrace(const DeviceTraceEvent* events, size_t count,
+	        std::string deviceName, std::string binaryName) override;
+
+	private:
+	    std::unique_ptr<TimelineTraceFile> TraceFile;
+	    std::map<std::thread::id, std::string> ThreadIdNames;
+	    std::string TraceName;
+	    std::string TypeName;
+	    std::string ArgNames;
+	    std::string WorkGroupSize;
+	    const std::string FileExtension = ".xtrace";
+    };
+
     //
     // Unified CSV Writer
     //
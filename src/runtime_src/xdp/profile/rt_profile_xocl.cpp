@@ -323,8 +323,8 @@ log_device_trace(key k, xclPerfMonType type, bool forceRead)
 
   // Make sure we're not overlapping multiple calls to trace
   // NOTE: This can happen when we do the 'final log' called from the singleton deconstructor
-  //       which is a different thread than the event scheduler.
-  if (mgr->getLoggingTrace(type)) {
+  //       or from the trace offload thread, which are different threads than the event scheduler.
+  if (!mgr->tryLoggingTrace(type)) {
     //XCL::logprintf("Trace already being logged (type=%d)\n", type);
     return -1;
   }
@@ -336,12 +336,10 @@ log_device_trace(key k, xclPerfMonType type, bool forceRead)
 #endif
 
     // Iterate over all devices
-    mgr->setLoggingTrace(type, true);
     for (auto device : platform->get_device_range()) {
       if (device->is_active())
         ret |= xdp::profile::device::logTrace(device,type, forceRead);
     }
-    mgr->setLoggingTrace(type, false);
 
 #ifdef PROFILE_RUNTIME
     std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
@@ -350,6 +348,7 @@ log_device_trace(key k, xclPerfMonType type, bool forceRead)
     mgr->setLoggingTraceUsec(mgr->getLoggingTraceUsec + time_span.count());
 #endif
   }
+  mgr->setLoggingTrace(type, false);
   return ret;
 }
 
@@ -629,7 +628,7 @@ logTrace(key k, xclPerfMonType type, bool forceRead)
         break;
 
       // log the device trace
-      XCL::RTSingleton::Instance()->getProfileManager()->logDeviceTrace(device_name, binary_name, type, data->mTraceVector);
+      XCL::RTSingleton::Instance()->getProfileManager()->logDeviceTrace(device_name, binary_name, type, data->mTraceVector, forceRead);
       data->mTraceVector.mLength = 0;
 
       // Only check repeatedly for trace buffer flush if HW emulation
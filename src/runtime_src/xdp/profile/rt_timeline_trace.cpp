@@ -0,0 +1,503 @@
+/**
+ * Copyright (C) 2016-2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "rt_timeline_trace.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+static const uint32_t file_version = 1;
+
+// Largest section accepted by the reader
+static const uint32_t max_section_size = 1u << 30;
+
+static const size_t min_match = 4;
+static const unsigned int hash_log = 14;
+
+static inline uint32_t
+read32(const uint8_t* p)
+{
+  uint32_t v;
+  std::memcpy(&v,p,sizeof(v));
+  return v;
+}
+
+static inline uint32_t
+hash32(uint32_t v)
+{
+  return (v * 2654435761U) >> (32 - hash_log);
+}
+
+static void
+writeLength(std::vector<uint8_t>& dst, size_t len)
+{
+  for (; len >= 255; len -= 255)
+    dst.push_back(255);
+  dst.push_back(static_cast<uint8_t>(len));
+}
+
+static bool
+readLength(const uint8_t*& ip, const uint8_t* iend, size_t& len)
+{
+  uint8_t b = 0;
+  do {
+    if (ip == iend)
+      return false;
+    b = *ip++;
+    len += b;
+  } while (b == 255);
+  return true;
+}
+
+// Sequence without match (matchLen 0) terminates the block
+static void
+writeSequence(std::vector<uint8_t>& dst, const uint8_t* literals, size_t litLen,
+              size_t offset, size_t matchLen)
+{
+  uint8_t token = static_cast<uint8_t>(std::min<size_t>(litLen,15) << 4);
+  if (matchLen)
+    token |= static_cast<uint8_t>(std::min<size_t>(matchLen - min_match,15));
+  dst.push_back(token);
+  if (litLen >= 15)
+    writeLength(dst,litLen - 15);
+  dst.insert(dst.end(),literals,literals + litLen);
+  if (!matchLen)
+    return;
+  dst.push_back(static_cast<uint8_t>(offset & 0xff));
+  dst.push_back(static_cast<uint8_t>(offset >> 8));
+  if (matchLen - min_match >= 15)
+    writeLength(dst,matchLen - min_match - 15);
+}
+
+// Column transforms, see file layout in rt_timeline_trace.h
+template <typename T>
+static uint8_t*
+putXor(uint8_t* out, const T* col, size_t count)
+{
+  static_assert(sizeof(T) == sizeof(uint64_t),"8 byte column expected");
+  uint64_t prev = 0;
+  for (size_t i=0; i<count; ++i, out+=sizeof(uint64_t)) {
+    uint64_t bits;
+    std::memcpy(&bits,&col[i],sizeof(bits));
+    uint64_t v = bits ^ prev;
+    prev = bits;
+    std::memcpy(out,&v,sizeof(v));
+  }
+  return out;
+}
+
+template <typename T>
+static const uint8_t*
+getXor(const uint8_t* in, std::vector<XCL::timeline::record>& records, T XCL::timeline::record::* field)
+{
+  uint64_t prev = 0;
+  for (auto& r : records) {
+    uint64_t v;
+    std::memcpy(&v,in,sizeof(v));
+    in += sizeof(v);
+    prev ^= v;
+    std::memcpy(&(r.*field),&prev,sizeof(prev));
+  }
+  return in;
+}
+
+static uint8_t*
+putDelta(uint8_t* out, const uint64_t* col, size_t count)
+{
+  uint64_t prev = 0;
+  for (size_t i=0; i<count; ++i, out+=sizeof(uint64_t)) {
+    uint64_t v = col[i] - prev;
+    prev = col[i];
+    std::memcpy(out,&v,sizeof(v));
+  }
+  return out;
+}
+
+static const uint8_t*
+getDelta(const uint8_t* in, std::vector<XCL::timeline::record>& records, uint64_t XCL::timeline::record::* field)
+{
+  uint64_t prev = 0;
+  for (auto& r : records) {
+    uint64_t v;
+    std::memcpy(&v,in,sizeof(v));
+    in += sizeof(v);
+    prev += v;
+    r.*field = prev;
+  }
+  return in;
+}
+
+static void
+corrupt()
+{
+  throw std::runtime_error("Corrupt timeline trace file");
+}
+
+static void
+writeTime(std::ostream& ofs, double time)
+{
+  auto precision = ofs.precision(10);
+  ofs << time << ",";
+  ofs.precision(precision);
+}
+
+static void
+writeCells(std::ostream& ofs, size_t count)
+{
+  for (size_t i=0; i<count; ++i)
+    ofs << ",";
+}
+
+// Format a record the same way as the WriterI timeline functions
+static void
+writeRow(std::ostream& ofs, const XCL::timeline::reader& rd, const XCL::timeline::record& r)
+{
+  using namespace XCL::timeline;
+  auto str = [&rd,&r](unsigned int idx) -> const std::string& { return rd.getString(r.S[idx]); };
+
+  switch (r.Kind) {
+  case API:
+    writeTime(ofs,r.Time);
+    ofs << str(0) << "," << str(1) << ",";
+    writeCells(ofs,8);
+    break;
+  case KERNEL: {
+    std::stringstream objId;
+    objId << std::showbase << std::hex << std::uppercase << r.U0;
+    writeTime(ofs,r.Time);
+    ofs << str(0) << "," << str(1) << "," << objId.str() << "," << r.U1 << ",";
+    writeCells(ofs,6);
+    ofs << str(2) << "," << str(3) << ",";
+    break;
+  }
+  case TRANSFER: {
+    char address[32];
+    std::snprintf(address,sizeof(address),"0X%09" PRIx64,r.U0);
+    writeTime(ofs,r.Time);
+    ofs << str(0) << "," << str(1) << "," << address << "|" << str(4);
+    if (str(1) == "START" || str(1) == "END")
+      ofs << "|" << str(5);
+    ofs << "," << r.U1 << ",";
+    writeCells(ofs,6);
+    ofs << str(2) << "," << str(3) << ",";
+    break;
+  }
+  case DEPENDENCY:
+    writeTime(ofs,r.Time);
+    ofs << str(0) << "," << str(1) << "," << str(2) << "," << str(3) << ",";
+    break;
+  case DEVICE_KERNEL:
+    writeTime(ofs,r.Time);
+    ofs << str(0) << ",START,," << str(1) << ",\n";
+    writeTime(ofs,r.D0);
+    ofs << str(0) << ",END,," << str(1) << ",";
+    break;
+  case DEVICE:
+    writeTime(ofs,r.Time);
+    ofs << str(0) << "," << str(1) << "," << str(2) << "," << r.U0 << ","
+        << (r.U2 - r.U1) << "," << r.U1 << "," << r.U2 << "," << r.D1 << ",";
+    writeTime(ofs,r.Time);
+    writeTime(ofs,r.D0);
+    break;
+  case COUNTER_WRITE:
+  case COUNTER_READ:
+    writeTime(ofs,r.Time);
+    ofs << "Device Counters," << (r.Kind == COUNTER_WRITE ? "Write," : "Read,")
+        << str(0) << "," << r.U0 << "," << r.D0 << ",";
+    writeCells(ofs,r.Kind == COUNTER_WRITE ? 5 : 4);
+    break;
+  default:
+    corrupt();
+  }
+  ofs << "\n";
+}
+
+}
+
+namespace XCL {
+
+namespace timeline {
+
+void
+encodeChunk(const columns& cols, const std::vector<const std::string*>& strings,
+            std::vector<uint8_t>& data)
+{
+  auto count = cols.Count;
+  size_t size = 2*sizeof(uint32_t);
+  for (auto s : strings)
+    size += sizeof(uint32_t) + s->size();
+  size += count * (sizeof(uint8_t) + 6*sizeof(uint64_t) + num_strings*sizeof(uint32_t));
+  data.resize(size);
+
+  auto out = data.data();
+  uint32_t header[2] = {static_cast<uint32_t>(count), static_cast<uint32_t>(strings.size())};
+  std::memcpy(out,header,sizeof(header));
+  out += sizeof(header);
+  for (auto s : strings) {
+    uint32_t length = s->size();
+    std::memcpy(out,&length,sizeof(length));
+    std::memcpy(out+sizeof(length),s->data(),length);
+    out += sizeof(length) + length;
+  }
+
+  std::memcpy(out,cols.Kind,count);
+  out += count;
+  out = putXor(out,cols.Time,count);
+  out = putXor(out,cols.D0,count);
+  out = putXor(out,cols.D1,count);
+  out = putDelta(out,cols.U0,count);
+  out = putDelta(out,cols.U1,count);
+  out = putDelta(out,cols.U2,count);
+  for (size_t s=0; s<num_strings; ++s, out+=count*sizeof(uint32_t))
+    std::memcpy(out,cols.S[s],count*sizeof(uint32_t));
+}
+
+void
+compress(const uint8_t* src, size_t size, std::vector<uint8_t>& dst)
+{
+  dst.clear();
+  dst.reserve(size + size/255 + 16);
+
+  // Positions are stored +1 so that 0 means empty
+  std::vector<uint32_t> table(1u << hash_log, 0);
+  size_t anchor = 0;
+  size_t ip = 0;
+  size_t limit = size > 8 ? size - 8 : 0;
+
+  while (ip < limit) {
+    auto seq = read32(src + ip);
+    auto h = hash32(seq);
+    size_t ref = table[h];
+    table[h] = static_cast<uint32_t>(ip + 1);
+    if (!ref || ip + 1 - ref > 0xffff || read32(src + ref - 1) != seq) {
+      ++ip;
+      continue;
+    }
+
+    --ref;
+    size_t len = min_match;
+    while (ip + len < size && src[ref + len] == src[ip + len])
+      ++len;
+    writeSequence(dst,src + anchor,ip - anchor,ip - ref,len);
+    ip += len;
+    anchor = ip;
+  }
+
+  writeSequence(dst,src + anchor,size - anchor,0,0);
+}
+
+bool
+decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t size)
+{
+  auto ip = src;
+  auto iend = src + srcSize;
+  auto op = dst;
+  auto oend = dst + size;
+
+  while (ip < iend) {
+    uint8_t token = *ip++;
+    size_t litLen = token >> 4;
+    if (litLen == 15 && !readLength(ip,iend,litLen))
+      return false;
+    if (litLen > static_cast<size_t>(iend - ip) || litLen > static_cast<size_t>(oend - op))
+      return false;
+    std::memcpy(op,ip,litLen);
+    op += litLen;
+    ip += litLen;
+    if (ip == iend)
+      break;
+
+    if (iend - ip < 2)
+      return false;
+    size_t offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    size_t matchLen = token & 15;
+    if (matchLen == 15 && !readLength(ip,iend,matchLen))
+      return false;
+    matchLen += min_match;
+    if (!offset || offset > static_cast<size_t>(op - dst) || matchLen > static_cast<size_t>(oend - op))
+      return false;
+
+    // Byte copy, match may overlap the bytes it produces
+    auto match = op - offset;
+    for (size_t i=0; i<matchLen; ++i)
+      op[i] = match[i];
+    op += matchLen;
+  }
+
+  return op == oend;
+}
+
+void
+writeFileHeader(std::ostream& ofs)
+{
+  ofs.write("XDPTLINE",8);
+  ofs.write(reinterpret_cast<const char*>(&file_version),sizeof(file_version));
+}
+
+size_t
+writeSection(std::ostream& ofs, e_section type, e_codec codec,
+             const uint8_t* data, size_t size, std::vector<uint8_t>& scratch)
+{
+  uint32_t header[4] = {type, CODEC_NONE, static_cast<uint32_t>(size), static_cast<uint32_t>(size)};
+  auto out = data;
+  if (codec == CODEC_LZ && size) {
+    compress(data,size,scratch);
+    if (scratch.size() < size) {
+      header[1] = CODEC_LZ;
+      header[3] = static_cast<uint32_t>(scratch.size());
+      out = scratch.data();
+    }
+  }
+  ofs.write(reinterpret_cast<const char*>(header),sizeof(header));
+  ofs.write(reinterpret_cast<const char*>(out),header[3]);
+  return header[3];
+}
+
+reader::
+reader(const std::string& fileName)
+  : mStream(fileName, std::ios::in | std::ios::binary)
+{
+  if (!mStream.is_open())
+    throw std::runtime_error("Unable to open timeline trace '" + fileName + "'");
+
+  char magic[8];
+  uint32_t version = 0;
+  mStream.read(magic,sizeof(magic));
+  mStream.read(reinterpret_cast<char*>(&version),sizeof(version));
+  if (!mStream || std::memcmp(magic,"XDPTLINE",sizeof(magic)) || version != file_version)
+    throw std::runtime_error("'" + fileName + "' is not a timeline trace");
+}
+
+bool
+reader::
+next()
+{
+  uint32_t header[4];
+  mStream.read(reinterpret_cast<char*>(header),sizeof(header));
+  if (mStream.gcount() == 0)
+    return false;
+  if (!mStream || header[0] > SECTION_FOOTER || header[1] > CODEC_LZ
+      || header[2] > max_section_size || header[3] > max_section_size)
+    corrupt();
+
+  mStored.resize(header[3]);
+  if (!mStream.read(reinterpret_cast<char*>(mStored.data()),mStored.size()))
+    corrupt();
+
+  if (header[1] == CODEC_NONE) {
+    if (header[2] != header[3])
+      corrupt();
+    mData.swap(mStored);
+  }
+  else {
+    mData.resize(header[2]);
+    if (!decompress(mStored.data(),mStored.size(),mData.data(),mData.size()))
+      corrupt();
+  }
+
+  mType = static_cast<e_section>(header[0]);
+  if (mType == SECTION_CHUNK)
+    decodeChunk();
+  return true;
+}
+
+std::string
+reader::
+getText() const
+{
+  return std::string(mData.begin(),mData.end());
+}
+
+void
+reader::
+decodeChunk()
+{
+  const uint8_t* in = mData.data();
+  auto end = in + mData.size();
+
+  uint32_t header[2];
+  if (mData.size() < sizeof(header))
+    corrupt();
+  std::memcpy(header,in,sizeof(header));
+  in += sizeof(header);
+
+  mStrings.clear();
+  mStrings.reserve(header[1] + 1);
+  mStrings.emplace_back();
+  for (uint32_t i=0; i<header[1]; ++i) {
+    uint32_t length;
+    if (static_cast<size_t>(end - in) < sizeof(length))
+      corrupt();
+    std::memcpy(&length,in,sizeof(length));
+    in += sizeof(length);
+    if (static_cast<size_t>(end - in) < length)
+      corrupt();
+    mStrings.emplace_back(reinterpret_cast<const char*>(in),length);
+    in += length;
+  }
+
+  size_t count = header[0];
+  if (count > chunk_records
+      || static_cast<size_t>(end - in) != count * (sizeof(uint8_t) + 6*sizeof(uint64_t) + num_strings*sizeof(uint32_t)))
+    corrupt();
+
+  mRecords.resize(count);
+  for (auto& r : mRecords)
+    r.Kind = *in++;
+  in = getXor(in,mRecords,&record::Time);
+  in = getXor(in,mRecords,&record::D0);
+  in = getXor(in,mRecords,&record::D1);
+  in = getDelta(in,mRecords,&record::U0);
+  in = getDelta(in,mRecords,&record::U1);
+  in = getDelta(in,mRecords,&record::U2);
+  for (size_t s=0; s<num_strings; ++s) {
+    for (auto& r : mRecords) {
+      std::memcpy(&r.S[s],in,sizeof(uint32_t));
+      in += sizeof(uint32_t);
+      if (r.S[s] >= mStrings.size())
+        corrupt();
+    }
+  }
+}
+
+size_t
+convertToCSV(const std::string& fileName, std::ostream& ofs)
+{
+  reader rd(fileName);
+  size_t count = 0;
+  while (rd.next()) {
+    if (rd.getType() != SECTION_CHUNK) {
+      ofs << rd.getText();
+      continue;
+    }
+    for (size_t i=0; i<rd.getRecordCount(); ++i)
+      writeRow(ofs,rd,rd.getRecord(i));
+    count += rd.getRecordCount();
+  }
+  return count;
+}
+
+} // timeline
+
+} // XCL
@@ -0,0 +1,187 @@
+/**
+ * Copyright (C) 2016-2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __XILINX_RT_TIMELINE_TRACE_H
+#define __XILINX_RT_TIMELINE_TRACE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Binary timeline trace format
+//
+// This file has no runtime dependencies, it is shared between the
+// runtime (see rt_timeline_trace_file.h) and the xtrace2csv tool.
+//
+// File layout is a header followed by a sequence of sections:
+//   header:  "XDPTLINE" uint32_t version
+//   section: uint32_t type, uint32_t codec, uint32_t raw size,
+//            uint32_t stored size, stored bytes
+//
+// Text sections hold the csv document header and footer verbatim.
+// A chunk section holds up to chunk_records records in columnar
+// form, preceded by the strings referenced by the chunk:
+//   uint32_t records, uint32_t strings, strings as (uint32_t length, bytes),
+//   Kind[], Time[], D0[], D1[], U0[], U1[], U2[], S0[] .. S5[]
+// 8 byte columns are stored as the xor (doubles) or difference
+// (integers) with the previous row, which leaves mostly zero bytes
+// for the block codec to squeeze.
+
+namespace XCL {
+
+  namespace timeline {
+
+    enum e_section : uint32_t {
+      SECTION_HEADER = 0,
+      SECTION_CHUNK,
+      SECTION_FOOTER
+    };
+
+    enum e_codec : uint32_t {
+      CODEC_NONE = 0,
+      CODEC_LZ
+    };
+
+    // Kind of timeline row, determines the meaning of record fields
+    //   API:           S0 function, S1 event
+    //   KERNEL:        S0 command, S1 stage, S2 event, S3 depend, U0 object id, U1 size
+    //   TRANSFER:      S0 command, S1 stage, S2 event, S3 depend, S4 bank, S5 thread,
+    //                  U0 address, U1 size
+    //   DEPENDENCY:    S0 command, S1 stage, S2 event, S3 depend
+    //   DEVICE_KERNEL: S0 trace name, S1 work group size, D0 end
+    //   DEVICE:        S0 trace name, S1 type, S2 arguments, U0 burst length,
+    //                  U1 start cycles, U2 end cycles, D0 end, D1 duration usec
+    //   COUNTER_*:     S0 slot, U0 bytes, D0 latency
+    enum e_record_kind : uint8_t {
+      API = 0,
+      KERNEL,
+      TRANSFER,
+      DEPENDENCY,
+      DEVICE_KERNEL,
+      DEVICE,
+      COUNTER_WRITE,
+      COUNTER_READ
+    };
+
+    static constexpr size_t num_strings = 6;
+    static constexpr size_t chunk_records = 8192;
+
+    // A decoded timeline record.  String ids index the strings of the
+    // chunk the record was read from, id 0 is always the empty string.
+    struct record {
+      uint8_t Kind;
+      double Time;
+      double D0;
+      double D1;
+      uint64_t U0;
+      uint64_t U1;
+      uint64_t U2;
+      uint32_t S[num_strings];
+    };
+
+    // Records of a chunk in columnar form as appended by the writer
+    struct columns {
+      size_t Count = 0;
+      uint8_t Kind[chunk_records];
+      double Time[chunk_records];
+      double D0[chunk_records];
+      double D1[chunk_records];
+      uint64_t U0[chunk_records];
+      uint64_t U1[chunk_records];
+      uint64_t U2[chunk_records];
+      uint32_t S[num_strings][chunk_records];
+    };
+
+    // Serialize a chunk into @data.  @strings are the chunk strings
+    // with ids 1..strings.size(), id 0 is the implicit empty string.
+    void
+    encodeChunk(const columns& cols, const std::vector<const std::string*>& strings,
+                std::vector<uint8_t>& data);
+
+    // Block compression, LZ77 with a 64KB window and LZ4 style
+    // sequences (token, literals, 16 bit offset, match length).
+    void
+    compress(const uint8_t* src, size_t size, std::vector<uint8_t>& dst);
+
+    // @return false if @src is corrupt or does not expand to @size bytes
+    bool
+    decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t size);
+
+    // Write a section to @ofs, compressed with @codec unless that
+    // does not make it smaller.  @scratch is reused between calls.
+    // @return number of bytes stored for the section data
+    size_t
+    writeSection(std::ostream& ofs, e_section type, e_codec codec,
+                 const uint8_t* data, size_t size, std::vector<uint8_t>& scratch);
+
+    void
+    writeFileHeader(std::ostream& ofs);
+
+    // Sequential reader of a binary timeline trace file
+    class reader {
+    public:
+      // Throws std::runtime_error if the file cannot be opened
+      // or is not a timeline trace
+      explicit reader(const std::string& fileName);
+
+      // Read next section, @return false at end of file.
+      // Throws std::runtime_error on a corrupt section.
+      bool
+      next();
+
+      e_section
+      getType() const { return mType; }
+
+      // Text of a header or footer section
+      std::string
+      getText() const;
+
+      // Records and strings of a chunk section
+      size_t
+      getRecordCount() const { return mRecords.size(); }
+
+      const record&
+      getRecord(size_t idx) const { return mRecords[idx]; }
+
+      const std::string&
+      getString(uint32_t id) const { return mStrings[id]; }
+
+    private:
+      void
+      decodeChunk();
+
+      std::ifstream mStream;
+      e_section mType = SECTION_HEADER;
+      std::vector<uint8_t> mStored;
+      std::vector<uint8_t> mData;
+      std::vector<record> mRecords;
+      std::vector<std::string> mStrings;
+    };
+
+    // Expand a binary timeline trace to the csv timeline trace format
+    // written by CSVWriter.  Throws std::runtime_error on error.
+    // @return number of records converted
+    size_t
+    convertToCSV(const std::string& fileName, std::ostream& ofs);
+
+  } // timeline
+
+} // XCL
+
+#endif
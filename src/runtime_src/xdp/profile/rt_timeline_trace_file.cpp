@@ -0,0 +1,112 @@
+/**
+ * Copyright (C) 2016-2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "rt_timeline_trace_file.h"
+
+#include <stdexcept>
+
+namespace XCL {
+
+TimelineTraceFile::
+TimelineTraceFile(const std::string& fileName, const std::string& header, bool compress)
+  : mStream(fileName, std::ios::out | std::ios::binary | std::ios::trunc)
+  , mCodec(compress ? timeline::CODEC_LZ : timeline::CODEC_NONE)
+  , mFull(2*max_chunks)
+{
+  if (!mStream.is_open())
+    throw std::runtime_error("Unable to open profile report for writing");
+
+  std::vector<uint8_t> scratch;
+  timeline::writeFileHeader(mStream);
+  timeline::writeSection(mStream,timeline::SECTION_HEADER,mCodec,
+                         reinterpret_cast<const uint8_t*>(header.data()),header.size(),scratch);
+
+  mThread = std::thread(&TimelineTraceFile::writerLoop,this);
+}
+
+TimelineTraceFile::
+~TimelineTraceFile()
+{
+  close("");
+}
+
+void
+TimelineTraceFile::
+flush()
+{
+  if (!mCurrent || !mCurrent->Columns.Count)
+    return;
+  mFull.addWork(std::move(mCurrent));
+  mCurrent = nullptr;
+}
+
+void
+TimelineTraceFile::
+close(const std::string& footer)
+{
+  if (!mStream.is_open())
+    return;
+
+  // A null chunk stops the writer thread after all chunks queued before it
+  flush();
+  mFull.addWork(nullptr);
+  mThread.join();
+
+  std::vector<uint8_t> scratch;
+  timeline::writeSection(mStream,timeline::SECTION_FOOTER,mCodec,
+                         reinterpret_cast<const uint8_t*>(footer.data()),footer.size(),scratch);
+  mStream.close();
+}
+
+TimelineTraceFile::chunk*
+TimelineTraceFile::
+getChunk()
+{
+  std::unique_lock<std::mutex> lk(mFreeMutex);
+  if (mFree.empty() && mChunks.size() < max_chunks) {
+    mChunks.emplace_back(new chunk);
+    return mChunks.back().get();
+  }
+
+  // Sleep rather than spin, the caller may hold a lock that other
+  // logging threads are waiting for
+  while (mFree.empty())
+    mFreeCond.wait(lk);
+  auto c = mFree.back();
+  mFree.pop_back();
+  return c;
+}
+
+void
+TimelineTraceFile::
+writerLoop()
+{
+  std::vector<uint8_t> data;
+  std::vector<uint8_t> scratch;
+  while (auto c = mFull.getWork()) {
+    timeline::encodeChunk(c->Columns,c->Strings,data);
+    auto stored = timeline::writeSection(mStream,timeline::SECTION_CHUNK,mCodec,
+                                         data.data(),data.size(),scratch);
+    mRawBytes += data.size();
+    mStoredBytes += stored;
+    c->reset();
+    std::lock_guard<std::mutex> lk(mFreeMutex);
+    mFree.push_back(c);
+    mFreeCond.notify_one();
+  }
+}
+
+} // XCL
@@ -0,0 +1,160 @@
+/**
+ * Copyright (C) 2016-2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __XILINX_RT_TIMELINE_TRACE_FILE_H
+#define __XILINX_RT_TIMELINE_TRACE_FILE_H
+
+#include "rt_timeline_trace.h"
+#include "xrt/util/task.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace XCL {
+
+  // **************************************************************************
+  // Binary timeline trace file written by a background thread
+  // **************************************************************************
+  // Records are appended to a columnar chunk by the logging thread.
+  // Full chunks are handed to the writer thread through a lock free
+  // queue, the writer thread serializes, compresses and writes them
+  // and then hands the chunk back for reuse.  At most max_chunks are
+  // allocated, the logging thread sleeps until a chunk is recycled if
+  // the writer thread falls behind.
+  //
+  // Calls to log, flush and close must be serialized by the caller.
+  class TimelineTraceFile {
+  public:
+    static constexpr size_t max_chunks = 8;
+
+    // Strings are referenced only for the duration of log(),
+    // a null string is the same as an empty string
+    struct entry {
+      uint8_t Kind;
+      double Time;
+      double D0;
+      double D1;
+      uint64_t U0;
+      uint64_t U1;
+      uint64_t U2;
+      const std::string* S[timeline::num_strings];
+    };
+
+    // Create the file and write the text @header.
+    // Throws std::runtime_error if the file cannot be opened.
+    TimelineTraceFile(const std::string& fileName, const std::string& header, bool compress);
+    ~TimelineTraceFile();
+
+    void
+    log(const entry& e)
+    {
+      if (!mCurrent)
+        mCurrent = getChunk();
+
+      auto& cols = mCurrent->Columns;
+      auto idx = cols.Count;
+      cols.Kind[idx] = e.Kind;
+      cols.Time[idx] = e.Time;
+      cols.D0[idx] = e.D0;
+      cols.D1[idx] = e.D1;
+      cols.U0[idx] = e.U0;
+      cols.U1[idx] = e.U1;
+      cols.U2[idx] = e.U2;
+      for (size_t s=0; s<timeline::num_strings; ++s)
+        cols.S[s][idx] = mCurrent->intern(e.S[s]);
+      ++mRecords;
+
+      if (++cols.Count == timeline::chunk_records)
+        flush();
+    }
+
+    // Hand the current chunk to the writer thread
+    void
+    flush();
+
+    // Write all records followed by the text @footer and close the file
+    void
+    close(const std::string& footer);
+
+    uint64_t
+    getRecordCount() const { return mRecords; }
+
+    // Serialized and stored (compressed) sizes of the chunks written so far
+    uint64_t
+    getRawBytes() const { return mRawBytes; }
+
+    uint64_t
+    getStoredBytes() const { return mStoredBytes; }
+
+  private:
+    struct chunk {
+      timeline::columns Columns;
+      std::unordered_map<std::string,uint32_t> Ids;
+      std::vector<const std::string*> Strings;
+
+      uint32_t
+      intern(const std::string* str)
+      {
+        if (!str || str->empty())
+          return 0;
+        auto itr = Ids.find(*str);
+        if (itr != Ids.end())
+          return itr->second;
+        uint32_t id = Strings.size() + 1;
+        Strings.push_back(&Ids.emplace(*str,id).first->first);
+        return id;
+      }
+
+      void
+      reset()
+      {
+        Columns.Count = 0;
+        Ids.clear();
+        Strings.clear();
+      }
+    };
+
+    chunk*
+    getChunk();
+
+    void
+    writerLoop();
+
+  private:
+    std::ofstream mStream;
+    timeline::e_codec mCodec;
+    chunk* mCurrent = nullptr;
+    uint64_t mRecords = 0;
+    std::atomic<uint64_t> mRawBytes {0};
+    std::atomic<uint64_t> mStoredBytes {0};
+    std::vector<std::unique_ptr<chunk>> mChunks;
+    xrt::task::lfqueue<chunk*> mFull;
+    std::mutex mFreeMutex;
+    std::condition_variable mFreeCond;
+    std::vector<chunk*> mFree;
+    std::thread mThread;
+  };
+
+} // XCL
+
+#endif
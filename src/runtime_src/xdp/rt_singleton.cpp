@@ -148,6 +148,15 @@ namespace XCL {
       timelineFile2 = "sdx_timeline_trace";
     }
 
+    // Binary timeline trace replaces the csv timeline trace
+    if (xrt::config::get_timeline_trace_binary()) {
+      BinaryWriter* binaryWriter = new BinaryWriter(timelineFile, "Xilinx",
+          xrt::config::get_timeline_trace_compression());
+      Writers.push_back(binaryWriter);
+      ProfileMgr->attach(binaryWriter);
+      timelineFile = "";
+    }
+
     // HTML and CSV writers
     //HTMLWriter* htmlWriter = new HTMLWriter(profileFile, timelineFile, "Xilinx");
     CSVWriter* csvWriter = new CSVWriter(profileFile, timelineFile, "Xilinx");
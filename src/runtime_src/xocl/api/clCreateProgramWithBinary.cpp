@@ -31,7 +31,9 @@
 #include "detail/device.h"
 
 #include <exception>
+#include <future>
 #include <string>
+#include <vector>
 #include <algorithm>
 
 #include "plugin/xdp/profile.h"
@@ -44,6 +46,41 @@ loadProgramBinary(xocl::program* program, xocl::device* device)
   device->load_program(program);
 }
 
+// Program all devices concurrently.  Devices are independent, and
+// with many devices sequential programming dominates startup time.
+// Return per device exception if any.
+static std::vector<std::exception_ptr>
+loadProgramBinaries(xocl::program* program, cl_uint num_devices, const cl_device_id* device_list)
+{
+  std::vector<std::exception_ptr> errors(num_devices);
+  if (num_devices==1) {
+    try {
+      loadProgramBinary(program,xocl::xocl(device_list[0]));
+    }
+    catch (...) {
+      errors[0] = std::current_exception();
+    }
+    return errors;
+  }
+
+  std::vector<std::future<void>> loads;
+  loads.reserve(num_devices);
+  for (auto device : xocl::get_range(device_list,device_list+num_devices))
+    loads.push_back(std::async(std::launch::async,loadProgramBinary,program,xocl::xocl(device)));
+
+  size_t idx = 0;
+  for (auto& load : loads) {
+    try {
+      load.get();
+    }
+    catch (...) {
+      errors[idx] = std::current_exception();
+    }
+    ++idx;
+  }
+  return errors;
+}
+
 } //namespace
 
 namespace xocl {
@@ -127,17 +164,26 @@ clCreateProgramWithBinary(cl_context                      context ,
   auto program = xrt::make_unique<xocl::program>(xocl::xocl(context),num_devices,device_list,binaries,lengths);
 
   // Assign binaries to all devices in the list
-  size_t idx = 0;
-  for (auto device : xocl::get_range(device_list,device_list+num_devices)) {
+  auto errors = loadProgramBinaries(program.get(),num_devices,device_list);
+  std::exception_ptr error;
+  for (size_t idx=0; idx<num_devices; ++idx) {
+    if (!errors[idx]) {
+      xocl::assign(&binary_status[idx],CL_SUCCESS);
+      continue;
+    }
     try {
-      loadProgramBinary(program.get(),xocl(device));
-      xocl::assign(&binary_status[idx++],CL_SUCCESS);
+      std::rethrow_exception(errors[idx]);
     }
     catch (const xocl::error& ex) {
       xocl::assign(&binary_status[idx],CL_INVALID_BINARY);
-      throw;
     }
+    catch (...) {
+    }
+    if (!error)
+      error = errors[idx];
   }
+  if (error)
+    std::rethrow_exception(error);
 
   xocl::profile::start_device_profiling(1);
   // NOTE: We read from the counters to set a baseline for values and
@@ -29,28 +29,22 @@
 #include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
 
-#include <fstream>
-
 // should use some md5 checksum instead
 #include <crypt.h> 
 #include "plugin/xdp/profile.h"
 
 namespace {
 
-static std::vector<char>
+// Map xclbin file read-only into memory
+static xocl::xclbin::binary_type
 read_file(const std::string& filename)
 {
-  std::ifstream istr(filename,std::ios::binary|std::ios::ate);
-  if (!istr)
-    throw xocl::error(CL_BUILD_PROGRAM_FAILURE,"Cannot not open '" + filename + "' for reading");
-
-  auto pos = istr.tellg();
-  istr.seekg(0,std::ios::beg);
-
-  std::vector<char> buffer(pos);
-  istr.read (&buffer[0],pos);
-
-  return buffer;
+  try {
+    return xocl::xclbin::binary_type(filename);
+  }
+  catch (const std::exception& ex) {
+    throw xocl::error(CL_BUILD_PROGRAM_FAILURE,"Cannot not read '" + filename + "': " + ex.what());
+  }
 }
 
 }
@@ -132,7 +126,7 @@ clCreateProgramWithSource(cl_context        context,
 
 
   auto xclbin = read_file(filematch);
-  char* binary = &xclbin[0]; // char
+  auto binary = xclbin.binary_data().first; // const char*
   size_t length=xclbin.size();
 
   // hash match found clCreateProgramWithBinary and exit search
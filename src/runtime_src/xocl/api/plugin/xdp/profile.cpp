@@ -36,6 +36,8 @@
 #include "xocl/xclbin/xclbin.h"
 
 #include <map>
+#include <mutex>
+#include <string>
 #include <sstream>
 #include "plugin/xdp/profile.h"
 
@@ -364,6 +366,20 @@ action_migrate(cl_uint num_mem_objects, const cl_mem *mem_objects, cl_mem_migrat
   };
 }
 
+unsigned int
+get_function_call_id(const char* function)
+{
+  static std::mutex mutex;
+  static std::map<std::string,unsigned int> ids;
+  std::lock_guard<std::mutex> lk(mutex);
+  auto itr = ids.find(function);
+  if (itr != ids.end())
+    return (*itr).second;
+  auto id = static_cast<unsigned int>(ids.size());
+  ids.emplace(function,id);
+  return id;
+}
+
 function_call_logger::
 function_call_logger(const char* function)
   : function_call_logger(function,0)
@@ -371,7 +387,12 @@ function_call_logger(const char* function)
   
 function_call_logger::
 function_call_logger(const char* function, long long address)
-  : m_name(function), m_address(address)
+  : function_call_logger(function,address,get_function_call_id(function))
+{}
+
+function_call_logger::
+function_call_logger(const char* function, long long address, unsigned int id)
+  : m_name(function), m_address(address), m_id(id)
 {
   static bool s_load_xdp = false;
 
@@ -385,14 +406,14 @@ function_call_logger(const char* function, long long address)
   }
 
   if (cb_log_function_start)
-    cb_log_function_start(m_name, m_address);
+    cb_log_function_start(m_name, m_address, m_id);
 }
 
 function_call_logger::
 ~function_call_logger()
 {
   if (cb_log_function_end)
-    cb_log_function_end(m_name, m_address);
+    cb_log_function_end(m_name, m_address, m_id);
 }
 
 void add_to_active_devices(const std::string& device_name)
@@ -60,8 +60,8 @@ using cb_action_migrate_type = std::function< void (xocl::event* event,cl_int st
  * callback function types for function logging, dependency ...
  */
 
-using cb_log_function_start_type = std::function<void(const char* functionName, long long queueAddress)>;
-using cb_log_function_end_type = std::function<void(const char* functionName, long long queueAddress)>;
+using cb_log_function_start_type = std::function<void(const char* functionName, long long queueAddress, unsigned int functionID)>;
+using cb_log_function_end_type = std::function<void(const char* functionName, long long queueAddress, unsigned int functionID)>;
 using cb_log_dependencies_type = std::function<void(xocl::event* event,  cl_uint num_deps, const cl_event* deps)>;
 using cb_add_to_active_devices_type = std::function<void (const std::string& device_name)>;
 using cb_set_kernel_clock_freq_type = std::function<void(const std::string& device_name, unsigned int freq)>;
@@ -155,14 +155,26 @@ log(xocl::event* event, cl_int status, const std::string& cuname);
 void
 log_dependencies (xocl::event* event,  cl_uint num_deps, const cl_event* deps);
 
+/**
+ * Get a unique id for an API function
+ *
+ * Ids are assigned in order of first call, starting at 0.  The
+ * logging macros resolve the id once per call site, so logging
+ * a function call never classifies the function by name.
+ */
+unsigned int
+get_function_call_id(const char* function);
+
 struct function_call_logger
 {
   function_call_logger(const char* function);
   function_call_logger(const char* function, long long address);
+  function_call_logger(const char* function, long long address, unsigned int id);
   ~function_call_logger();
 
   const char* m_name = nullptr;
   long long m_address = 0;
+  unsigned int m_id = 0;
 };
 
 void
@@ -197,8 +209,12 @@ end_device_profiling();
 
 }} // profile,xocl
 
-#define PROFILE_LOG_FUNCTION_CALL xocl::profile::function_call_logger function_call_logger_object(__func__);
-#define PROFILE_LOG_FUNCTION_CALL_WITH_QUEUE(Q) xocl::profile::function_call_logger function_call_logger_object(__func__, (long long)Q);
+#define PROFILE_LOG_FUNCTION_CALL \
+  static const unsigned int function_call_id = xocl::profile::get_function_call_id(__func__); \
+  xocl::profile::function_call_logger function_call_logger_object(__func__, 0, function_call_id);
+#define PROFILE_LOG_FUNCTION_CALL_WITH_QUEUE(Q) \
+  static const unsigned int function_call_id = xocl::profile::get_function_call_id(__func__); \
+  xocl::profile::function_call_logger function_call_logger_object(__func__, (long long)Q, function_call_id);
 
 #endif
 
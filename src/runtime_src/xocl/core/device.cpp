@@ -23,6 +23,7 @@
 #include "xocl/api/plugin/xdp/debug.h"
 #include "xocl/xclbin/xclbin.h"
 #include "xrt/util/memory.h"
+#include "xrt/util/fill.h"
 #include "xrt/scheduler/scheduler.h"
 
 #include <iostream>
@@ -34,6 +35,9 @@ namespace {
 
 static unsigned int uid_count = 0;
 
+// serializes process global steps of device::load_program
+static std::mutex s_load_mutex;
+
 static
 std::string
 to_hex(void* addr)
@@ -108,6 +112,66 @@ sync_to_hbuf(xocl::memory* buffer, size_t offset, size_t size,
   }
 }
 
+// Sync [offset,offset+size) of boh to device.  The host side data
+// is staged by host_copy(offset,size).  Transfers larger than the
+// configured chunk size are split into chunks that are synced
+// asynchronously on the DMA write queue, staging of next chunk
+// overlaps DMA of previous chunks.
+template <typename HostCopy>
+static void
+sync_to_device(xrt::device* xdevice, const xrt::device::BufferObjectHandle& boh,
+               size_t offset, size_t size, HostCopy&& host_copy)
+{
+  size_t chunk = xrt::config::get_dma_chunk_size();
+  if (!chunk || size<=chunk) {
+    host_copy(offset,size);
+    xdevice->sync(boh,size,offset,xrt::hal::device::direction::HOST2DEVICE,false);
+    return;
+  }
+
+  std::vector<xrt::event> events;
+  events.reserve((size+chunk-1)/chunk);
+  for (size_t off=offset, end=offset+size; off<end; off+=chunk) {
+    auto sz = std::min(chunk,end-off);
+    host_copy(off,sz);
+    events.emplace_back(xdevice->sync(boh,sz,off,xrt::hal::device::direction::HOST2DEVICE,true));
+  }
+
+  for (auto& event : events)
+    event.wait();
+}
+
+// Sync [offset,offset+size) of boh from device.  The host side data
+// is updated by host_copy(offset,size).  Transfers larger than the
+// configured chunk size are split into chunks that are all synced
+// asynchronously on the DMA read queue, host copy of a chunk
+// overlaps DMA of following chunks.
+template <typename HostCopy>
+static void
+sync_from_device(xrt::device* xdevice, const xrt::device::BufferObjectHandle& boh,
+                 size_t offset, size_t size, HostCopy&& host_copy)
+{
+  size_t chunk = xrt::config::get_dma_chunk_size();
+  if (!chunk || size<=chunk) {
+    xdevice->sync(boh,size,offset,xrt::hal::device::direction::DEVICE2HOST,false);
+    host_copy(offset,size);
+    return;
+  }
+
+  std::vector<xrt::event> events;
+  events.reserve((size+chunk-1)/chunk);
+  for (size_t off=offset, end=offset+size; off<end; off+=chunk)
+    events.emplace_back(xdevice->sync(boh,std::min(chunk,end-off),off,xrt::hal::device::direction::DEVICE2HOST,true));
+
+  size_t off = offset;
+  for (auto& event : events) {
+    auto sz = std::min(chunk,offset+size-off);
+    event.wait();
+    host_copy(off,sz);
+    off += sz;
+  }
+}
+
 static void
 open_or_error(xrt::device* device, const std::string& log)
 {
@@ -766,18 +830,15 @@ map_buffer(memory* buffer, cl_map_flags map_flags, size_t offset, size_t size, v
   void* result = static_cast<char*>(ubuf) + offset;
   assert(!assert_result || result==assert_result);
 
-  // If this buffer is being mapped for writing, then a following
-  // unmap will have to sync the data to device, so record this.  We
-  // will not enforce that map is followed by unmap, so two maps of
-  // same buffer for write without corresponding unmaps will simply
-  // override previous map value.  We do however keep track of the
-  // map with largest size to subsume small maps into the largest.
-  // That way largest chunk is synced to device if necessary.
+  // Every map is recorded as an interval of the buffer so that a
+  // following unmap can sync exactly the range written by host.  We
+  // will not enforce that map is followed by unmap, maps without a
+  // corresponding unmap are simply never synced.
   std::lock_guard<std::mutex> lk(m_mutex);
-  auto& mapinfo = m_mapped[result];
-  mapinfo.flags = map_flags;
-  mapinfo.offset = offset;
-  mapinfo.size = std::max(mapinfo.size,size);
+  auto& mapped = m_mapped_buffers[buffer];
+  mapped.base = static_cast<const char*>(ubuf);
+  mapped.maps.emplace(offset,mapinfo{map_flags,size});
+  ++m_mapped[result];
   return result;
 }
 
@@ -785,32 +846,70 @@ void
 device::
 unmap_buffer(memory* buffer, void* mapped_ptr)
 {
-  cl_map_flags flags = 0; // flags of mapped_ptr
-  size_t offset = 0;      // offset of mapped_ptr wrt BO
-  size_t size = 0;        // size of mapped_ptr
+  size_t offset = 0;
+  mapinfo info;
   {
-    // There is no checking that map/unmap match.  Only one active
-    // map of a mapped_ptr is maintained and is erased on first unmap
     std::lock_guard<std::mutex> lk(m_mutex);
-    auto itr = m_mapped.find(mapped_ptr);
-    if (itr!=m_mapped.end()) {
-      flags = (*itr).second.flags;
-      offset = (*itr).second.offset;
-      size = (*itr).second.size;
-      m_mapped.erase(itr);
-    }
+    auto pitr = m_mapped.find(mapped_ptr);
+    if (pitr==m_mapped.end())
+      return;
+    if (--(*pitr).second==0)
+      m_mapped.erase(pitr);
+
+    auto bitr = m_mapped_buffers.find(buffer);
+    if (bitr==m_mapped_buffers.end())
+      return;
+    auto& mapped = (*bitr).second;
+
+    // There is no checking that map/unmap match.  If a mapped_ptr is
+    // mapped more than once, then the most recent map is unmapped.
+    offset = static_cast<const char*>(mapped_ptr) - mapped.base;
+    auto range = mapped.maps.equal_range(offset);
+    if (range.first==range.second)
+      return;
+    auto itr = std::prev(range.second);
+    info = (*itr).second;
+    mapped.maps.erase(itr);
+
+    if (mapped.maps.empty())
+      m_mapped_buffers.erase(bitr);
   }
 
+  // Sync exactly the range written through this map
+  if (!(info.flags & (CL_MAP_WRITE | CL_MAP_WRITE_INVALIDATE_REGION)))
+    return;
+
   auto xdevice = get_xrt_device();
   auto boh = buffer->get_buffer_object_or_error(this);
+  auto ubuf = static_cast<char*>(buffer->get_host_ptr());
+  auto host_copy = [=](size_t off, size_t sz) {
+    if (ubuf)
+      xdevice->write(boh,ubuf+off,sz,off,false);
+  };
+
+  // Sync data to boh, and sync to device if resident
+  if (buffer->is_resident(this))
+    sync_to_device(xdevice,boh,offset,info.size,host_copy);
+  else
+    host_copy(offset,info.size);
+}
+
+void
+device::
+unmap_all(const memory* buffer)
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  auto bitr = m_mapped_buffers.find(buffer);
+  if (bitr==m_mapped_buffers.end())
+    return;
 
-  // Sync data to boh if write flags, and sync to device if resident
-  if (flags & (CL_MAP_WRITE | CL_MAP_WRITE_INVALIDATE_REGION)) {
-    if (auto ubuf = static_cast<char*>(buffer->get_host_ptr()))
-      xdevice->write(boh,ubuf+offset,size,offset,false);
-    if (buffer->is_resident(this))
-      xdevice->sync(boh,size,offset,xrt::hal::device::direction::HOST2DEVICE,false);
+  auto& mapped = (*bitr).second;
+  for (auto& map : mapped.maps) {
+    auto pitr = m_mapped.find(mapped.base + map.first);
+    if (pitr!=m_mapped.end() && --(*pitr).second==0)
+      m_mapped.erase(pitr);
   }
+  m_mapped_buffers.erase(bitr);
 }
 
 void
@@ -822,8 +921,8 @@ migrate_buffer(memory* buffer,cl_mem_migration_flags flags)
     buffer_resident_or_error(buffer,this);
     auto boh = buffer->get_buffer_object_or_error(this);
     auto xdevice = get_xrt_device();
-    xdevice->sync(boh,buffer->get_size(),0,xrt::hal::device::direction::DEVICE2HOST,false);
-    sync_to_ubuf(buffer,0,buffer->get_size(),xdevice,boh);
+    sync_from_device(xdevice,boh,0,buffer->get_size(),
+                     [=](size_t off, size_t sz) { sync_to_ubuf(buffer,off,sz,xdevice,boh); });
     return;
   }
 
@@ -833,8 +932,8 @@ migrate_buffer(memory* buffer,cl_mem_migration_flags flags)
   xrt::device::BufferObjectHandle boh = buffer->get_buffer_object(this);
 
   // Sync from host to device to make make buffer resident of this device
-  sync_to_hbuf(buffer,0,buffer->get_size(),xdevice,boh);
-  xdevice->sync(boh,buffer->get_size(), 0, xrt::hal::device::direction::HOST2DEVICE,false);
+  sync_to_device(xdevice,boh,0,buffer->get_size(),
+                 [=](size_t off, size_t sz) { sync_to_hbuf(buffer,off,sz,xdevice,boh); });
 
   // Now buffer is resident on this device and migrate is complete
   buffer->set_resident(this);
@@ -847,16 +946,21 @@ write_buffer(memory* buffer, size_t offset, size_t size, const void* ptr)
   auto xdevice = get_xrt_device();
   auto boh = buffer->get_buffer_object(this);
 
-  // Write data to buffer object at offset
-  xdevice->write(boh,ptr,size,offset,false);
+  // Write data to buffer object at offset and update unaligned
+  // ubuf if necessary
+  auto host_copy = [=](size_t off, size_t sz) {
+    xdevice->write(boh,static_cast<const char*>(ptr)+(off-offset),sz,off,false);
+    sync_to_ubuf(buffer,off,sz,xdevice,boh);
+  };
 
-  // Update unaligned ubuf if necessary
-  sync_to_ubuf(buffer,offset,size,xdevice,boh);
+  if (!buffer->is_resident(this)) {
+    host_copy(offset,size);
+    return;
+  }
 
-  if (buffer->is_resident(this))
-    // Sync new written data to device at offset
-    // HAL performs read/modify write if necesary
-    xdevice->sync(boh,size,offset,xrt::hal::device::direction::HOST2DEVICE,false);
+  // Sync new written data to device at offset
+  // HAL performs read/modify write if necesary
+  sync_to_device(xdevice,boh,offset,size,host_copy);
 }
 
 void
@@ -866,46 +970,34 @@ read_buffer(memory* buffer, size_t offset, size_t size, void* ptr)
   auto xdevice = get_xrt_device();
   auto boh = buffer->get_buffer_object(this);
 
-  if (buffer->is_resident(this))
-    // Sync back from device at offset to buffer object
-    // HAL performs skip/copy read if necesary
-    xdevice->sync(boh,size,offset,xrt::hal::device::direction::DEVICE2HOST,false);
+  // Read data from buffer object at offset and update unaligned
+  // ubuf if necessary
+  auto host_copy = [=](size_t off, size_t sz) {
+    xdevice->read(boh,static_cast<char*>(ptr)+(off-offset),sz,off,false);
+    sync_to_ubuf(buffer,off,sz,xdevice,boh);
+  };
 
-  // Read data from buffer object at offset
-  xdevice->read(boh,ptr,size,offset,false);
+  if (!buffer->is_resident(this)) {
+    host_copy(offset,size);
+    return;
+  }
 
-  // Update unaligned ubuf if necessary
-  sync_to_ubuf(buffer,offset,size,xdevice,boh);
+  // Sync back from device at offset to buffer object
+  // HAL performs skip/copy read if necesary
+  sync_from_device(xdevice,boh,offset,size,host_copy);
 }
 
-void
-device::
-copy_buffer(memory* src_buffer, memory* dst_buffer, size_t src_offset, size_t dst_offset, size_t size, const cmd_type& cmd)
+// Construct and schedule a CDMA copy command.
+static void
+schedule_cdma_copy(device* device, const device::cmd_type& cmd, uint64_t src_addr, uint64_t dst_addr, size_t size)
 {
-  auto xdevice = get_xrt_device();
-
-  if (!get_num_cdmas() || is_emulation_mode()) {
-    auto cb = [this](memory* src_buffer, memory* dst_buffer, size_t src_offset, size_t dst_offset, size_t size,const cmd_type& cmd) {
-      cmd->start();
-      char* hbuf_src = static_cast<char*>(map_buffer(src_buffer,CL_MAP_READ,src_offset,size,nullptr));
-      char* hbuf_dst = static_cast<char*>(map_buffer(dst_buffer,CL_MAP_WRITE_INVALIDATE_REGION,dst_offset,size,nullptr));
-      std::memcpy(hbuf_dst,hbuf_src,size);
-      unmap_buffer(src_buffer,hbuf_src);
-      unmap_buffer(dst_buffer,hbuf_dst);
-      cmd->done();
-    };
-    xdevice->schedule(cb,xrt::device::queue_type::misc,src_buffer,dst_buffer, src_offset, dst_offset, size,cmd);
-    return;
-  }
-
-  // CDMA.  TODO, this needs to be done at lower shim level, not in OCL land
   auto sk_cmd = xrt::command_cast<ert_start_kernel_cmd*>(cmd);
   auto packet = cmd->get_packet();
   size_t offset = 1; // packet offset past header
 
-  auto maxidx = get_num_cus() + get_num_cdmas();
+  auto maxidx = device->get_num_cus() + device->get_num_cdmas();
 
-  for (auto cu_idx=get_num_cus(); cu_idx<maxidx; ++cu_idx) {
+  for (auto cu_idx=device->get_num_cus(); cu_idx<maxidx; ++cu_idx) {
     auto mask_idx = cu_idx/32;
     auto cu_mask_idx = cu_idx - mask_idx*32;
     packet[offset + mask_idx] |= 1 << cu_mask_idx;
@@ -915,11 +1007,6 @@ copy_buffer(memory* src_buffer, memory* dst_buffer, size_t src_offset, size_t ds
   offset += maxidx/32 + 1; // packet offset past cumasks
 
   // Insert copy command content
-  auto src_boh = xocl::xocl(src_buffer)->get_buffer_object(this);
-  auto src_addr = xdevice->getDeviceAddr(src_boh) + src_offset;
-  auto dst_boh = xocl::xocl(dst_buffer)->get_buffer_object(this);
-  auto dst_addr = xdevice->getDeviceAddr(dst_boh) + dst_offset;
-
   packet[offset++] = 0; // 0x0 reserved CU AP_CTRL
   packet[offset++] = 0; // 0x4 reserved CU GIE
   packet[offset++] = 0; // 0xc reserved CU IER
@@ -936,6 +1023,34 @@ copy_buffer(memory* src_buffer, memory* dst_buffer, size_t src_offset, size_t ds
   xrt::scheduler::schedule(cmd);
 }
 
+void
+device::
+copy_buffer(memory* src_buffer, memory* dst_buffer, size_t src_offset, size_t dst_offset, size_t size, const cmd_type& cmd)
+{
+  auto xdevice = get_xrt_device();
+
+  if (!get_num_cdmas() || is_emulation_mode()) {
+    auto cb = [this](memory* src_buffer, memory* dst_buffer, size_t src_offset, size_t dst_offset, size_t size,const cmd_type& cmd) {
+      cmd->start();
+      char* hbuf_src = static_cast<char*>(map_buffer(src_buffer,CL_MAP_READ,src_offset,size,nullptr));
+      char* hbuf_dst = static_cast<char*>(map_buffer(dst_buffer,CL_MAP_WRITE_INVALIDATE_REGION,dst_offset,size,nullptr));
+      std::memcpy(hbuf_dst,hbuf_src,size);
+      unmap_buffer(src_buffer,hbuf_src);
+      unmap_buffer(dst_buffer,hbuf_dst);
+      cmd->done();
+    };
+    xdevice->schedule(cb,xrt::device::queue_type::misc,src_buffer,dst_buffer, src_offset, dst_offset, size,cmd);
+    return;
+  }
+
+  // CDMA.  TODO, this needs to be done at lower shim level, not in OCL land
+  auto src_boh = xocl::xocl(src_buffer)->get_buffer_object(this);
+  auto src_addr = xdevice->getDeviceAddr(src_boh) + src_offset;
+  auto dst_boh = xocl::xocl(dst_buffer)->get_buffer_object(this);
+  auto dst_addr = xdevice->getDeviceAddr(dst_boh) + dst_offset;
+  schedule_cdma_copy(this,cmd,src_addr,dst_addr,size);
+}
+
 void
 device::
 copy_p2p_buffer(memory* src_buffer, memory* dst_buffer, size_t src_offset, size_t dst_offset, size_t size)
@@ -951,91 +1066,165 @@ device::
 fill_buffer(memory* buffer, const void* pattern, size_t pattern_size, size_t offset, size_t size)
 {
   auto boh = xocl::xocl(buffer)->get_buffer_object(this);
+
+  // Fill in device memory using CDMA if possible.  The first
+  // cdma_fill_seed bytes are filled by host and synced, then the
+  // filled region is doubled by CDMA copies of itself.  CDMA copies
+  // in units of 512 bits, which is a multiple of the pattern size.
+  const size_t cdma_fill_threshold = 1<<20;
+  const size_t cdma_fill_seed = 1<<16;
+  if (get_num_cdmas() && !is_emulation_mode() && buffer->is_resident(this)
+      && size>=cdma_fill_threshold && !(offset%64) && !(size%64) && !(cdma_fill_seed%pattern_size)) {
+    char* hbuf = static_cast<char*>(map_buffer(buffer,CL_MAP_WRITE_INVALIDATE_REGION,offset,cdma_fill_seed,nullptr));
+    xrt::fill(hbuf,cdma_fill_seed,pattern,pattern_size);
+    unmap_buffer(buffer,hbuf);
+
+    auto xdevice = get_xrt_device();
+    auto addr = xdevice->getDeviceAddr(boh) + offset;
+    for (size_t filled=cdma_fill_seed; filled<size; ) {
+      auto sz = std::min(filled,size-filled);
+      auto cmd = std::make_shared<xrt::command>(xdevice,ERT_START_CU);
+      schedule_cdma_copy(this,cmd,addr,addr+filled,sz);
+      cmd->wait();
+      filled += sz;
+    }
+    return;
+  }
+
   char* hbuf = static_cast<char*>(map_buffer(buffer,CL_MAP_WRITE_INVALIDATE_REGION,offset,size,nullptr));
-  char* dst = hbuf;
-  for (; pattern_size <= size; size-=pattern_size, dst+=pattern_size)
-    std::memcpy(dst,pattern,pattern_size);
-  if (size)
-    std::memcpy(dst,pattern,size);
+  xrt::fill(hbuf,size,pattern,pattern_size);
   unmap_buffer(buffer,hbuf);
 }
 
+// Copy a strided region between ptr and the host side of the buffer
+// object of mem.  The region is synced from device before read and
+// synced to device after write if mem is resident.  Rows are copied
+// directly to/from the mapped buffer object and the region is synced
+// as a whole by the HAL.
 static void
-rw_image(device* device,
-         memory* image,const size_t* origin,const size_t* region,size_t row_pitch,size_t slice_pitch
-         ,char* read_to,const char* write_from)
+rw_rect(device* device, memory* mem, const xrt::device::rect& rect
+        ,size_t host_row_pitch, size_t host_slice_pitch
+        ,char* read_to, const char* write_from)
 {
-  auto boh = image->get_buffer_object(device);
+  if (!rect.width || !rect.height || !rect.depth)
+    return;
+
   auto xdevice = device->get_xrt_device();
+  auto boh = mem->get_buffer_object(device);
+  auto resident = mem->is_resident(device);
 
-  size_t image_offset = image->get_image_data_offset()
-    + image->get_image_bytes_per_pixel()*origin[0]
-    + image->get_image_row_pitch()*origin[1]
-    + image->get_image_slice_pitch()*origin[2];
+  // bounding span of region in buffer object
+  auto span = (rect.depth-1)*rect.slice_pitch + (rect.height-1)*rect.row_pitch + rect.width;
 
-  if (!origin[0] && region[0]==image->get_image_width() && row_pitch==image->get_image_row_pitch()
-      && (region[2]==1
-          || (!origin[1] && region[1]==image->get_image_height() && slice_pitch==image->get_image_slice_pitch())
-          )
-      ) {
-    size_t sz = region[2]==1 ? row_pitch*region[1] : slice_pitch*region[2];
-    if (read_to)
-      xdevice->read(boh,read_to,sz,image_offset,false);
-    else
-      xdevice->write(boh,write_from,sz,image_offset,false);
+  if (read_to && resident) {
+    xdevice->sync_rect(boh,rect,xrt::hal::device::direction::DEVICE2HOST);
+    sync_to_ubuf(mem,rect.offset,span,xdevice,boh);
   }
-  else {
-    size_t image_offset_tmp = image_offset;
-    for (unsigned int j=0; j<region[2]; ++j) {
-      size_t offset = image_offset_tmp;
-      for (unsigned int i=0; i<region[1]; ++i) {
-        if (read_to) {
-          xdevice->read(boh,read_to,image->get_image_bytes_per_pixel()*region[0],offset,false);
-          read_to += row_pitch;
-        }
-        else {
-          xdevice->write(boh,write_from,image->get_image_bytes_per_pixel()*region[0],offset, false);
-          write_from += row_pitch;
-        }
-        offset += image->get_image_row_pitch();
-      }
-      image_offset_tmp += image->get_image_slice_pitch();
+
+  auto hbuf = static_cast<char*>(xdevice->map(boh));
+  xdevice->unmap(boh);
+
+  for (size_t z=0; z<rect.depth; ++z) {
+    for (size_t y=0; y<rect.height; ++y) {
+      auto bo_row = hbuf + rect.offset + z*rect.slice_pitch + y*rect.row_pitch;
+      auto host_row = z*host_slice_pitch + y*host_row_pitch;
       if (read_to)
-        read_to += slice_pitch;
+        std::memcpy(read_to+host_row,bo_row,rect.width);
       else
-        write_from += slice_pitch;
+        std::memcpy(bo_row,write_from+host_row,rect.width);
     }
   }
+
+  if (write_from) {
+    sync_to_ubuf(mem,rect.offset,span,xdevice,boh);
+    if (resident)
+      xdevice->sync_rect(boh,rect,xrt::hal::device::direction::HOST2DEVICE);
+  }
+}
+
+static void
+rw_image(device* device,
+         memory* image,const size_t* origin,const size_t* region,size_t row_pitch,size_t slice_pitch
+         ,char* read_to,const char* write_from)
+{
+  xrt::device::rect rect;
+  rect.offset = image->get_image_data_offset()
+    + image->get_image_bytes_per_pixel()*origin[0]
+    + image->get_image_row_pitch()*origin[1]
+    + image->get_image_slice_pitch()*origin[2];
+  rect.width = image->get_image_bytes_per_pixel()*region[0];
+  rect.height = region[1];
+  rect.depth = region[2];
+  rect.row_pitch = image->get_image_row_pitch();
+  rect.slice_pitch = image->get_image_slice_pitch();
+
+  rw_rect(device,image,rect,row_pitch,slice_pitch,read_to,write_from);
+}
+
+static void
+rw_buffer_rect(device* device, memory* buffer
+               ,const size_t* buffer_origin,const size_t* host_origin,const size_t* region
+               ,size_t buffer_row_pitch,size_t buffer_slice_pitch
+               ,size_t host_row_pitch,size_t host_slice_pitch
+               ,char* read_to,const char* write_from)
+{
+  xrt::device::rect rect;
+  rect.offset = buffer_origin[2]*buffer_slice_pitch + buffer_origin[1]*buffer_row_pitch + buffer_origin[0];
+  rect.width = region[0];
+  rect.height = region[1];
+  rect.depth = region[2];
+  rect.row_pitch = buffer_row_pitch;
+  rect.slice_pitch = buffer_slice_pitch;
+
+  auto host_offset = host_origin[2]*host_slice_pitch + host_origin[1]*host_row_pitch + host_origin[0];
+  if (read_to)
+    read_to += host_offset;
+  else
+    write_from += host_offset;
+
+  rw_rect(device,buffer,rect,host_row_pitch,host_slice_pitch,read_to,write_from);
 }
 
 void
 device::
 write_image(memory* image,const size_t* origin,const size_t* region,size_t row_pitch,size_t slice_pitch,const void *ptr)
 {
-  // Write from ptr into image
+  // Write from ptr into image, sync written region to device if
+  // image is resident
   rw_image(this,image,origin,region,row_pitch,slice_pitch,nullptr,static_cast<const char*>(ptr));
-
-  // Sync newly writte data to device if image is resident
-  if (image->is_resident(this)) {
-    auto boh = image->get_buffer_object_or_error(this);
-    get_xrt_device()->sync(boh, image->get_size(), 0,xrt::hal::device::direction::HOST2DEVICE,false);
-  }
 }
 
 void
 device::
 read_image(memory* image,const size_t* origin,const size_t* region,size_t row_pitch,size_t slice_pitch,void *ptr)
 {
-  // Sync back from device if image is resident
-  if (image->is_resident(this)) {
-    auto boh = image->get_buffer_object_or_error(this);
-    get_xrt_device()->sync(boh,image->get_size(),0,xrt::hal::device::direction::DEVICE2HOST,false);
-  }
-
-  // Now read from image into ptr
+  // Sync region back from device if image is resident, then read
+  // from image into ptr
   rw_image(this,image,origin,region,row_pitch,slice_pitch,static_cast<char*>(ptr),nullptr);
 }
 
+void
+device::
+write_buffer_rect(memory* buffer,const size_t* buffer_origin,const size_t* host_origin,const size_t* region
+                  ,size_t buffer_row_pitch,size_t buffer_slice_pitch
+                  ,size_t host_row_pitch,size_t host_slice_pitch,const void* ptr)
+{
+  rw_buffer_rect(this,buffer,buffer_origin,host_origin,region
+                 ,buffer_row_pitch,buffer_slice_pitch,host_row_pitch,host_slice_pitch
+                 ,nullptr,static_cast<const char*>(ptr));
+}
+
+void
+device::
+read_buffer_rect(memory* buffer,const size_t* buffer_origin,const size_t* host_origin,const size_t* region
+                 ,size_t buffer_row_pitch,size_t buffer_slice_pitch
+                 ,size_t host_row_pitch,size_t host_slice_pitch,void* ptr)
+{
+  rw_buffer_rect(this,buffer,buffer_origin,host_origin,region
+                 ,buffer_row_pitch,buffer_slice_pitch,host_row_pitch,host_slice_pitch
+                 ,static_cast<char*>(ptr),nullptr);
+}
+
 void
 device::
 read_register(memory* mem, size_t offset,void* ptr, size_t size)
@@ -1085,6 +1274,12 @@ load_program(program* program)
 
   std::lock_guard<std::mutex> lock(m_mutex);
 
+  // Devices can be programmed concurrently, but only reclocking and
+  // bitstream download are device local.  Remaining steps update
+  // process global state (profiling, debug, scheduler) and are
+  // serialized across devices.
+  std::unique_lock<std::mutex> glock(s_load_mutex);
+
   if (m_active && !std::getenv("XCL_CONFORMANCE"))
     throw xocl::error(CL_OUT_OF_RESOURCES,"program already loaded on device");
 
@@ -1114,62 +1309,74 @@ load_program(program* program)
   // get the xrt device.  guaranteed to be the final device after
   // above call to setXrtDevice
   auto xdevice = get_xrt_device();
+  auto header = reinterpret_cast<const xclBin *>(binary_data.first);
 
-  // reclocking - old
-  // This is obsolete and will be removed soon (pending verify.xclbin updates)
-  if (xrt::config::get_frequency_scaling()) {
-    const clock_freq_topology* freqs = m_xclbin.get_clk_freq_topology();
-    if(!freqs) {
-      if (!is_sw_emulation())
-        std::cout << "WARNING: Please update xclbin. Legacy clocking section support will be removed soon" << std::endl;
-      unsigned short idx = 0;
-      unsigned short target_freqs[4] = {0};
-      auto kclocks = m_xclbin.kernel_clocks();
-      if (kclocks.size()>2)
-	throw xocl::error(CL_INVALID_PROGRAM,"Too many kernel clocks");
-      for (auto& clock : kclocks) {
-	if (idx == 0) {
-	  std::string device_name = get_unique_name();
-	  profile::set_kernel_clock_freq(device_name, clock.frequency);
-	}
-	target_freqs[idx++] = clock.frequency;
-      }
+  // Same xclbin as the one already on the device, skip reclocking
+  // and download if the CUs can be reset instead.
+  if (xdevice->resetXclbinKernels(header)) {
+    XOCL_DEBUG(std::cout,"xocl::device::load_program(",m_uid,") xclbin already loaded, CUs reset\n");
+  }
+  else {
+    glock.unlock();
+
+    // reclocking - old
+    // This is obsolete and will be removed soon (pending verify.xclbin updates)
+    if (xrt::config::get_frequency_scaling()) {
+      const clock_freq_topology* freqs = m_xclbin.get_clk_freq_topology();
+      if(!freqs) {
+        if (!is_sw_emulation())
+          std::cout << "WARNING: Please update xclbin. Legacy clocking section support will be removed soon" << std::endl;
+        unsigned short idx = 0;
+        unsigned short target_freqs[4] = {0};
+        auto kclocks = m_xclbin.kernel_clocks();
+        if (kclocks.size()>2)
+          throw xocl::error(CL_INVALID_PROGRAM,"Too many kernel clocks");
+        for (auto& clock : kclocks) {
+          if (idx == 0) {
+            std::string device_name = get_unique_name();
+            std::lock_guard<std::mutex> lk(s_load_mutex);
+            profile::set_kernel_clock_freq(device_name, clock.frequency);
+          }
+          target_freqs[idx++] = clock.frequency;
+        }
 
-      // System clocks
-      idx=2; // system clocks start at idx==2
-      auto sclocks = m_xclbin.system_clocks();
-      if (sclocks.size()>2)
-        throw xocl::error(CL_INVALID_PROGRAM,"Too many system clocks");
-      for (auto& clock : sclocks)
-        target_freqs[idx++] = clock.frequency;
-
-      auto rv = xdevice->reClock2(0,target_freqs);
-      if (rv.valid() && rv.get())
-        throw xocl::error(CL_INVALID_PROGRAM,"Reclocking failed");
+        // System clocks
+        idx=2; // system clocks start at idx==2
+        auto sclocks = m_xclbin.system_clocks();
+        if (sclocks.size()>2)
+          throw xocl::error(CL_INVALID_PROGRAM,"Too many system clocks");
+        for (auto& clock : sclocks)
+          target_freqs[idx++] = clock.frequency;
+
+        auto rv = xdevice->reClock2(0,target_freqs);
+        if (rv.valid() && rv.get())
+          throw xocl::error(CL_INVALID_PROGRAM,"Reclocking failed");
+      }
     }
-  }
 
 
-  // programmming
-  if (xrt::config::get_xclbin_programing()) {
-    auto header = reinterpret_cast<const xclBin *>(binary_data.first);
-    auto xbrv = xdevice->loadXclBin(header);
-    if (xbrv.valid() && xbrv.get()){
-      if(xbrv.get() == -EACCES)
-        throw xocl::error(CL_INVALID_PROGRAM,"Failed to load xclbin. Invalid DNA");
-      else if (xbrv.get() == -EBUSY)
-        throw xocl::error(CL_INVALID_PROGRAM,"Failed to load xclbin. Device Busy, see dmesg for details");
-      else if (xbrv.get() == -ETIMEDOUT)
-        throw xocl::error(CL_INVALID_PROGRAM,"Failed to load xclbin. Timeout, see dmesg for details");
-      else if (xbrv.get() == -ENOMEM)
-        throw xocl::error(CL_INVALID_PROGRAM,"Failed to load xclbin. Out of Memory, see dmesg for details");
-      else
+    // programmming
+    if (xrt::config::get_xclbin_programing()) {
+      auto xbrv = xdevice->loadXclBin(header);
+      if (xbrv.valid() && xbrv.get()){
+        if(xbrv.get() == -EACCES)
+          throw xocl::error(CL_INVALID_PROGRAM,"Failed to load xclbin. Invalid DNA");
+        else if (xbrv.get() == -EBUSY)
+          throw xocl::error(CL_INVALID_PROGRAM,"Failed to load xclbin. Device Busy, see dmesg for details");
+        else if (xbrv.get() == -ETIMEDOUT)
+          throw xocl::error(CL_INVALID_PROGRAM,"Failed to load xclbin. Timeout, see dmesg for details");
+        else if (xbrv.get() == -ENOMEM)
+          throw xocl::error(CL_INVALID_PROGRAM,"Failed to load xclbin. Out of Memory, see dmesg for details");
+        else
+          throw xocl::error(CL_INVALID_PROGRAM,"Failed to load xclbin.");
+      }
+
+      if (!xbrv.valid()) {
         throw xocl::error(CL_INVALID_PROGRAM,"Failed to load xclbin.");
+      }
     }
 
-    if (!xbrv.valid()) {
-      throw xocl::error(CL_INVALID_PROGRAM,"Failed to load xclbin.");
-    }
+    glock.lock();
   }
 
   // Add compute units for each kernel in the program.
@@ -376,6 +376,14 @@ public:
   void
   unmap_buffer(memory* mem, void* mapped_ptr);
 
+  /**
+   * Forget outstanding maps of a memory object without syncing
+   *
+   * Used when a memory object is released with maps outstanding
+   */
+  void
+  unmap_all(const memory* mem);
+
   /**
    * Migrate buffer to this device (clEnqueueMigrateMemObjects)
    *
@@ -448,7 +456,8 @@ public:
    * @param buffer
    *  Buffer to fill with pattern.  The buffer will synced to device
    *  after being filled if and only if the buffer is currently
-   *  resident on the device.
+   *  resident on the device.  Large fills of a resident buffer are
+   *  done in device memory using CDMA if the device has CDMA CUs.
    * @param pattern
    *  The pattern to fill the buffer with.
    * @param pattern_size
@@ -467,6 +476,30 @@ public:
   void
   read_image(memory* image,const size_t* origin,const size_t* region,size_t row_pitch,size_t slice_pitch,void *ptr);
 
+  /**
+   * Write a 2D or 3D region of a buffer from host memory
+   *
+   * The region is synced to device if the buffer is resident.
+   * Arguments are as for clEnqueueWriteBufferRect, the pitches must
+   * be computed by caller.
+   */
+  void
+  write_buffer_rect(memory* buffer,const size_t* buffer_origin,const size_t* host_origin,const size_t* region
+                    ,size_t buffer_row_pitch,size_t buffer_slice_pitch
+                    ,size_t host_row_pitch,size_t host_slice_pitch,const void* ptr);
+
+  /**
+   * Read a 2D or 3D region of a buffer into host memory
+   *
+   * The region is synced from device if the buffer is resident.
+   * Arguments are as for clEnqueueReadBufferRect, the pitches must
+   * be computed by caller.
+   */
+  void
+  read_buffer_rect(memory* buffer,const size_t* buffer_origin,const size_t* host_origin,const size_t* region
+                   ,size_t buffer_row_pitch,size_t buffer_slice_pitch
+                   ,size_t host_row_pitch,size_t host_slice_pitch,void* ptr);
+
   //streaming APIs. TODO : document them.
   int
   get_stream(xrt::device::stream_flags flags, xrt::device::stream_attrs attrs, const cl_mem_ext_ptr_t* ext, xrt::device::stream_handle* stream);
@@ -718,8 +751,16 @@ private:
 private:
   struct mapinfo {
     cl_map_flags flags = 0; // mapflags
-    size_t offset = 0;      // boh:hbuf offset
-    size_t size = 0;        // max size mapped
+    size_t size = 0;        // size mapped
+
+    mapinfo() {}
+    mapinfo(cl_map_flags f, size_t sz) : flags(f), size(sz) {}
+  };
+
+  // Outstanding maps of a buffer keyed by boh:hbuf offset
+  struct mapped_buffer {
+    const char* base = nullptr;          // mapped ptr at offset 0
+    std::multimap<size_t,mapinfo> maps;
   };
 
   unsigned int m_uid = 0;
@@ -740,10 +781,12 @@ private:
   // Mutual exclusive access to this device
   mutable std::mutex m_mutex;
 
-  // Track how a region of a buffer object is mapped.  There is
-  // no tracking of matching map and unmap.  Last map of a region
-  // is what is stored and first unmap of a region erases the content.
-  std::map<const void*,mapinfo> m_mapped;
+  // Track how regions of buffer objects are mapped.  Each map is
+  // stored as an interval of its buffer, and mapped ptrs are counted
+  // for is_mapped.  First unmap of a mapped ptr erases its most
+  // recent map.
+  std::map<const memory*,mapped_buffer> m_mapped_buffers;
+  std::map<const void*,unsigned int> m_mapped;
 
   // Track memory objects allocated on this device
   std::set<const memory*> m_memobjs;
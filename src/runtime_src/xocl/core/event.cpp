@@ -136,8 +136,12 @@ set_status(cl_int s)
     // remove the completed event from queue (submitted queue)
     // before event_scheduler attempts to submit next event.
     queue_remove();   // 1 (order matters)
+
+    // Kernel commands of chained events are scheduled together
+    execution_context::command_batch batch;
     for (auto& c : m_chain) // not a race, since m_chain is blocked by CL_COMPLETE
       c->submit();
+    batch.flush();
   }
 
   return s;
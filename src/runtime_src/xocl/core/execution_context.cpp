@@ -23,6 +23,7 @@
 
 #include "impl/spir.h"
 
+#include <cstring>
 #include <iostream>
 #include <fstream>
 
@@ -119,6 +120,9 @@ try_pending()
 
 namespace xocl {
 
+// Outermost command batch of calling thread
+static thread_local execution_context::command_batch* t_batch = nullptr;
+
 static std::vector<command_callback_function_type> cmd_start_cb;
 static std::vector<command_callback_function_type> cmd_done_cb;
 
@@ -179,33 +183,91 @@ struct execution_context::start_kernel_conformance : start_kernel
   }
 };
 
-static int
-fill_regmap(execution_context::regmap_type& regmap, size_t offset,
+/**
+ * Register map of a kernel started on a set of compute units
+ *
+ * The template holds the command packet words following the header
+ * as computed from the kernel argument values: the CU masks followed
+ * by the CU register map.  Starting a workgroup copies the words to
+ * the command packet and patches the words of the runtime arguments.
+ */
+struct kernel::regmap_template
+{
+  using rtinfo_type = kernel::argument::rtinfo_type;
+
+  // A word of a runtime argument.  @hostoffset is the byte offset of
+  // the word in the host value of the argument
+  struct rtinfo_word
+  {
+    size_t word;
+    rtinfo_type type;
+    size_t hostoffset;
+  };
+
+  const device* dev = nullptr;
+  std::vector<const compute_unit*> cus;
+  std::vector<uint32_t> words;
+  size_t extra_cu_masks = 0;
+  std::vector<rtinfo_word> rtinfo;
+  bool printf_buffer = false;
+  uint64_t printf_buffer_addr = 0;
+
+  // Memory objects with device address in the template
+  std::vector<ptr<memory>> buffers;
+};
+
+// Packet words following the header, max packet size is 4KB
+static constexpr size_t max_regmap_words = 0x1000/sizeof(uint32_t) - 1;
+
+// 32-bit word at @offset of host value @data of @size bytes.  Bytes
+// past the end of the value are zero so that the word doesn't carry
+// junk in case the value is smaller than the word.
+static uint32_t
+host_word(const void* data, size_t size, size_t offset)
+{
+  uint32_t word = 0;
+  if (offset < size)
+    std::memcpy(&word,static_cast<const char*>(data)+offset,std::min(size-offset,sizeof(word)));
+  return word;
+}
+
+static void
+resize_regmap(std::vector<uint32_t>& words, size_t size)
+{
+  if (size > max_regmap_words)
+    throw xrt::error(CL_OUT_OF_RESOURCES
+                     , std::string("control buffer size '")
+                     + std::to_string((size+1)*sizeof(uint32_t)/static_cast<double>(0x400))
+                     + std::string("KB' exceeds maximum value of 4KB"));
+  if (size > words.size())
+    words.resize(size,0);
+}
+
+static void
+fill_regmap(std::vector<uint32_t>& regmap, size_t offset,
             const void* data, const size_t size,
             const xocl::kernel::argument::arginfo_range_type& arginforange)
 {
-  // scale raw data input to specified size so that the
-  // value when cast to uint32_t* doesn't carry junk in case
-  // size is less than sizeof(uint32_t). Fill host_data
-  // conservative with an additional sizeof(uint32_t) bytes.
-  const char* cdata = reinterpret_cast<const char*>(data);
-  std::vector<char> host_data(cdata,cdata+size);
-  host_data.resize(size+sizeof(uint32_t));
-
   // For each component of the argument
   for (auto arginfo : arginforange) {
-    const char* component = host_data.data() + arginfo->hostoffset;
-    const uint32_t* word = reinterpret_cast<const uint32_t*>(component);
     // For each 32-bit word of the component
     for (size_t wi=0, we=arginfo->size/sizeof(uint32_t); wi!=we; ++wi) {
       size_t device_offset = arginfo->offset + wi*sizeof(uint32_t);
-      uint32_t device_value = *word;
       size_t register_offset = device_offset / sizeof(uint32_t);
-      regmap[offset+register_offset] = device_value;
-      //      std::cout << "regmap[" << register_offset << "]=" << device_value << "\n";
-      ++word;
+      resize_regmap(regmap,offset+register_offset+1);
+      regmap[offset+register_offset] = host_word(data,size,arginfo->hostoffset + wi*sizeof(uint32_t));
     }
   }
+}
+
+static uint64_t
+get_buffer_addr(const xocl::kernel::argument* arg, const device* device,
+                std::vector<ptr<memory>>& buffers)
+{
+  if (auto mem = arg->get_memory_object()) {
+    buffers.emplace_back(mem);
+    return mem->get_buffer_object_addr_or_error(device);
+  }
   return 0;
 }
 
@@ -231,13 +293,22 @@ execution_context(device* device
   std::copy(global_work_size,global_work_size+work_dim,m_gsize.begin());
   std::copy(local_work_size,local_work_size+work_dim,m_lsize.begin());
 
-  // Bind the kernel arguments to this context so that the same kernel
-  // object can be reused while this context is executing
-  for (auto& arg : m_kernel->get_argument_range())
-    m_kernel_args.push_back(arg->clone());
-
   // Compute units to use
   add_compute_units(device);
+
+  // Use the register map cached with the kernel if it was built for
+  // the current argument values, otherwise bind the kernel arguments
+  // to this context so that the same kernel object can be reused while
+  // this context is executing
+  m_arg_stamp = m_kernel->get_argument_stamp();
+  auto regmap = m_kernel->get_regmap_template();
+  if (!conformance::on() && regmap && regmap->dev==m_device && regmap->cus==m_cus) {
+    m_regmap = std::move(regmap);
+    return;
+  }
+
+  for (auto& arg : m_kernel->get_argument_range())
+    m_kernel_args.push_back(arg->clone());
 }
 
 void
@@ -258,6 +329,54 @@ add_compute_units(device* device)
   }
 }
 
+execution_context::command_batch::
+command_batch()
+  : m_outer(t_batch)
+{
+  if (!m_outer)
+    t_batch = this;
+}
+
+execution_context::command_batch::
+~command_batch()
+{
+  if (m_outer)
+    return;
+  t_batch = nullptr;
+  if (m_cmds.empty())
+    return;
+
+  // Commands that failed to schedule will never complete, abort
+  // their events so that waiters are released with an error
+  auto cmds = std::move(m_cmds);
+  try {
+    xrt::scheduler::schedule_batch(cmds);
+  }
+  catch (const std::exception& ex) {
+    xrt::message::send(xrt::message::severity_level::ERROR,ex.what());
+    event* aborted = nullptr;
+    for (auto& cmd : cmds) {
+      auto ev = static_cast<start_kernel*>(cmd.get())->m_ec->m_event;
+      if (ev!=aborted)
+        (aborted=ev)->abort(-1,true/*fatal*/);
+    }
+  }
+}
+
+void
+execution_context::command_batch::
+flush()
+{
+  if (m_outer || m_cmds.empty())
+    return;
+
+  // Clear before scheduling, failed commands are not rescheduled
+  // by the destructor after an explicit flush throws
+  auto cmds = std::move(m_cmds);
+  m_cmds.clear();
+  xrt::scheduler::schedule_batch(cmds);
+}
+
 bool
 execution_context::
 write(const command_type& cmd)
@@ -290,13 +409,16 @@ write(const command_type& cmd)
       ostr << "0x" << std::uppercase << std::setfill('0') << std::setw(8) << std::hex << packet[i] << std::dec << "\n";
   }
 
-  xrt::scheduler::schedule(cmd);
+  if (auto batch = t_batch)
+    batch->m_cmds.push_back(cmd);
+  else
+    xrt::scheduler::schedule(cmd);
   return true;
 }
 
-void
+size_t
 execution_context::
-encode_compute_units(packet_type& packet)
+encode_compute_units(std::vector<word_type>& words)
 {
   // Encode CUs in a bitmask with bits in position according to the
   // CU physical address.   The CU address is at 4k boundaries starting
@@ -312,13 +434,8 @@ encode_compute_units(packet_type& packet)
   }
   assert(no_of_masks >= 1);
 
-  size_t offset = 1; // past header
-  for (size_t i=0; i<no_of_masks; ++i)
-    packet[offset++] = cu_bitmask[i];
-
-  // write extra cu mask count to header [11:10]
-  auto epacket = reinterpret_cast<ert_start_kernel_cmd*>(packet.data());
-  epacket->extra_cu_masks = no_of_masks-1;
+  words.assign(cu_bitmask,cu_bitmask+no_of_masks);
+  return no_of_masks;
 }
 
 const compute_unit*
@@ -351,46 +468,26 @@ update_work()
   m_done = true;
 }
 
-void
+execution_context::regmap_template_type
 execution_context::
-start()
+build_regmap_template()
 {
-  XOCL_DEBUGF("execution_context(%d) starting workgroup(%d,%d,%d)\n"
-              ,get_uid(),m_cu_group_id[0],m_cu_group_id[1],m_cu_group_id[2]);
-
-  // On first work load, transition event to CL_RUNNING
-  if ( (m_cu_group_id[0]==0) && (m_cu_group_id[1]==0) && (m_cu_group_id[2]==0))
-    m_event->set_status(CL_RUNNING);
-
-  auto xdevice = m_device->get_xrt_device();
-
-  // Construct command packet and send to hardware
-  auto cmd = conformance::on()
-    ? std::make_shared<start_kernel_conformance>(xdevice,this)
-    : std::make_shared<start_kernel>(xdevice,this);
-  ++m_active;
-  auto& packet = cmd->get_packet();
+  auto regmap = std::make_shared<kernel::regmap_template>();
+  regmap->dev = m_device;
+  regmap->cus = m_cus;
 
   // Encode CUs in cu bitmasks with bits in position according to the
-  // CUs that can be used
-  encode_compute_units(packet);
-
-  // Create the cu register map
-  auto offset = packet.size();  // start of regmap
-  auto& regmap = packet;
-
-  size3 num_workgroups {0,0,0};
-  for (auto d : {0,1,2}) {
-    if (m_lsize[d]) // actually always true
-      num_workgroups[d] = m_gsize[d]/m_lsize[d];
-  }
+  // CUs that can be used, the cu register map follows the masks
+  auto& words = regmap->words;
+  auto offset = encode_compute_units(words);
+  regmap->extra_cu_masks = offset-1;
 
   // Push kernel args
-  xocl::memory* printf_buffer = nullptr;
   for (auto& arg : m_kernel_args) {
     if (arg->is_printf()) {
-      printf_buffer = arg->get_memory_object();
-      assert(printf_buffer);
+      assert(arg->get_memory_object());
+      regmap->printf_buffer = true;
+      regmap->printf_buffer_addr = get_buffer_addr(arg.get(),m_device,regmap->buffers);
       continue;
     }
 
@@ -398,40 +495,98 @@ start()
     if (address_space == SPIR_ADDRSPACE_PRIVATE)
     {
       auto arginforange = arg->get_arginfo_range();
-      fill_regmap(regmap,offset,arg->get_value(),arg->get_size(),arginforange);
+      fill_regmap(words,offset,arg->get_value(),arg->get_size(),arginforange);
     } else if(address_space==SPIR_ADDRSPACE_PIPES) {
 	//do nothing
     } else if (address_space==SPIR_ADDRSPACE_GLOBAL
              || address_space==SPIR_ADDRSPACE_CONSTANT)
     {
       uint64_t physaddr = 0;
-      if (auto mem = arg->get_memory_object()) {
-        auto boh = xocl::xocl(mem)->get_buffer_object_or_error(m_device);
-        physaddr = xdevice->getDeviceAddr(boh);
-      }
-      else if (auto svm = arg->get_svm_object()) {
+      if (arg->get_memory_object())
+        physaddr = get_buffer_addr(arg.get(),m_device,regmap->buffers);
+      else if (auto svm = arg->get_svm_object())
         physaddr = reinterpret_cast<uint64_t>(svm);
-      }
       auto arginforange = arg->get_arginfo_range();
       assert(arginforange.size()==1);
-      fill_regmap(regmap,offset,&physaddr, arg->get_size(), arginforange);
+      fill_regmap(words,offset,&physaddr, arg->get_size(), arginforange);
     }
   }
 
   for (auto& arg : m_kernel->get_progvar_argument_range()) {
-    uint64_t physaddr = 0;
-    if (auto mem = arg->get_memory_object()) {
-      auto boh = xocl::xocl(mem)->get_buffer_object_or_error(m_device);
-      physaddr = xdevice->getDeviceAddr(boh);
-    }
+    uint64_t physaddr = get_buffer_addr(arg.get(),m_device,regmap->buffers);
     assert(arg->get_arginfo_range().size()==1);
-    fill_regmap(regmap,offset,&physaddr,arg->get_size(),arg->get_arginfo_range());
+    fill_regmap(words,offset,&physaddr,arg->get_size(),arg->get_arginfo_range());
+  }
+
+  // Locate runtime arg words, these are set when a workgroup is started
+  for (auto& arg : m_kernel->get_rtinfo_argument_range()) {
+    auto type = arg->get_rtinfo_type();
+    if (type==kernel::argument::rtinfo_type::none)
+      continue;
+    for (auto arginfo : arg->get_arginfo_range()) {
+      for (size_t wi=0, we=arginfo->size/sizeof(uint32_t); wi!=we; ++wi) {
+        size_t word = offset + (arginfo->offset + wi*sizeof(uint32_t)) / sizeof(uint32_t);
+        resize_regmap(words,word+1);
+        regmap->rtinfo.push_back({word,type,arginfo->hostoffset + wi*sizeof(uint32_t)});
+      }
+    }
+  }
+
+  if (!conformance::on())
+    m_kernel->set_regmap_template(regmap,m_arg_stamp);
+  return regmap;
+}
+
+void
+execution_context::
+start()
+{
+  XOCL_DEBUGF("execution_context(%d) starting workgroup(%d,%d,%d)\n"
+              ,get_uid(),m_cu_group_id[0],m_cu_group_id[1],m_cu_group_id[2]);
+
+  // On first work load, transition event to CL_RUNNING
+  if ( (m_cu_group_id[0]==0) && (m_cu_group_id[1]==0) && (m_cu_group_id[2]==0))
+    m_event->set_status(CL_RUNNING);
+
+  // Build the register map once, CUs change only in conformance mode
+  if (!m_regmap || m_regmap->cus!=m_cus)
+    m_regmap = build_regmap_template();
+
+  auto xdevice = m_device->get_xrt_device();
+
+  // Construct command packet and send to hardware
+  auto cmd = conformance::on()
+    ? std::make_shared<start_kernel_conformance>(xdevice,this)
+    : std::make_shared<start_kernel>(xdevice,this);
+  ++m_active;
+  auto& packet = cmd->get_packet();
+
+  // Copy CU masks and register map past header
+  auto& words = m_regmap->words;
+  auto data = packet.data();
+  std::copy(words.begin(),words.end(),data+1);
+  packet.resize(words.size()+1);
+
+  // write extra cu mask count to header [11:10]
+  auto epacket = reinterpret_cast<ert_start_kernel_cmd*>(data);
+  epacket->extra_cu_masks = m_regmap->extra_cu_masks;
+
+  if (m_regmap->rtinfo.empty()) {
+    // send command to mbs
+    write(cmd);
+    return;
   }
 
   // Set runtime arguments as required
+  size3 num_workgroups {0,0,0};
+  for (auto d : {0,1,2}) {
+    if (m_lsize[d]) // actually always true
+      num_workgroups[d] = m_gsize[d]/m_lsize[d];
+  }
+
   size3 local_id {0,0,0};
   uint64_t printf_buffer_addr = 0;
-  if ( printf_buffer ) {
+  if (m_regmap->printf_buffer) {
     // This computes the offset that gets added to a physical printf buffer
     // address for a given workgroup. Necessary so we have a different
     // segment to hold each workgroup in the overall buffer.
@@ -447,33 +602,48 @@ start()
                       group_x_size * m_cu_group_id[1] +
                       group_y_size * group_x_size * m_cu_group_id[2];
     auto printf_buffer_offset = group_id * local_buffer_size;
-    auto boh = printf_buffer->get_buffer_object_or_error(m_device);
-    auto printf_buffer_base_addr = static_cast<uint64_t>(xdevice->getDeviceAddr(boh));
-    printf_buffer_addr = printf_buffer_base_addr + printf_buffer_offset;
+    printf_buffer_addr = m_regmap->printf_buffer_addr + printf_buffer_offset;
   }
 
   // Push runtime args
-  for (auto& arg : m_kernel->get_rtinfo_argument_range()) {
-    auto nm = arg->get_name();
-    XOCL_DEBUGF("execution_context(%d) sets rtinfo(%s)\n",get_uid(),nm.c_str());
-    if (nm=="work_dim")
-      fill_regmap(regmap,offset,&m_dim,sizeof(cl_uint),arg->get_arginfo_range());
-    else if (nm=="global_offset")
-      fill_regmap(regmap,offset,m_goffset.data(),3*sizeof(size_t),arg->get_arginfo_range());
-    else if (nm=="global_size")
-      fill_regmap(regmap,offset,m_gsize.data(),3*sizeof(size_t),arg->get_arginfo_range());
-    else if (nm=="local_size")
-      fill_regmap(regmap,offset,m_lsize.data(),3*sizeof(size_t),arg->get_arginfo_range());
-    else if (nm=="num_groups")
-      fill_regmap(regmap,offset,num_workgroups.data(),3*sizeof(size_t),arg->get_arginfo_range());
-    else if (nm=="global_id")
-      fill_regmap(regmap,offset,m_cu_global_id.data(),3*sizeof(size_t),arg->get_arginfo_range());
-    else if (nm=="local_id")
-      fill_regmap(regmap,offset,local_id.data(),3*sizeof(size_t),arg->get_arginfo_range());
-    else if (nm=="group_id")
-      fill_regmap(regmap,offset,m_cu_group_id.data(),3*sizeof(size_t),arg->get_arginfo_range());
-    else if (nm=="printf_buffer")
-      fill_regmap(regmap,offset,&printf_buffer_addr,sizeof(printf_buffer_addr),arg->get_arginfo_range());
+  using rtinfo_type = kernel::argument::rtinfo_type;
+  for (auto& rtinfo : m_regmap->rtinfo) {
+    const void* value = nullptr;
+    size_t size = 3*sizeof(size_t);
+    switch (rtinfo.type) {
+    case rtinfo_type::work_dim:
+      value = &m_dim;
+      size = sizeof(cl_uint);
+      break;
+    case rtinfo_type::global_offset:
+      value = m_goffset.data();
+      break;
+    case rtinfo_type::global_size:
+      value = m_gsize.data();
+      break;
+    case rtinfo_type::local_size:
+      value = m_lsize.data();
+      break;
+    case rtinfo_type::num_groups:
+      value = num_workgroups.data();
+      break;
+    case rtinfo_type::global_id:
+      value = m_cu_global_id.data();
+      break;
+    case rtinfo_type::local_id:
+      value = local_id.data();
+      break;
+    case rtinfo_type::group_id:
+      value = m_cu_group_id.data();
+      break;
+    case rtinfo_type::printf_buffer:
+      value = &printf_buffer_addr;
+      size = sizeof(printf_buffer_addr);
+      break;
+    case rtinfo_type::none:
+      continue;
+    }
+    data[1+rtinfo.word] = host_word(value,size,rtinfo.hostoffset);
   }
 
   // send command to mbs
@@ -521,6 +691,9 @@ execute()
   if (m_done)
     return true;
 
+  // Commands of all workgroups started here are scheduled together
+  command_batch batch;
+
   // Schedule workgroups.  But don't blindly schedule all workgroups
   // because that would fill the command queue with commands that
   // compete for same CUs and block (CQ full) other kernel calls that
@@ -535,6 +708,7 @@ execute()
     update_work();
   }
 
+  batch.flush();
   return m_done;
 }
 
@@ -63,6 +63,30 @@ public:
   using size = std::size_t;
   using size3 = std::array<size,3>;
 
+  /**
+   * Batch of commands started by the calling thread
+   *
+   * While a command_batch is alive, commands of execution contexts
+   * executed by the calling thread are collected rather than
+   * scheduled one by one.  The collected commands are scheduled
+   * together on flush or when the batch is destroyed.  A nested
+   * batch adds to the outermost batch of the thread.  Errors from
+   * flush are thrown to the caller, errors when the batch is
+   * destroyed abort the events of the unscheduled commands.
+   */
+  class command_batch
+  {
+    friend class execution_context;
+    std::vector<command_type> m_cmds;
+    command_batch* m_outer;
+  public:
+    command_batch();
+    ~command_batch();
+
+    void
+    flush();
+  };
+
 private:
   unsigned int m_uid {0};
 
@@ -93,6 +117,13 @@ private:
   using argument_iterator_type = argument_vector_type::const_iterator;
   argument_vector_type m_kernel_args;
 
+  // Register map template used to start all workgroups.  Taken from
+  // the kernel if cached for current argument values, otherwise
+  // built from m_kernel_args when the first workgroup is started.
+  using regmap_template_type = std::shared_ptr<const kernel::regmap_template>;
+  regmap_template_type m_regmap;
+  unsigned int m_arg_stamp = 0;
+
   // The context maintains a list of kernel compute units represented
   // by xcl::cu.  These cus (their base addresses) are used in the command
   // that starts the mbs. 
@@ -116,8 +147,14 @@ private:
   bool
   write(const command_type& cmd);
 
-  void
-  encode_compute_units(packet_type& pkt);
+  size_t
+  encode_compute_units(std::vector<word_type>& words);
+
+  /**
+   * Build register map template from bound kernel arguments
+   */
+  regmap_template_type
+  build_regmap_template();
 
   /**
    * Update workgroup accounting.
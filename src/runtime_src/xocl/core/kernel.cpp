@@ -23,13 +23,50 @@
 #include <iostream>
 #include <memory>
 #include <algorithm>
+#include <map>
 
 
 namespace xocl {
 
+namespace {
+
+kernel::argument::rtinfo_type
+to_rtinfo_type(const xclbin::symbol::arg* arg)
+{
+  using rtinfo_type = kernel::argument::rtinfo_type;
+  using argtype = xclbin::symbol::arg::argtype;
+  static const std::map<std::string,rtinfo_type> rtinfo_names = {
+    { "work_dim",      rtinfo_type::work_dim },
+    { "global_offset", rtinfo_type::global_offset },
+    { "global_size",   rtinfo_type::global_size },
+    { "local_size",    rtinfo_type::local_size },
+    { "num_groups",    rtinfo_type::num_groups },
+    { "global_id",     rtinfo_type::global_id },
+    { "local_id",      rtinfo_type::local_id },
+    { "group_id",      rtinfo_type::group_id },
+    { "printf_buffer", rtinfo_type::printf_buffer }
+  };
+
+  if (arg->atype!=argtype::rtinfo && arg->atype!=argtype::printf)
+    return rtinfo_type::none;
+  auto itr = rtinfo_names.find(arg->name);
+  return itr==rtinfo_names.end() ? rtinfo_type::none : (*itr).second;
+}
+
+}
+
 std::unique_ptr<kernel::argument>
 kernel::argument::
 create(arginfo_type arg, kernel* kernel)
+{
+  auto argument = create_argument(arg,kernel);
+  argument->m_rtinfo = to_rtinfo_type(arg);
+  return argument;
+}
+
+std::unique_ptr<kernel::argument>
+kernel::argument::
+create_argument(arginfo_type arg, kernel* kernel)
 {
   switch (arg->address_qualifier) {
   case 0:
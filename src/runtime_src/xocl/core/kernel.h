@@ -23,7 +23,10 @@
 #include "xocl/xclbin/xclbin.h"
 
 #include "xrt/util/td.h"
+#include <atomic>
 #include <limits>
+#include <memory>
+#include <mutex>
 
 #include <iostream>
 
@@ -49,6 +52,15 @@ public:
     using arginfo_iterator_type = arginfo_vector_type::const_iterator;
     using arginfo_range_type = range<arginfo_iterator_type>;
 
+    /**
+     * Runtime argument set by the runtime when the kernel is started,
+     * resolved from the argument name when the argument is created
+     */
+    enum class rtinfo_type {
+      none, work_dim, global_offset, global_size, local_size,
+      num_groups, global_id, local_id, group_id, printf_buffer
+    };
+
   private:
     /**
      * Get the type of the argument
@@ -108,6 +120,15 @@ public:
     is_rtinfo() const
     { return get_argtype()==argtype::rtinfo; }
 
+    /**
+     * @return
+     *   The runtime argument kind of an rtinfo or printf argument,
+     *   rtinfo_type::none for other arguments
+     */
+    rtinfo_type
+    get_rtinfo_type() const
+    { return m_rtinfo; }
+
     virtual ~argument() {}
 
     /**
@@ -223,9 +244,14 @@ public:
     static std::unique_ptr<kernel::argument>
       create(arginfo_type arg,kernel* kernel);
 
+  private:
+    static std::unique_ptr<kernel::argument>
+      create_argument(arginfo_type arg,kernel* kernel);
+
   protected:
     kernel* m_kernel = nullptr;
     unsigned long m_argidx = std::numeric_limits<unsigned long>::max();
+    rtinfo_type m_rtinfo = rtinfo_type::none;
     bool m_set = false;
   };
 
@@ -365,6 +391,12 @@ private:
   using argument_filter_type = std::function<bool(const argument_value_type&)>;
 
 public:
+  /**
+   * Command register map for starting this kernel, built and used by
+   * execution_context.  The kernel only caches the most recent one.
+   */
+  struct regmap_template;
+
   // only program constructs kernels, but private doesn't work as long
   // xrt::make_unique is used
   friend class program; // only program constructs kernels
@@ -502,18 +534,56 @@ public:
   set_argument(unsigned long idx, size_t sz, const void* arg)
   {
     m_indexed_args.at(idx)->set(idx,sz,arg);
+    invalidate_regmap_template();
   }
 
   void
   set_svm_argument(unsigned long idx, size_t sz, const void* arg)
   {
     m_indexed_args.at(idx)->set_svm(sz,arg);
+    invalidate_regmap_template();
   }
 
   void
   set_printf_argument(size_t sz, const void* arg)
   {
     m_printf_args.at(0)->set(sz,arg);
+    invalidate_regmap_template();
+  }
+
+  /**
+   * Stamp of the current argument values
+   *
+   * The stamp changes whenever an argument is set, a register map
+   * template is valid for the argument stamp it was built with.
+   */
+  unsigned int
+  get_argument_stamp() const
+  {
+    return m_arg_stamp;
+  }
+
+  /**
+   * @return
+   *   Most recently cached register map template or nullptr
+   */
+  std::shared_ptr<const regmap_template>
+  get_regmap_template() const
+  {
+    std::lock_guard<std::mutex> lk(m_regmap_mutex);
+    return m_regmap_template;
+  }
+
+  /**
+   * Cache a register map template built for argument values with
+   * @stamp, ignored if an argument has been set since.
+   */
+  void
+  set_regmap_template(std::shared_ptr<const regmap_template> regmap, unsigned int stamp)
+  {
+    std::lock_guard<std::mutex> lk(m_regmap_mutex);
+    if (stamp==m_arg_stamp)
+      m_regmap_template = std::move(regmap);
   }
 
   /**
@@ -577,6 +647,15 @@ public:
     return m_symbol.hash;
   }
 
+private:
+  void
+  invalidate_regmap_template()
+  {
+    std::lock_guard<std::mutex> lk(m_regmap_mutex);
+    ++m_arg_stamp;
+    m_regmap_template = nullptr;
+  }
+
 private:
   unsigned int m_uid = 0;
   ptr<program> m_program;     // retain reference
@@ -586,6 +665,12 @@ private:
   argument_vector_type m_printf_args;
   argument_vector_type m_progvar_args;
   argument_vector_type m_rtinfo_args;
+
+  // Cached register map template, retains the memory objects it
+  // references so it is dropped as soon as an argument changes
+  mutable std::mutex m_regmap_mutex;
+  std::atomic<unsigned int> m_arg_stamp {0};
+  std::shared_ptr<const regmap_template> m_regmap_template;
 };
 
 } // xocl
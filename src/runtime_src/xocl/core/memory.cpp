@@ -81,6 +81,10 @@ memory::
   for (auto& cb: sg_destructor_callbacks)
     cb(this);
    //appdebug::remove_clmem(this);
+
+  // Maps are tracked per device that has a buffer object
+  for (auto& bo : m_bomap)
+    const_cast<device*>(bo.first)->unmap_all(this);
 }
 
 
@@ -211,6 +215,20 @@ try_get_buffer_object_or_error(const device* device) const
   return (*itr).second;
 }
 
+uint64_t
+memory::
+get_buffer_object_addr_or_error(const device* device) const
+{
+  std::lock_guard<std::mutex> lk(m_boh_mutex);
+  auto aitr = m_addrmap.find(device);
+  if (aitr!=m_addrmap.end())
+    return (*aitr).second;
+  auto itr = m_bomap.find(device);
+  if (itr==m_bomap.end())
+    throw std::runtime_error("Internal error. cl_mem doesn't map to buffer object");
+  return (m_addrmap[device] = device->get_boh_addr((*itr).second));
+}
+
 memory::memidx_bitmask_type
 memory::
 get_memidx(const device* dev) const
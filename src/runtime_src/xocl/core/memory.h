@@ -359,6 +359,22 @@ public:
   buffer_object_handle
   try_get_buffer_object_or_error(const device* device) const;
 
+  /**
+   * Get the device address of the buffer object on argument device
+   * or error out if none exists.
+   *
+   * The address of a buffer object does not change, it is looked
+   * up once per device and cached with this memory object.
+   *
+   * @param device
+   *   The device from which to get the buffer object address.
+   * @return
+   *   The device address of the buffer object associated with the
+   *   device, or std::runtime_error if no buffer object exists.
+   */
+  uint64_t
+  get_buffer_object_addr_or_error(const device* device) const;
+
   /**
    * Get buffer object or create with arguments.
    *
@@ -459,6 +475,7 @@ private:
 
   mutable std::mutex m_boh_mutex;
   bomap_type m_bomap;
+  mutable std::map<const device*,uint64_t> m_addrmap;
   std::vector<const device*> m_resident;
 };
 
@@ -24,7 +24,6 @@
 
 #include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
-#include <fstream>
 #include <iostream>
 #include <cassert>
 
@@ -62,22 +61,6 @@ is_emulation_mode()
   return emulation_mode;
 }
 
-static std::vector<char>
-read_file(const std::string& filename)
-{
-  std::ifstream istr(filename,std::ios::binary|std::ios::ate);
-  if (!istr)
-    throw xocl::error(CL_BUILD_PROGRAM_FAILURE,"Cannot not open '" + filename + "' for reading");
-
-  auto pos = istr.tellg();
-  istr.seekg(0,std::ios::beg);
-
-  std::vector<char> buffer(pos);
-  istr.read (&buffer[0],pos);
-
-  return buffer;
-}
-
 static void
 init_conformance()
 {
@@ -91,7 +74,7 @@ init_conformance()
     bfs::path file(itr->path());
 
     if (bfs::exists(file) && bfs::is_regular_file(file) && file.extension()==".xclbin") {
-      auto xclbin = xocl::xclbin(read_file(file.string()));
+      auto xclbin = xocl::xclbin(file.string());
       for (auto hash : xclbin.conformance_kernel_hashes())  {
         XOCL_DEBUG(std::cout,"(hash,file)=(",hash,",",file.string(),")\n");
         global_conformance_xclbin_map.emplace(hash,file.string());
@@ -25,6 +25,7 @@
 #include "xrt/util/memory.h"
 
 #include <boost/filesystem/operations.hpp>
+#include <algorithm>
 #include <vector>
 #include <iostream>
 #include <fstream>
@@ -32,20 +33,16 @@
 
 namespace {
 
-static std::vector<char>
+// Map xclbin file read-only into memory
+static xocl::xclbin::binary_type
 read_file(const std::string& filename)
 {
-  std::ifstream istr(filename,std::ios::binary|std::ios::ate);
-  if (!istr)
-    throw xocl::error(CL_BUILD_PROGRAM_FAILURE,"Cannot not open '" + filename + "' for reading");
-
-  auto pos = istr.tellg();
-  istr.seekg(0,std::ios::beg);
-
-  std::vector<char> buffer(pos);
-  istr.read (&buffer[0],pos);
-
-  return buffer;
+  try {
+    return xocl::xclbin::binary_type(filename);
+  }
+  catch (const std::exception& ex) {
+    throw xocl::error(CL_BUILD_PROGRAM_FAILURE,"Cannot not read '" + filename + "': " + ex.what());
+  }
 }
 
 // Current list of live program objects.
@@ -102,8 +99,17 @@ program(context* ctx,cl_uint num_devices, const cl_device_id* devices,
   : program(ctx,"")
 {
   for (cl_uint i=0; i<num_devices; ++i) {
-    m_devices.push_back(xocl::xocl(devices[i]));
-    m_binaries.emplace(xocl::xocl(devices[i]),std::vector<char>(binaries[i],binaries[i]+lengths[i]));
+    auto device = xocl::xocl(devices[i]);
+    m_devices.push_back(device);
+
+    // Devices given the same binary share one copy of it
+    auto j = std::find(binaries,binaries+i,binaries[i]) - binaries;
+    if (j<i && lengths[j]==lengths[i]) {
+      m_binaries.emplace(device,m_binaries.at(xocl::xocl(devices[j])));
+      continue;
+    }
+
+    m_binaries.emplace(device,std::vector<char>(binaries[i],binaries[i]+lengths[i]));
   }
 
   // Verify that each binary contains the same kernels
@@ -275,7 +281,7 @@ build(const std::vector<device*>& devices,const std::string& options)
     throw xocl::error(CL_BUILD_PROGRAM_FAILURE,"could not delete temporary file");
 
   auto xclbin = read_file("xcl_verif.xclbin");
-  auto data = &xclbin[0]; // char*
+  auto data = xclbin.binary_data().first; // const char*
   auto size = xclbin.size();
 
   for (auto device : devices) {
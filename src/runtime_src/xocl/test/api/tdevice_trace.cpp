@@ -0,0 +1,132 @@
+/**
+ * Copyright (C) 2016-2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Decoded device trace events written by DeviceTraceFileSink are
+// read back unchanged, one block per write.
+
+#include <boost/test/unit_test.hpp>
+
+#include "xdp/profile/rt_device_trace.h"
+
+#include <boost/filesystem/operations.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using XCL::DeviceTraceEvent;
+
+namespace {
+
+static std::vector<DeviceTraceEvent>
+make_events(size_t count, uint8_t type)
+{
+  std::vector<DeviceTraceEvent> events(count);
+  for (size_t i=0; i<count; ++i) {
+    auto& event = events[i];
+    std::memset(&event,0,sizeof(event));
+    event.Start = i * 1.5;
+    event.End = event.Start + 0.5;
+    event.StartTime = i * 100;
+    event.EndTime = event.StartTime + 10;
+    event.SlotNum = i % 8;
+    event.BurstLength = 16;
+    event.NumBytes = 64;
+    event.Type = type;
+  }
+  return events;
+}
+
+template <typename T>
+static T
+read_value(std::istream& istr)
+{
+  T value = 0;
+  istr.read(reinterpret_cast<char*>(&value),sizeof(value));
+  return value;
+}
+
+static void
+check_block(std::istream& istr, const std::string& deviceName,
+            const std::vector<DeviceTraceEvent>& events)
+{
+  auto nameLength = read_value<uint32_t>(istr);
+  std::string name(nameLength,'\0');
+  istr.read(&name[0],nameLength);
+  BOOST_CHECK_EQUAL(name,deviceName);
+
+  auto count = read_value<uint32_t>(istr);
+  BOOST_REQUIRE_EQUAL(count,events.size());
+  std::vector<DeviceTraceEvent> read(count);
+  istr.read(reinterpret_cast<char*>(read.data()),count*sizeof(DeviceTraceEvent));
+  BOOST_REQUIRE(istr);
+  for (size_t i=0; i<count; ++i) {
+    BOOST_CHECK_EQUAL(read[i].Start,events[i].Start);
+    BOOST_CHECK_EQUAL(read[i].EndTime,events[i].EndTime);
+    BOOST_CHECK_EQUAL(read[i].SlotNum,events[i].SlotNum);
+    BOOST_CHECK_EQUAL(read[i].Type,events[i].Type);
+    BOOST_CHECK_EQUAL(read[i].isKernel(),events[i].isKernel());
+  }
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_device_trace )
+
+BOOST_AUTO_TEST_CASE( test_device_trace1 )
+{
+  auto fnm = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+  auto reads = make_events(100,DeviceTraceEvent::READ);
+  auto kernels = make_events(10,DeviceTraceEvent::KERNEL);
+
+  {
+    XCL::DeviceTraceFileSink sink(fnm);
+    BOOST_REQUIRE(sink.isOpen());
+    XCL::DeviceTraceSink* base = &sink;
+    base->write("device0",reads.data(),reads.size());
+    base->write("device0",nullptr,0);  // empty batch is not written
+    base->write("device1",kernels.data(),kernels.size());
+    base->flush();
+  }
+
+  std::ifstream istr(fnm,std::ios::binary);
+  char magic[8];
+  istr.read(magic,sizeof(magic));
+  BOOST_CHECK(std::memcmp(magic,"XDPTRACE",8)==0);
+  BOOST_CHECK_EQUAL(read_value<uint32_t>(istr),1);
+  BOOST_CHECK_EQUAL(read_value<uint32_t>(istr),sizeof(DeviceTraceEvent));
+
+  check_block(istr,"device0",reads);
+  check_block(istr,"device1",kernels);
+  istr.peek();
+  BOOST_CHECK(istr.eof());
+
+  std::remove(fnm.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( test_device_trace2 )
+{
+  // unwritable file leaves sink closed and writes are dropped
+  XCL::DeviceTraceFileSink sink("/nonexistent/dir/trace.bin");
+  BOOST_CHECK(!sink.isOpen());
+  auto events = make_events(1,DeviceTraceEvent::WRITE);
+  sink.write("device0",events.data(),events.size());
+  sink.flush();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
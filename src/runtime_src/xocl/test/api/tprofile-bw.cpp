@@ -0,0 +1,173 @@
+/**
+ * Copyright (C) 2016-2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Per call overhead of API function call logging with profiling off,
+// with the legacy logging path, and with the API trace buffer.
+
+#include <boost/test/unit_test.hpp>
+
+#include "xocl/api/plugin/xdp/profile.h"
+#include "xocl/core/time.h"
+#include "xdp/profile/rt_profile.h"
+
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const size_t calls = 1000000;
+
+static void
+api_call()
+{
+  PROFILE_LOG_FUNCTION_CALL;
+}
+
+static void
+api_call_with_queue(long long queue)
+{
+  PROFILE_LOG_FUNCTION_CALL_WITH_QUEUE(queue);
+}
+
+static void
+register_profile(XCL::RTProfile* profile)
+{
+  if (!profile) {
+    xocl::profile::register_cb_log_function_start(nullptr);
+    xocl::profile::register_cb_log_function_end(nullptr);
+    return;
+  }
+
+  xocl::profile::register_cb_log_function_start
+    ([profile](const char* name, long long queue, unsigned int id)
+     { profile->logFunctionCallStart(name,queue,id); });
+  xocl::profile::register_cb_log_function_end
+    ([profile](const char* name, long long queue, unsigned int id)
+     { profile->logFunctionCallEnd(name,queue,id); });
+}
+
+// Return nsec per call with @threads threads each making @calls calls
+static double
+run(unsigned int threads)
+{
+  unsigned long ns = 0;
+  {
+    xocl::time_guard tg(ns);
+    std::vector<std::thread> workers;
+    for (unsigned int t=0; t<threads; ++t)
+      workers.emplace_back([t] {
+          for (size_t i=0; i<calls; ++i) {
+            if (i%2)
+              api_call();
+            else
+              api_call_with_queue(t+1);
+          }
+        });
+    for (auto& w : workers)
+      w.join();
+  }
+  return static_cast<double>(ns)/(calls*threads);
+}
+
+static void
+bench(const char* mode, XCL::RTProfile* profile)
+{
+  register_profile(profile);
+  for (auto threads : {1,4}) {
+    auto ns = run(threads);
+    std::cout << mode << " threads=" << threads << " " << ns << " ns/call\n";
+  }
+  register_profile(nullptr);
+
+  // Logged functions are not in the reported list
+  if (profile) {
+    auto id = xocl::profile::get_function_call_id("api_call");
+    BOOST_CHECK_EQUAL(profile->getFunctionEventID("api_call",id),XCL_PERF_MON_IGNORE_EVENT);
+  }
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_profile_bw )
+
+BOOST_AUTO_TEST_CASE( test_profile_bw1 )
+{
+  bench("off",nullptr);
+
+  int flags = XCL::RTProfile::PROFILE_APPLICATION;
+  {
+    XCL::RTProfile profile(flags);
+    profile.setApiTraceBuffer(false);
+    bench("legacy",&profile);
+  }
+  {
+    XCL::RTProfile profile(flags);
+    profile.setApiTraceBuffer(true);
+    bench("trace buffer",&profile);
+    profile.flushApiTrace();
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_profile_bw2 )
+{
+  int flags = XCL::RTProfile::PROFILE_APPLICATION;
+  XCL::RTProfile profile(flags);
+
+  auto read = xocl::profile::get_function_call_id("clEnqueueReadBuffer");
+  auto migrate = xocl::profile::get_function_call_id("clEnqueueMigrateMemObjects");
+  auto release = xocl::profile::get_function_call_id("clReleaseKernel");
+  auto info = xocl::profile::get_function_call_id("clGetKernelInfo");
+
+  // Second round is answered from the per function call id cache
+  for (int i=0; i<2; ++i) {
+    BOOST_CHECK_EQUAL(profile.getFunctionEventID("clEnqueueReadBuffer",read),XCL_PERF_MON_API_READ_BUFFER_ID);
+    BOOST_CHECK_EQUAL(profile.getFunctionEventID("clEnqueueMigrateMemObjects",migrate),XCL_PERF_MON_API_MIGRATE_MEM_OBJECTS_ID);
+    BOOST_CHECK_EQUAL(profile.getFunctionEventID("clReleaseKernel",release),XCL_PERF_MON_IGNORE_EVENT);
+    BOOST_CHECK_EQUAL(profile.getFunctionEventID("clGetKernelInfo",info),XCL_PERF_MON_IGNORE_EVENT);
+  }
+
+  // Function call id beyond the cache
+  BOOST_CHECK_EQUAL(profile.getFunctionEventID("clEnqueueTask",100000u),XCL_PERF_MON_API_TASK_ID);
+}
+
+BOOST_AUTO_TEST_CASE( test_profile_bw3 )
+{
+  int flags = XCL::RTProfile::PROFILE_APPLICATION;
+  XCL::RTProfile profile(flags);
+
+  auto migrate = xocl::profile::get_function_call_id("clEnqueueMigrateMemObjects");
+  auto read = xocl::profile::get_function_call_id("clEnqueueReadBuffer");
+
+  // Classification is cached per function call id, repeat calls agree
+  for (int i=0; i<2; ++i) {
+    BOOST_CHECK(profile.isMigrateMemFunction("clEnqueueMigrateMemObjects",migrate));
+    BOOST_CHECK(!profile.isMigrateMemFunction("clEnqueueReadBuffer",read));
+  }
+  BOOST_CHECK(profile.isMigrateMemFunction("clEnqueueSVMMigrateMem",100000u));
+
+  // Only starts of migration calls are counted
+  profile.setApiTraceBuffer(false);
+  for (int i=0; i<3; ++i) {
+    profile.logFunctionCallStart("clEnqueueMigrateMemObjects",0,migrate);
+    profile.logFunctionCallEnd("clEnqueueMigrateMemObjects",0,migrate);
+    profile.logFunctionCallStart("clEnqueueReadBuffer",0,read);
+    profile.logFunctionCallEnd("clEnqueueReadBuffer",0,read);
+  }
+  BOOST_CHECK_EQUAL(profile.getMigrateMemCalls(),3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
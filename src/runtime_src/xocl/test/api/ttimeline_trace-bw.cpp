@@ -0,0 +1,157 @@
+/**
+ * Copyright (C) 2016-2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Timeline trace write throughput in events/sec, csv text rows
+// versus the binary timeline trace with and without compression.
+
+#include <boost/test/unit_test.hpp>
+
+#include "xocl/core/time.h"
+#include "xdp/profile/rt_profile_writers.h"
+#include "xdp/profile/rt_timeline_trace_file.h"
+
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+const size_t events = 2000000;
+
+const std::string functions[] = {
+  "clEnqueueWriteBuffer", "clEnqueueNDRangeKernel", "clEnqueueReadBuffer", "clFinish"
+};
+const std::string start = "START";
+const std::string end = "END";
+const std::string bank = "0";
+
+// Timeline rows formatted as by CSVWriter, without document header
+// and footer which need a platform
+class text_writer : public XCL::WriterI
+{
+public:
+  explicit text_writer(const std::string& fileName)
+  {
+    openStream(Timeline_ofs,fileName);
+  }
+
+protected:
+  void writeTableHeader(std::ofstream&, const std::string&, const std::vector<std::string>&) override {}
+  void writeTableRowStart(std::ofstream& ofs) override {}
+  void writeTableRowEnd(std::ofstream& ofs) override { ofs << "\n"; }
+  const char* cellEnd() override { return ","; }
+};
+
+// Mix of API calls and buffer transfers as logged by RTProfile
+static double
+run_text(const std::string& fileName)
+{
+  unsigned long ns = 0;
+  {
+    xocl::time_guard tg(ns);
+    text_writer writer(fileName);
+    auto tid = std::this_thread::get_id();
+    for (size_t i=0; i<events; ++i) {
+      double time = 0.001 * i;
+      auto& fn = functions[i % 4];
+      if (i % 4 == 0) {
+        auto event = std::to_string(i);
+        writer.writeTimeline(time,fn,start,event,"",4096,0x1000*i,bank,tid);
+        continue;
+      }
+      writer.writeTimeline(time,fn,(i % 2) ? start : end);
+    }
+  }
+  return events * 1e9 / ns;
+}
+
+static double
+run_binary(const std::string& fileName, bool compress, uint64_t& stored)
+{
+  unsigned long ns = 0;
+  {
+    xocl::time_guard tg(ns);
+    XCL::TimelineTraceFile file(fileName,"",compress);
+    std::stringstream tidStr;
+    tidStr << std::showbase << std::hex << std::uppercase << std::this_thread::get_id();
+    auto tid = tidStr.str();
+    for (size_t i=0; i<events; ++i) {
+      double time = 0.001 * i;
+      auto& fn = functions[i % 4];
+      if (i % 4 == 0) {
+        auto event = std::to_string(i);
+        XCL::TimelineTraceFile::entry e = {XCL::timeline::TRANSFER, time, 0.0, 0.0, 0x1000*i, 4096};
+        e.S[0] = &fn;
+        e.S[1] = &start;
+        e.S[2] = &event;
+        e.S[4] = &bank;
+        e.S[5] = &tid;
+        file.log(e);
+        continue;
+      }
+      XCL::TimelineTraceFile::entry e = {XCL::timeline::API, time};
+      e.S[0] = &fn;
+      e.S[1] = (i % 2) ? &start : &end;
+      file.log(e);
+    }
+    file.close("");
+    stored = file.getStoredBytes();
+  }
+  return events * 1e9 / ns;
+}
+
+static size_t
+file_size(const std::string& fileName)
+{
+  std::ifstream ifs(fileName, std::ios::binary | std::ios::ate);
+  return ifs.tellg();
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_timeline_trace_bw )
+
+BOOST_AUTO_TEST_CASE( test_timeline_trace_bw1 )
+{
+  const std::string csv = "ttimeline_trace-bw.csv";
+  const std::string raw = "ttimeline_trace-bw-raw.xtrace";
+  const std::string lz = "ttimeline_trace-bw-lz.xtrace";
+
+  auto text_rate = run_text(csv);
+  std::cout << "csv           " << text_rate << " events/sec " << file_size(csv) << " bytes\n";
+
+  uint64_t stored = 0;
+  auto raw_rate = run_binary(raw,false,stored);
+  std::cout << "binary        " << raw_rate << " events/sec " << file_size(raw) << " bytes\n";
+
+  auto lz_rate = run_binary(lz,true,stored);
+  std::cout << "binary+lz     " << lz_rate << " events/sec " << file_size(lz) << " bytes\n";
+
+  // Binary trace expands to the same rows as the csv writer
+  std::stringstream expanded;
+  BOOST_CHECK_EQUAL(XCL::timeline::convertToCSV(lz,expanded),events);
+  std::ifstream ifs(csv);
+  std::stringstream text;
+  text << ifs.rdbuf();
+  BOOST_CHECK(expanded.str() == text.str());
+
+  std::remove(csv.c_str());
+  std::remove(raw.c_str());
+  std::remove(lz.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
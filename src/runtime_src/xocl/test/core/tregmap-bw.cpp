@@ -0,0 +1,269 @@
+/**
+ * Copyright (C) 2016-2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Register map cached with a kernel versus register map rebuilt from
+// the kernel arguments.  Kernels are executed on a mock device, the
+// command packets are captured with MBS_PRINT_REGMAP and must be the
+// same whether the register map was cached or rebuilt after setting
+// the kernel arguments.  Also times start of kernels with cached and
+// with rebuilt register map.
+
+#include <boost/test/unit_test.hpp>
+#include "xrt/test/mock_device.h"
+
+#include "xocl/core/device.h"
+#include "xocl/core/context.h"
+#include "xocl/core/program.h"
+#include "xocl/core/kernel.h"
+#include "xocl/core/command_queue.h"
+#include "xocl/core/event.h"
+#include "xocl/core/execution_context.h"
+#include "xocl/core/time.h"
+#include "xrt/device/device.h"
+#include "xrt/scheduler/scheduler.h"
+#include "xrt/util/memory.h"
+
+#include <boost/filesystem/operations.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const size_t num_args = 32;
+const size_t launches = 1000;
+
+// Kernel krnl with num_args scalar arguments a0..aN at 0x10 and up
+static std::string
+make_xml()
+{
+  std::ostringstream xml;
+  xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      << "<project name=\"bench\">\n"
+      << " <platform vendor=\"xilinx\" boardid=\"vcu1525\" name=\"dynamic\">\n"
+      << "  <device name=\"fpga0\">\n"
+      << "   <core name=\"OCL_REGION_0\" target=\"bitstream\" type=\"clc_region\" clockFreq=\"300MHz\">\n"
+      << "    <kernel name=\"krnl\" language=\"c\" vlnv=\"xilinx.com:hls:krnl:1.0\" attributes=\"\" hash=\"0\"\n"
+      << "     preferredWorkGroupSizeMultiple=\"1\" workGroupSize=\"1\" interrupt=\"true\">\n"
+      << "     <port name=\"S_AXI_CONTROL\" mode=\"slave\" range=\"0x1000\" dataWidth=\"32\" portType=\"addressable\" base=\"0x0\"/>\n";
+  for (size_t i=0; i<num_args; ++i)
+    xml << "     <arg name=\"a" << i << "\" addressQualifier=\"0\" id=\"" << i << "\" port=\"S_AXI_CONTROL\" size=\"0x4\""
+        << " offset=\"0x" << std::hex << 0x10 + i*8 << std::dec << "\" hostOffset=\"0x0\" hostSize=\"0x4\" type=\"int\"/>\n";
+  xml << "     <instance name=\"krnl_1\"><addrRemap base=\"0x0\" port=\"S_AXI_CONTROL\"/></instance>\n"
+      << "     <compileWorkGroupSize x=\"1\" y=\"1\" z=\"1\"/>\n"
+      << "    </kernel>\n"
+      << "   </core>\n"
+      << "  </device>\n"
+      << " </platform>\n"
+      << "</project>\n";
+  return xml.str();
+}
+
+// xclbin2 with meta data and a small bitstream section
+static std::vector<char>
+make_xclbin()
+{
+  auto xml = make_xml();
+  const size_t bitstream_size = 4096;
+  auto header_size = sizeof(axlf) + sizeof(axlf_section_header);
+  std::vector<char> xclbin(header_size+xml.size()+bitstream_size,0x5a);
+  std::fill(xclbin.begin(),xclbin.begin()+header_size,0);
+  auto top = reinterpret_cast<axlf*>(xclbin.data());
+  std::memcpy(top->m_magic,"xclbin2",8);
+  top->m_header.m_length = xclbin.size();
+  top->m_header.m_numSections = 2;
+  top->m_sections[0].m_sectionKind = EMBEDDED_METADATA;
+  top->m_sections[0].m_sectionOffset = header_size;
+  top->m_sections[0].m_sectionSize = xml.size();
+  top->m_sections[1].m_sectionKind = BITSTREAM;
+  top->m_sections[1].m_sectionOffset = header_size + xml.size();
+  top->m_sections[1].m_sectionSize = bitstream_size;
+  std::copy(xml.begin(),xml.end(),xclbin.begin()+header_size);
+  return xclbin;
+}
+
+// Packets written to the MBS_PRINT_REGMAP file, the file is read
+// once by execution_context so it must be set before first launch.
+static std::string
+regmap_file()
+{
+  static std::string fnm = [] {
+    auto fnm = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    setenv("MBS_PRINT_REGMAP",fnm.c_str(),1);
+    return fnm;
+  }();
+  return fnm;
+}
+
+using packet = std::vector<std::string>;
+
+// Packets from the regmap file, each packet is the list of words
+// following the header line written by execution_context
+static std::vector<packet>
+read_packets()
+{
+  std::vector<packet> packets;
+  std::ifstream istr(regmap_file());
+  std::string line;
+  while (std::getline(istr,line)) {
+    if (line[0]=='#')
+      packets.emplace_back();
+    else if (!packets.empty())
+      packets.back().push_back(line);
+  }
+  std::remove(regmap_file().c_str());
+  return packets;
+}
+
+// Device with program loaded and scheduler running.  The scheduler
+// can be started only once per process, so there is one test case.
+struct setup
+{
+  xrt::test::mock_device* hal = new xrt::test::mock_device;
+  xrt::device xdevice {std::unique_ptr<xrt::hal::device>(hal)};
+  xocl::device device {nullptr,&xdevice,nullptr,nullptr};
+  cl_device_id did = &device;
+  xocl::context context {nullptr,1,&did};
+  std::vector<char> xclbin = make_xclbin();
+  xocl::program* program = nullptr;
+  xocl::kernel* kernel = nullptr;
+  xocl::command_queue* queue = nullptr;
+
+  setup()
+  {
+    regmap_file();
+    xrt::scheduler::start();
+    auto binary = reinterpret_cast<const unsigned char*>(xclbin.data());
+    auto size = xclbin.size();
+    program = new xocl::program(&context,1,&did,&binary,&size);
+    device.load_program(program);
+    kernel = program->create_kernel("krnl").release();
+    queue = new xocl::command_queue(&context,&device,0);
+  }
+
+  ~setup()
+  {
+    delete queue;
+    if (kernel->release())
+      delete kernel;
+    device.unload_program(program);
+    delete program;
+    xrt::scheduler::stop();
+  }
+
+  // Launch kernel as done by clEnqueueNDRangeKernel and wait
+  void
+  launch()
+  {
+    size_t goffset[1] = {0};
+    size_t gsize[1] = {1};
+    size_t lsize[1] = {1};
+    auto ev = xocl::create_hard_event(queue,CL_COMMAND_NDRANGE_KERNEL);
+    ev->set_execution_context
+      (xrt::make_unique<xocl::execution_context>(&device,kernel,ev.get(),1,goffset,gsize,lsize));
+    ev->set_enqueue_action([](xocl::event* ev) { ev->get_execution_context()->execute(); });
+    ev->queue();
+    ev->wait();
+  }
+
+  void
+  set_args(int base)
+  {
+    for (size_t i=0; i<num_args; ++i) {
+      int value = base + i;
+      kernel->set_argument(i,sizeof(value),&value);
+    }
+  }
+};
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_regmap_bw )
+
+BOOST_AUTO_TEST_CASE( test_regmap_bw1 )
+{
+  setup s;
+
+  s.set_args(0x100);
+  s.launch();         // builds and caches regmap
+  s.launch();         // cached regmap
+  s.set_args(0x100);  // same values, regmap is rebuilt
+  s.launch();
+  s.launch();         // cached again
+  s.set_args(0x200);  // new values, regmap is rebuilt
+  s.launch();
+
+  auto packets = read_packets();
+  BOOST_REQUIRE_EQUAL(packets.size(),5);
+
+  // header, cu mask, then registers with args at 0x10 + 8*i
+  auto& built = packets[0];
+  BOOST_REQUIRE_EQUAL(built.size(),2 + (0x10 + 8*(num_args-1))/4 + 1);
+  for (size_t i=0; i<num_args; ++i) {
+    char word[16];
+    std::sprintf(word,"0x%08X",static_cast<unsigned int>(0x100+i));
+    BOOST_CHECK_EQUAL(built[2 + (0x10 + 8*i)/4],word);
+  }
+
+  BOOST_CHECK(packets[1]==built);
+  BOOST_CHECK(packets[2]==built);
+  BOOST_CHECK(packets[3]==built);
+
+  auto& changed = packets[4];
+  BOOST_REQUIRE_EQUAL(changed.size(),built.size());
+  for (size_t w=0; w<built.size(); ++w) {
+    if (w<2 || (w-2)<4 || (w-2-4)%2)
+      BOOST_CHECK_EQUAL(changed[w],built[w]);
+    else
+      BOOST_CHECK(changed[w]!=built[w]);
+  }
+
+  // Time launches with cached and with rebuilt register map
+  s.set_args(0x100);
+
+  unsigned long cached = 0;
+  {
+    xocl::time_guard tg(cached);
+    for (size_t i=0; i<launches; ++i)
+      s.launch();
+  }
+
+  unsigned long rebuilt = 0;
+  {
+    xocl::time_guard tg(rebuilt);
+    for (size_t i=0; i<launches; ++i) {
+      s.set_args(0x100);
+      s.launch();
+    }
+  }
+
+  // All packets are the same whether regmap was cached or rebuilt
+  packets = read_packets();
+  BOOST_REQUIRE_EQUAL(packets.size(),2*launches);
+  for (auto& p : packets)
+    BOOST_CHECK(p==packets[0]);
+
+  std::cout << "cached:  " << cached / 1e3 / launches << " us per launch\n";
+  std::cout << "rebuilt: " << rebuilt / 1e3 / launches << " us per launch\n";
+}
+
+BOOST_AUTO_TEST_SUITE_END()
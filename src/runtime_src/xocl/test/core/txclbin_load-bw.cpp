@@ -0,0 +1,145 @@
+/**
+ * Copyright (C) 2016-2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Time and private memory to load a large xclbin file, reading the
+// file into a std::vector versus mapping the file.
+
+#include <boost/test/unit_test.hpp>
+
+#include "xocl/xclbin/xclbin.h"
+#include "xocl/core/time.h"
+
+#include <boost/filesystem/operations.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+
+const size_t bitstream_size = 256 << 20;
+const size_t loads = 10;
+
+const char* xml =
+  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+  "<project name=\"bench\">\n"
+  " <platform vendor=\"xilinx\" boardid=\"vcu1525\" name=\"dynamic\">\n"
+  "  <device name=\"fpga0\">\n"
+  "   <core name=\"OCL_REGION_0\" target=\"bitstream\" type=\"clc_region\">\n"
+  "    <kernel name=\"krnl\" language=\"c\" vlnv=\"xilinx.com:hls:krnl:1.0\" attributes=\"\" hash=\"0\"\n"
+  "     preferredWorkGroupSizeMultiple=\"1\" workGroupSize=\"1\" interrupt=\"true\">\n"
+  "     <port name=\"S_AXI_CONTROL\" mode=\"slave\" range=\"0x1000\" dataWidth=\"32\" portType=\"addressable\" base=\"0x0\"/>\n"
+  "     <arg name=\"a\" addressQualifier=\"0\" id=\"0\" port=\"S_AXI_CONTROL\" size=\"0x4\" offset=\"0x10\" hostOffset=\"0x0\" hostSize=\"0x4\" type=\"int\"/>\n"
+  "     <instance name=\"krnl_1\"><addrRemap base=\"0x0\" port=\"S_AXI_CONTROL\"/></instance>\n"
+  "     <compileWorkGroupSize x=\"1\" y=\"1\" z=\"1\"/>\n"
+  "    </kernel>\n"
+  "   </core>\n"
+  "  </device>\n"
+  " </platform>\n"
+  "</project>\n";
+
+// xclbin2 with meta data and bitstream sections
+static void
+write_xclbin(const std::string& fnm)
+{
+  auto xml_size = std::strlen(xml);
+  auto header_size = sizeof(axlf) + sizeof(axlf_section_header);
+  std::vector<char> header(header_size,0);
+  auto top = reinterpret_cast<axlf*>(header.data());
+  std::memcpy(top->m_magic,"xclbin2",8);
+  top->m_header.m_length = header_size + xml_size + bitstream_size;
+  top->m_header.m_numSections = 2;
+  top->m_sections[0].m_sectionKind = EMBEDDED_METADATA;
+  top->m_sections[0].m_sectionOffset = header_size;
+  top->m_sections[0].m_sectionSize = xml_size;
+  top->m_sections[1].m_sectionKind = BITSTREAM;
+  top->m_sections[1].m_sectionOffset = header_size + xml_size;
+  top->m_sections[1].m_sectionSize = bitstream_size;
+
+  std::ofstream ostr(fnm,std::ios::binary);
+  ostr.write(header.data(),header.size());
+  ostr.write(xml,xml_size);
+  std::vector<char> bitstream(1<<20,0x5a);
+  for (size_t sz=0; sz<bitstream_size; sz+=bitstream.size())
+    ostr.write(bitstream.data(),bitstream.size());
+}
+
+// As formerly done by xocl::program and xocl::platform
+static std::vector<char>
+read_file(const std::string& filename)
+{
+  std::ifstream istr(filename,std::ios::binary|std::ios::ate);
+  auto pos = istr.tellg();
+  istr.seekg(0,std::ios::beg);
+  std::vector<char> buffer(pos);
+  istr.read (&buffer[0],pos);
+  return buffer;
+}
+
+// Anonymous (private) resident memory in KB
+static size_t
+rss_anon()
+{
+  std::ifstream istr("/proc/self/status");
+  std::string line;
+  while (std::getline(istr,line))
+    if (line.compare(0,8,"RssAnon:")==0)
+      return std::stoul(line.substr(8));
+  return 0;
+}
+
+template <typename Load>
+static void
+run(const char* name, Load load)
+{
+  unsigned long ns = 0;
+  size_t kb = 0;
+  for (size_t i=0; i<loads; ++i) {
+    auto before = rss_anon();
+    xocl::xclbin xclbin;
+    {
+      xocl::time_guard tg(ns);
+      xclbin = load();
+    }
+    kb = std::max(kb,rss_anon()-before);
+    auto binary = xclbin.binary().binary_data();
+    BOOST_CHECK_EQUAL(binary.second[-1],0x5a);
+    BOOST_CHECK_EQUAL(xclbin.num_kernels(),1);
+  }
+  std::cout << name << ns / 1e6 / loads << " ms, " << kb / 1024 << " MB private\n";
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_xclbin_load_bw )
+
+BOOST_AUTO_TEST_CASE( test_xclbin_load_bw1 )
+{
+  auto fnm = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+  write_xclbin(fnm);
+
+  // warm page cache
+  read_file(fnm);
+
+  run("vector: ",[&fnm]() { return xocl::xclbin(read_file(fnm)); });
+  run("mmap:   ",[&fnm]() { return xocl::xclbin(fnm); });
+
+  std::remove(fnm.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
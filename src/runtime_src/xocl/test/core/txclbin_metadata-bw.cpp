@@ -0,0 +1,270 @@
+/**
+ * Copyright (C) 2016-2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Time to construct xocl::xclbin for a large multi-kernel xclbin,
+// parsing the xml versus loading the cached meta data image.  A
+// corrupt, truncated, or stale image is rejected and the xml parsed.
+//
+// The cache directory is configured through a generated sdaccel.ini,
+// run this test by itself so no other test reads the cache directory
+// from the configuration first.
+
+#include <boost/test/unit_test.hpp>
+
+#include "xocl/xclbin/xclbin.h"
+#include "xocl/xclbin/metadata_cache.h"
+#include "xocl/core/time.h"
+#include "xrt/config.h"
+
+#include <boost/filesystem/operations.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const size_t kernels = 64;
+const size_t args = 32;
+const size_t instances = 4;
+const size_t loads = 20;
+
+static std::string
+make_xml()
+{
+  std::stringstream xml;
+  xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      << "<project name=\"bench\">\n"
+      << " <platform vendor=\"xilinx\" boardid=\"vcu1525\" name=\"dynamic\">\n"
+      << "  <version major=\"5\" minor=\"1\"/>\n"
+      << "  <device name=\"fpga0\">\n"
+      << "   <systemClocks><clock port=\"DATA_CLK\" frequency=\"300MHz\"/></systemClocks>\n"
+      << "   <core name=\"OCL_REGION_0\" target=\"bitstream\" type=\"clc_region\" clockFreq=\"300MHz\">\n"
+      << "    <kernelClocks>\n"
+      << "     <clock port=\"KERNEL_CLK\" frequency=\"500MHz\"/>\n"
+      << "     <clock port=\"DATA_CLK\" frequency=\"300MHz\"/>\n"
+      << "    </kernelClocks>\n";
+  for (size_t k=0; k<kernels; ++k) {
+    xml << "    <kernel name=\"krnl_" << k << "\" language=\"c\" vlnv=\"xilinx.com:hls:krnl:1.0\""
+        << " attributes=\"\" hash=\"" << std::hex << 0x1000+k << std::dec << "\""
+        << " preferredWorkGroupSizeMultiple=\"1\" workGroupSize=\"1\" interrupt=\"true\">\n"
+        << "     <port name=\"S_AXI_CONTROL\" mode=\"slave\" range=\"0x1000\" dataWidth=\"32\" portType=\"addressable\" base=\"0x0\"/>\n"
+        << "     <port name=\"M_AXI_GMEM\" mode=\"master\" range=\"0xFFFFFFFF\" dataWidth=\"512\" portType=\"addressable\" base=\"0x0\"/>\n";
+    for (size_t a=0; a<args; ++a) {
+      bool global = (a%2)==0;
+      xml << "     <arg name=\"arg" << a << "\" addressQualifier=\"" << (global ? 1 : 0) << "\""
+          << " id=\"" << a << "\" port=\"" << (global ? "M_AXI_GMEM" : "S_AXI_CONTROL") << "\""
+          << " size=\"0x8\" offset=\"0x" << std::hex << 0x10+a*0xc << std::dec << "\""
+          << " hostOffset=\"0x0\" hostSize=\"0x8\" type=\"" << (global ? "int*" : "unsigned long") << "\"/>\n";
+    }
+    for (size_t i=0; i<instances; ++i) {
+      xml << "     <instance name=\"krnl_" << k << "_" << i << "\">\n"
+          << "      <addrRemap base=\"0x" << std::hex << ((k*instances+i)<<16) << std::dec << "\" port=\"S_AXI_CONTROL\"/>\n"
+          << "     </instance>\n";
+    }
+    xml << "     <compileWorkGroupSize x=\"1\" y=\"1\" z=\"1\"/>\n"
+        << "    </kernel>\n";
+  }
+  xml << "   </core>\n"
+      << "  </device>\n"
+      << " </platform>\n"
+      << "</project>\n";
+  return xml.str();
+}
+
+// xclbin2 with the xml as its only section
+static std::vector<char>
+make_xclbin(const std::string& xml)
+{
+  std::vector<char> xb(sizeof(axlf)+xml.size());
+  auto top = reinterpret_cast<axlf*>(xb.data());
+  std::memcpy(top->m_magic,"xclbin2",8);
+  top->m_header.m_length = xb.size();
+  top->m_header.m_numSections = 1;
+  auto& section = top->m_sections[0];
+  section.m_sectionKind = EMBEDDED_METADATA;
+  section.m_sectionOffset = sizeof(axlf);
+  section.m_sectionSize = xml.size();
+  std::memcpy(xb.data()+sizeof(axlf),xml.data(),xml.size());
+  return xb;
+}
+
+static void
+check(const xocl::xclbin& xclbin)
+{
+  BOOST_CHECK_EQUAL(xclbin.num_kernels(),kernels);
+  BOOST_CHECK_EQUAL(xclbin.lookup_kernel("krnl_7").arguments.size(),args);
+  BOOST_CHECK_EQUAL(xclbin.cu_base_address_map().size(),kernels*instances);
+  auto symbols = xclbin.kernel_symbols();
+  BOOST_CHECK_EQUAL(symbols.back()->arguments.back().host,symbols.back());
+}
+
+// Average time in ms to construct xocl::xclbin, if @cache is not
+// empty the cache is cleared before each load so the xml is parsed
+static double
+load(const std::vector<char>& xb, const std::string& cache)
+{
+  unsigned long ns = 0;
+  for (size_t i=0; i<loads; ++i) {
+    if (!cache.empty())
+      boost::filesystem::remove_all(cache);
+    auto copy = xb;
+    xocl::time_guard tg(ns);
+    xocl::xclbin xclbin(std::move(copy));
+    check(xclbin);
+  }
+  return ns / 1e6 / loads;
+}
+
+// Configure the cache directory once, the configuration is read once
+static std::string
+cache_dir()
+{
+  static std::string cache;
+  if (!cache.empty())
+    return cache;
+
+  auto dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  boost::filesystem::create_directories(dir);
+  auto ini = (dir / "sdaccel.ini").string();
+  {
+    std::ofstream ostr(ini);
+    ostr << "[Runtime]\nxclbin_metadata_cache=" << (dir / "cache").string() << "\n";
+  }
+  std::stringstream config;
+  xrt::config::detail::debug(config,ini);
+  boost::filesystem::remove_all(dir);
+  return cache = (dir / "cache").string();
+}
+
+static std::string
+read_file(const std::string& fnm)
+{
+  std::ifstream istr(fnm,std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(istr),std::istreambuf_iterator<char>());
+}
+
+static void
+write_file(const std::string& fnm, const std::string& data)
+{
+  std::ofstream ostr(fnm,std::ios::binary|std::ios::trunc);
+  ostr.write(data.data(),data.size());
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_xclbin_metadata_bw )
+
+BOOST_AUTO_TEST_CASE( test_xclbin_metadata_bw1 )
+{
+  auto cache = cache_dir();
+  BOOST_REQUIRE_EQUAL(xrt::config::get_xclbin_metadata_cache(),cache);
+
+  auto xml = make_xml();
+  auto xb = make_xclbin(xml);
+
+  // parse xml and store image
+  auto parse_ms = load(xb,cache);
+  auto key = xocl::metadata_cache::key(std::make_pair(xml.data(),xml.data()+xml.size()));
+  xocl::metadata_cache::image img;
+  BOOST_REQUIRE(xocl::metadata_cache::load(cache,key,img));
+  BOOST_CHECK_EQUAL(img.symbols.size(),kernels);
+
+  // load cached image
+  auto cached_ms = load(xb,"");
+
+  std::cout << kernels << " kernels, " << xml.size() << " bytes xml\n"
+            << "xml parse + image store: " << parse_ms << " ms\n"
+            << "cached image:            " << cached_ms << " ms\n";
+
+  boost::filesystem::remove_all(cache);
+}
+
+BOOST_AUTO_TEST_CASE( test_xclbin_metadata_bw2 )
+{
+  auto cache = cache_dir();
+  BOOST_REQUIRE_EQUAL(xrt::config::get_xclbin_metadata_cache(),cache);
+
+  auto xml = make_xml();
+  auto xb = make_xclbin(xml);
+  auto key = xocl::metadata_cache::key(std::make_pair(xml.data(),xml.data()+xml.size()));
+
+  // parse xml and store image
+  boost::filesystem::remove_all(cache);
+  check(xocl::xclbin(std::vector<char>(xb)));
+  auto fnm = boost::filesystem::directory_iterator(cache)->path().string();
+  auto good = read_file(fnm);
+  xocl::metadata_cache::image img;
+  BOOST_REQUIRE(xocl::metadata_cache::deserialize(good.data(),good.size(),key,img));
+
+  auto corrupt = good;
+  corrupt[corrupt.size()/2] ^= 0x1;
+  auto truncated = good.substr(0,good.size()/2);
+  auto stale_version = good;
+  stale_version[8] ^= 0x1;  // header version
+  auto stale_key = xocl::metadata_cache::serialize(key+1,img);
+
+  for (auto& bad : {corrupt,truncated,stale_version,stale_key}) {
+    BOOST_CHECK(!xocl::metadata_cache::deserialize(bad.data(),bad.size(),key,img));
+
+    // bad image is rejected, xml is parsed and image is stored again
+    write_file(fnm,bad);
+    check(xocl::xclbin(std::vector<char>(xb)));
+    BOOST_CHECK(read_file(fnm)==good);
+  }
+
+  boost::filesystem::remove_all(cache);
+}
+
+BOOST_AUTO_TEST_CASE( test_xclbin_metadata_bw3 )
+{
+  auto cache = cache_dir();
+
+  auto xml = make_xml();
+  auto key = xocl::metadata_cache::key(std::make_pair(xml.data(),xml.data()+xml.size()));
+  xocl::metadata_cache::image img;
+  check(xocl::xclbin(make_xclbin(xml)));
+  BOOST_REQUIRE(xocl::metadata_cache::load(cache,key,img));
+
+  // threads storing same image concurrently must not share temp file
+  boost::filesystem::remove_all(cache);
+  std::vector<std::thread> threads;
+  std::atomic<unsigned int> stored(0);
+  for (int t=0; t<8; ++t)
+    threads.emplace_back([&] {
+      for (int i=0; i<20; ++i)
+        if (xocl::metadata_cache::store(cache,key,img))
+          ++stored;
+    });
+  for (auto& t : threads)
+    t.join();
+  BOOST_CHECK_EQUAL(stored,8*20);
+
+  // one valid image and no left over temp files
+  auto files = std::distance(boost::filesystem::directory_iterator(cache),boost::filesystem::directory_iterator());
+  BOOST_CHECK_EQUAL(files,1);
+  xocl::metadata_cache::image loaded;
+  BOOST_CHECK(xocl::metadata_cache::load(cache,key,loaded));
+  BOOST_CHECK_EQUAL(loaded.symbols.size(),kernels);
+
+  boost::filesystem::remove_all(cache);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
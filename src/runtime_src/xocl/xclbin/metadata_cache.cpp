@@ -0,0 +1,436 @@
+/**
+ * Copyright (C) 2016-2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "metadata_cache.h"
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+////////////////////////////////////////////////////////////////
+// Image file layout
+//   header:  "XMDCACHE" uint32_t version, uint32_t payload checksum,
+//            uint64_t key, uint64_t payload size
+//   payload: fields of image in declaration order
+// Integers are stored in host byte order, the cache is local to
+// the host.  Strings are stored as uint32_t length and bytes,
+// vectors as uint32_t count and elements.
+////////////////////////////////////////////////////////////////
+namespace {
+
+using image = xocl::metadata_cache::image;
+using symbol = xocl::xclbin::symbol;
+
+const char magic[8] = {'X','M','D','C','A','C','H','E'};
+const uint32_t version = 2;
+
+struct header
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t checksum;
+  uint64_t key;
+  uint64_t size;
+};
+
+class writer
+{
+  std::string m_data;
+
+public:
+  template <typename T>
+  void
+  put(T value)
+  {
+    m_data.append(reinterpret_cast<const char*>(&value),sizeof(T));
+  }
+
+  void
+  put(const std::string& str)
+  {
+    put<uint32_t>(str.size());
+    m_data.append(str);
+  }
+
+  template <typename T, typename F>
+  void
+  put(const std::vector<T>& vec, F f)
+  {
+    put<uint32_t>(vec.size());
+    for (auto& v : vec)
+      f(*this,v);
+  }
+
+  std::string&
+  data()
+  {
+    return m_data;
+  }
+};
+
+// Reads past end of data or invalid enum values throw, they are
+// caught by deserialize which then rejects the image
+class reader
+{
+  const char* m_data;
+  const char* m_end;
+
+public:
+  reader(const char* data, size_t size)
+    : m_data(data), m_end(data+size)
+  {}
+
+  template <typename T>
+  T
+  get()
+  {
+    T value;
+    if (static_cast<size_t>(m_end-m_data) < sizeof(T))
+      throw std::runtime_error("truncated");
+    std::memcpy(&value,m_data,sizeof(T));
+    m_data += sizeof(T);
+    return value;
+  }
+
+  std::string
+  get_string()
+  {
+    auto size = get<uint32_t>();
+    if (static_cast<size_t>(m_end-m_data) < size)
+      throw std::runtime_error("truncated");
+    std::string str(m_data,size);
+    m_data += size;
+    return str;
+  }
+
+  template <typename T, typename F>
+  void
+  get(std::vector<T>& vec, F f)
+  {
+    auto count = get<uint32_t>();
+    vec.reserve(count);
+    for (uint32_t i=0; i<count; ++i)
+      f(*this,vec);
+  }
+
+  bool
+  done() const
+  {
+    return m_data==m_end;
+  }
+};
+
+template <typename ENUM>
+ENUM
+to_enum(uint32_t value, ENUM last)
+{
+  if (value > static_cast<uint32_t>(last))
+    throw std::runtime_error("bad enum");
+  return static_cast<ENUM>(value);
+}
+
+void
+put_clocks(writer& w, const xocl::xclbin::clocks& clk)
+{
+  w.put(clk.region_name);
+  w.put(clk.clock_name);
+  w.put<uint32_t>(clk.frequency);
+}
+
+void
+get_clocks(reader& r, std::vector<xocl::xclbin::clocks>& vec)
+{
+  auto region = r.get_string();
+  auto clock = r.get_string();
+  auto freq = r.get<uint32_t>();
+  vec.emplace_back(std::move(region),std::move(clock),freq);
+}
+
+void
+put_profiler(writer& w, const xocl::xclbin::profiler& profiler)
+{
+  w.put(profiler.name);
+  w.put(profiler.slots,[](writer& w, const xocl::xclbin::profiler::slot_type& slot) {
+      w.put<int32_t>(std::get<0>(slot));
+      w.put(std::get<1>(slot));
+      w.put(std::get<2>(slot));
+    });
+}
+
+void
+get_profiler(reader& r, std::vector<xocl::xclbin::profiler>& vec)
+{
+  xocl::xclbin::profiler profiler;
+  profiler.name = r.get_string();
+  r.get(profiler.slots,[](reader& r, std::vector<xocl::xclbin::profiler::slot_type>& slots) {
+      auto index = r.get<int32_t>();
+      auto cuname = r.get_string();
+      auto type = r.get_string();
+      slots.emplace_back(index,std::move(cuname),std::move(type));
+    });
+  vec.emplace_back(std::move(profiler));
+}
+
+void
+put_symbol(writer& w, const symbol& sym)
+{
+  w.put<uint32_t>(sym.stringtable.size());
+  for (auto& str : sym.stringtable) {
+    w.put<uint32_t>(str.first);
+    w.put(str.second);
+  }
+  w.put(sym.name);
+  w.put(sym.dsaname);
+  w.put(sym.attributes);
+  w.put(sym.hash);
+  w.put(sym.controlport);
+  w.put<uint64_t>(sym.workgroupsize);
+  for (auto d : {0,1,2})
+    w.put<uint64_t>(sym.compileworkgroupsize[d]);
+  for (auto d : {0,1,2})
+    w.put<uint64_t>(sym.maxworkgroupsize[d]);
+  w.put(sym.arguments,[](writer& w, const symbol::arg& arg) {
+      w.put(arg.name);
+      w.put<uint64_t>(arg.address_qualifier);
+      w.put(arg.id);
+      w.put(arg.port);
+      w.put<uint64_t>(arg.port_width);
+      w.put<uint64_t>(arg.size);
+      w.put<uint64_t>(arg.offset);
+      w.put<uint64_t>(arg.hostoffset);
+      w.put<uint64_t>(arg.hostsize);
+      w.put(arg.type);
+      w.put<uint64_t>(arg.memsize);
+      w.put<uint64_t>(arg.baseaddr);
+      w.put(arg.linkage);
+      w.put<uint32_t>(static_cast<uint32_t>(arg.atype));
+    });
+  w.put(sym.instances,[](writer& w, const symbol::instance& inst) {
+      w.put(inst.name);
+      w.put<uint64_t>(inst.base);
+      w.put(inst.port);
+    });
+  w.put<uint8_t>(sym.cu_interrupt);
+  w.put<uint32_t>(static_cast<uint32_t>(sym.target));
+}
+
+void
+get_symbol(reader& r, std::vector<symbol>& vec)
+{
+  vec.emplace_back();
+  auto& sym = vec.back();
+  for (auto count = r.get<uint32_t>(); count; --count) {
+    auto id = r.get<uint32_t>();
+    sym.stringtable.emplace(id,r.get_string());
+  }
+  sym.name = r.get_string();
+  sym.dsaname = r.get_string();
+  sym.attributes = r.get_string();
+  sym.hash = r.get_string();
+  sym.controlport = r.get_string();
+  sym.workgroupsize = r.get<uint64_t>();
+  for (auto d : {0,1,2})
+    sym.compileworkgroupsize[d] = r.get<uint64_t>();
+  for (auto d : {0,1,2})
+    sym.maxworkgroupsize[d] = r.get<uint64_t>();
+  r.get(sym.arguments,[](reader& r, std::vector<symbol::arg>& args) {
+      symbol::arg arg;
+      arg.name = r.get_string();
+      arg.address_qualifier = r.get<uint64_t>();
+      arg.id = r.get_string();
+      arg.port = r.get_string();
+      arg.port_width = r.get<uint64_t>();
+      arg.size = r.get<uint64_t>();
+      arg.offset = r.get<uint64_t>();
+      arg.hostoffset = r.get<uint64_t>();
+      arg.hostsize = r.get<uint64_t>();
+      arg.type = r.get_string();
+      arg.memsize = r.get<uint64_t>();
+      arg.baseaddr = r.get<uint64_t>();
+      arg.linkage = r.get_string();
+      arg.atype = to_enum(r.get<uint32_t>(),symbol::arg::argtype::rtinfo);
+      arg.host = nullptr;
+      args.emplace_back(std::move(arg));
+    });
+  r.get(sym.instances,[](reader& r, std::vector<symbol::instance>& instances) {
+      symbol::instance inst;
+      inst.name = r.get_string();
+      inst.base = r.get<uint64_t>();
+      inst.port = r.get_string();
+      instances.emplace_back(std::move(inst));
+    });
+  sym.cu_interrupt = r.get<uint8_t>();
+  sym.target = to_enum(r.get<uint32_t>(),xocl::xclbin::target_type::invalid);
+}
+
+// FNV-1a
+uint64_t
+hash(const char* first, const char* last)
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (auto itr=first; itr!=last; ++itr) {
+    hash ^= static_cast<unsigned char>(*itr);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+uint32_t
+payload_checksum(const char* first, const char* last)
+{
+  auto h = hash(first,last);
+  return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+std::string
+image_path(const std::string& dir, uint64_t key)
+{
+  std::stringstream fnm;
+  fnm << std::hex << std::setfill('0') << std::setw(16) << key << ".xmd";
+  return (boost::filesystem::path(dir) / fnm.str()).string();
+}
+
+} // namespace
+
+namespace xocl { namespace metadata_cache {
+
+uint64_t
+key(const ::xclbin::data_range& xml)
+{
+  return hash(xml.first,xml.second);
+}
+
+std::string
+serialize(uint64_t key, const image& img)
+{
+  writer w;
+  w.put(header{{0},version,0,key,0});
+  std::memcpy(&w.data()[0],magic,sizeof(magic));
+
+  w.put(img.dsa_name);
+  w.put(img.project_name);
+  w.put<uint32_t>(static_cast<uint32_t>(img.target));
+  w.put(img.system_clocks,put_clocks);
+  w.put(img.kernel_clocks,put_clocks);
+  w.put(img.profilers,put_profiler);
+  w.put(img.symbols,put_symbol);
+
+  auto& data = w.data();
+  uint64_t size = data.size() - sizeof(header);
+  std::memcpy(&data[offsetof(header,size)],&size,sizeof(size));
+  auto sum = payload_checksum(&data[sizeof(header)],&data[0]+data.size());
+  std::memcpy(&data[offsetof(header,checksum)],&sum,sizeof(sum));
+  return std::move(data);
+}
+
+bool
+deserialize(const char* data, size_t size, uint64_t key, image& img)
+{
+  header hdr;
+  if (size < sizeof(hdr))
+    return false;
+  std::memcpy(&hdr,data,sizeof(hdr));
+  if (std::memcmp(hdr.magic,magic,sizeof(magic)) || hdr.version!=version
+      || hdr.key!=key || hdr.size!=size-sizeof(hdr)
+      || hdr.checksum!=payload_checksum(data+sizeof(hdr),data+size))
+    return false;
+
+  try {
+    reader r(data+sizeof(hdr),hdr.size);
+    image tmp;
+    tmp.dsa_name = r.get_string();
+    tmp.project_name = r.get_string();
+    tmp.target = to_enum(r.get<uint32_t>(),xclbin::target_type::invalid);
+    r.get(tmp.system_clocks,get_clocks);
+    r.get(tmp.kernel_clocks,get_clocks);
+    r.get(tmp.profilers,get_profiler);
+    r.get(tmp.symbols,get_symbol);
+    if (!r.done())
+      return false;
+    img = std::move(tmp);
+    return true;
+  }
+  catch (const std::exception&) {
+    return false;
+  }
+}
+
+bool
+load(const std::string& dir, uint64_t key, image& img)
+{
+  auto fd = open(image_path(dir,key).c_str(),O_RDONLY);
+  if (fd<0)
+    return false;
+
+  struct stat st;
+  if (fstat(fd,&st) || st.st_size < static_cast<off_t>(sizeof(header))) {
+    close(fd);
+    return false;
+  }
+
+  auto addr = mmap(nullptr,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+  close(fd);
+  if (addr==MAP_FAILED)
+    return false;
+
+  auto valid = deserialize(static_cast<const char*>(addr),st.st_size,key,img);
+  munmap(addr,st.st_size);
+  return valid;
+}
+
+bool
+store(const std::string& dir, uint64_t key, const image& img)
+{
+  try {
+    boost::filesystem::create_directories(dir);
+    auto path = image_path(dir,key);
+    // Temp file is unique per process and per store within process so
+    // that threads storing the same image don't write the same file
+    static std::atomic<unsigned int> count(0);
+    auto tmp = path + "." + std::to_string(getpid()) + "." + std::to_string(count++);
+    {
+      std::ofstream ostr(tmp,std::ios::binary|std::ios::trunc);
+      auto data = serialize(key,img);
+      ostr.write(data.data(),data.size());
+      if (!ostr.good()) {
+        ostr.close();
+        std::remove(tmp.c_str());
+        return false;
+      }
+    }
+    if (std::rename(tmp.c_str(),path.c_str())) {
+      std::remove(tmp.c_str());
+      return false;
+    }
+    return true;
+  }
+  catch (const std::exception&) {
+    return false;
+  }
+}
+
+}} // metadata_cache,xocl
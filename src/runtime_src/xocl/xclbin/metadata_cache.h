@@ -0,0 +1,99 @@
+/**
+ * Copyright (C) 2016-2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef runtime_src_xocl_xclbin_metadata_cache_h_
+#define runtime_src_xocl_xclbin_metadata_cache_h_
+
+#include "xocl/xclbin/xclbin.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace xocl { namespace metadata_cache {
+
+/**
+ * Meta data of an xclbin as extracted from its xml section
+ *
+ * The image holds everything xocl::xclbin exposes from the xml, it
+ * has no references to the xml itself.  An image is stored in the
+ * cache directory in a compact binary form keyed by a hash of the
+ * xml, a later load of the same xclbin reads the image back with
+ * no xml parsing.
+ */
+struct image
+{
+  std::string dsa_name;
+  std::string project_name;
+  xclbin::target_type target = xclbin::target_type::invalid;
+  xclbin::system_clocks_type system_clocks;
+  xclbin::kernel_clocks_type kernel_clocks;
+  xclbin::profilers_type profilers;
+  std::vector<xclbin::symbol> symbols;
+};
+
+/**
+ * Cache key of xml meta data
+ *
+ * @return
+ *   64 bit hash (FNV-1a) of the xml
+ */
+uint64_t
+key(const ::xclbin::data_range& xml);
+
+/**
+ * Load image from cache directory
+ *
+ * The symbol uid and back pointers from arguments to the symbol are
+ * not part of the image and must be set by caller.
+ *
+ * @return
+ *   true if image for @key was found and is valid, false otherwise
+ */
+bool
+load(const std::string& dir, uint64_t key, image& img);
+
+/**
+ * Store image in cache directory
+ *
+ * The image is written to a temporary file that is renamed into
+ * place, concurrent processes storing the same image is safe.
+ *
+ * @return
+ *   true if image was stored, false otherwise
+ */
+bool
+store(const std::string& dir, uint64_t key, const image& img);
+
+/**
+ * Serialize image to binary form
+ */
+std::string
+serialize(uint64_t key, const image& img);
+
+/**
+ * Deserialize image from binary form
+ *
+ * @return
+ *   true if @data is a valid image with matching @key, version and
+ *   payload checksum, false otherwise
+ */
+bool
+deserialize(const char* data, size_t size, uint64_t key, image& img);
+
+}} // metadata_cache,xocl
+
+#endif
@@ -15,6 +15,7 @@
  */
 
 #include "xclbin.h"
+#include "metadata_cache.h"
 
 #include "xocl/config.h"
 #include "xocl/core/debug.h"
@@ -403,6 +404,13 @@ private:
       { return a.m_name < b.m_name; }
     };
 
+    static unsigned int
+    next_uid()
+    {
+      static unsigned int count = 0;
+      return count++;
+    }
+
     const platform_wrapper*  platform() const { return m_platform; }
     const device_wrapper* device() const { return m_device; }
     const core_wrapper* core() const { return m_core; }
@@ -625,8 +633,7 @@ private:
     void
     init_symbol()
     {
-      static unsigned int count = 0;
-      m_symbol.uid = count++;
+      m_symbol.uid = next_uid();
 
       init_args();
       fix_rtinfo();
@@ -657,76 +664,58 @@ private:
     {
       return m_symbol;
     }
-
-    size_t
-    cu_base_offset() const
-    {
-      size_t offset = std::numeric_limits<size_t>::max();
-      for (auto& instance : m_symbol.instances)
-        offset = std::min(offset,instance.base);
-      return offset;
-    }
-
-    void
-    cu_base_address_map(std::vector<uint32_t>& amap) const
-    {
-      for (auto& instance : m_symbol.instances)
-        amap.push_back(instance.base);
-    }
-
-    std::string
-    conformance_rename()
-    {
-      std::string name = m_name;
-      m_name = name.substr(0,name.find_last_of("_"));
-      m_symbol.name = m_name;
-      return name;
-    }
-
-    bool
-    cu_interrupt() const
-    {
-      return m_symbol.cu_interrupt;
-    }
-
-    size_t
-    regmap_size() const
-    {
-      size_t sz = 0;
-      for (auto& arg : m_symbol.arguments)
-        sz = std::max(arg.offset+arg.size,sz);
-      return sz;
-    }
   }; // class kernel_wrapper
 
 private:
-  std::vector<std::unique_ptr<kernel_wrapper>> m_kernels;
-  std::vector<std::unique_ptr<platform_wrapper>> m_platforms;
-  std::vector<std::unique_ptr<device_wrapper>> m_devices;
-  std::vector<std::unique_ptr<core_wrapper>> m_cores;
+  using image_type = xocl::metadata_cache::image;
+  using symbol_type = xocl::xclbin::symbol;
+
+  // Everything exposed from the xml, either extracted from the xml
+  // or loaded from the meta data cache
+  image_type m_image;
+
+  // Errors from extracting values that used to be parsed on demand,
+  // rethrown when the value is accessed.  An image with errors is
+  // not cached.
+  std::exception_ptr m_system_clocks_error;
+  std::exception_ptr m_kernel_clocks_error;
+  std::exception_ptr m_profilers_error;
+
+  template <typename T, typename F>
+  static void
+  extract(T& value, std::exception_ptr& error, F f)
+  {
+    try {
+      value = f();
+    }
+    catch (...) {
+      error = std::current_exception();
+    }
+  }
 
-  pt::ptree xml_project;
+  static void
+  rethrow(const std::exception_ptr& error)
+  {
+    if (error)
+      std::rethrow_exception(error);
+  }
 
   bool
-  driver_match(const kernel_wrapper& k, const std::string& dsa) const
+  cacheable() const
   {
-    // Deal with old dsa's
-    if(dsa.size() == 0)
-      return true;
-
-    // Deal with ibm capi dsa's
-    if(dsa.find("CAPI") != std::string::npos)
-      return true;
-
-    std::string kernel_dsa = k.platform()->dsa_name();
-
-    return (kernel_dsa==dsa) ? true : false;
+    return !m_system_clocks_error && !m_kernel_clocks_error && !m_profilers_error;
   }
 
-public:
-  explicit
-  metadata(const data_range& xml)
+  // Parse the xml and extract all meta data into m_image
+  void
+  parse(const data_range& xml)
   {
+    pt::ptree xml_project;
+    std::vector<std::unique_ptr<kernel_wrapper>> kernels;
+    std::unique_ptr<platform_wrapper> platform;
+    std::unique_ptr<device_wrapper> device;
+    std::unique_ptr<core_wrapper> core;
+
     try {
       std::stringstream xml_stream;
       xml_stream.write(xml.first,xml.second-xml.first);
@@ -743,9 +732,8 @@ public:
         continue;
       if (++count>1)
         throw xocl::error(CL_INVALID_BINARY,"Only one platform supported");
-      m_platforms.emplace_back(xrt::make_unique<platform_wrapper>(xml_platform.second));
+      platform = xrt::make_unique<platform_wrapper>(xml_platform.second);
     }
-    auto platform = m_platforms.back().get();
 
     // iterate devices
     count = 0;
@@ -754,9 +742,8 @@ public:
         continue;
       if (++count>1)
         throw xocl::error(CL_INVALID_BINARY,"Only one device supported");
-      m_devices.emplace_back(xrt::make_unique<device_wrapper>(platform,xml_device.second));
+      device = xrt::make_unique<device_wrapper>(platform.get(),xml_device.second);
     }
-    auto device = m_devices.back().get();
 
     auto nm = device->name();
     auto c = device->system_clocks();
@@ -768,53 +755,101 @@ public:
         continue;
       if (++count>1)
         throw xocl::error(CL_INVALID_BINARY,"Only one core supported");
-      m_cores.emplace_back(xrt::make_unique<core_wrapper>(platform,device,xml_core.second));
+      core = xrt::make_unique<core_wrapper>(platform.get(),device.get(),xml_core.second);
     }
-    auto core = m_cores.back().get();
 
     // iterate kernels
     for (auto& xml_kernel : xml_project.get_child("project.platform.device.core")) {
       if (xml_kernel.first != "kernel")
         continue;
       XOCL_DEBUG(std::cout,"xclbin found kernel '" + xml_kernel.second.get<std::string>("<xmlattr>.name") + "'\n");
-      m_kernels.emplace_back(xrt::make_unique<kernel_wrapper>(platform,device,core,xml_kernel.second));
+      kernels.emplace_back(xrt::make_unique<kernel_wrapper>(platform.get(),device.get(),core.get(),xml_kernel.second));
+    }
+
+    // extract meta data from the wrappers, the xml is discarded on return
+    m_image.dsa_name = platform->dsa_name();
+    m_image.project_name = xml_project.get<std::string>("project.<xmlattr>.name","");
+    m_image.target = core->target();
+    extract(m_image.system_clocks,m_system_clocks_error,[&device]() { return device->system_clocks(); });
+    extract(m_image.kernel_clocks,m_kernel_clocks_error,[&core]() { return core->kernel_clocks(); });
+    extract(m_image.profilers,m_profilers_error,[&core]() { return core->profilers(); });
+    m_image.symbols.reserve(kernels.size());
+    for (auto& kernel : kernels)
+      m_image.symbols.push_back(kernel->symbol());
+  }
+
+  // Symbols are copied into the image, link arguments to their
+  // symbol in the image.  Loaded symbols also need a uid.
+  void
+  init_symbols(bool loaded)
+  {
+    for (auto& symbol : m_image.symbols) {
+      if (loaded)
+        symbol.uid = kernel_wrapper::next_uid();
+      for (auto& arg : symbol.arguments)
+        arg.host = &symbol;
     }
   }
 
+  static size_t
+  regmap_size(const symbol_type& symbol)
+  {
+    size_t sz = 0;
+    for (auto& arg : symbol.arguments)
+      sz = std::max(arg.offset+arg.size,sz);
+    return sz;
+  }
+
+public:
+  explicit
+  metadata(const data_range& xml)
+  {
+    auto dir = xrt::config::get_xclbin_metadata_cache();
+    if (dir.empty()) {
+      parse(xml);
+      init_symbols(false);
+      return;
+    }
+
+    auto key = xocl::metadata_cache::key(xml);
+    if (xocl::metadata_cache::load(dir,key,m_image)) {
+      XOCL_DEBUG(std::cout,"xclbin meta data loaded from cache '",dir,"'\n");
+      init_symbols(true);
+      return;
+    }
+
+    parse(xml);
+    init_symbols(false);
+    if (cacheable())
+      xocl::metadata_cache::store(dir,key,m_image);
+  }
+
   xocl::xclbin::system_clocks_type
   system_clocks() const
   {
-    xocl::xclbin::system_clocks_type clocks;
-    for (auto& device : m_devices) {
-      auto cclocks = device->system_clocks();
-      std::move(cclocks.begin(),cclocks.end(),std::back_inserter(clocks));
-    }
-    return clocks;
+    rethrow(m_system_clocks_error);
+    return m_image.system_clocks;
   }
 
   xocl::xclbin::kernel_clocks_type
   kernel_clocks() const
   {
-    xocl::xclbin::kernel_clocks_type clocks;
-    for (auto& core : m_cores) {
-      auto cclocks = core->kernel_clocks();
-      std::move(cclocks.begin(),cclocks.end(),std::back_inserter(clocks));
-    }
-    return clocks;
+    rethrow(m_kernel_clocks_error);
+    return m_image.kernel_clocks;
   }
 
   unsigned int
   num_kernels() const
   {
-    return m_kernels.size();
+    return m_image.symbols.size();
   }
 
   std::vector<std::string>
   kernel_names() const
   {
     std::vector<std::string> names;
-    for (auto& kernel : m_kernels)
-      names.emplace_back(kernel->name());
+    for (auto& symbol : m_image.symbols)
+      names.emplace_back(symbol.name);
     return names;
   }
 
@@ -822,8 +857,8 @@ public:
   kernel_symbols() const
   {
     std::vector<const xocl::xclbin::symbol*> symbols;
-    for (auto& kernel : m_kernels)
-      symbols.push_back(&kernel->symbol());
+    for (auto& symbol : m_image.symbols)
+      symbols.push_back(&symbol);
     return symbols;
   }
 
@@ -831,17 +866,17 @@ public:
   kernel_max_regmap_size() const
   {
     size_t sz = 0;
-    for (auto& kernel : m_kernels)
-      sz = std::max(kernel->regmap_size(),sz);
+    for (auto& symbol : m_image.symbols)
+      sz = std::max(regmap_size(symbol),sz);
     return sz;
   }
 
   const xocl::xclbin::symbol&
   lookup_kernel(const std::string& kernel_name) const
   {
-    for (auto& kernel : m_kernels) {
-      if (kernel->name()==kernel_name)
-        return kernel->symbol();
+    for (auto& symbol : m_image.symbols) {
+      if (symbol.name==kernel_name)
+        return symbol;
     }
     throw xocl::error(CL_INVALID_KERNEL_NAME,"No kernel with name '" + kernel_name + "' found in program");
   }
@@ -849,54 +884,57 @@ public:
   std::string
   dsa_name() const
   {
-    return m_platforms[0]->dsa_name();
+    return m_image.dsa_name;
   }
 
   bool
   is_unified() const
   {
-    return m_platforms[0]->is_unified();
+    // Since 17.4, we only support unified platform.
+    return true;
   }
 
   std::string
   project_name() const
   {
-    return xml_project.get<std::string>("project.<xmlattr>.name","");
+    return m_image.project_name;
   }
 
   target_type
   target() const
   {
-    return m_cores[0]->target();
+    return m_image.target;
   }
 
   xocl::xclbin::profilers_type
   profilers() const
   {
-    return m_cores[0]->profilers();
+    rethrow(m_profilers_error);
+    return m_image.profilers;
   }
 
   size_t
   cu_base_offset() const
   {
     size_t offset = std::numeric_limits<size_t>::max();
-    for (auto& kernel : m_kernels)
-      offset = std::min(offset,kernel->cu_base_offset());
+    for (auto& symbol : m_image.symbols)
+      for (auto& instance : symbol.instances)
+        offset = std::min(offset,instance.base);
     return offset;
   }
 
   size_t
   cu_size() const
   {
-    return m_platforms[0]->is_unified() ? 16 : 12;
+    return is_unified() ? 16 : 12;
   }
 
   bool
   cu_interrupt() const
   {
     bool retval = true;
-    for (auto& kernel : m_kernels)
-      if (!kernel->cu_interrupt())
+    for (auto& symbol : m_image.symbols)
+      if (!symbol.cu_interrupt)
         return false;
     return retval;
   }
@@ -905,8 +943,9 @@ public:
   cu_base_address_map() const
   {
     std::vector<uint32_t> amap;
-    for (auto& kernel : m_kernels)
-      kernel->cu_base_address_map(amap);
+    for (auto& symbol : m_image.symbols)
+      for (auto& instance : symbol.instances)
+        amap.push_back(instance.base);
 
     std::sort(amap.begin(),amap.end());
     return amap;
@@ -916,9 +955,9 @@ public:
   conformance_rename_kernel(const std::string& hash)
   {
     unsigned int retval = 0;
-    for (auto& kernel : m_kernels) {
-      if (kernel->hash()==hash)  {
-        kernel->conformance_rename();
+    for (auto& symbol : m_image.symbols) {
+      if (symbol.hash==hash)  {
+        symbol.name = symbol.name.substr(0,symbol.name.find_last_of("_"));
         ++retval;
       }
     }
@@ -929,8 +968,8 @@ public:
   conformance_kernel_hashes() const
   {
     std::vector<std::string> retval;
-    for (auto& kernel : m_kernels)
-      retval.push_back(kernel->hash());
+    for (auto& symbol : m_image.symbols)
+      retval.push_back(symbol.hash);
     return retval;
   }
 }; // metadata
@@ -1152,7 +1191,8 @@ struct xclbin::impl
   metadata m_xml;
   xclbin_data_sections m_sections;
 
-  impl(std::vector<char>&& xb)
+  explicit
+  impl(binary_type&& xb)
     : m_binary(std::move(xb))
     , m_xml(m_binary.meta_data())
     , m_sections(m_binary)
@@ -1274,7 +1314,13 @@ xclbin()
 
 xclbin::
 xclbin(std::vector<char>&& xb)
-  : m_impl(xrt::make_unique<xclbin::impl>(std::move(xb)))
+  : m_impl(xrt::make_unique<xclbin::impl>(binary_type(std::move(xb))))
+{
+}
+
+xclbin::
+xclbin(const std::string& filename)
+  : m_impl(xrt::make_unique<xclbin::impl>(binary_type(filename)))
 {
 }
 
@@ -149,6 +149,14 @@ public:
    */
   // implicit
   xclbin(std::vector<char>&& xb);
+
+  /**
+   * Construct from xclbin file, which is mapped read-only into
+   * memory rather than copied
+   */
+  explicit
+  xclbin(const std::string& filename);
+
   xclbin(xclbin&& rhs);
 
   xclbin(const xclbin& rhs);
@@ -19,11 +19,45 @@
 #include "xrt/util/task.h"
 #include "xrt/util/event.h"
 
+#include "driver/include/xclbin.h"
+
 #include <future>
 #include <cstring> // for std::memset
 
 namespace xrt {
 
+hal::operations_result<int>
+device::
+loadXclBin(const axlf* xclbin)
+{
+  m_xclbin_uuid.fill(0);
+  auto ret = m_hal->loadXclBin(xclbin);
+  if (ret.valid() && !ret.get())
+    std::memcpy(m_xclbin_uuid.data(),&xclbin->m_header.uuid,m_xclbin_uuid.size());
+  return ret;
+}
+
+bool
+device::
+isXclbinLoaded(const axlf* xclbin) const
+{
+  static const std::array<unsigned char,16> null_uuid {{0}};
+  return m_xclbin_uuid != null_uuid
+    && std::memcmp(m_xclbin_uuid.data(),&xclbin->m_header.uuid,m_xclbin_uuid.size())==0;
+}
+
+bool
+device::
+resetXclbinKernels(const axlf* xclbin)
+{
+  if (!isXclbinLoaded(xclbin))
+    return false;
+
+  // Drivers that cannot reset the compute units get the xclbin loaded
+  auto ret = m_hal->resetComputeUnits();
+  return ret.valid() && !ret.get();
+}
+
 std::ostream&
 device::
 printDeviceInfo(std::ostream& ostr) const
@@ -20,6 +20,7 @@
 #include "xrt/device/hal.h"
 #include "xrt/util/range.h"
 
+#include <array>
 #include <set>
 #include <vector>
 #include <thread>
@@ -42,6 +43,7 @@ public:
   using BufferObjectHandle = hal::BufferObjectHandle;
   using ExecBufferObjectHandle = hal::ExecBufferObjectHandle;
   using direction = hal::device::direction;
+  using rect = hal::rect;
   using memoryDomain = hal::device::Domain;
   using queue_type = hal::queue_type;
   using stream_handle = hal::StreamHandle;
@@ -62,6 +64,7 @@ public:
 
   device(device&& rhs)
     : m_hal(std::move(rhs.m_hal)), m_setup_done(rhs.m_setup_done)
+    , m_xclbin_uuid(rhs.m_xclbin_uuid)
   {}
 
   ~device()
@@ -159,6 +162,7 @@ public:
   void
   close()
   {
+    m_xclbin_uuid.fill(0);
     m_hal->close();
   }
 
@@ -268,6 +272,17 @@ public:
   sync(const BufferObjectHandle& bo, size_t sz, size_t offset, direction dir, bool async=true)
   { return m_hal->sync(bo,sz,offset,dir,async); }
 
+  /**
+   * Sync a strided region of a buffer object to/from device
+   *
+   * The region is described by a 2D/3D pitch descriptor that is
+   * passed to the HAL, which syncs it with one DMA per contiguous
+   * span or in one scatter-gather transfer.
+   */
+  void
+  sync_rect(const BufferObjectHandle& bo, const rect& region, direction dir)
+  { m_hal->sync_rect(bo,region,dir); }
+
   /**
    * Copy sz bytes at offset from device to device/host
    *
@@ -356,6 +371,10 @@ public:
   exec_buf(const ExecBufferObjectHandle& bo)
   { return m_hal->exec_buf(bo); }
 
+  int
+  exec_buf(const std::vector<ExecBufferObjectHandle>& bos)
+  { return m_hal->exec_buf(bos); }
+
   int
   exec_wait(int timeout_ms) const
   { return m_hal->exec_wait(timeout_ms); }
@@ -574,10 +593,41 @@ public:
    *   return value is implementation dependent.
    */
   hal::operations_result<int>
-  loadXclBin(const axlf* xclbin)
-  {
-    return m_hal->loadXclBin(xclbin);
-  }
+  loadXclBin(const axlf* xclbin);
+
+  /**
+   * Check if an xclbin is already loaded on this device
+   *
+   * The device remembers the uuid of the last xclbin successfully
+   * loaded through loadXclBin.  The bitstream cannot be swapped by
+   * other processes while the device is open, so a matching uuid
+   * means that the xclbin need not be downloaded again.
+   *
+   * @param xclbin
+   *   Pointer to an xclbin
+   * @returns
+   *   True if @xclbin has a uuid that matches the uuid of the last
+   *   xclbin loaded, false otherwise
+   */
+  bool
+  isXclbinLoaded(const axlf* xclbin) const;
+
+  /**
+   * Reset the compute units of an xclbin already loaded on this device
+   *
+   * Used in place of loadXclBin when the same xclbin is loaded again.
+   * The compute units are reset by the driver without downloading the
+   * bitstream again (hal::device::resetComputeUnits).  Drivers without
+   * such reset, e.g. the emulation drivers, get the xclbin loaded.
+   *
+   * @param xclbin
+   *   Pointer to an xclbin
+   * @returns
+   *   True if @xclbin is loaded (isXclbinLoaded) and its compute units
+   *   were reset, false if the xclbin must be loaded with loadXclBin
+   */
+  bool
+  resetXclbinKernels(const axlf* xclbin);
 
   /**
    * Load a bistream from a file
@@ -664,7 +714,11 @@ public:
   hal::operations_result<int>
   resetKernel()
   {
-    return m_hal->resetKernel();
+    // Device may no longer have the xclbin loaded after a reset
+    auto ret = m_hal->resetKernel();
+    if (ret.valid())
+      m_xclbin_uuid.fill(0);
+    return ret;
   }
 
   /**
@@ -844,6 +898,9 @@ private:
   std::vector<BufferObjectHandle> m_buffers;
   mutable std::mutex m_buffers_mutex;
   bool m_setup_done;
+
+  // uuid of last loaded xclbin, all zeros if none
+  std::array<unsigned char,16> m_xclbin_uuid {{0}};
 };
 
 /**
@@ -147,6 +147,44 @@ device::
 {
 }
 
+device::span_list
+device::
+get_rect_spans(const rect& region, direction dir)
+{
+  span_list spans;
+  auto size = region.width*region.height*region.depth;
+  if (!size)
+    return spans;
+
+  if (dir==direction::DEVICE2HOST) {
+    auto end = region.offset + (region.depth-1)*region.slice_pitch
+      + (region.height-1)*region.row_pitch + region.width;
+    if (end-region.offset <= 2*size) {
+      spans.emplace_back(region.offset,end-region.offset);
+      return spans;
+    }
+  }
+
+  for (size_t z=0; z<region.depth; ++z) {
+    for (size_t y=0; y<region.height; ++y) {
+      auto offset = region.offset + z*region.slice_pitch + y*region.row_pitch;
+      if (!spans.empty() && spans.back().first+spans.back().second==offset)
+        spans.back().second += region.width;
+      else
+        spans.emplace_back(offset,region.width);
+    }
+  }
+  return spans;
+}
+
+void
+device::
+sync_rect(const BufferObjectHandle& bo, const rect& region, direction dir)
+{
+  for (auto& span : get_rect_spans(region,dir))
+    sync(bo,span.second,span.first,dir,false);
+}
+
 hal::device_list
 loadDevices()
 {
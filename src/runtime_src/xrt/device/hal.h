@@ -73,6 +73,24 @@ typedef uint64_t StreamFlags;
 
 using StreamXferReq = stream_xfer_req;
 using StreamXferCompletions = streams_poll_req_completions;
+
+/**
+ * Strided region of a buffer object
+ *
+ * The region is depth slices of height rows, each row is width
+ * bytes.  The first row starts at offset in the buffer object,
+ * rows are row_pitch bytes apart and slices are slice_pitch bytes
+ * apart.
+ */
+struct rect
+{
+  size_t offset;
+  size_t width;
+  size_t height;
+  size_t depth;
+  size_t row_pitch;
+  size_t slice_pitch;
+};
 /**
  * Helper class to encapsulate return values from HAL operations.
  *
@@ -140,6 +158,21 @@ public:
 public:
   enum class direction { HOST2DEVICE, DEVICE2HOST };
 
+  // [offset,offset+size) spans of a buffer object
+  using span_list = std::vector<std::pair<size_t,size_t>>;
+
+  /**
+   * Contiguous spans to sync for a strided region
+   *
+   * Adjacent rows are merged into one span.  When syncing from
+   * device, the bounding span of the region is used if it is at
+   * most twice the size of the region.  A bounding span is never
+   * used to sync to device, since bytes between rows are not
+   * necessarily current on host.
+   */
+  static span_list
+  get_rect_spans(const rect& region, direction dir);
+
   //TODO: Verify that this is the right place.
   enum class Domain
   {
@@ -232,6 +265,16 @@ public:
   virtual event
   sync(const BufferObjectHandle& bo, size_t sz, size_t offset, direction dir, bool async) = 0;
 
+  /**
+   * Sync a strided region of a buffer object to/from device
+   *
+   * The default implementation syncs each contiguous span of the
+   * region in the buffer object.  A HAL with scatter-gather DMA
+   * can override and sync the region in one transfer.
+   */
+  virtual void
+  sync_rect(const BufferObjectHandle& bo, const rect& region, direction dir);
+
   virtual event
   copy(const BufferObjectHandle& dst_bo, const BufferObjectHandle& src_bo, size_t sz,
        size_t dst_offset, size_t src_offset) = 0;
@@ -260,6 +303,22 @@ public:
     throw std::runtime_error("exec_buf not supported");
   }
 
+  /**
+   * Submit several exec buffers in order
+   *
+   * Default implementation submits each exec buffer separately,
+   * devices override if the driver can take the exec buffers in
+   * one call.
+   */
+  virtual int
+  exec_buf(const std::vector<ExecBufferObjectHandle>& bos)
+  {
+    for (auto& bo : bos)
+      if (auto ret = exec_buf(bo))
+        return ret;
+    return 0;
+  }
+
   virtual int
   exec_wait(int timeout_ms) const
   {
@@ -467,6 +526,24 @@ public:
     return operations_result<int>();
   }
 
+  /**
+   * Reset the compute units of the loaded xclbin
+   *
+   * Unlike resetKernel, the xclbin stays loaded and the device is
+   * not disturbed for other users.  Implementations that cannot do
+   * this return an invalid result.
+   *
+   * @returns
+   *   A pair <int,bool> where bool is set to true if
+   *   and only if the return int value is valid. The
+   *   return value is 0 on success.
+   */
+  virtual operations_result<int>
+  resetComputeUnits()
+  {
+    return operations_result<int>();
+  }
+
   /**
    * Re-clock device at specified freq
    *
@@ -347,11 +347,31 @@ device::sync(const BufferObjectHandle& boh, size_t sz, size_t offset, direction
 
   if (async) {
     auto qt = (dir==XCL_BO_SYNC_BO_FROM_DEVICE) ? hal::queue_type::read : hal::queue_type::write;
-    return event(addTaskF(m_ops->mSyncBO,qt,m_handle,bo->handle,dir,sz,offset));
+    return event(addTaskF(m_ops->mSyncBO,qt,m_handle,bo->handle,dir,sz,offset+bo->offset));
   }
   return event(typed_event<int>(m_ops->mSyncBO(m_handle, bo->handle, dir, sz, offset+bo->offset)));
 }
 
+void
+device::
+sync_rect(const BufferObjectHandle& boh, const hal::rect& region, direction dir)
+{
+  auto spans = get_rect_spans(region,dir);
+  if (spans.size()<2) {
+    for (auto& span : spans)
+      sync(boh,span.second,span.first,dir,false);
+    return;
+  }
+
+  // Spread spans over the DMA channel workers
+  std::vector<event> events;
+  events.reserve(spans.size());
+  for (auto& span : spans)
+    events.emplace_back(sync(boh,span.second,span.first,dir,true));
+  for (auto& event : events)
+    event.wait();
+}
+
 event
 device::copy(const BufferObjectHandle& dst_boh, const BufferObjectHandle& src_boh, size_t sz, size_t dst_offset, size_t src_offset)
 {
@@ -410,6 +430,20 @@ exec_buf(const ExecBufferObjectHandle& boh)
   return m_ops->mExecBuf(m_handle,bo->handle);
 }
 
+int
+device::
+exec_buf(const std::vector<ExecBufferObjectHandle>& bos)
+{
+  if (!m_ops->mExecBufBatch)
+    return hal::device::exec_buf(bos);
+
+  std::vector<unsigned int> handles;
+  handles.reserve(bos.size());
+  for (auto& boh : bos)
+    handles.push_back(getExecBufferObject(boh)->handle);
+  return m_ops->mExecBufBatch(m_handle,handles.size(),handles.data());
+}
+
 int
 device::
 exec_wait(int timeout_ms) const
@@ -294,6 +294,9 @@ public:
   virtual event
   sync(const BufferObjectHandle& bo, size_t sz, size_t offset, direction dir, bool async);
 
+  virtual void
+  sync_rect(const BufferObjectHandle& bo, const hal::rect& region, direction dir);
+
   virtual event
   copy(const BufferObjectHandle& dst_bo, const BufferObjectHandle& src_bo, size_t sz, size_t dst_offset, size_t src_offset);
 
@@ -318,6 +321,9 @@ public:
   virtual int
   exec_buf(const ExecBufferObjectHandle& bo);
 
+  virtual int
+  exec_buf(const std::vector<ExecBufferObjectHandle>& bos);
+
   virtual int
   exec_wait(int timeout_ms) const;
 
@@ -420,6 +426,14 @@ public:
     return m_ops->mReClock2(m_handle, region, freqMHz);
   }
 
+  virtual hal::operations_result<int>
+  resetComputeUnits()
+  {
+    if (!m_ops->mResetComputeUnits)
+      return hal::operations_result<int>();
+    return m_ops->mResetComputeUnits(m_handle);
+  }
+
   // Following functions are profiling functions
   virtual hal::operations_result<size_t>
   clockTraining(xclPerfMonType type)
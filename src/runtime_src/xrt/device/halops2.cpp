@@ -34,6 +34,7 @@ operations(const std::string &fileName, void *fileHandle, unsigned int count)
   ,mExportBO(0)
   ,mGetBOProperties(0)
   ,mExecBuf(0)
+  ,mExecBufBatch(0)
   ,mExecWait(0)
   ,mFreeBO(0)
   ,mWriteBO(0)
@@ -44,6 +45,7 @@ operations(const std::string &fileName, void *fileHandle, unsigned int count)
   ,mWrite(0)
   ,mRead(0)
   ,mReClock2(0)
+  ,mResetComputeUnits(0)
   ,mLockDevice(0)
   ,mUnlockDevice(0)
   ,mGetDeviceInfo(0)
@@ -96,6 +98,7 @@ operations(const std::string &fileName, void *fileHandle, unsigned int count)
 
   mGetBOProperties = (getBOPropertiesFuncType)dlsym(const_cast<void *>(mDriverHandle), "xclGetBOProperties");
   mExecBuf = (execBOFuncType)dlsym(const_cast<void *>(mDriverHandle), "xclExecBuf");
+  mExecBufBatch = (execBOBatchFuncType)dlsym(const_cast<void *>(mDriverHandle), "xclExecBufBatch");
   mExecWait = (execWaitFuncType)dlsym(const_cast<void *>(mDriverHandle), "xclExecWait");
 
   mFreeBO   = (freeBOFuncType)dlsym(const_cast<void *>(mDriverHandle), "xclFreeBO");
@@ -120,6 +123,7 @@ operations(const std::string &fileName, void *fileHandle, unsigned int count)
     return;
 
   mReClock2 = (reClock2FuncType)dlsym(const_cast<void *>(mDriverHandle), "xclReClock2");
+  mResetComputeUnits = (resetComputeUnitsFuncType)dlsym(const_cast<void *>(mDriverHandle), "xclResetComputeUnits");
   mLockDevice = (lockDeviceFuncType)dlsym(const_cast<void *>(mDriverHandle), "xclLockDevice");
   mUnlockDevice = (unlockDeviceFuncType)dlsym(const_cast<void *>(mDriverHandle), "xclUnlockDevice");
   mGetDeviceInfo = (getDeviceInfoFuncType)dlsym(const_cast<void *>(mDriverHandle), "xclGetDeviceInfo2");
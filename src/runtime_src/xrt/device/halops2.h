@@ -62,6 +62,7 @@ private:
   typedef unsigned int (*exportBOFuncType)(xclDeviceHandle handle, unsigned int boHandle);
   typedef int (*getBOPropertiesFuncType)(xclDeviceHandle handle, unsigned int boHandle, xclBOProperties*);
   typedef unsigned int (*execBOFuncType)(xclDeviceHandle handle, unsigned int cmdBO);
+  typedef int (*execBOBatchFuncType)(xclDeviceHandle handle, size_t num_bo, unsigned int *cmdBOs);
   typedef int (*execWaitFuncType)(xclDeviceHandle handle, int timeoutMS);
 
   typedef void (* freeBOFuncType)(xclDeviceHandle handle, unsigned int boHandle);
@@ -76,6 +77,9 @@ private:
 
   typedef int (* reClock2FuncType)(xclDeviceHandle handle, unsigned short region,
                                    const unsigned short *targetFreqMHz);
+  // Optional, only exported by shims that can reset the compute units
+  // without disturbing the loaded xclbin or other users of the device
+  typedef int (* resetComputeUnitsFuncType)(xclDeviceHandle handle);
   //These are for readControl() and writeControl() functions
   typedef size_t (* writeFuncType)(xclDeviceHandle handle, xclAddressSpace space, uint64_t offset,
                                    const void *hostBuf, size_t size);
@@ -157,6 +161,7 @@ public:
   getBOPropertiesFuncType mGetBOProperties;
 
   execBOFuncType mExecBuf;
+  execBOBatchFuncType mExecBufBatch;
   execWaitFuncType mExecWait;
 
   freeBOFuncType mFreeBO;
@@ -168,6 +173,7 @@ public:
   writeFuncType mWrite;
   readFuncType mRead;
   reClock2FuncType mReClock2;
+  resetComputeUnitsFuncType mResetComputeUnits;
   lockDeviceFuncType mLockDevice;
   unlockDeviceFuncType mUnlockDevice;
   getDeviceInfoFuncType mGetDeviceInfo;
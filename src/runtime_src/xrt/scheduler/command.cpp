@@ -14,56 +14,216 @@
  * under the License.
  */
 
+
 #include "command.h"
+#include "xrt/config.h"
 
-#include <map>
+#include <array>
+#include <atomic>
+#include <mutex>
 #include <vector>
 
+namespace xrt { namespace detail {
+
+/**
+ * Pooled exec buffer object
+ *
+ * The buffer is mapped once when allocated.  @used is the number of
+ * packet words written by the last command that used the buffer,
+ * only these words are cleared when the buffer is recycled.
+ * @in_use is changed under the pool lock so purge can skip the
+ * buffers of live commands.
+ */
+struct exec_buffer
+{
+  xrt::device::ExecBufferObjectHandle bo;
+  void* data = nullptr;
+  size_t used = 0;
+  bool in_use = false;
+};
+
+}} // detail,xrt
+
 namespace {
 
 using buffer_type = xrt::device::ExecBufferObjectHandle;
-static std::mutex s_mutex;
+using exec_buffer = xrt::detail::exec_buffer;
+static constexpr size_t packet_words = 4096/sizeof(uint32_t);
 
 // Static destruction logic to prevent double purging.
 
 // Exec buffer objects must be purged before device is closed.  Static
 // destruction calls platform dtor, which in turns calls purge
 // commands, but static destruction could have deleted the static
-// object in this file first.
+// objects in this file first.  Pools are therefore never deleted.
 static bool s_purged = false;
 
-struct X {
-  std::map<xrt::device*,std::vector<buffer_type>> freelist;
-  X() {}
-  ~X() { s_purged = true; }
+/**
+ * Exec buffer pool for one device
+ *
+ * Buffers are owned by the pool and never deleted, a free buffer
+ * is in the pool's freelist.
+ */
+class device_pool
+{
+  xrt::device* m_device;
+  std::mutex m_mutex;
+  std::mutex m_alloc_mutex;  // allocExecBuffer is not thread safe
+  std::vector<exec_buffer*> m_freelist;
+  std::vector<std::unique_ptr<exec_buffer>> m_buffers;
+
+public:
+  std::atomic<size_t> reserved {0};
+  std::atomic<size_t> in_use {0};
+  std::atomic<size_t> hits {0};
+  std::atomic<size_t> misses {0};
+
+  explicit
+  device_pool(xrt::device* device)
+    : m_device(device)
+  {}
+
+  xrt::device*
+  get_device() const
+  {
+    return m_device;
+  }
+
+  // Allocate device exec buffer object for a pool buffer
+  void
+  alloc(exec_buffer* buffer)
+  {
+    std::lock_guard<std::mutex> lk(m_alloc_mutex);
+    buffer->bo = m_device->allocExecBuffer(packet_words*sizeof(uint32_t));
+    buffer->data = m_device->map(buffer->bo);
+    buffer->used = packet_words;
+  }
+
+  exec_buffer*
+  create()
+  {
+    std::unique_ptr<exec_buffer> buffer(new exec_buffer);
+    alloc(buffer.get());
+    buffer->in_use = true;
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_buffers.emplace_back(std::move(buffer));
+    return m_buffers.back().get();
+  }
+
+  exec_buffer*
+  get()
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_freelist.empty())
+      return nullptr;
+    auto buffer = m_freelist.back();
+    m_freelist.pop_back();
+    buffer->in_use = true;
+    return buffer;
+  }
+
+  void
+  put(exec_buffer* buffer)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    buffer->in_use = false;
+    m_freelist.push_back(buffer);
+  }
+
+  void
+  reserve(size_t count)
+  {
+    while (size() < count) {
+      put(create());
+      ++reserved;
+    }
+  }
+
+  size_t
+  size()
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_buffers.size();
+  }
+
+  // Release device buffer objects of all buffers not in use.
+  // Buffers with released objects are reallocated on next use.
+  void
+  purge()
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    for (auto& buffer : m_buffers) {
+      if (!buffer->in_use) {
+        buffer->bo.reset();
+        buffer->data = nullptr;
+      }
+    }
+  }
 };
 
-static X sx;
+////////////////////////////////////////////////////////////////
+// Device pools are append only, lookup is lock free
+////////////////////////////////////////////////////////////////
+static std::mutex s_mutex;
+static const size_t max_devices = 64;
+static std::array<device_pool*,max_devices> s_pools;
+static std::atomic<size_t> s_num_pools(0);
+
+static device_pool*
+get_pool(const xrt::device* device)
+{
+  auto num = s_num_pools.load(std::memory_order_acquire);
+  for (size_t i=0; i<num; ++i)
+    if (s_pools[i]->get_device()==device)
+      return s_pools[i];
+  return nullptr;
+}
 
-static buffer_type
-get_buffer(xrt::device* device,size_t sz)
+static device_pool*
+get_or_create_pool(xrt::device* device)
 {
+  if (auto pool = get_pool(device))
+    return pool;
+
   std::lock_guard<std::mutex> lk(s_mutex);
+  if (auto pool = get_pool(device))
+    return pool;
+  auto num = s_num_pools.load();
+  if (num==max_devices)
+    throw std::runtime_error("command: too many devices");
+  s_pools[num] = new device_pool(device);
+  s_num_pools.store(num+1,std::memory_order_release);
+  return s_pools[num];
+}
 
-  auto itr = sx.freelist.find(device);
-  if (itr != sx.freelist.end()) {
-    auto& freelist = (*itr).second;
-    if (!freelist.empty()) {
-      auto buffer = freelist.back();
-      freelist.pop_back();
-      return buffer;
-    }
+static exec_buffer*
+get_buffer(xrt::device* device)
+{
+  auto pool = get_or_create_pool(device);
+
+  auto buffer = pool->get();
+
+  if (buffer) {
+    ++pool->hits;
+    if (!buffer->bo)  // purged
+      pool->alloc(buffer);
+  }
+  else {
+    ++pool->misses;
+    buffer = pool->create();
   }
 
-  return device->allocExecBuffer(sz); // not thread safe
+  ++pool->in_use;
+  return buffer;
 }
 
 static void
-free_buffer(xrt::device* device,buffer_type bo)
+free_buffer(xrt::device* device, exec_buffer* buffer)
 {
-  std::lock_guard<std::mutex> lk(s_mutex);
-  s_purged=false;
-  sx.freelist[device].emplace_back(std::move(bo));
+  auto pool = get_pool(device);
+  s_purged = false;
+  --pool->in_use;
+  pool->put(buffer);
 }
 
 } // namespace
@@ -79,23 +239,51 @@ purge_command_freelist()
   if (s_purged)
     return;
 
-  for (auto& elem : sx.freelist)
-    elem.second.clear();
+  for (size_t i=0, num=s_num_pools; i<num; ++i) {
+    auto pool = s_pools[i];
+    XRT_DEBUG(std::cout,"xrt::command pool for device '",pool->get_device()->getName(),"'"
+              ,", buffers: ",pool->size()
+              ,", reserved: ",pool->reserved
+              ,", hits: ",pool->hits
+              ,", misses: ",pool->misses,"\n");
+    pool->purge();
+  }
 
   s_purged = true;
 }
 
+void
+reserve_command_freelist(xrt::device* device, size_t count)
+{
+  get_or_create_pool(device)->reserve(count);
+}
+
+command_pool_stats
+get_command_pool_stats(const xrt::device* device)
+{
+  command_pool_stats stats;
+  if (auto pool = get_pool(device)) {
+    stats.buffers = pool->size();
+    stats.reserved = pool->reserved;
+    stats.in_use = pool->in_use;
+    stats.hits = pool->hits;
+    stats.misses = pool->misses;
+  }
+  return stats;
+}
+
 command::
 command(xrt::device* device, ert_cmd_opcode opcode)
   : m_device(device)
-  , m_exec_bo(get_buffer(m_device,regmap_size*sizeof(value_type)))
-  , m_packet(m_device->map(m_exec_bo))
+  , m_buffer(get_buffer(m_device))
+  , m_exec_bo(m_buffer->bo)
+  , m_packet(m_buffer->data)
 {
   static unsigned int uid_count = 0;
   m_uid = uid_count++;
 
-  // Clear in case packet was recycled
-  m_packet.clear();
+  // Clear words used by previous command if packet was recycled
+  m_packet.clear(m_buffer->used);
 
   auto epacket = get_ert_cmd<ert_packet*>();
   epacket->state = ERT_CMD_STATE_NEW; // new command
@@ -109,19 +297,25 @@ command(xrt::device* device, ert_cmd_opcode opcode)
 command::
 command(command&& rhs)
   : m_uid(rhs.m_uid), m_device(rhs.m_device)
+  , m_buffer(rhs.m_buffer)
   , m_exec_bo(std::move(rhs.m_exec_bo))
   , m_packet(std::move(rhs.m_packet))
 {
+  rhs.m_buffer = nullptr;
   rhs.m_exec_bo = 0;
 }
 
 command::
 ~command()
 {
-  if (m_exec_bo) {
+  if (m_buffer) {
     XRT_DEBUG(std::cout,"xrt::command::~command(",m_uid,")\n");
-    m_device->unmap(m_exec_bo);
-    free_buffer(m_device,m_exec_bo);
+
+    // Words written through the packet API or declared in the
+    // packet header payload count, whichever is larger
+    auto epacket = get_ert_cmd<ert_packet*>();
+    m_buffer->used = std::min(packet_words,std::max(m_packet.size(),size_t(epacket->count)+1));
+    free_buffer(m_device,m_buffer);
   }
 }
 
@@ -26,6 +26,10 @@
 
 namespace xrt {
 
+namespace detail {
+struct exec_buffer;
+}
+
 /**
  * Command class for command format used by scheduler.
  *
@@ -217,6 +221,7 @@ public:
 private:
   unsigned int m_uid;
   xrt::device* m_device;
+  detail::exec_buffer* m_buffer;
   buffer_type m_exec_bo;
   mutable packet_type m_packet;
 
@@ -249,6 +254,36 @@ command_cast(const std::shared_ptr<command>& cmd)
 void
 purge_command_freelist();
 
+/**
+ * Preallocate exec buffer objects for commands on device
+ *
+ * @device: device on which to allocate exec buffers
+ * @count: minimum number of exec buffers in pool for device
+ */
+void
+reserve_command_freelist(xrt::device* device, size_t count);
+
+/**
+ * Statistics of exec buffer pool for a device
+ *
+ * @buffers:  number of exec buffers allocated from device
+ * @reserved: number of exec buffers preallocated
+ * @in_use:   number of exec buffers currently used by commands
+ * @hits:     number of commands that got a recycled exec buffer
+ * @misses:   number of commands that allocated a new exec buffer
+ */
+struct command_pool_stats
+{
+  size_t buffers = 0;
+  size_t reserved = 0;
+  size_t in_use = 0;
+  size_t hits = 0;
+  size_t misses = 0;
+};
+
+command_pool_stats
+get_command_pool_stats(const xrt::device* device);
+
 } // xrt
 
 #endif
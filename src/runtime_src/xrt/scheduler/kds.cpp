@@ -37,13 +37,14 @@
 #include <cstring>
 #include <algorithm>
 #include <thread>
-#include <list>
-#include <map>
+#include <array>
+#include <atomic>
+#include <vector>
 
 namespace {
 
 using command_type = std::shared_ptr<xrt::command>;
-using command_queue_type = std::list<command_type>;
+using command_batch_type = std::vector<command_type>;
 
 ////////////////////////////////////////////////////////////////
 // Command notification is threaded through task queue
@@ -57,13 +58,10 @@ static bool threaded_notification = true;
 ////////////////////////////////////////////////////////////////
 // Main command monitor interfacing to embedded MB scheduler
 ////////////////////////////////////////////////////////////////
-static std::mutex s_mutex;
-static std::condition_variable s_work;
+static std::mutex s_mutex;   // protects start, stop, and init
 static bool s_running = false;
-static bool s_stop = false;
+static std::atomic<bool> s_stop(false);
 static std::exception_ptr s_exception;
-static std::map<const xrt::device*, command_queue_type> s_device_cmds;
-static std::map<const xrt::device*, std::thread> s_device_monitor_threads;
 
 inline bool
 is_51_dsa(const xrt::device* device)
@@ -79,109 +77,240 @@ is_command_done(const command_type& cmd)
   return epacket->state >= ERT_CMD_STATE_COMPLETED;
 }
 
-static bool
-check(const command_type& cmd)
+static void
+notify(const command_batch_type& cmds)
 {
-  if (!is_command_done(cmd))
-    return false;
-
-  XRT_DEBUG(std::cout,"xrt::kds::command(",cmd->get_uid(),") [running->done]\n");
-  if (!threaded_notification) {
+  for (auto& cmd : cmds) {
+    XRT_DEBUG(std::cout,"xrt::kds::command(",cmd->get_uid(),") [running->done]\n");
     cmd->notify(ERT_CMD_STATE_COMPLETED);
-    return true;
   }
-
-  auto notify = [](command_type c) {
-    c->notify(ERT_CMD_STATE_COMPLETED);
-  };
-
-  xrt::task::createF(notify_queue,notify,cmd);
-  return true;
 }
 
-static void
-launch(command_type cmd)
+/**
+ * Submitted commands of one device
+ *
+ * Commands are stored in slots, a bitmap tracks which slots are
+ * occupied so the monitor only inspects commands in flight, and a
+ * completed command is released by clearing one bit.  Each device
+ * has its own lock, launching and monitoring commands on one device
+ * does not block other devices.
+ */
+class device_monitor
 {
-  XRT_DEBUG(std::cout,"xrt::kds::command(",cmd->get_uid(),") [new->submitted->running]\n");
-
-  // Submit the command
-  auto device = cmd->get_device();
-  auto exec_bo = cmd->get_exec_bo();
-  device->exec_buf(exec_bo);
-
-  // thread safe access, since guaranteed to be inserted in init
-  auto& submitted_cmds = s_device_cmds[device];
-
-  // Store command so completion can be tracked
-  std::lock_guard<std::mutex> lk(s_mutex);
-  submitted_cmds.push_back(cmd);
-  s_work.notify_all();
-}
+  using bitmask_type = uint64_t;
+  static constexpr size_t mask_bits = 64;
+
+  const xrt::device* m_device;
+  std::mutex m_mutex;
+  std::condition_variable m_work;
+  std::vector<command_type> m_slots;
+  std::vector<bitmask_type> m_busy;   // bit per occupied slot
+  size_t m_count = 0;                 // number of occupied slots
+  size_t m_hint = 0;                  // mask index to search first
+  std::thread m_thread;
+
+  // Find free slot, grow if necessary.  Caller holds lock.
+  size_t
+  get_free_slot()
+  {
+    auto masks = m_busy.size();
+    for (size_t i=0; i<masks; ++i) {
+      auto idx = (m_hint+i) % masks;
+      auto free = ~m_busy[idx];
+      if (free) {
+        m_hint = idx;
+        return idx*mask_bits + __builtin_ctzll(free);
+      }
+    }
 
-static void
-monitor_loop(const xrt::device* device)
-{
-  unsigned long loops = 0;           // number of outer loops
-  unsigned long sleeps = 0;          // number of sleeps
+    // all slots are busy
+    m_busy.resize(masks ? 2*masks : 1, 0);
+    m_slots.resize(m_busy.size()*mask_bits);
+    m_hint = masks;
+    return masks*mask_bits;
+  }
 
-  // thread safe access, since guaranteed to be inserted in init
-  auto& submitted_cmds = s_device_cmds[device];
+  // Collect and release completed commands
+  void
+  collect(command_batch_type& completed)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    for (size_t idx=0, end=m_busy.size(); idx<end; ++idx) {
+      auto mask = m_busy[idx];
+      while (mask) {
+        auto bit = __builtin_ctzll(mask);
+        mask &= mask-1;
+        auto& cmd = m_slots[idx*mask_bits + bit];
+        if (is_command_done(cmd)) {
+          completed.push_back(std::move(cmd));
+          m_busy[idx] &= ~(bitmask_type(1) << bit);
+          --m_count;
+        }
+      }
+    }
+  }
 
-  while (1) {
-    ++loops;
+  void
+  monitor_loop()
+  {
+    command_batch_type completed;
 
-    {
+    while (1) {
       {
-        std::unique_lock<std::mutex> lk(s_mutex);
+        std::unique_lock<std::mutex> lk(m_mutex);
 
         // Larger wait
-        while (!s_stop && submitted_cmds.empty()) {
-          ++sleeps;
-          s_work.wait(lk);
-        }
+        while (!s_stop && !m_count)
+          m_work.wait(lk);
       }
 
       if (s_stop)
         return;
 
-      // Finer wait
-      while (device->exec_wait(1000)==0) ;
+      // Finer wait, rescan all commands on timeout as well in case
+      // a completion was consumed before its command was collected
+      m_device->exec_wait(1000);
 
-      std::lock_guard<std::mutex> lk(s_mutex);
-      auto end = submitted_cmds.end();
-      for (auto itr=submitted_cmds.begin(); itr!=end; ) {
-        auto& cmd = (*itr);
-        if (check(cmd)) {
-          itr = submitted_cmds.erase(itr);
-          end = submitted_cmds.end();
-        }
-        else {
-          ++itr;
-        }
-      }
+      collect(completed);
+      if (completed.empty())
+        continue;
+
+      // Notify outside lock as one batch
+      if (!threaded_notification)
+        notify(completed);
+      else
+        xrt::task::createF(notify_queue,&notify,std::move(completed));
+
+      completed.clear();
     }
   }
-}
 
+  void
+  monitor()
+  {
+    try {
+      monitor_loop();
+    }
+    catch (const std::exception& ex) {
+      std::string msg = std::string("kds command monitor died unexpectedly: ") + ex.what();
+      xrt::send_exception_message(msg.c_str());
+      s_exception = std::current_exception();
+    }
+    catch (...) {
+      xrt::send_exception_message("kds command monitor died unexpectedly");
+      s_exception = std::current_exception();
+    }
+  }
 
-static void
-monitor(const xrt::device* device)
-{
-  try {
-    monitor_loop(device);
+public:
+  explicit
+  device_monitor(const xrt::device* device)
+    : m_device(device)
+  {
+    XRT_DEBUG(std::cout,"creating monitor thread and queue for device '",device->getName(),"'\n");
+    m_thread = xrt::thread(&device_monitor::monitor,this);
+  }
+
+  const xrt::device*
+  get_device() const
+  {
+    return m_device;
   }
-  catch (const std::exception& ex) {
-    std::string msg = std::string("kds command monitor died unexpectedly: ") + ex.what();
-    xrt::send_exception_message(msg.c_str());
-    s_exception = std::current_exception();
+
+  void
+  submit(command_type cmd)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto slot = get_free_slot();
+    m_slots[slot] = std::move(cmd);
+    m_busy[slot/mask_bits] |= bitmask_type(1) << (slot%mask_bits);
+    if (++m_count==1)
+      m_work.notify_all();
   }
-  catch (...) {
-    xrt::send_exception_message("kds command monitor died unexpectedly");
-    s_exception = std::current_exception();
+
+  template <typename ITR>
+  void
+  submit(ITR first, ITR last)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto count = m_count;
+    for (; first!=last; ++first) {
+      auto slot = get_free_slot();
+      m_slots[slot] = *first;
+      m_busy[slot/mask_bits] |= bitmask_type(1) << (slot%mask_bits);
+      ++m_count;
+    }
+    if (!count && m_count)
+      m_work.notify_all();
   }
+
+  void
+  stop()
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_work.notify_all();
+    }
+    if (m_thread.joinable())
+      m_thread.join();
+  }
+};
+
+////////////////////////////////////////////////////////////////
+// Device monitors are added in init and never removed.  The
+// array is append only so lookup by launch is lock free.
+////////////////////////////////////////////////////////////////
+static const size_t max_devices = 64;
+static std::array<std::unique_ptr<device_monitor>,max_devices> s_monitors;
+static std::atomic<size_t> s_num_monitors(0);
+
+static device_monitor*
+get_monitor(const xrt::device* device)
+{
+  auto num = s_num_monitors.load(std::memory_order_acquire);
+  for (size_t i=0; i<num; ++i)
+    if (s_monitors[i]->get_device()==device)
+      return s_monitors[i].get();
+  return nullptr;
+}
+
+static void
+launch(command_type cmd)
+{
+  XRT_DEBUG(std::cout,"xrt::kds::command(",cmd->get_uid(),") [new->submitted->running]\n");
+
+  // Store command before submitting so completion is tracked
+  // even if device completes command right away, monitor is
+  // guaranteed to have been created in init
+  auto device = cmd->get_device();
+  auto exec_bo = cmd->get_exec_bo();
+  get_monitor(device)->submit(std::move(cmd));
+
+  // Submit the command
+  device->exec_buf(exec_bo);
 }
 
-static std::thread s_monitor;
+static void
+launch(const command_batch_type& cmds)
+{
+  // Consecutive commands on same device are submitted with one call
+  std::vector<xrt::device::ExecBufferObjectHandle> exec_bos;
+  for (auto itr=cmds.begin(), end=cmds.end(); itr!=end; ) {
+    auto device = (*itr)->get_device();
+    auto last = std::find_if(itr,end,[device](const command_type& cmd) { return cmd->get_device()!=device; });
+
+    exec_bos.clear();
+    for (auto cmd=itr; cmd!=last; ++cmd) {
+      XRT_DEBUG(std::cout,"xrt::kds::command(",(*cmd)->get_uid(),") [new->submitted->running]\n");
+      exec_bos.push_back((*cmd)->get_exec_bo());
+    }
+
+    // Store commands before submitting, see single command launch
+    get_monitor(device)->submit(itr,last);
+    device->exec_buf(exec_bos);
+    itr = last;
+  }
+}
 
 } // namespace
 
@@ -194,6 +323,12 @@ schedule(const command_type& cmd)
   launch(cmd);
 }
 
+void
+schedule_batch(const std::vector<command_type>& cmds)
+{
+  launch(cmds);
+}
+
 void
 start()
 {
@@ -212,14 +347,10 @@ stop()
   if (!s_running)
     return;
 
-  {
-    std::lock_guard<std::mutex> lk(s_mutex);
-    s_stop = true;
-  }
-
-  s_work.notify_all();
-  for (auto& e : s_device_monitor_threads)
-    e.second.join();
+  std::lock_guard<std::mutex> lk(s_mutex);
+  s_stop = true;
+  for (size_t i=0, num=s_num_monitors; i<num; ++i)
+    s_monitors[i]->stop();
 
   notify_queue.stop();
   if (threaded_notification)
@@ -273,14 +404,14 @@ init(xrt::device* device, size_t regmap_size, bool cu_isr, size_t num_cus, size_
   while (!is_command_done(configure))
     while (device->exec_wait(1000)==0) ;
 
-  // create a submitted command queue for this device if necessary,
-  // create a command monitor thread for this device if necessary
+  // create a command monitor for this device if necessary
   std::lock_guard<std::mutex> lk(s_mutex);
-  auto itr = s_device_monitor_threads.find(device);
-  if (itr==s_device_monitor_threads.end()) {
-    XRT_DEBUG(std::cout,"creating monitor thread and queue for device '",device->getName(),"'\n");
-    s_device_cmds.emplace(device,command_queue_type());
-    s_device_monitor_threads.emplace(device,xrt::thread(::monitor,device));
+  if (!get_monitor(device)) {
+    auto num = s_num_monitors.load();
+    if (num==max_devices)
+      throw std::runtime_error("kds: too many devices");
+    s_monitors[num].reset(new device_monitor(device));
+    s_num_monitors.store(num+1,std::memory_order_release);
   }
 
   XRT_DEBUG(std::cout,"configure complete\n");
@@ -138,12 +138,24 @@ schedule(const command_type& cmd)
     sws::schedule(cmd);
 }
 
+void
+schedule_batch(const std::vector<command_type>& cmds)
+{
+  if (kds_enabled())
+    kds::schedule_batch(cmds);
+  else
+    sws::schedule_batch(cmds);
+}
+
 void
 init(xrt::device* device, size_t regmap_size, bool cu_isr, size_t num_cus, size_t cu_offset, size_t cu_base_addr, const std::vector<uint32_t>& cu_addr_map)
 {
   emu_50_disable_kds(device);
   aws_50_disable_kds(device);
 
+  // Preallocate exec buffers to avoid allocation on first launches
+  reserve_command_freelist(device,xrt::config::get_command_pool_size());
+
   if (kds_enabled())
     kds::init(device,regmap_size,cu_isr,num_cus,cu_offset,cu_base_addr,cu_addr_map);
   else
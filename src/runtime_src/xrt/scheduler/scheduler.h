@@ -52,6 +52,13 @@ init(xrt::device* device, size_t slot_size, size_t num_cus, size_t cu_offset, si
 void 
 schedule(const command_type& cmd);
 
+/**
+ * Schedule several commands for execution, same as scheduling
+ * each command in order
+ */
+void
+schedule_batch(const std::vector<command_type>& cmds);
+
 } // sws
 
 /**
@@ -81,6 +88,15 @@ namespace kds {
 void 
 schedule(const command_type& cmd);
 
+/**
+ * Schedule several commands for execution
+ *
+ * The exec buffers of consecutive commands on the same device are
+ * submitted to the driver in one call.
+ */
+void
+schedule_batch(const std::vector<command_type>& cmds);
+
 void
 start();
 
@@ -99,6 +115,15 @@ namespace scheduler {
 void 
 schedule(const command_type& cmd);
 
+/**
+ * Schedule several commands for execution on either sws or mbs
+ *
+ * Commands are started in order, consecutive commands on the
+ * same device may be submitted with one driver call.
+ */
+void
+schedule_batch(const std::vector<command_type>& cmds);
+
 void
 start();
 
@@ -19,6 +19,12 @@
  *
  * This is a software model of the firmware for the embedded
  * scheduler.  It is used for DSAs without MB and for emulation.
+ *
+ * Each device has its own scheduler state.  By default one
+ * scheduler thread services all devices, with sdaccel.ini
+ *   [Runtime]
+ *   sws_thread_per_device = true
+ * each device is serviced by its own polling thread.
  */
 
 #include "xrt/config.h"
@@ -27,9 +33,11 @@
 #include "xrt/util/task.h"
 #include "command.h"
 #include <limits>
-#include <bitset>
+#include <array>
+#include <atomic>
 #include <vector>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <condition_variable>
 
@@ -47,7 +55,8 @@ using command_type = std::shared_ptr<xrt::command>;
 // Constants
 ////////////////////////////////////////////////////////////////
 const size_type max_cus = 128;
-using bitmask_type = std::bitset<max_cus>;
+const size_type mask_bits = 64;
+const size_type num_masks = max_cus/mask_bits;
 
 // FFA  handling
 const size_type CONTROL_AP_START=1;
@@ -60,24 +69,6 @@ const size_type CONTROL_AP_IDLE=4;
 const value_type CMD_START_KERNEL = 0;
 const value_type CMD_CONFIGURE = 1;
 
-////////////////////////////////////////////////////////////////
-// Configuarable constants
-////////////////////////////////////////////////////////////////
-// Actual number of cus
-static size_type num_cus = 0;
-
-// CU base address
-static addr_type cu_base_address = 0x0;
-
-// CU offset (addone is 32k (1<<15), OCL is 4k (1<<12))
-static size_type cu_offset = 12;
-
-// Enable features via  configure_mb
-static value_type cu_trace_enabled = 0;
-
-// Mapping from cu_idx to its base address
-static std::vector<uint32_t> cu_addr_map;
-
 ////////////////////////////////////////////////////////////////
 // Helper functions for extracting command header information
 ////////////////////////////////////////////////////////////////
@@ -118,13 +109,78 @@ regmap_size(value_type header_value)
 }
 
 /**
- * Convert cu idx into cu address
+ * Bitmask of max_cus bits with find first set support
  */
-inline addr_type
-cu_idx_to_addr(size_type cu_idx)
+struct bitmask_type
 {
-  return cu_addr_map[cu_idx];
-}
+  std::array<uint64_t,num_masks> m_bits {{0}};
+
+  void
+  set(size_type bit)
+  {
+    m_bits[bit/mask_bits] |= uint64_t(1) << (bit%mask_bits);
+  }
+
+  void
+  reset(size_type bit)
+  {
+    m_bits[bit/mask_bits] &= ~(uint64_t(1) << (bit%mask_bits));
+  }
+
+  void
+  reset()
+  {
+    m_bits.fill(0);
+  }
+
+  // Set 32 bit word at word index of the mask
+  void
+  set_word(size_type idx, value_type word)
+  {
+    m_bits[idx/2] |= uint64_t(word) << (32*(idx%2));
+  }
+
+  value_type
+  get_word(size_type idx) const
+  {
+    return (m_bits[idx/2] >> (32*(idx%2))) & 0xFFFFFFFF;
+  }
+
+  /**
+   * Index of first bit set in (this & ~rhs), or max_cus if none
+   */
+  size_type
+  first_set_not_in(const bitmask_type& rhs) const
+  {
+    for (size_type i=0; i<num_masks; ++i)
+      if (auto bits = m_bits[i] & ~rhs.m_bits[i])
+        return i*mask_bits + __builtin_ctzll(bits);
+    return max_cus;
+  }
+
+  template <typename F>
+  void
+  for_each_set(F&& f) const
+  {
+    for (size_type i=0; i<num_masks; ++i) {
+      auto bits = m_bits[i];
+      while (bits) {
+        auto bit = __builtin_ctzll(bits);
+        bits &= bits-1;
+        f(i*mask_bits + bit);
+      }
+    }
+  }
+
+  bool
+  any() const
+  {
+    for (auto bits : m_bits)
+      if (bits)
+        return true;
+    return false;
+  }
+};
 
 struct slot_info
 {
@@ -156,7 +212,7 @@ struct slot_info
     return cmd->get_packet();
   }
 
-  void start(size_type cu)
+  void start(size_type cu, bool cu_trace_enabled)
   {
     // update cus to reflect running cu
     cus.reset();
@@ -167,9 +223,8 @@ struct slot_info
     if (cu_trace_enabled) {
       auto& packet = get_packet();
       auto cumasks = cu_masks(header_value);
-      for (size_type i=0; i<cumasks; ++i) {
-        packet[1+i] = ((cus>>(sizeof(value_type)*8*i)).to_ulong()) & 0xFFFFFFFF;
-      }
+      for (size_type i=0; i<cumasks; ++i)
+        packet[1+i] = cus.get_word(i);
     }
 
     // Invoke command callback
@@ -177,6 +232,8 @@ struct slot_info
   }
 };
 
+using slot_list = std::list<slot_info>;
+
 // Command notification is threaded through task queue
 // and notifier.  This allows the scheduler to continue
 // while host callback can be processed in the background
@@ -184,38 +241,6 @@ static xrt::task::queue notify_queue;
 static std::thread notifier;
 static bool threaded_notification = true;
 
-static std::list<slot_info> command_queue;
-
-// Fixed sized map from cu_idx -> slot_info
-static const slot_info* cu_slot_usage[max_cus];
-
-// Bitmask indicating status of CUs. (0) idle, (1) running.
-// Only 'num_cus' lower bits are used
-static bitmask_type cu_status;
-
-// Track runtime of each cu
-static uint64_t cu_total_runtime[max_cus] = {0};
-static uint64_t cu_start_time[max_cus] = {0};
-static uint64_t cu_stop_time[max_cus] = {0};
-
-
-/**
- * MB configuration
- */
-static void
-setup()
-{
-  command_queue.clear();
-
-  // Initialize cu_slot_usage
-  for (size_type i=0; i<num_cus; ++i) {
-    cu_slot_usage[i] = nullptr;
-    cu_total_runtime[i] = 0;
-    cu_start_time[i] = 0;
-    cu_stop_time[i] = 0;
-  }
-}
-
 /**
  * Notify host of command completion
  *
@@ -247,295 +272,416 @@ notify_host(slot_info* slot)
   xrt::task::createF(notify_queue,notify,slot->cmd);
 }
 
-/**
- * Configure a CU at argument address
- *
- * Write register map to CU control register at address
- *
- * @param cu_addr
- *  Address of CU control register
- * @param regmap_addr
- *  The address of the register map to copy into the CU control
- *  register
- * @param regmap_size
- *  The size of register map in 32 bit words
- */
-inline void
-configure_cu(slot_info* slot, size_type cu)
-{
-  auto cu_addr = cu_idx_to_addr(cu);
-  auto size = regmap_size(slot->header_value);
-
-  // data past header and cu_masks
-  auto regmap = slot->get_packet().data() + 1 + cu_masks(slot->header_value);
-
-  // write register map, starting at base + 0xC
-  // 0x4, 0x8 used for interrupt, which is initialized in setu
-  slot->device->write_register(cu_addr,regmap,size*4);
-
-  // start cu
-  const_cast<uint32_t*>(regmap)[0] = 1;
-  slot->device->write_register(cu_addr,regmap,size*4);
-}
+class device_scheduler;
 
 /**
- * Start a cu for command in slot
+ * Scheduler thread servicing one or more devices
  *
- * @param slot_idx
- *  Index of command
- * @return
- *  True of a CU was started, false otherwise
+ * New commands are added to the devices under the thread's lock,
+ * all other scheduler state is accessed by the thread only.
  */
-static bool
-start_cu(slot_info* slot)
+struct scheduler_thread
 {
-  auto cus = slot->cus;
-
-  // Check all CUs against argument cus mask and against cu_status
-  for (size_type cu=0; cu<num_cus; ++cu) {
-    if (cus.test(cu) && !cu_status.test(cu)) {
-      slot->start(cu);           // note that slot is starting on cu
-      configure_cu(slot,cu);
-      cu_status.flip(cu);        // toggle cu status bit, it is now busy
-      cu_slot_usage[cu] = slot;
-      return true;
+  std::mutex m_mutex;
+  std::condition_variable m_work;
+  std::vector<device_scheduler*> m_devices;
+  std::atomic<bool> m_pending {false}; // new commands or devices
+  bool m_stop = false;
+  std::thread m_thread;
+
+  void
+  run();
+
+  void
+  start()
+  {
+    m_stop = false;
+    m_thread = xrt::thread(&scheduler_thread::run,this);
+  }
+
+  void
+  stop()
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_stop = true;
     }
+    m_work.notify_one();
+    if (m_thread.joinable())
+      m_thread.join();
   }
-  return false;
-}
+};
 
 /**
- * Check CU status
+ * Software model of the embedded scheduler for one device
  *
- * CU to check is indicated by bit position in argument cu_mask.
- *
- * If CU is done, then host status register is updated accordingly
- * and internal cu_status register that tracks running CUs is toggled
- * at corresponding position.
- *
- * @param cu_mask
- *   A bitmask with 1 bit set. Position of bit indicates the CU to check
- * @return
- *   True if CU is done, false otherwise
+ * Started commands move from the ready list to the running list.
+ * A free CU for a command is found with find-first-set over the
+ * command's CU mask and the CU status mask, and only running CUs
+ * are polled for completion.
  */
-static bool
-check_cu(slot_info* slot,bool wait=false)
+class device_scheduler
 {
-  auto device = slot->device;
-  auto& cu_mask = slot->cus;
-
-  // find cu idx in mask
-  size_type cu_idx = 0;
-  for (; !cu_mask.test(cu_idx); ++cu_idx);
-  XRT_ASSERT(cu_idx < num_cus,"bad cu idx");
-  XRT_ASSERT(cu_status.test(cu_idx),"cu wasn't started");
-  auto cu_addr = cu_idx_to_addr(cu_idx);
-  value_type ctrlreg = 0;
-
-  do {
-    device->read_register(cu_addr,&ctrlreg,4);
-    if (ctrlreg & (CONTROL_AP_IDLE | CONTROL_AP_DONE)) {
-      cu_status.flip(cu_idx);
-      cu_slot_usage[cu_idx] = nullptr;
-      return true;
-    }
-  } while (wait);
+  xrt::device* m_device;
+  scheduler_thread* m_thread = nullptr;
 
-  return false;
-}
+  // Actual number of cus
+  size_type m_num_cus = 0;
 
-/**
- * Check if queue is idle except for command in argument slot
- */
-static bool
-check_idle_prereq(slot_info* slot)
-{
-  auto end=command_queue.end();
-  for (auto itr=command_queue.begin(); itr!=end; ++itr) {
-    auto s = &(*itr);
-    if (s==slot)
-      continue;
-    if ((s->header_value & 0xF) != 0x4) {
-      XRT_DEBUGF("slot(%d) is busy\n",s->get_uid());
-      return false;
-    }
+  // CU base address
+  addr_type m_cu_base_address = 0x0;
+
+  // CU offset (addone is 32k (1<<15), OCL is 4k (1<<12))
+  size_type m_cu_offset = 12;
+
+  // Enable features via  configure_mb
+  value_type m_cu_trace_enabled = 0;
+
+  // Mapping from cu_idx to its base address
+  std::vector<uint32_t> m_cu_addr_map;
+
+  // Commands added by host, protected by scheduler thread lock
+  std::vector<command_type> m_new;
+
+  // Commands waiting for a CU, and commands running on a CU
+  slot_list m_ready;
+  slot_list m_running;
+
+  // Fixed sized map from cu_idx -> running slot
+  std::array<slot_list::iterator,max_cus> m_cu_slot;
+
+  // Bitmask indicating status of CUs. (0) idle, (1) running.
+  // Only 'm_num_cus' lower bits are used
+  bitmask_type m_cu_status;
+
+  // Bitmask with 'm_num_cus' lower bits set
+  bitmask_type m_cu_all;
+
+  /**
+   * Convert cu idx into cu address
+   */
+  addr_type
+  cu_idx_to_addr(size_type cu_idx) const
+  {
+    return m_cu_addr_map[cu_idx];
   }
 
-  return true;
-}
+  bool
+  all_cus_busy() const
+  {
+    return m_cu_all.first_set_not_in(m_cu_status) == max_cus;
+  }
 
+  /**
+   * MB configuration
+   */
+  void
+  setup()
+  {
+    m_cu_status.reset();
+    m_cu_all.reset();
+    for (size_type cu=0; cu<m_num_cus; ++cu)
+      m_cu_all.set(cu);
+  }
 
-/**
- * Configure MB and peripherals
- *
- * Wait for CONFIGURE_MB in specified slot, then configure as
- * requested.
- *
- * This function is used in two different scenarios:
- *  1. MB reset/startup, in which case the CONFIGURE_MB is guaranteed
- *     to be in a slot at default slot offset (4K), most likely slot 0.
- *  2. During regular scheduler loop, in which case the CONFIGURE_MB
- *     packet is at an arbitrary slot location.   In this scenario, the
- *     function may return (false) without processing the command if
- *     other commands are currently executing; this is to avoid hardware
- *     lockup.
- *
- * @param slot_idx
- *   The slot index with the CONFIGURE_MB command
- * @return
- *   True if CONFIGURE_MB packet was processed, false otherwise
- */
-static bool
-configure(slot_info* slot)
-{
-  // Ignore the CONFIGURE packet if any commands are
-  // currently being processed.  The main scheduler loop
-  // will revisit the CONFIGURE packet again in case 2).
-  if (!check_idle_prereq(slot))
-    return false;
+  /**
+   * Configure a CU at argument address
+   *
+   * Write register map to CU control register at address
+   */
+  void
+  configure_cu(slot_info* slot, size_type cu)
+  {
+    auto cu_addr = cu_idx_to_addr(cu);
+    auto size = regmap_size(slot->header_value);
 
-  XRT_DEBUGF("configure found)\n");
-  XRT_DEBUGF("slot(%d) [new->queued]\n",slot->get_uid());
-  XRT_DEBUGF("slot(%d) [queued->running]\n",slot->get_uid());
+    // data past header and cu_masks
+    auto regmap = slot->get_packet().data() + 1 + cu_masks(slot->header_value);
 
-  auto& packet = slot->get_packet();
-  num_cus=packet[2];
-  cu_offset=packet[3];
-  cu_base_address=packet[4];
+    // write register map, starting at base + 0xC
+    // 0x4, 0x8 used for interrupt, which is initialized in setu
+    m_device->write_register(cu_addr,regmap,size*4);
 
-  // Features
-  auto features = packet[5];
-  cu_trace_enabled = features & 0x8;
+    // start cu
+    const_cast<uint32_t*>(regmap)[0] = 1;
+    m_device->write_register(cu_addr,regmap,size*4);
+  }
 
-  // (Re)initilize MB
-  setup();
+  /**
+   * Start a cu for command in ready list
+   *
+   * @return
+   *  True of a CU was started, false otherwise
+   */
+  bool
+  start_cu(slot_list::iterator itr)
+  {
+    auto slot = &(*itr);
+    auto cu = slot->cus.first_set_not_in(m_cu_status);
+    if (cu >= m_num_cus)
+      return false;
 
-  // notify host
-  notify_host(slot);
+    slot->start(cu,m_cu_trace_enabled); // note that slot is starting on cu
+    configure_cu(slot,cu);
+    m_cu_status.set(cu);                // cu is now busy
+    m_running.splice(m_running.end(),m_ready,itr);
+    m_cu_slot[cu] = itr;
+    return true;
+  }
 
-  slot->header_value = (slot->header_value & ~0xF) | 0x4; // free
-  XRT_DEBUGF("slot(%d) [running->free]\n",slot->get_uid());
+  /**
+   * Check CU status
+   *
+   * If CU is done, then host is notified, the internal cu_status
+   * register that tracks running CUs is toggled and the slot is
+   * released.
+   *
+   * @return
+   *   True if CU is done, false otherwise
+   */
+  bool
+  check_cu(size_type cu_idx)
+  {
+    value_type ctrlreg = 0;
+    m_device->read_register(cu_idx_to_addr(cu_idx),&ctrlreg,4);
+    if (!(ctrlreg & (CONTROL_AP_IDLE | CONTROL_AP_DONE)))
+      return false;
 
-  return true;
-}
+    auto itr = m_cu_slot[cu_idx];
+    auto slot = &(*itr);
+    notify_host(slot);
+    XRT_DEBUGF("slot(%d) [running->free]\n",slot->get_uid());
+    m_cu_status.reset(cu_idx);
+    m_running.erase(itr);
+    return true;
+  }
 
-/**
- * Process special command.
- *
- * Special commands are not performace critical
- *
- * @return true
- *   If command was processed, false otherwise
- */
-static bool
-process_special_command(slot_info* slot, size_type opcode)
-{
-  if (opcode==CMD_CONFIGURE)
-    return configure(slot);
-  return false;
-}
+  /**
+   * Configure MB and peripherals
+   *
+   * The CONFIGURE packet is processed only if no other commands are
+   * currently being processed.  The main scheduler loop will revisit
+   * the CONFIGURE packet again otherwise.
+   *
+   * @return
+   *   True if CONFIGURE_MB packet was processed, false otherwise
+   */
+  bool
+  configure(slot_list::iterator itr)
+  {
+    if (!m_running.empty() || m_ready.size()!=1)
+      return false;
 
-static std::mutex s_mutex;
-static std::condition_variable s_work;
-static bool s_stop=false;
-static std::vector<command_type> s_cmds;
+    auto slot = &(*itr);
+    XRT_DEBUGF("configure found)\n");
+    XRT_DEBUGF("slot(%d) [new->queued]\n",slot->get_uid());
+    XRT_DEBUGF("slot(%d) [queued->running]\n",slot->get_uid());
 
-/**
- * Main routine executed by embedded scheduler loop
- *
- * For each command slot do
- *  1. If status is free (0x4), then read new command header
- *     Status remains free (0x4), or transitions to new (0x1)
- *  2. If status is new (0x1), then read CUs in command
- *     Status transitions to queued (0x2)
- *  3. If status is queued (0x2), then start command on available CU
- *     Status remains queued if no CUs available, or transitions to running (0x3)
- *  4. If status is running (0x4), then check CU status
- *     Status remains running (0x4) if CU is still running, or
- *     transitions to free if CU is done
- */
-static void
-scheduler_loop()
-{
-  // Basic setup will be changed by configure_mb, but is necessary
-  // for even configure_mb() to work.
-  setup();
+    auto& packet = slot->get_packet();
+    m_num_cus=packet[2];
+    m_cu_offset=packet[3];
+    m_cu_base_address=packet[4];
 
-  while (1) {
+    // Features
+    auto features = packet[5];
+    m_cu_trace_enabled = features & 0x8;
 
-    {
-      std::unique_lock<std::mutex> lk(s_mutex);
-      while (!s_stop && command_queue.empty() && s_cmds.empty())
-        s_work.wait(lk);
+    // (Re)initilize MB
+    setup();
 
-      if (s_stop) {
-        if (!command_queue.empty() || !s_cmds.empty())
-          throw std::runtime_error("software scheduler stopping while there are active commands");
-        break;
-      }
+    // notify host
+    notify_host(slot);
+    XRT_DEBUGF("slot(%d) [running->free]\n",slot->get_uid());
+    m_ready.erase(itr);
+    return true;
+  }
 
-      // copy new commands to pending list
-      std::copy(s_cmds.begin(),s_cmds.end(),std::back_inserter(command_queue));
-      s_cmds.clear();
-    } // lk scope
+public:
+  explicit
+  device_scheduler(xrt::device* device)
+    : m_device(device)
+  {}
+
+  xrt::device*
+  get_device() const
+  {
+    return m_device;
+  }
+
+  scheduler_thread*
+  get_thread() const
+  {
+    return m_thread;
+  }
+
+  void
+  set_thread(scheduler_thread* thread)
+  {
+    m_thread = thread;
+  }
+
+  void
+  init(size_t cus, size_t cuoffset, size_t cubase, const std::vector<uint32_t>& cu_amap)
+  {
+    m_num_cus = std::min<size_t>(cus,max_cus);
+    m_cu_base_address = cubase;
+    m_cu_offset = cuoffset;
+    m_cu_trace_enabled = xrt::config::get_profile();
+    m_cu_addr_map = cu_amap;
+    setup();
+  }
 
-    // iterate commands
-    auto end = command_queue.end();
-    auto nitr = command_queue.begin();
-    for (auto itr=nitr; itr!=end; itr=nitr) {
-      auto slot = &(*itr);
+  /**
+   * Add a command.  Caller holds the lock of the scheduler thread.
+   */
+  void
+  add(const command_type& cmd)
+  {
+    m_new.push_back(cmd);
+  }
 
-      if ((slot->header_value & 0xF) == 0x1) { // new
-        auto opc = opcode(slot->header_value);
-        if (opc!=CMD_START_KERNEL) { // Non performance critical command
-          process_special_command(slot,opc);
-          continue;
-        }
+  /**
+   * Move new commands to ready list.  Caller holds the lock of the
+   * scheduler thread.
+   */
+  void
+  take_new()
+  {
+    for (auto& cmd : m_new) {
+      m_ready.emplace_back(std::move(cmd));
+      auto& slot = m_ready.back();
 
+      if (opcode(slot.header_value)==CMD_START_KERNEL) {
         // Extract and cache cumask from cmd
-        size_type cumasks = cu_masks(slot->header_value);
-        for (size_type i=0; i<cumasks; ++i) {
-          auto& payload = slot->get_packet();
-          bitmask_type mask(payload[1+i]);
-          slot->cus |= (mask<<sizeof(value_type)*8*i);
-        }
-
-        slot->header_value = (slot->header_value & ~0xF) | 0x2; // queued
-        XRT_DEBUGF("slot(%d) [new->queued]\n",slot->get_uid());
+        size_type cumasks = cu_masks(slot.header_value);
+        auto& payload = slot.get_packet();
+        for (size_type i=0; i<cumasks; ++i)
+          slot.cus.set_word(i,payload[1+i]);
       }
 
-      if ((slot->header_value & 0xF) == 0x2) { // queued
-        // queued command, start if any of cus is ready
-        if (start_cu(slot)) { // started
-          slot->header_value |= 0x1; // running (0x2->0x3)
-          XRT_DEBUGF("slot(%d) [queued->running]\n",slot->get_uid());
-        }
-      }
+      slot.header_value = (slot.header_value & ~0xF) | 0x2; // queued
+      XRT_DEBUGF("slot(%d) [new->queued]\n",slot.get_uid());
+    }
+    m_new.clear();
+  }
 
-      if ((slot->header_value & 0xF) == 0x3) { // running
-        // running command, check its cu status
-        if (check_cu(slot,false)) {
-          notify_host(slot);
-          slot->header_value = (slot->header_value & ~0xF) | 0x4; // free
-          XRT_DEBUGF("slot(%d) [running->free]\n",slot->get_uid());
-        }
-      }
+  bool
+  idle() const
+  {
+    return m_new.empty() && m_ready.empty() && m_running.empty();
+  }
 
-      if ((slot->header_value & 0xF) == 0x4) { // free
-        nitr = command_queue.erase(itr);
-        end = command_queue.end();
+  /**
+   * One pass of scheduler
+   *
+   *  1. Start ready commands on available CUs, stop looking as soon
+   *     as all CUs are busy.
+   *  2. Check status of running CUs
+   *
+   * @return
+   *   True if there are commands ready or running after this pass
+   */
+  bool
+  step()
+  {
+    auto end = m_ready.end();
+    for (auto itr=m_ready.begin(); itr!=end && !all_cus_busy(); ) {
+      auto curr = itr++;
+      auto opc = opcode(curr->header_value);
+      if (opc!=CMD_START_KERNEL) { // Non performance critical command
+        if (opc==CMD_CONFIGURE)
+          configure(curr);
         continue;
       }
+      if (start_cu(curr))
+        XRT_DEBUGF("slot(%d) [queued->running]\n",m_running.back().get_uid());
+    }
 
-      nitr = ++itr;
+    // special commands can be pending when all cus are busy
+    if (!m_ready.empty() && m_running.empty() && opcode(m_ready.front().header_value)==CMD_CONFIGURE)
+      configure(m_ready.begin());
 
-    }
-  } // while
+    m_cu_status.for_each_set([this](size_type cu) { check_cu(cu); });
+
+    return !m_ready.empty() || !m_running.empty();
+  }
+};
+
+void
+scheduler_thread::
+run()
+{
+  std::vector<device_scheduler*> devices;
+  bool busy = false;
+
+  while (1) {
+
+    if (!busy || m_pending) {
+      std::unique_lock<std::mutex> lk(m_mutex);
+      while (!m_stop && !busy && !m_pending)
+        m_work.wait(lk);
+
+      if (m_stop) {
+        for (auto device : m_devices)
+          if (!device->idle())
+            throw std::runtime_error("software scheduler stopping while there are active commands");
+        break;
+      }
+
+      // copy new commands to ready lists
+      devices = m_devices;
+      for (auto device : devices)
+        device->take_new();
+      m_pending = false;
+    } // lk scope
+
+    busy = false;
+    for (auto device : devices)
+      busy |= device->step();
+  }
 }
 
+////////////////////////////////////////////////////////////////
+// Device schedulers are added in init and never removed.  The
+// array is append only so lookup by schedule is lock free.
+////////////////////////////////////////////////////////////////
+static std::mutex s_mutex;  // protects start, stop, and init
 static bool s_running=false;
-static std::thread s_scheduler;
+static scheduler_thread s_shared_thread;
+static const size_t max_devices = 64;
+static std::array<std::unique_ptr<device_scheduler>,max_devices> s_devices;
+static std::array<std::unique_ptr<scheduler_thread>,max_devices> s_device_threads;
+static std::atomic<size_t> s_num_devices(0);
+
+static device_scheduler*
+get_device_scheduler(const xrt::device* device)
+{
+  auto num = s_num_devices.load(std::memory_order_acquire);
+  for (size_t i=0; i<num; ++i)
+    if (s_devices[i]->get_device()==device)
+      return s_devices[i].get();
+  return nullptr;
+}
 
+static void
+start_threads()
+{
+  if (!xrt::config::get_sws_thread_per_device())
+    return s_shared_thread.start();
+
+  for (size_t i=0, num=s_num_devices; i<num; ++i)
+    s_device_threads[i]->start();
+}
+
+static void
+stop_threads()
+{
+  if (!xrt::config::get_sws_thread_per_device())
+    return s_shared_thread.stop();
+
+  for (size_t i=0, num=s_num_devices; i<num; ++i)
+    s_device_threads[i]->stop();
+}
 
 } // namespace
 
@@ -544,9 +690,33 @@ namespace xrt { namespace sws {
 void
 schedule(const command_type& cmd)
 {
-  std::lock_guard<std::mutex> lk(s_mutex);
-  s_cmds.push_back(cmd);
-  s_work.notify_one();
+  auto device = get_device_scheduler(cmd->get_device());
+  if (!device)
+    throw std::runtime_error("sws: device not initialized");
+
+  auto thread = device->get_thread();
+  std::lock_guard<std::mutex> lk(thread->m_mutex);
+  device->add(cmd);
+  thread->m_pending = true;
+  thread->m_work.notify_one();
+}
+
+void
+schedule_batch(const std::vector<command_type>& cmds)
+{
+  // Consecutive commands on same device are added under one lock
+  for (auto itr=cmds.begin(), end=cmds.end(); itr!=end; ) {
+    auto device = get_device_scheduler((*itr)->get_device());
+    if (!device)
+      throw std::runtime_error("sws: device not initialized");
+
+    auto thread = device->get_thread();
+    std::lock_guard<std::mutex> lk(thread->m_mutex);
+    for (; itr!=end && (*itr)->get_device()==device->get_device(); ++itr)
+      device->add(*itr);
+    thread->m_pending = true;
+    thread->m_work.notify_one();
+  }
 }
 
 void
@@ -556,7 +726,7 @@ start()
     throw std::runtime_error("sws command scheduler is already started");
 
   std::lock_guard<std::mutex> lk(s_mutex);
-  s_scheduler = std::move(xrt::thread(scheduler_loop));
+  start_threads();
   if (threaded_notification)
     notifier = std::move(xrt::thread(xrt::task::worker,std::ref(notify_queue)));
   s_running = true;
@@ -568,13 +738,8 @@ stop()
   if (!s_running)
     return;
 
-  {
-    std::lock_guard<std::mutex> lk(s_mutex);
-    s_stop=true;
-  }
-
-  s_work.notify_one();
-  s_scheduler.join();
+  std::lock_guard<std::mutex> lk(s_mutex);
+  stop_threads();
 
   if (threaded_notification) {
     // wait for notifier to drain
@@ -590,13 +755,40 @@ stop()
 }
 
 void
-init(xrt::device*, size_t, size_t cus, size_t cuoffset, size_t cubase, const std::vector<uint32_t>& cu_amap)
+init(xrt::device* device, size_t, size_t cus, size_t cuoffset, size_t cubase, const std::vector<uint32_t>& cu_amap)
 {
-  num_cus = cus;
-  cu_base_address = cubase;
-  cu_offset = cuoffset;
-  cu_trace_enabled = xrt::config::get_profile();
-  cu_addr_map = cu_amap;
+  std::lock_guard<std::mutex> lk(s_mutex);
+  auto sched = get_device_scheduler(device);
+  if (!sched) {
+    auto num = s_num_devices.load();
+    if (num==max_devices)
+      throw std::runtime_error("sws: too many devices");
+    s_devices[num].reset(new device_scheduler(device));
+    sched = s_devices[num].get();
+
+    if (xrt::config::get_sws_thread_per_device()) {
+      s_device_threads[num].reset(new scheduler_thread);
+      sched->set_thread(s_device_threads[num].get());
+      if (s_running)
+        s_device_threads[num]->start();
+    }
+    else
+      sched->set_thread(&s_shared_thread);
+
+    s_num_devices.store(num+1,std::memory_order_release);
+  }
+
+  // Scheduler state is owned by the scheduler thread, update
+  // under its lock when idle.
+  auto thread = sched->get_thread();
+  std::lock_guard<std::mutex> tlk(thread->m_mutex);
+  if (!sched->idle())
+    throw std::runtime_error("sws: device reinitialized while there are active commands");
+  sched->init(cus,cuoffset,cubase,cu_amap);
+  if (std::find(thread->m_devices.begin(),thread->m_devices.end(),sched)==thread->m_devices.end())
+    thread->m_devices.push_back(sched);
+  thread->m_pending = true;
+  thread->m_work.notify_one();
 }
 
 }} // sws,xrt
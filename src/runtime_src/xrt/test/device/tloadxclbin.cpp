@@ -0,0 +1,188 @@
+/**
+ * Copyright (C) 2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+////////////////////////////////////////////////////////////////
+// Unit testing of xrt::device tracking of loaded xclbin uuid,
+// reset of CUs in place of reloading same xclbin, fallback to
+// reloading on emulation like devices, and loading
+// xclbins on multiple devices concurrently
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+#include "../mock_device.h"
+
+#include "xrt/device/device.h"
+#include "driver/include/xclbin.h"
+
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <vector>
+
+using namespace xrt::test;
+
+namespace {
+
+static axlf
+make_axlf(unsigned char id)
+{
+  axlf top;
+  std::memset(&top,0,sizeof(top));
+  std::memcpy(top.m_magic,"xclbin2",8);
+  if (id)
+    std::memset(&top.m_header.uuid,id,sizeof(top.m_header.uuid));
+  return top;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_loadxclbin )
+
+BOOST_AUTO_TEST_CASE( test_loadxclbin1 )
+{
+  auto hal = new mock_device;
+  xrt::device device{std::unique_ptr<xrt::hal::device>(hal)};
+
+  auto xclbin1 = make_axlf(1);
+  auto xclbin2 = make_axlf(2);
+
+  // nothing loaded yet
+  BOOST_CHECK(!device.isXclbinLoaded(&xclbin1));
+
+  auto rv = device.loadXclBin(&xclbin1);
+  BOOST_CHECK(rv.valid() && rv.get()==0);
+  BOOST_CHECK_EQUAL(hal->load_xclbin_calls,1);
+  BOOST_CHECK(device.isXclbinLoaded(&xclbin1));
+  BOOST_CHECK(!device.isXclbinLoaded(&xclbin2));
+
+  // reload same xclbin if caller so chooses
+  device.loadXclBin(&xclbin1);
+  BOOST_CHECK_EQUAL(hal->load_xclbin_calls,2);
+  BOOST_CHECK(device.isXclbinLoaded(&xclbin1));
+
+  // different xclbin replaces uuid
+  device.loadXclBin(&xclbin2);
+  BOOST_CHECK(device.isXclbinLoaded(&xclbin2));
+  BOOST_CHECK(!device.isXclbinLoaded(&xclbin1));
+
+  // closing device forgets the xclbin
+  device.close();
+  BOOST_CHECK(!device.isXclbinLoaded(&xclbin2));
+}
+
+BOOST_AUTO_TEST_CASE( test_loadxclbin2 )
+{
+  auto hal = new mock_device;
+  xrt::device device{std::unique_ptr<xrt::hal::device>(hal)};
+
+  auto xclbin1 = make_axlf(1);
+  device.loadXclBin(&xclbin1);
+  BOOST_CHECK(device.isXclbinLoaded(&xclbin1));
+
+  // failed load leaves device with unknown xclbin
+  hal->load_result = -EBUSY;
+  auto rv = device.loadXclBin(&xclbin1);
+  BOOST_CHECK(rv.valid() && rv.get()==-EBUSY);
+  BOOST_CHECK(!device.isXclbinLoaded(&xclbin1));
+
+  // xclbin without uuid is never considered loaded
+  hal->load_result = 0;
+  auto legacy = make_axlf(0);
+  device.loadXclBin(&legacy);
+  BOOST_CHECK(!device.isXclbinLoaded(&legacy));
+}
+
+BOOST_AUTO_TEST_CASE( test_loadxclbin3 )
+{
+  auto hal = new mock_device;
+  xrt::device device{std::unique_ptr<xrt::hal::device>(hal)};
+
+  auto xclbin1 = make_axlf(1);
+  auto xclbin2 = make_axlf(2);
+
+  // nothing to reset before xclbin is loaded
+  BOOST_CHECK(!device.resetXclbinKernels(&xclbin1));
+  BOOST_CHECK_EQUAL(hal->reset_cu_calls,0);
+
+  // same xclbin resets CUs without download
+  device.loadXclBin(&xclbin1);
+  BOOST_CHECK(device.resetXclbinKernels(&xclbin1));
+  BOOST_CHECK_EQUAL(hal->reset_cu_calls,1);
+  BOOST_CHECK_EQUAL(hal->load_xclbin_calls,1);
+
+  // different xclbin must be loaded
+  BOOST_CHECK(!device.resetXclbinKernels(&xclbin2));
+  BOOST_CHECK_EQUAL(hal->reset_cu_calls,1);
+
+  // failed reset falls back to loading the xclbin
+  hal->reset_result = -EBUSY;
+  BOOST_CHECK(!device.resetXclbinKernels(&xclbin1));
+  BOOST_CHECK_EQUAL(hal->reset_cu_calls,2);
+}
+
+BOOST_AUTO_TEST_CASE( test_loadxclbin5 )
+{
+  auto hal = new mock_device;
+  hal->emulation = true;
+  xrt::device device{std::unique_ptr<xrt::hal::device>(hal)};
+
+  auto xclbin = make_axlf(1);
+
+  // As xocl load_program, release (unload_program), load_program
+  for (int i=0; i<3; ++i) {
+    if (!device.resetXclbinKernels(&xclbin))
+      device.loadXclBin(&xclbin);
+    BOOST_CHECK(hal->running);
+    BOOST_CHECK_EQUAL(hal->load_xclbin_calls,i+1);
+
+    device.resetKernel();
+    BOOST_CHECK(!hal->running);
+    BOOST_CHECK(!device.isXclbinLoaded(&xclbin));
+  }
+  BOOST_CHECK_EQUAL(hal->reset_cu_calls,0);
+}
+
+BOOST_AUTO_TEST_CASE( test_loadxclbin4 )
+{
+  // Devices are loaded concurrently as by clCreateProgramWithBinary
+  const size_t num_devices = 4;
+  const std::chrono::milliseconds latency(200);
+
+  std::vector<std::unique_ptr<xrt::device>> devices;
+  for (size_t i=0; i<num_devices; ++i) {
+    auto hal = new mock_device;
+    hal->load_latency = latency;
+    devices.emplace_back(new xrt::device{std::unique_ptr<xrt::hal::device>(hal)});
+  }
+
+  auto xclbin = make_axlf(1);
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::future<int>> loads;
+  for (auto& device : devices) {
+    auto dev = device.get();
+    loads.emplace_back(std::async(std::launch::async,[dev,&xclbin]() { return dev->loadXclBin(&xclbin).get(); }));
+  }
+  for (auto& load : loads)
+    BOOST_CHECK_EQUAL(load.get(),0);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  // loads overlap rather than run one device at a time
+  BOOST_CHECK(elapsed < 2*latency);
+  for (auto& device : devices)
+    BOOST_CHECK(device->isXclbinLoaded(&xclbin));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
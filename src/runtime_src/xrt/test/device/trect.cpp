@@ -0,0 +1,70 @@
+/**
+ * Copyright (C) 2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <boost/test/unit_test.hpp>
+
+#include "xrt/device/hal.h"
+
+using hal = xrt::hal::device;
+using direction = hal::direction;
+
+BOOST_AUTO_TEST_SUITE ( test_rect )
+
+BOOST_AUTO_TEST_CASE( test_rect1 )
+{
+  // contiguous rows and slices are one span
+  {
+    xrt::hal::rect rect {64,16,4,2,16,64};
+    auto spans = hal::get_rect_spans(rect,direction::HOST2DEVICE);
+    BOOST_CHECK_EQUAL(spans.size(),1);
+    BOOST_CHECK_EQUAL(spans[0].first,64);
+    BOOST_CHECK_EQUAL(spans[0].second,128);
+  }
+
+  // strided rows are one span per row to device, but bounding span
+  // from device
+  {
+    xrt::hal::rect rect {8,16,4,1,32,128};
+    auto spans = hal::get_rect_spans(rect,direction::HOST2DEVICE);
+    BOOST_CHECK_EQUAL(spans.size(),4);
+    BOOST_CHECK_EQUAL(spans[3].first,8+3*32);
+    BOOST_CHECK_EQUAL(spans[3].second,16);
+
+    spans = hal::get_rect_spans(rect,direction::DEVICE2HOST);
+    BOOST_CHECK_EQUAL(spans.size(),1);
+    BOOST_CHECK_EQUAL(spans[0].first,8);
+    BOOST_CHECK_EQUAL(spans[0].second,3*32+16);
+  }
+
+  // sparse region is one span per contiguous part both ways,
+  // rows within a slice are contiguous
+  {
+    xrt::hal::rect rect {0,16,2,3,16,1024};
+    auto spans = hal::get_rect_spans(rect,direction::DEVICE2HOST);
+    BOOST_CHECK_EQUAL(spans.size(),3);
+    BOOST_CHECK_EQUAL(spans[1].first,1024);
+    BOOST_CHECK_EQUAL(spans[1].second,32);
+  }
+
+  // empty region
+  {
+    xrt::hal::rect rect {0,0,2,3,16,1024};
+    BOOST_CHECK(hal::get_rect_spans(rect,direction::DEVICE2HOST).empty());
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,278 @@
+/**
+ * Copyright (C) 2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef xrt_test_mock_device_h_
+#define xrt_test_mock_device_h_
+
+#include "xrt/device/hal.h"
+#include "driver/include/ert.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace xrt { namespace test {
+
+namespace hal = xrt::hal;
+using BufferObjectHandle = hal::BufferObjectHandle;
+using ExecBufferObjectHandle = hal::ExecBufferObjectHandle;
+using verbosity_level = hal::verbosity_level;
+
+/**
+ * Mock hal device for scheduler unit tests and benchmarks
+ *
+ * Exec buffers are plain host memory.  Commands submitted with
+ * exec_buf are completed by a simulated device thread after an
+ * optional latency, exec_wait returns when some command completed
+ * since the previous call.  Device counts calls to exec_buf so
+ * benchmarks can report driver calls per command.
+ *
+ * CUs are simulated by a plain register file.  Writing a control
+ * register with AP_START set completes the CU immediately, the
+ * register then reads back as AP_DONE|AP_IDLE.
+ *
+ * Loading an xclbin only counts the call and returns load_result
+ * after load_latency.  Resetting compute units counts the call and
+ * returns reset_result.  With emulation set the device behaves like
+ * the emulation drivers: compute units cannot be reset and
+ * resetKernel tears down the loaded xclbin (running is cleared).
+ */
+class mock_device : public hal::device
+{
+  struct exec_bo : hal::exec_buffer_object
+  {
+    void* data;
+    size_t size;
+    explicit exec_bo(size_t sz) : data(nullptr), size(sz)
+    {
+      if (posix_memalign(&data,4096,sz))
+        throw std::bad_alloc();
+    }
+    ~exec_bo() { std::free(data); }
+  };
+
+  std::chrono::nanoseconds m_latency;
+
+  mutable std::mutex m_mutex;
+  mutable std::condition_variable m_submitted;
+  mutable std::condition_variable m_completed;
+  std::deque<ert_packet*> m_queue;
+  mutable unsigned long m_completions = 0;
+  mutable unsigned long m_seen = 0;
+  bool m_stop = false;
+  std::thread m_hw;
+
+  // CU register file, 128 CUs at 4K offsets
+  std::vector<uint32_t> m_regs = std::vector<uint32_t>((128<<12)/4,0);
+
+  void
+  hw_loop()
+  {
+    while (true) {
+      ert_packet* pkt = nullptr;
+      {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        while (!m_stop && m_queue.empty())
+          m_submitted.wait(lk);
+        if (m_stop)
+          return;
+        pkt = m_queue.front();
+        m_queue.pop_front();
+      }
+
+      if (m_latency.count())
+        std::this_thread::sleep_for(m_latency);
+
+      std::lock_guard<std::mutex> lk(m_mutex);
+      pkt->state = ERT_CMD_STATE_COMPLETED;
+      ++m_completions;
+      m_completed.notify_all();
+    }
+  }
+
+public:
+  std::atomic<unsigned long> exec_buf_calls {0};
+  std::atomic<unsigned long> load_xclbin_calls {0};
+  std::atomic<unsigned long> reset_kernel_calls {0};
+  std::atomic<unsigned long> reset_cu_calls {0};
+  int load_result = 0;
+  int reset_result = 0;
+  bool emulation = false;
+  bool running = false;
+  std::chrono::milliseconds load_latency {0};
+
+  explicit
+  mock_device(std::chrono::nanoseconds latency = std::chrono::nanoseconds(0))
+    : m_latency(latency)
+  {
+    m_hw = std::thread(&mock_device::hw_loop,this);
+  }
+
+  ~mock_device()
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_stop = true;
+      m_submitted.notify_all();
+    }
+    m_hw.join();
+  }
+
+  virtual int
+  exec_buf(const ExecBufferObjectHandle& bo)
+  {
+    ++exec_buf_calls;
+    auto ebo = static_cast<exec_bo*>(bo.get());
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_queue.push_back(static_cast<ert_packet*>(ebo->data));
+    m_submitted.notify_one();
+    return 0;
+  }
+
+  virtual int
+  exec_buf(const std::vector<ExecBufferObjectHandle>& bos)
+  {
+    ++exec_buf_calls;
+    std::lock_guard<std::mutex> lk(m_mutex);
+    for (auto& bo : bos)
+      m_queue.push_back(static_cast<ert_packet*>(static_cast<exec_bo*>(bo.get())->data));
+    m_submitted.notify_one();
+    return 0;
+  }
+
+  virtual int
+  exec_wait(int timeout_ms) const
+  {
+    std::unique_lock<std::mutex> lk(m_mutex);
+    if (m_seen==m_completions)
+      m_completed.wait_for(lk,std::chrono::milliseconds(timeout_ms));
+    auto completed = m_completions - m_seen;
+    m_seen = m_completions;
+    return completed ? 1 : 0;
+  }
+
+  virtual hal::operations_result<int>
+  loadXclBin(const axlf*)
+  {
+    ++load_xclbin_calls;
+    std::this_thread::sleep_for(load_latency);
+    running = (load_result==0);
+    return int(load_result);
+  }
+
+  virtual hal::operations_result<int>
+  resetKernel()
+  {
+    ++reset_kernel_calls;
+    if (!emulation)
+      return hal::operations_result<int>();
+    running = false;
+    return 0;
+  }
+
+  virtual hal::operations_result<int>
+  resetComputeUnits()
+  {
+    if (emulation)
+      return hal::operations_result<int>();
+    ++reset_cu_calls;
+    return int(reset_result);
+  }
+
+  virtual ExecBufferObjectHandle
+  allocExecBuffer(size_t sz)
+  {
+    return std::make_shared<exec_bo>(sz);
+  }
+
+  virtual void*
+  map(const ExecBufferObjectHandle& bo)
+  {
+    return static_cast<exec_bo*>(bo.get())->data;
+  }
+
+  virtual void
+  unmap(const ExecBufferObjectHandle&)
+  {}
+
+  // Remaining hal::device interface is not used by tests
+  virtual bool open(const char*, verbosity_level) { return true; }
+  virtual void close() {}
+  virtual std::string getDriverLibraryName() const { return "mock"; }
+  virtual std::string getName() const { return "mock"; }
+  virtual unsigned int getBankCount() const { return 1; }
+  virtual size_t getDdrSize() const { return 0; }
+  virtual size_t getAlignment() const { return 4096; }
+  virtual range<const unsigned short*> getClockFrequencies() const { return range<const unsigned short*>(); }
+  virtual std::ostream& printDeviceInfo(std::ostream& ostr) const { return ostr; }
+  virtual size_t get_cdma_count() const { return 0; }
+  virtual BufferObjectHandle alloc(size_t) { return nullptr; }
+  virtual BufferObjectHandle alloc(size_t,void*) { return nullptr; }
+  virtual BufferObjectHandle alloc(size_t, Domain, uint64_t, void*) { return nullptr; }
+  virtual BufferObjectHandle alloc(const BufferObjectHandle&, size_t, size_t) { return nullptr; }
+  virtual void* alloc_svm(size_t) { return nullptr; }
+  virtual BufferObjectHandle import(const BufferObjectHandle&) { return nullptr; }
+  virtual void free(const BufferObjectHandle&) {}
+  virtual void free_svm(void*) {}
+  virtual event write(const BufferObjectHandle&, const void*, size_t, size_t, bool) { return event(); }
+  virtual event read(const BufferObjectHandle&, void*, size_t, size_t, bool) { return event(); }
+  virtual event sync(const BufferObjectHandle&, size_t, size_t, direction, bool) { return event(); }
+  virtual event copy(const BufferObjectHandle&, const BufferObjectHandle&, size_t, size_t, size_t) { return event(); }
+
+  virtual size_t
+  read_register(size_t offset, void* buffer, size_t size)
+  {
+    if (offset+size > m_regs.size()*4)
+      return 0;
+    std::memcpy(buffer,reinterpret_cast<char*>(m_regs.data())+offset,size);
+    return size;
+  }
+
+  virtual size_t
+  write_register(size_t offset, const void* buffer, size_t size)
+  {
+    if (offset+size > m_regs.size()*4)
+      return 0;
+    auto regs = reinterpret_cast<char*>(m_regs.data())+offset;
+    std::memcpy(regs,buffer,size);
+    auto ctrl = reinterpret_cast<uint32_t*>(regs);
+    if (size>=4 && (*ctrl & 0x1)) // AP_START
+      *ctrl = 0x6;                 // AP_DONE|AP_IDLE
+    return size;
+  }
+
+  virtual void* map(const BufferObjectHandle&) { return nullptr; }
+  virtual void unmap(const BufferObjectHandle&) {}
+  virtual int createWriteStream(hal::StreamFlags, hal::StreamAttributes, uint64_t, uint64_t, hal::StreamHandle*) { return -1; }
+  virtual int createReadStream(hal::StreamFlags, hal::StreamAttributes, uint64_t, uint64_t, hal::StreamHandle*) { return -1; }
+  virtual int closeStream(hal::StreamHandle) { return -1; }
+  virtual hal::StreamBuf allocStreamBuf(size_t, hal::StreamBufHandle*) { return nullptr; }
+  virtual int freeStreamBuf(hal::StreamBufHandle) { return -1; }
+  virtual ssize_t writeStream(hal::StreamHandle, const void*, size_t, size_t, hal::StreamXferReq*) { return -1; }
+  virtual ssize_t readStream(hal::StreamHandle, void*, size_t, size_t, hal::StreamXferReq*) { return -1; }
+  virtual int pollStreams(hal::StreamXferCompletions*, int, int, int*, int) { return -1; }
+  virtual uint64_t getDeviceAddr(const BufferObjectHandle&) { return 0; }
+};
+
+}} // test,xrt
+
+#endif
@@ -0,0 +1,76 @@
+/**
+ * Copyright (C) 2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+////////////////////////////////////////////////////////////////
+// Unit testing of xrt/scheduler/command.h exec buffer pool
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+#include "../mock_device.h"
+
+#include "xrt/scheduler/command.h"
+
+using namespace xrt::test;
+
+BOOST_AUTO_TEST_SUITE ( test_command )
+
+BOOST_AUTO_TEST_CASE( test_command1 )
+{
+  xrt::device device(std::unique_ptr<xrt::hal::device>(new mock_device));
+
+  xrt::reserve_command_freelist(&device,4);
+  auto stats = xrt::get_command_pool_stats(&device);
+  BOOST_CHECK_EQUAL(stats.buffers,4);
+  BOOST_CHECK_EQUAL(stats.reserved,4);
+
+  {
+    // dirty some words of a packet
+    xrt::command cmd(&device,ERT_START_CU);
+    auto epacket = xrt::command_cast<ert_packet*>(&cmd);
+    epacket->count = 8;
+    for (int i=1; i<=8; ++i)
+      epacket->data[i-1] = 0xdeadbeef;
+    BOOST_CHECK_EQUAL(xrt::get_command_pool_stats(&device).in_use,1);
+  }
+
+  {
+    // recycled packet is cleared
+    xrt::command cmd(&device,ERT_START_CU);
+    auto epacket = xrt::command_cast<ert_packet*>(&cmd);
+    BOOST_CHECK_EQUAL(epacket->count,0);
+    for (int i=1; i<=8; ++i)
+      BOOST_CHECK_EQUAL(epacket->data[i-1],0);
+  }
+
+  {
+    // exceed reserved buffers
+    std::vector<std::unique_ptr<xrt::command>> cmds;
+    for (int i=0; i<6; ++i)
+      cmds.emplace_back(new xrt::command(&device,ERT_START_CU));
+    stats = xrt::get_command_pool_stats(&device);
+    BOOST_CHECK_EQUAL(stats.in_use,6);
+    BOOST_CHECK_EQUAL(stats.buffers,6);
+    BOOST_CHECK_EQUAL(stats.misses,2);
+  }
+
+  stats = xrt::get_command_pool_stats(&device);
+  BOOST_CHECK_EQUAL(stats.in_use,0);
+  BOOST_CHECK_EQUAL(stats.hits,6);
+
+  xrt::purge_command_freelist();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,87 @@
+/**
+ * Copyright (C) 2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+////////////////////////////////////////////////////////////////
+// Benchmark of xrt/scheduler/kds.cpp command monitor
+//
+// Uses a mock device that completes exec buffers in a simulated
+// device thread, and reports commands/sec for a range of commands
+// in flight.  Commands are scheduled one at a time or as one batch,
+// driver calls per command are reported for both.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+#include "../test_helpers.h"
+#include "../mock_device.h"
+
+#include "xrt/scheduler/scheduler.h"
+#include "xrt/scheduler/command.h"
+
+#include <iostream>
+
+using namespace xrt::test;
+
+namespace {
+
+static void
+run(xrt::device* device, mock_device* hal, size_t inflight, size_t total, bool batch)
+{
+  std::vector<std::shared_ptr<xrt::command>> cmds;
+  cmds.reserve(inflight);
+
+  auto calls = hal->exec_buf_calls.load();
+  Timer timer;
+  for (size_t done=0; done<total; done+=inflight) {
+    for (size_t i=0; i<inflight; ++i) {
+      cmds.push_back(std::make_shared<xrt::command>(device,ERT_START_CU));
+      if (!batch)
+        xrt::kds::schedule(cmds.back());
+    }
+    if (batch)
+      xrt::kds::schedule_batch(cmds);
+    for (auto& cmd : cmds)
+      cmd->wait();
+    cmds.clear();
+  }
+  auto sec = timer.stop();
+  calls = hal->exec_buf_calls - calls;
+
+  std::cout << "kds " << (batch ? "batch " : "") << inflight << " commands in flight: "
+            << static_cast<unsigned long>(total/sec) << " commands/s "
+            << static_cast<double>(calls)/total << " exec_buf calls/command\n";
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_kds_bw )
+
+BOOST_AUTO_TEST_CASE( test_kds_bw1 )
+{
+  auto hal = new mock_device;
+  xrt::device device {std::unique_ptr<xrt::hal::device>(hal)};
+
+  xrt::kds::start();
+  xrt::kds::init(&device,0x100,false,1,16,0,{0});
+
+  for (bool batch : {false,true})
+    for (size_t inflight : {1,16,256,1024})
+      run(&device,hal,inflight,std::max<size_t>(inflight,1<<16),batch);
+
+  xrt::kds::stop();
+  xrt::purge_command_freelist();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,104 @@
+/**
+ * Copyright (C) 2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+////////////////////////////////////////////////////////////////
+// Benchmark of xrt/scheduler/sws.cpp software scheduler
+//
+// Uses a mock device with a register file where CUs complete as
+// soon as they are started, and reports commands/sec for 1 to 128
+// CUs with all CUs kept busy.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+#include "../test_helpers.h"
+#include "../mock_device.h"
+
+#include "xrt/scheduler/scheduler.h"
+#include "xrt/scheduler/command.h"
+
+#include <iostream>
+
+using namespace xrt::test;
+
+namespace {
+
+const size_t regmap_words = 4;
+
+static std::shared_ptr<xrt::command>
+create_command(xrt::device* device, size_t num_cus)
+{
+  auto cmd = std::make_shared<xrt::command>(device,ERT_START_CU);
+  auto skcmd = xrt::command_cast<ert_start_kernel_cmd*>(cmd);
+  size_t cumasks = (num_cus+31)/32;
+  skcmd->extra_cu_masks = cumasks-1;
+  skcmd->count = cumasks + regmap_words;
+
+  // cu_mask is followed by extra masks in data
+  auto masks = &skcmd->cu_mask;
+  for (size_t i=0; i<cumasks; ++i)
+    masks[i] = 0;
+  for (size_t cu=0; cu<num_cus; ++cu)
+    masks[cu/32] |= 1u << (cu%32);
+  return cmd;
+}
+
+static void
+run(xrt::device* device, size_t num_cus, size_t total)
+{
+  std::vector<uint32_t> cu_addr_map;
+  for (size_t cu=0; cu<num_cus; ++cu)
+    cu_addr_map.push_back(cu<<12);
+  xrt::sws::init(device,0x100,num_cus,12,0,cu_addr_map);
+
+  // keep two commands per cu in flight
+  auto inflight = 2*num_cus;
+  std::vector<std::shared_ptr<xrt::command>> cmds;
+  cmds.reserve(inflight);
+
+  Timer timer;
+  for (size_t done=0; done<total; done+=inflight) {
+    for (size_t i=0; i<inflight; ++i) {
+      cmds.push_back(create_command(device,num_cus));
+      xrt::sws::schedule(cmds.back());
+    }
+    for (auto& cmd : cmds)
+      cmd->wait();
+    cmds.clear();
+  }
+  auto sec = timer.stop();
+
+  std::cout << "sws " << num_cus << " cus: "
+            << static_cast<unsigned long>(total/sec) << " commands/s\n";
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_sws_bw )
+
+BOOST_AUTO_TEST_CASE( test_sws_bw1 )
+{
+  xrt::device device(std::unique_ptr<xrt::hal::device>(new mock_device));
+
+  xrt::sws::start();
+
+  for (size_t num_cus : {1,2,4,8,16,32,64,128})
+    run(&device,num_cus,1<<16);
+
+  xrt::sws::stop();
+  xrt::purge_command_freelist();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,77 @@
+/**
+ * Copyright (C) 2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+////////////////////////////////////////////////////////////////
+// Benchmark of xrt::fill compared to one memcpy per pattern as
+// used by xocl::device::fill_buffer before.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+#include "../test_helpers.h"
+
+#include "xrt/util/fill.h"
+#include <vector>
+#include <cstring>
+#include <iostream>
+
+using namespace xrt::test;
+
+namespace {
+
+const size_t buffer_size = 64<<20;
+const size_t iterations = 8;
+
+static void
+memcpy_fill(char* dst, size_t size, const void* pattern, size_t pattern_size)
+{
+  for (; pattern_size <= size; size-=pattern_size, dst+=pattern_size)
+    std::memcpy(dst,pattern,pattern_size);
+  if (size)
+    std::memcpy(dst,pattern,size);
+}
+
+template <typename F>
+static double
+run(F&& f, char* dst, const char* pattern, size_t pattern_size)
+{
+  Timer timer;
+  for (size_t i=0; i<iterations; ++i)
+    f(dst,buffer_size,pattern,pattern_size);
+  auto sec = timer.stop();
+  return (iterations*buffer_size) / sec / (1<<20);
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_fill_bw )
+
+BOOST_AUTO_TEST_CASE( test_fill_bw1 )
+{
+  std::vector<char> buf(buffer_size);
+  char pattern[128];
+  for (size_t i=0; i<sizeof(pattern); ++i)
+    pattern[i] = static_cast<char>(i);
+
+  for (size_t pattern_size : {1,4,16,128}) {
+    auto mb_memcpy = run(memcpy_fill,buf.data(),pattern,pattern_size);
+    auto mb_fill = run(xrt::fill,buf.data(),pattern,pattern_size);
+    std::cout << "pattern size " << pattern_size << ": memcpy " << static_cast<unsigned long>(mb_memcpy)
+              << " MB/s, xrt::fill " << static_cast<unsigned long>(mb_fill) << " MB/s\n";
+    BOOST_CHECK_EQUAL(buf[buffer_size-1],pattern[(buffer_size-1)%pattern_size]);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,57 @@
+/**
+ * Copyright (C) 2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <boost/test/unit_test.hpp>
+
+#include "xrt/util/fill.h"
+#include <vector>
+#include <cstdint>
+
+namespace {
+
+static void
+check_fill(size_t pattern_size, size_t offset, size_t size)
+{
+  std::vector<uint8_t> pattern(pattern_size);
+  for (size_t i=0; i<pattern_size; ++i)
+    pattern[i] = static_cast<uint8_t>(i*7+1);
+
+  // guard bytes before and after filled region
+  std::vector<uint8_t> buf(offset+size+64,0xEE);
+  xrt::fill(buf.data()+offset,size,pattern.data(),pattern_size);
+
+  for (size_t i=0; i<offset; ++i)
+    BOOST_REQUIRE_EQUAL(buf[i],0xEE);
+  for (size_t i=0; i<size; ++i)
+    BOOST_REQUIRE_EQUAL(buf[offset+i],pattern[i%pattern_size]);
+  for (size_t i=offset+size; i<buf.size(); ++i)
+    BOOST_REQUIRE_EQUAL(buf[i],0xEE);
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_fill )
+
+BOOST_AUTO_TEST_CASE( test_fill1 )
+{
+  for (size_t pattern_size : {1,2,3,4,8,16,32,64,96,128})
+    for (size_t offset : {0,1,13})
+      for (size_t size : {0,1,63,64,127,128,129,1000,4096})
+        check_fill(pattern_size,offset,size);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
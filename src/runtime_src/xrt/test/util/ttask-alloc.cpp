@@ -0,0 +1,148 @@
+/**
+ * Copyright (C) 2016-2017 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+////////////////////////////////////////////////////////////////
+// Allocation count benchmark of xrt/util/task.h
+//
+// Counts heap allocations per enqueued task for the legacy
+// std::packaged_task based scheme and for the current task and
+// event implementation.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "xrt/util/task.h"
+#include "xrt/util/event.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <queue>
+
+namespace {
+
+static std::atomic<unsigned long> allocations(0);
+
+static int
+dma(void*, unsigned int, int, size_t sz, size_t)
+{
+  return static_cast<int>(sz);
+}
+
+// Legacy scheme: type erased holder of a packaged_task in a
+// std::queue, returning the future
+struct legacy_task
+{
+  struct iholder
+  {
+    virtual ~iholder() {}
+    virtual void execute() = 0;
+  };
+
+  template <typename Callable>
+  struct holder : iholder
+  {
+    Callable held;
+    holder(Callable&& c) : held(std::move(c)) {}
+    void execute() { held(); }
+  };
+
+  std::unique_ptr<iholder> content;
+
+  template <typename Callable>
+  legacy_task(Callable&& c) : content(new holder<Callable>(std::move(c))) {}
+};
+
+static double
+legacy(unsigned int count)
+{
+  std::queue<legacy_task> q;
+  auto start = allocations.load();
+  for (unsigned int i=0; i<count; ++i) {
+    std::packaged_task<int()> t(std::bind(&dma,nullptr,1,0,4096,0));
+    auto f = t.get_future();
+    q.push(legacy_task(std::move(t)));
+    q.front().content->execute();
+    q.pop();
+    f.get();
+  }
+  return static_cast<double>(allocations.load()-start)/count;
+}
+
+static double
+current(bool lockfree, bool wrap, unsigned int count)
+{
+  xrt::task::queue queue(lockfree);
+  auto worker = std::thread(xrt::task::worker,std::ref(queue));
+
+  // warm up the queue and the event pool
+  for (unsigned int i=0; i<64; ++i)
+    xrt::task::createF(queue,&dma,nullptr,1,0,4096,0).get();
+
+  auto start = allocations.load();
+  for (unsigned int i=0; i<count; ++i) {
+    if (wrap) {
+      xrt::event ev(xrt::task::createF(queue,&dma,nullptr,1,0,4096,0));
+      ev.wait();
+    }
+    else
+      xrt::task::createF(queue,&dma,nullptr,1,0,4096,0).get();
+  }
+  auto allocs = static_cast<double>(allocations.load()-start)/count;
+
+  queue.stop();
+  worker.join();
+  return allocs;
+}
+
+}
+
+// Replacement global allocation functions counting allocations.
+// Not inlined so the compiler sees matching new/delete pairs.
+__attribute__((noinline)) void*
+operator new(size_t sz)
+{
+  ++allocations;
+  if (auto ptr = std::malloc(sz ? sz : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void
+operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+BOOST_AUTO_TEST_SUITE ( test_task_alloc )
+
+BOOST_AUTO_TEST_CASE( test_task_alloc1 )
+{
+  const unsigned int count = 100000;
+  std::cout << "legacy packaged_task: " << legacy(count) << " allocations per task\n";
+  for (bool lockfree : {false,true}) {
+    for (bool wrap : {false,true}) {
+      auto allocs = current(lockfree,wrap,count);
+      std::cout << (lockfree ? "lockfree" : "mutex") << " queue"
+                << (wrap ? ", xrt::event" : ", task::event")
+                << ": " << allocs << " allocations per task\n";
+      BOOST_CHECK_EQUAL(allocs,0);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
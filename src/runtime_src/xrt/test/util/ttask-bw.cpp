@@ -0,0 +1,101 @@
+/**
+ * Copyright (C) 2016-2017 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+////////////////////////////////////////////////////////////////
+// Benchmark of xrt/util/task.h queues
+//
+// Compares enqueue->execute latency and throughput of the mutex
+// based task queue against the lock free task queue
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+#include "../test_helpers.h"
+
+#include "xrt/util/task.h"
+#include "xrt/util/time.h"
+
+#include <atomic>
+#include <iostream>
+
+using namespace xrt::test;
+
+namespace {
+
+static void
+latency(xrt::task::queue& queue, unsigned int count)
+{
+  unsigned long total = 0;
+  for (unsigned int i=0; i<count; ++i) {
+    auto start = xrt::time_ns();
+    auto tev = xrt::task::createF(queue,[start]() { return xrt::time_ns()-start; });
+    total += tev.get();
+  }
+  std::cout << "  enqueue->execute latency: " << total/count << " ns\n";
+}
+
+static void
+throughput(xrt::task::queue& queue, unsigned int producers, unsigned int count)
+{
+  std::atomic<unsigned int> done(0);
+  auto inc = [&done]() { ++done; };
+
+  Timer timer;
+  std::vector<std::thread> threads;
+  for (unsigned int p=0; p<producers; ++p)
+    threads.push_back(std::thread([&queue,&inc,count]() {
+          for (unsigned int i=0; i<count; ++i)
+            xrt::task::createF(queue,inc);
+        }));
+  for (auto& t : threads)
+    t.join();
+  while (done < producers*count)
+    std::this_thread::yield();
+  auto sec = timer.stop();
+
+  std::cout << "  " << producers << " producers throughput: "
+            << static_cast<unsigned long>(producers*count/sec) << " tasks/s\n";
+}
+
+static void
+run(bool lockfree, unsigned int workers)
+{
+  xrt::task::queue queue(lockfree);
+  std::vector<std::thread> threads;
+  for (unsigned int i=0; i<workers; ++i)
+    threads.push_back(std::thread(xrt::task::worker,std::ref(queue)));
+
+  std::cout << (lockfree ? "lockfree" : "mutex") << " queue, " << workers << " workers\n";
+  latency(queue,10000);
+  for (auto producers : {1,4,8})
+    throughput(queue,producers,100000);
+
+  queue.stop();
+  for (auto& t : threads)
+    t.join();
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_task_bw )
+
+BOOST_AUTO_TEST_CASE( test_task_bw1 )
+{
+  for (auto workers : {1,4,8})
+    for (bool lockfree : {false,true})
+      run(lockfree,workers);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -110,6 +110,66 @@ BOOST_AUTO_TEST_CASE( test_task1 )
     t.join();
 }
 
+BOOST_AUTO_TEST_CASE( test_task2 )
+{
+  // lock free queue with a capacity small enough to exercise the
+  // full queue path
+  xrt::task::lfqueue<xrt::task::task> lfq(4);
+  xrt::task::task t([]{});
+  for (int i=0; i<4; ++i) {
+    xrt::task::task tmp([]{});
+    BOOST_CHECK_EQUAL(lfq.tryAddWork(tmp),true);
+  }
+  BOOST_CHECK_EQUAL(lfq.tryAddWork(t),false);
+  BOOST_CHECK_EQUAL(t.valid(),true);
+  BOOST_CHECK_EQUAL(lfq.size(),4);
+
+  xrt::task::task out;
+  while (lfq.tryGetWork(out))
+    out();
+  BOOST_CHECK_EQUAL(lfq.size(),0);
+
+  // same tests as test_task1 but with lock free task queue
+  xrt::task::queue queue(true);
+  BOOST_CHECK_EQUAL(queue.is_lockfree(),true);
+  std::vector<std::thread> workers;
+  workers.push_back(std::thread(xrt::task::worker,std::ref(queue)));
+  workers.push_back(std::thread(xrt::task::worker,std::ref(queue)));
+
+  {
+    auto tev = xrt::task::createF(queue,&sleepy_waiter,100);
+    BOOST_CHECK_EQUAL(tev.get(),100);
+  }
+
+  {
+    API api;
+    auto tev = xrt::task::createM(queue,&API::foo,api,100,'a');
+    BOOST_CHECK_EQUAL(tev.get(),100);
+  }
+
+  {
+    // many producers
+    std::atomic<int> count(0);
+    auto inc = [&count]() { ++count; };
+    std::vector<std::thread> producers;
+    for (int p=0; p<4; ++p)
+      producers.push_back(std::thread([&queue,&inc]() {
+            for (int i=0; i<10000; ++i)
+              xrt::task::createF(queue,inc);
+          }));
+    for (auto& p : producers)
+      p.join();
+    xrt::task::createF(queue,&noargs).get();
+    while (count < 40000)
+      std::this_thread::yield();
+    BOOST_CHECK_EQUAL(count,40000);
+  }
+
+  queue.stop();
+  for (auto& t : workers)
+    t.join();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
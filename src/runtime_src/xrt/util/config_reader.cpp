@@ -74,10 +74,11 @@ struct tree
 {
   boost::property_tree::ptree m_tree;
 
+  // Read m_tree directly, the tree may still be under construction
   void
   setenv()
   {
-    if (xrt::config::get_multiprocess())
+    if (m_tree.get<bool>("Runtime.multiprocess",false))
       ::setenv("XCL_MULTIPROCESS_MODE","1",1);
   }
 
@@ -112,7 +113,14 @@ struct tree
   }
 };
 
-static tree s_tree;
+// Constructed on first use, config values are read during static
+// initialization of other translation units (e.g. task queues)
+static tree&
+get_tree()
+{
+  static tree s_tree;
+  return s_tree;
+}
 
 }
 
@@ -123,16 +131,16 @@ namespace detail {
 bool
 get_bool_value(const char* key, bool default_value)
 {
-  return s_tree.m_tree.get<bool>(key,default_value);
+  return get_tree().m_tree.get<bool>(key,default_value);
 }
 
 std::string
 get_string_value(const char* key, const std::string& default_value)
 {
-  std::string val = s_tree.m_tree.get<std::string>(key,default_value);
+  std::string val = get_tree().m_tree.get<std::string>(key,default_value);
   // Although INI file entries are not supposed to have quotes around strings
   // but we want to be cautious
-  if ((val.front() == '"') && (val.back() == '"')) {
+  if ((val.size() > 1) && (val.front() == '"') && (val.back() == '"')) {
     val.erase(0, 1);
     val.erase(val.size()-1);
   }
@@ -142,16 +150,16 @@ get_string_value(const char* key, const std::string& default_value)
 unsigned int
 get_uint_value(const char* key, unsigned int default_value)
 {
-  return s_tree.m_tree.get<unsigned int>(key,default_value);
+  return get_tree().m_tree.get<unsigned int>(key,default_value);
 }
 
 std::ostream&
 debug(std::ostream& ostr, const std::string& ini)
 {
   if (!ini.empty())
-    s_tree.reread(ini);
+    get_tree().reread(ini);
 
-  for(auto& section : s_tree.m_tree) {
+  for(auto& section : get_tree().m_tree) {
     ostr << "[" << section.first << "]\n";
     for (auto& key:section.second) {
       ostr << key.first << " = " << key.second.get_value<std::string>() << std::endl;
@@ -137,6 +137,48 @@ get_timeline_trace()
   return value;
 }
 
+/**
+ * Write the timeline trace in compressed binary form instead of csv.
+ * Expand with xtrace2csv.
+ */
+inline bool
+get_timeline_trace_binary()
+{
+  static bool value = get_timeline_trace() && detail::get_bool_value("Debug.timeline_trace_binary",false);
+  return value;
+}
+
+inline bool
+get_timeline_trace_compression()
+{
+  static bool value = detail::get_bool_value("Debug.timeline_trace_compression",true);
+  return value;
+}
+
+inline bool
+get_api_trace_buffer()
+{
+  static bool value = get_profile() && detail::get_bool_value("Debug.api_trace_buffer",false);
+  return value;
+}
+
+/**
+ * Write decoded device trace events in binary form to this file
+ */
+inline std::string
+get_device_trace_file()
+{
+  static std::string value = (!get_profile()) ? "" : detail::get_string_value("Debug.device_trace_file","");
+  return value;
+}
+
+inline unsigned int
+get_trace_offload_interval_ms()
+{
+  static unsigned int value = (!get_profile()) ? 0 : detail::get_uint_value("Debug.trace_offload_interval_ms",0);
+  return value;
+}
+
 inline bool
 get_api_checks()
 {
@@ -165,6 +207,60 @@ get_dma_threads()
   return value;
 }
 
+/**
+ * Buffer transfers larger than this many bytes are split into chunks
+ * of this size and spread over all DMA channels.  0 disables chunking.
+ */
+inline unsigned int
+get_dma_chunk_size()
+{
+  static unsigned int value = detail::get_uint_value("Runtime.dma_chunk_size",0);
+  return value;
+}
+
+/**
+ * Task queue implementation used by DMA and notification workers,
+ * either "mutex" (default) or "lockfree".
+ */
+inline std::string
+get_task_queue()
+{
+  static std::string value = detail::get_string_value("Runtime.task_queue","mutex");
+  return value;
+}
+
+/**
+ * Capacity of lock free task queues, rounded up to a power of 2
+ */
+inline unsigned int
+get_task_queue_size()
+{
+  static unsigned int value = detail::get_uint_value("Runtime.task_queue_size",4096);
+  return value;
+}
+
+/**
+ * Number of command exec buffers preallocated per device
+ */
+inline unsigned int
+get_command_pool_size()
+{
+  static unsigned int value = detail::get_uint_value("Runtime.command_pool_size",16);
+  return value;
+}
+
+/**
+ * Directory for binary images of xclbin meta data.  An image is
+ * derived from the xclbin xml on first load and reused by later
+ * loads of the same xclbin.  Empty (default) disables the cache.
+ */
+inline std::string
+get_xclbin_metadata_cache()
+{
+  static std::string value = detail::get_string_value("Runtime.xclbin_metadata_cache","");
+  return value;
+}
+
 inline unsigned int
 get_polling_throttle()
 {
@@ -218,6 +314,17 @@ get_kds()
   return value;
 }
 
+/**
+ * Use one software scheduler thread per device instead of one
+ * thread servicing all devices
+ */
+inline bool
+get_sws_thread_per_device()
+{
+  static bool value = detail::get_bool_value("Runtime.sws_thread_per_device",false);
+  return value;
+}
+
 /**
  * Enable / disable embedded runtime scheduler
  */
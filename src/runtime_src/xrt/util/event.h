@@ -19,6 +19,10 @@
 
 #include "xrt/util/error.h"
 
+#include <memory>
+#include <new>
+#include <type_traits>
+
 namespace xrt {
 
 /**
@@ -47,6 +51,10 @@ namespace xrt {
  *   myevent ev = ...;
  *   xrt::event ev(std::move(myevent));
  *   int i = ev.get<int>();
+ *
+ * Small concrete events, e.g. task::event and typed_event of scalar
+ * types, are stored in place within the xrt::event object, larger
+ * events are heap allocated.
  */
 class event
 {
@@ -55,6 +63,7 @@ class event
     virtual ~iholder() {}
     virtual void wait() const = 0;
     virtual bool ready() const = 0;
+    virtual iholder* move_to(void* buffer) = 0;
   };
 
   template <typename ValueType, int dummy=0>
@@ -88,6 +97,7 @@ class event
     event_holder(EventType&& e) : m_held(std::move(e)) {}
     void wait()  const { if (!this->isValid()) this->setValue(m_held.wait()); }
     bool ready() const { return this->isValid() ? true : m_held.ready(); }
+    iholder* move_to(void* buffer) { return new (buffer) event_holder(std::move(*this)); }
   };
 
   // Argh, avoid specialization, find a better way to compose setValue
@@ -100,15 +110,64 @@ class event
     event_holder(EventType&& e) : m_held(std::move(e)) {}
     void wait()  const { if (!this->isValid()) {m_held.wait(); this->setValue();} }
     bool ready() const { return this->isValid() ? true : m_held.ready(); }
+    iholder* move_to(void* buffer) { return new (buffer) event_holder(std::move(*this)); }
   };
 
-  std::unique_ptr<iholder> m_content;
+  static constexpr size_t inline_size = 48;
+  typename std::aligned_storage<inline_size>::type m_buffer;
+  iholder* m_content;
+
+  bool
+  is_inline() const
+  {
+    return m_content == reinterpret_cast<const iholder*>(&m_buffer);
+  }
+
+  void
+  reset()
+  {
+    if (!m_content)
+      return;
+    if (is_inline())
+      m_content->~iholder();
+    else
+      delete m_content;
+    m_content = nullptr;
+  }
+
+  void
+  take(event& rhs)
+  {
+    if (!rhs.m_content)
+      m_content = nullptr;
+    else if (rhs.is_inline()) {
+      m_content = rhs.m_content->move_to(&m_buffer);
+      rhs.reset();
+    }
+    else
+      m_content = rhs.m_content;
+    rhs.m_content = nullptr;
+  }
+
+  template <typename Holder, typename EventType>
+  static iholder*
+  create(void* buffer, EventType&& e, std::true_type)
+  {
+    return new (buffer) Holder(std::forward<EventType>(e));
+  }
+
+  template <typename Holder, typename EventType>
+  static iholder*
+  create(void*, EventType&& e, std::false_type)
+  {
+    return new Holder(std::forward<EventType>(e));
+  }
 
   template <typename ValueType>
   value_holder<ValueType>*
   value_cast() const noexcept
   {
-    return dynamic_cast<value_holder<ValueType>*>(m_content.get());
+    return dynamic_cast<value_holder<ValueType>*>(m_content);
   }
 
 
@@ -119,21 +178,31 @@ public:
   {}
 
   event(event&& rhs)
-    : m_content(std::move(rhs.m_content))
   {
-    // Invalidate rhs to avoid double delete
-    rhs.m_content = nullptr;
+    take(rhs);
   }
 
-  template <typename EventType>
+  template <typename EventType,
+            typename Holder = event_holder<EventType,typename EventType::value_type>>
   event(EventType&& e)
-    : m_content(new event_holder<EventType,typename EventType::value_type>(std::forward<EventType>(e)))
+    : m_content(create<Holder>(&m_buffer,std::forward<EventType>(e),
+                               std::integral_constant<bool,
+                               (sizeof(Holder) <= inline_size
+                                && alignof(Holder) <= alignof(decltype(m_buffer)))>()))
   {}
 
+  ~event()
+  {
+    reset();
+  }
+
   event&
   operator=(event&& e)
   {
-    std::swap(m_content,e.m_content);
+    if (this != &e) {
+      reset();
+      take(e);
+    }
     return *this;
   }
 
@@ -0,0 +1,66 @@
+/**
+ * Copyright (C) 2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include "fill.h"
+#include <cstring>
+#include <cstdint>
+
+namespace {
+
+// 64 byte vector, lowered by the compiler to the widest stores
+// available on the target
+typedef uint8_t vec64 __attribute__((vector_size(64)));
+
+const size_t block_size = 2*sizeof(vec64);
+
+}
+
+namespace xrt {
+
+void
+fill(void* dst, size_t size, const void* pattern, size_t pattern_size)
+{
+  auto cdst = static_cast<char*>(dst);
+
+  if (!pattern_size || block_size % pattern_size) {
+    for (; pattern_size && pattern_size <= size; size-=pattern_size, cdst+=pattern_size)
+      std::memcpy(cdst,pattern,pattern_size);
+    if (size)
+      std::memcpy(cdst,pattern,size);
+    return;
+  }
+
+  // Expand pattern into block of two vector registers
+  vec64 block[2];
+  auto bytes = reinterpret_cast<char*>(block);
+  for (size_t i=0; i<block_size; i+=pattern_size)
+    std::memcpy(bytes+i,pattern,pattern_size);
+  auto lo = block[0];
+  auto hi = block[1];
+
+  // Wide stores, block_size is a multiple of pattern_size so
+  // pattern stays in phase
+  for (; size >= block_size; size-=block_size, cdst+=block_size) {
+    std::memcpy(cdst,&lo,sizeof(vec64));
+    std::memcpy(cdst+sizeof(vec64),&hi,sizeof(vec64));
+  }
+
+  if (size)
+    std::memcpy(cdst,bytes,size);
+}
+
+} // xrt
@@ -0,0 +1,46 @@
+/**
+ * Copyright (C) 2018 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef xrt_util_fill_h_
+#define xrt_util_fill_h_
+
+#include <cstddef>
+
+namespace xrt {
+
+/**
+ * Fill memory with a repeated pattern
+ *
+ * Patterns whose size divides 128 bytes are expanded into 64 byte
+ * vector registers and written with wide stores.  Other patterns
+ * are copied one pattern at a time.
+ *
+ * @param dst
+ *   Memory to fill
+ * @param size
+ *   Number of bytes to fill, a trailing partial pattern is written
+ *   if size is not a multiple of pattern_size
+ * @param pattern
+ *   The pattern to fill with
+ * @param pattern_size
+ *   The size of the pattern in bytes
+ */
+void
+fill(void* dst, size_t size, const void* pattern, size_t pattern_size);
+
+} // xrt
+
+#endif
@@ -212,6 +212,17 @@ public:
     std::memset(m_regmap,0,MaxSize*sizeof(WordType));
   }
 
+  /**
+   * Clear first @words words only, for recycled storage where
+   * only a known prefix is dirty
+   */
+  void
+  clear(size_type words)
+  {
+    m_size = 0;
+    std::memset(m_regmap,0,std::min(words,MaxSize)*sizeof(WordType));
+  }
+
   std::size_t
   bytes() const
   {
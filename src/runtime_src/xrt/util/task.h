@@ -27,68 +27,190 @@
 #include <queue>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <type_traits>
+#include <exception>
 #include <iostream>
 
 namespace xrt { namespace task {
 
 /**
- * Type erased std::packaged_task<RT()>
+ * Type erased callable with small buffer optimization
  *
- * Wraps a std::packaged_task of any return type, such that the task's
- * return value can be captured in a future.
+ * Wraps any nullary callable, typically a task runner that captures
+ * the task's return value in an event (see createF and createM).
+ *
+ * Callables that fit in the inline buffer and are nothrow move
+ * constructible are stored in place, larger callables are heap
+ * allocated.  The task scheduling path of xrt creates callables that
+ * fit inline, so constructing and moving a task does not allocate.
  *
  * Objects of this task class can be stored in any STL container even
- * when the underlying std::packaged_tasks are of different types.
+ * when the underlying callables are of different types.
  */
 class task
 {
-  struct task_iholder
+  static constexpr size_t inline_size = 96;
+  using storage_type = std::aligned_storage<inline_size>::type;
+
+  struct ops
   {
-    virtual ~task_iholder() {};
-    virtual void execute() = 0;
+    void (*execute)(storage_type&);
+    void (*move)(storage_type& dst, storage_type& src);
+    void (*destroy)(storage_type&);
+  };
+
+  template <typename Callable,
+            bool small = (sizeof(Callable)<=inline_size
+                          && alignof(Callable)<=alignof(storage_type)
+                          && std::is_nothrow_move_constructible<Callable>::value)>
+  struct holder
+  {
+    static Callable*
+    get(storage_type& s)
+    {
+      return reinterpret_cast<Callable*>(&s);
+    }
+
+    static void
+    create(storage_type& s, Callable&& c)
+    {
+      new (&s) Callable(std::move(c));
+    }
+
+    static void
+    execute(storage_type& s)
+    {
+      (*get(s))();
+    }
+
+    static void
+    move(storage_type& dst, storage_type& src)
+    {
+      new (&dst) Callable(std::move(*get(src)));
+      get(src)->~Callable();
+    }
+
+    static void
+    destroy(storage_type& s)
+    {
+      get(s)->~Callable();
+    }
+
+    static const ops*
+    table()
+    {
+      static const ops t = { &execute, &move, &destroy };
+      return &t;
+    }
   };
 
   template <typename Callable>
-  struct task_holder : public task_iholder
+  struct holder<Callable,false>
   {
-    Callable held;
-    task_holder(Callable&& t) : held(std::move(t)) {}
-    void execute() { held(); }
+    static Callable*&
+    get(storage_type& s)
+    {
+      return *reinterpret_cast<Callable**>(&s);
+    }
+
+    static void
+    create(storage_type& s, Callable&& c)
+    {
+      get(s) = new Callable(std::move(c));
+    }
+
+    static void
+    execute(storage_type& s)
+    {
+      (*get(s))();
+    }
+
+    static void
+    move(storage_type& dst, storage_type& src)
+    {
+      get(dst) = get(src);
+    }
+
+    static void
+    destroy(storage_type& s)
+    {
+      delete get(s);
+    }
+
+    static const ops*
+    table()
+    {
+      static const ops t = { &execute, &move, &destroy };
+      return &t;
+    }
   };
 
-  std::unique_ptr<task_iholder> content;
+  storage_type m_storage;
+  const ops* m_ops;
+
+  void
+  reset()
+  {
+    if (m_ops)
+      m_ops->destroy(m_storage);
+    m_ops = nullptr;
+  }
 
 public:
   task()
-    : content(nullptr)
+    : m_ops(nullptr)
   {}
 
   task(task&& rhs)
-    : content(std::move(rhs.content))
-  {}
+    : m_ops(rhs.m_ops)
+  {
+    if (m_ops)
+      m_ops->move(m_storage,rhs.m_storage);
+    rhs.m_ops = nullptr;
+  }
 
-  template <typename Callable>
+  template <typename Callable,
+            typename C = typename std::decay<Callable>::type,
+            typename = typename std::enable_if<!std::is_same<C,task>::value>::type>
   task(Callable&& c)
-    : content(new task_holder<Callable>(std::forward<Callable>(c)))
-  {}
+    : m_ops(holder<C>::table())
+  {
+    C tmp(std::forward<Callable>(c));
+    holder<C>::create(m_storage,std::move(tmp));
+  }
+
+  ~task()
+  {
+    reset();
+  }
 
   task&
   operator=(task&& rhs)
   {
-    content = std::move(rhs.content);
+    if (this != &rhs) {
+      reset();
+      m_ops = rhs.m_ops;
+      if (m_ops)
+        m_ops->move(m_storage,rhs.m_storage);
+      rhs.m_ops = nullptr;
+    }
     return *this;
   }
 
   bool
   valid() const
   {
-    return content!=nullptr;
+    return m_ops!=nullptr;
   }
 
   void
   execute()
   {
-    content->execute();
+    m_ops->execute(m_storage);
   }
 
   void
@@ -107,13 +229,42 @@ public:
 template <typename Task>
 class mpmcqueue
 {
-  std::queue<Task> m_tasks;
+  // Circular buffer of tasks.  The buffer grows on demand but never
+  // shrinks, so adding and getting work does not allocate once the
+  // queue has reached its working size.
+  std::vector<Task> m_tasks;
+  size_t m_head = 0;
+  size_t m_count = 0;
   mutable std::mutex m_mutex;
   std::condition_variable m_work;
   bool m_stop = false;
   unsigned long tp = 0;       // time point when last task consumed
   unsigned long waittime = 0; // wait time from tp to next task avail
   bool debug = false;
+
+  void
+  push(Task&& t)
+  {
+    if (m_count == m_tasks.size()) {
+      std::vector<Task> tasks(std::max<size_t>(16,2*m_tasks.size()));
+      for (size_t i=0; i<m_count; ++i)
+        tasks[i] = std::move(m_tasks[(m_head+i) % m_tasks.size()]);
+      m_tasks.swap(tasks);
+      m_head = 0;
+    }
+    m_tasks[(m_head+m_count) % m_tasks.size()] = std::move(t);
+    ++m_count;
+  }
+
+  Task
+  pop()
+  {
+    Task task = std::move(m_tasks[m_head]);
+    m_head = (m_head+1) % m_tasks.size();
+    --m_count;
+    return task;
+  }
+
 public:
   mpmcqueue()
   {}
@@ -126,14 +277,14 @@ public:
   addWork(Task&& t)
   {
     std::lock_guard<std::mutex> lk(m_mutex);
-    m_tasks.push(std::move(t));
+    push(std::move(t));
     if (debug && tp) {
       auto wt = time_ns() - tp;
       waittime += wt;
-      XRT_DEBUG(std::cout,"m_tasks.size()=",m_tasks.size()," waittime (ms): ",wt*1e-6,"\n");
+      XRT_DEBUG(std::cout,"m_tasks.size()=",m_count," waittime (ms): ",wt*1e-6,"\n");
       tp = 0;
     }
-    //XRT_PRINT(std::cout,"m_tasks.size()=",m_tasks.size(),"\n");
+    //XRT_PRINT(std::cout,"m_tasks.size()=",m_count,"\n");
     m_work.notify_one();
   }
 
@@ -141,15 +292,14 @@ public:
   getWork()
   {
     std::unique_lock<std::mutex> lk(m_mutex);
-    while (!m_stop && m_tasks.empty()) {
+    while (!m_stop && m_count==0) {
       m_work.wait(lk);
     }
 
     Task task;
     if (!m_stop) {
-      task = std::move(m_tasks.front());
-      m_tasks.pop();
-      if (debug && m_tasks.size()==0)
+      task = pop();
+      if (debug && m_count==0)
         tp = time_ns();
 
     }
@@ -160,7 +310,7 @@ public:
   size() const
   {
     std::lock_guard<std::mutex> lk(m_mutex);
-    return m_tasks.size();
+    return m_count;
   }
 
   void
@@ -228,59 +378,574 @@ public:
   }
 };
 
-using queue = mpmcqueue<task>;
+/**
+ * Bounded lock free multiple producer / multiple consumer queue
+ *
+ * Ring buffer of cells with per cell sequence numbers.  Producers
+ * and consumers claim a cell by CAS on the enqueue and dequeue
+ * positions respectively, there is no shared lock in the common
+ * path.
+ *
+ * Consumers spin for a while before parking on a condition
+ * variable.  Producers only take the parking mutex if some consumer
+ * is actually parked, so a busy queue does no futex calls.  When the
+ * ring is full the producer yields until a slot is available.
+ */
+template <typename Task>
+class lfqueue
+{
+  struct cell
+  {
+    std::atomic<size_t> seq;
+    Task data;
+  };
+
+  // Number of failed pops before a consumer parks
+  static constexpr unsigned int spin_count = 2048;
+
+  std::unique_ptr<cell[]> m_cells;
+  const size_t m_mask;
+
+  // Keep producer and consumer positions on separate cache lines
+  std::atomic<size_t> m_enqueue {0};
+  char m_pad0[64];
+  std::atomic<size_t> m_dequeue {0};
+  char m_pad1[64];
+  std::atomic<unsigned int> m_sleepers {0};
+  std::atomic<bool> m_stop {false};
+
+  std::mutex m_mutex;
+  std::condition_variable m_work;
+
+  static size_t
+  round_up(size_t sz)
+  {
+    size_t pow2 = 2;
+    while (pow2 < sz)
+      pow2 <<= 1;
+    return pow2;
+  }
+
+public:
+  explicit lfqueue(size_t capacity=4096)
+    : m_cells(new cell[round_up(capacity)]), m_mask(round_up(capacity)-1)
+  {
+    for (size_t i=0; i<=m_mask; ++i)
+      m_cells[i].seq.store(i,std::memory_order_relaxed);
+  }
+
+  /**
+   * Try to add a task to the queue
+   *
+   * @return
+   *   true if task was moved to the queue, false if queue is full
+   *   in which case the task argument is left unchanged.
+   */
+  bool
+  tryAddWork(Task& t)
+  {
+    cell* c = nullptr;
+    size_t pos = m_enqueue.load(std::memory_order_relaxed);
+    while (true) {
+      c = &m_cells[pos & m_mask];
+      auto seq = c->seq.load(std::memory_order_acquire);
+      auto dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (dif == 0) {
+        if (m_enqueue.compare_exchange_weak(pos,pos+1,std::memory_order_relaxed))
+          break;
+      }
+      else if (dif < 0)
+        return false;
+      else
+        pos = m_enqueue.load(std::memory_order_relaxed);
+    }
+    c->data = std::move(t);
+    c->seq.store(pos+1,std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Try to get a task from the queue
+   *
+   * @return
+   *   true if a task was retrieved, false if queue is empty
+   */
+  bool
+  tryGetWork(Task& t)
+  {
+    cell* c = nullptr;
+    size_t pos = m_dequeue.load(std::memory_order_relaxed);
+    while (true) {
+      c = &m_cells[pos & m_mask];
+      auto seq = c->seq.load(std::memory_order_acquire);
+      auto dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos+1);
+      if (dif == 0) {
+        if (m_dequeue.compare_exchange_weak(pos,pos+1,std::memory_order_relaxed))
+          break;
+      }
+      else if (dif < 0)
+        return false;
+      else
+        pos = m_dequeue.load(std::memory_order_relaxed);
+    }
+    t = std::move(c->data);
+    c->seq.store(pos+m_mask+1,std::memory_order_release);
+    return true;
+  }
+
+  void
+  addWork(Task&& t)
+  {
+    while (!tryAddWork(t))
+      std::this_thread::yield();
+
+    // Pairs with fence in getWork, either the parked consumer sees
+    // the task or this thread sees the consumer as sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleepers.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_work.notify_one();
+    }
+  }
+
+  Task
+  getWork()
+  {
+    Task task;
+
+    // spin
+    for (unsigned int i=0; i<spin_count && !m_stop.load(std::memory_order_relaxed); ++i) {
+      if (tryGetWork(task))
+        return task;
+      if (i > 64)
+        std::this_thread::yield();
+    }
+
+    // park
+    std::unique_lock<std::mutex> lk(m_mutex);
+    m_sleepers.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (!m_stop && !tryGetWork(task))
+      m_work.wait(lk);
+    m_sleepers.fetch_sub(1);
+
+    if (m_stop)
+      return Task();
+    return task;
+  }
+
+  size_t
+  size() const
+  {
+    auto enq = m_enqueue.load(std::memory_order_relaxed);
+    auto deq = m_dequeue.load(std::memory_order_relaxed);
+    return enq > deq ? enq - deq : 0;
+  }
+
+  void
+  stop()
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_stop = true;
+    m_work.notify_all();
+  }
+};
 
 /**
- * event class wraps std::future<RT>
+ * Task queue used by xrt worker threads
  *
- * Adds a ready() function that can be used to poll if event is ready.
- * Otherwise, currently adds no value compared to bare std::future
+ * The queue implementation is selected at construction, either
+ * the mutex based mpmcqueue (default) or the lock free lfqueue.
+ * The default can be changed in sdaccel.ini:
+ *  [Runtime]
+ *   task_queue = lockfree
+ */
+class queue
+{
+  std::unique_ptr<mpmcqueue<task>> m_mpmc;
+  std::unique_ptr<lfqueue<task>> m_lf;
+
+public:
+  queue()
+    : queue(config::get_task_queue()=="lockfree")
+  {}
+
+  explicit queue(bool lockfree)
+  {
+    if (lockfree)
+      m_lf.reset(new lfqueue<task>(config::get_task_queue_size()));
+    else
+      m_mpmc.reset(new mpmcqueue<task>());
+  }
+
+  bool
+  is_lockfree() const
+  {
+    return m_lf!=nullptr;
+  }
+
+  void
+  addWork(task&& t)
+  {
+    if (m_lf)
+      m_lf->addWork(std::move(t));
+    else
+      m_mpmc->addWork(std::move(t));
+  }
+
+  task
+  getWork()
+  {
+    return m_lf ? m_lf->getWork() : m_mpmc->getWork();
+  }
+
+  size_t
+  size() const
+  {
+    return m_lf ? m_lf->size() : m_mpmc->size();
+  }
+
+  void
+  stop()
+  {
+    if (m_lf)
+      m_lf->stop();
+    else
+      m_mpmc->stop();
+  }
+};
+
+namespace detail {
+
+/**
+ * Shared state between a task and the event for its return value.
+ *
+ * States are recycled through a pool, so a steady stream of tasks
+ * does not allocate shared state.  A state is referenced by both the
+ * task runner and the event, it returns to the pool when both have
+ * released it.
+ */
+class state_base
+{
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::atomic<bool> m_ready {false};
+
+protected:
+  std::exception_ptr m_exception;
+
+  void
+  mark_ready()
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_ready = true;
+    }
+    m_cv.notify_all();
+  }
+
+  void
+  reset_base()
+  {
+    m_exception = nullptr;
+    m_ready = false;
+  }
+
+public:
+  std::atomic<unsigned int> m_refs {0};
+
+  bool
+  ready() const
+  {
+    return m_ready.load(std::memory_order_acquire);
+  }
+
+  void
+  wait()
+  {
+    if (ready())
+      return;
+    std::unique_lock<std::mutex> lk(m_mutex);
+    while (!m_ready)
+      m_cv.wait(lk);
+  }
+
+  void
+  set_exception(std::exception_ptr ex)
+  {
+    m_exception = std::move(ex);
+    mark_ready();
+  }
+};
+
+template <typename RT>
+class state : public state_base
+{
+  typename std::aligned_storage<sizeof(RT),alignof(RT)>::type m_value;
+  bool m_has_value = false;
+
+  RT*
+  value()
+  {
+    return reinterpret_cast<RT*>(&m_value);
+  }
+
+public:
+  state* m_next = nullptr;
+
+  void
+  set_value(RT&& v)
+  {
+    new (&m_value) RT(std::move(v));
+    m_has_value = true;
+    mark_ready();
+  }
+
+  RT
+  take()
+  {
+    wait();
+    if (m_exception)
+      std::rethrow_exception(m_exception);
+    RT v(std::move(*value()));
+    value()->~RT();
+    m_has_value = false;
+    return v;
+  }
+
+  void
+  reset()
+  {
+    if (m_has_value)
+      value()->~RT();
+    m_has_value = false;
+    reset_base();
+  }
+};
+
+template <>
+class state<void> : public state_base
+{
+public:
+  state* m_next = nullptr;
+
+  void
+  set_value()
+  {
+    mark_ready();
+  }
+
+  void
+  take()
+  {
+    wait();
+    if (m_exception)
+      std::rethrow_exception(m_exception);
+  }
+
+  void
+  reset()
+  {
+    reset_base();
+  }
+};
+
+/**
+ * Free list of shared states per return type.
+ *
+ * The pool is never destroyed since states can be released by
+ * worker threads during static destruction.
+ */
+template <typename RT>
+class state_pool
+{
+  std::mutex m_mutex;
+  state<RT>* m_free = nullptr;
+
+public:
+  static state_pool&
+  instance()
+  {
+    static state_pool* pool = new state_pool;
+    return *pool;
+  }
+
+  state<RT>*
+  acquire()
+  {
+    state<RT>* s = nullptr;
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      if ((s = m_free))
+        m_free = s->m_next;
+    }
+    if (!s)
+      s = new state<RT>;
+    s->m_next = nullptr;
+    s->m_refs = 2; // task and event
+    return s;
+  }
+
+  void
+  release(state<RT>* s)
+  {
+    if (--s->m_refs)
+      return;
+    s->reset();
+    std::lock_guard<std::mutex> lk(m_mutex);
+    s->m_next = m_free;
+    m_free = s;
+  }
+};
+
+template <typename RT, typename Bound>
+inline void
+set_result(state<RT>* s, Bound& b)
+{
+  s->set_value(b());
+}
+
+template <typename Bound>
+inline void
+set_result(state<void>* s, Bound& b)
+{
+  b();
+  s->set_value();
+}
+
+/**
+ * Callable stored in a task::task.  Executes the bound function
+ * and stores its result (or exception) in the shared state.  A
+ * runner destroyed without being executed breaks its promise.
+ */
+template <typename RT, typename Bound>
+class runner
+{
+  state<RT>* m_state;
+  Bound m_bound;
+
+public:
+  runner(state<RT>* s, Bound&& b)
+    : m_state(s), m_bound(std::move(b))
+  {}
+
+  runner(runner&& rhs) noexcept(std::is_nothrow_move_constructible<Bound>::value)
+    : m_state(rhs.m_state), m_bound(std::move(rhs.m_bound))
+  {
+    rhs.m_state = nullptr;
+  }
+
+  ~runner()
+  {
+    if (!m_state)
+      return;
+    m_state->set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+    state_pool<RT>::instance().release(m_state);
+  }
+
+  void
+  operator() ()
+  {
+    auto s = m_state;
+    m_state = nullptr;
+    try {
+      set_result(s,m_bound);
+    }
+    catch (...) {
+      s->set_exception(std::current_exception());
+    }
+    state_pool<RT>::instance().release(s);
+  }
+};
+
+template <typename RT, typename Bound>
+inline runner<RT,Bound>
+make_runner(state<RT>* s, Bound&& b)
+{
+  return runner<RT,Bound>(s,std::move(b));
+}
+
+} // detail
+
+/**
+ * event class for the return value of a task
+ *
+ * Similar to std::future<RT> but with a ready() function that can
+ * be used to poll if event is ready.  The shared state between task
+ * and event is pooled, so creating an event does not allocate in
+ * steady state.
+ *
+ * As with std::future, get() can be called only once.
  */
 template <typename RT>
 class event
 {
 public:
   typedef RT value_type;
-  typedef std::future<value_type> FutureType;
 
 private:
-  mutable FutureType m_future;
+  mutable detail::state<RT>* m_state;
+
+  struct releaser
+  {
+    detail::state<RT>* s;
+    ~releaser() { detail::state_pool<RT>::instance().release(s); }
+  };
+
+  detail::state<RT>*
+  valid_state() const
+  {
+    if (!m_state)
+      throw std::future_error(std::future_errc::no_state);
+    return m_state;
+  }
 
 public:
   event() = delete;
   event(const event& rhs) = delete;
 
-  event(const event&& rhs)
-    : m_future(std::move(rhs.m_future))
-  {}
+  event(event&& rhs)
+    : m_state(rhs.m_state)
+  {
+    rhs.m_state = nullptr;
+  }
 
-  event(FutureType&& f)
-    : m_future(std::forward<FutureType>(f))
+  explicit
+  event(detail::state<RT>* s)
+    : m_state(s)
   {}
 
+  ~event()
+  {
+    if (m_state)
+      detail::state_pool<RT>::instance().release(m_state);
+  }
+
   event&
   operator=(event&& rhs)
   {
-    m_future = std::move(rhs.m_future);
+    std::swap(m_state,rhs.m_state);
     return *this;
   }
 
   RT
   wait() const
   {
-    return m_future.get();
+    return get();
   }
 
   RT
   get() const
   {
-    return m_future.get();
+    releaser r{valid_state()};
+    m_state = nullptr;
+    return r.s->take();
   }
 
   bool
   ready() const
   {
-    return (m_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    return valid_state()->ready();
   }
 };
 
@@ -305,10 +970,9 @@ createF(Q& q, F&& f, Args&&... args)
   -> event<decltype(f(std::forward<Args>(args)...))>
 {
   typedef decltype(f(std::forward<Args>(args)...)) value_type;
-  typedef std::packaged_task<value_type()> task_type;
-  task_type t(std::bind(std::forward<F>(f),std::forward<Args>(args)...));
-  event<value_type> e(t.get_future());
-  q.addWork(std::move(t));
+  auto s = detail::state_pool<value_type>::instance().acquire();
+  event<value_type> e(s);
+  q.addWork(detail::make_runner(s,std::bind(std::forward<F>(f),std::forward<Args>(args)...)));
   return e;
 }
 
@@ -320,10 +984,9 @@ createM(Q& q, F&& f, C& c, Args&&... args)
   -> event<decltype(std::bind(std::forward<F>(f),std::ref(c),std::forward<Args>(args)...)())>
 {
   typedef decltype(std::bind(std::forward<F>(f),std::ref(c),std::forward<Args>(args)...)()) value_type;
-  typedef std::packaged_task<value_type()> task_type;
-  task_type t(std::bind(std::forward<F>(f),std::ref(c),std::forward<Args>(args)...));
-  event<value_type> e(t.get_future());
-  q.addWork(std::move(t));
+  auto s = detail::state_pool<value_type>::instance().acquire();
+  event<value_type> e(s);
+  q.addWork(detail::make_runner(s,std::bind(std::forward<F>(f),std::ref(c),std::forward<Args>(args)...)));
   return e;
 }
 #pragma GCC diagnostic pop
@@ -69,6 +69,9 @@ extern "C" {
  * @typedef XmaFrameFormatDesc
  * Member data structure describing video format and frame count
  *
+ * @typedef XmaFramePool
+ * Opaque pool of recycled frames sharing the same frame properties
+ *
 */
 
 /**
@@ -145,6 +148,7 @@ typedef struct XmaFrame
     int32_t            is_idr; /**< flag indicating that frame should be treated as an IDR frame */
     int32_t            do_not_encode; /**< flag instruction to not encode frame */
     int32_t            is_last_frame; /**< flag indicating this is the last frame to encode */
+    struct XmaFramePool *pool; /**< pool the frame is returned to when freed, NULL if not pooled */
 } XmaFrame;
 
 /**
@@ -177,9 +181,18 @@ typedef struct XmaFrameFormatDesc
     int32_t         num_planes; /**< number of planes for format */
 } XmaFrameFormatDesc;
 
+typedef struct XmaFramePool XmaFramePool;
+
+struct XmaHwSession;
+
 /**
  * Allocate a new frame buffer according to specified frame properties
  *
+ * Planes are sized for the chroma subsampling of the format and
+ * aligned to 64 bytes.  If frame pooling is enabled with
+ * @ref xma_frame_pool_enable() the frame is taken from a pool shared
+ * by all frames with the same properties.
+ *
  * @param [in] frame_props Description of frame buffer to be allocated
  *
  * @returns XmaFrame pointer
@@ -187,6 +200,100 @@ typedef struct XmaFrameFormatDesc
 XmaFrame*
 xma_frame_alloc(XmaFrameProperties *frame_props);
 
+/**
+ * Return the size in bytes of a plane of the frame specified
+ *
+ * @param [in] frame_props Properties of frame being queried
+ * @param [in] plane Index of plane
+ *
+ * @returns size of plane, 0 if format has no such plane
+*/
+size_t
+xma_frame_plane_size_get(XmaFrameProperties *frame_props, int32_t plane);
+
+/**
+ * Enable or disable frame pooling by @ref xma_frame_alloc()
+ *
+ * Frames allocated from a pool are returned to the pool by
+ * @ref xma_frame_free() and reused by later allocations with the
+ * same frame properties.  Pooling is disabled by default.
+ *
+ * @param [in] enable true to allocate frames from shared pools
+*/
+void
+xma_frame_pool_enable(bool enable);
+
+/**
+ * Create a pool of frames with the specified frame properties
+ *
+ * @param [in] frame_props Properties of the frames of the pool
+ * @param [in] num_frames Number of frames allocated up front, the
+ *  pool grows when more frames are in use
+ * @param [in] hw_session If not NULL frames are allocated in device
+ *  memory of the session and mapped for host access
+ *
+ * @returns XmaFramePool pointer, NULL on failure
+*/
+XmaFramePool*
+xma_frame_pool_create(XmaFrameProperties  *frame_props,
+                      int32_t              num_frames,
+                      struct XmaHwSession *hw_session);
+
+/**
+ * Allocate a frame from a pool
+ *
+ * @param [in] pool Pool created with @ref xma_frame_pool_create()
+ *
+ * @returns XmaFrame pointer with a reference count of 1, NULL on failure
+*/
+XmaFrame*
+xma_frame_pool_alloc(XmaFramePool *pool);
+
+/**
+ * Destroy a frame pool
+ *
+ * @param [in] pool Pool created with @ref xma_frame_pool_create()
+ *
+ * @note: Frames of the pool that are still in use remain valid and
+ * are freed by @ref xma_frame_free().
+*/
+void
+xma_frame_pool_destroy(XmaFramePool *pool);
+
+/**
+ * Return the device physical address of a plane of a frame
+ *
+ * @param [in] frame Frame allocated from a pool in device memory
+ * @param [in] plane Index of plane
+ *
+ * @returns physical address of plane, 0 if frame is not in device memory
+*/
+uint64_t
+xma_frame_paddr_get(XmaFrame *frame, int32_t plane);
+
+/**
+ * Synchronize the host mapping and device memory of a frame
+ *
+ * @param [in] frame Frame allocated from a pool in device memory
+ * @param [in] to_device true to copy host writes to the device, false
+ *  to make device writes visible to the host
+ *
+ * @returns XMA_SUCCESS on success or if frame is not in device memory,
+ *  XMA_ERROR on failure
+*/
+int32_t
+xma_frame_sync(XmaFrame *frame, bool to_device);
+
+/**
+ * Add a reference to a frame
+ *
+ * @param [in] frame Frame to reference
+ *
+ * @returns frame, which must be released with @ref xma_frame_free()
+*/
+XmaFrame*
+xma_frame_ref(XmaFrame *frame);
+
 /**
  * Return the number of planes in the frame specified
  *
@@ -213,6 +320,9 @@ xma_frame_from_buffers_clone(XmaFrameProperties *frame_props,
 /**
  * Free frame data structure
  *
+ * Drops a reference to the frame, the frame is freed or returned
+ * to its pool when the last reference is dropped.
+ *
  * @param frame frame instance to free
  *
  * @note: A buffer with is_clone flag set will not be freed
@@ -18,6 +18,7 @@
 #define _XMA_HW_H_
 
 #include <stdint.h>
+#include <stddef.h>
 #include <stdbool.h>
 #include "lib/xmacfg.h"
 #include "lib/xmalimits.h"
@@ -127,6 +128,42 @@ bool xma_hw_is_compatible(XmaHwCfg *hwcfg, XmaSystemCfg *systemcfg);
  */
 bool xma_hw_configure(XmaHwCfg *hwcfg, XmaSystemCfg *systemcfg, bool hw_cfg_status);
 
+/**
+ *  @brief Allocate a device buffer mapped into host memory
+ *
+ *  This function allocates a buffer in the DDR bank of the
+ *  session, as done by xma_plg_buffer_alloc(), and maps the
+ *  buffer into the address space of the process.
+ *
+ *  @param s_handle  Session handle the buffer is allocated for
+ *  @param size      Size in bytes of the buffer
+ *  @param b_handle  Returns the handle of the buffer
+ *  @param paddr     Returns the physical address of the buffer
+ *
+ *  @return          Host pointer to the buffer on success
+ *                   NULL on failure
+ */
+void *xma_hw_buffer_map(XmaHwSession *s_handle, size_t size,
+                        uint32_t *b_handle, uint64_t *paddr);
+
+/**
+ *  @brief Unmap and free a buffer allocated by @ref xma_hw_buffer_map()
+ */
+void xma_hw_buffer_unmap(XmaHwSession *s_handle, uint32_t b_handle,
+                         void *data, size_t size);
+
+/**
+ *  @brief Synchronize host mapping and device memory of a buffer
+ *
+ *  @param to_device TRUE to copy host writes to the device,
+ *                   FALSE to make device writes visible to the host
+ *
+ *  @return          0 on success
+ *                  <0 on failure
+ */
+int32_t xma_hw_buffer_sync(XmaHwSession *s_handle, uint32_t b_handle,
+                           size_t size, size_t offset, bool to_device);
+
 /**
  *  @}
  */
@@ -26,6 +26,12 @@ typedef struct XmaHwInterface
     bool    (*is_compatible)(XmaHwCfg *hwcfg, XmaSystemCfg *systemcfg);
     bool    (*configure)(XmaHwCfg *hwcfg, XmaSystemCfg *systemcfg,
                          bool hw_cfg_status);
+    void*   (*buffer_map)(XmaHwSession *s_handle, size_t size,
+                          uint32_t *b_handle, uint64_t *paddr);
+    void    (*buffer_unmap)(XmaHwSession *s_handle, uint32_t b_handle,
+                            void *data, size_t size);
+    int32_t (*buffer_sync)(XmaHwSession *s_handle, uint32_t b_handle,
+                           size_t size, size_t offset, bool to_device);
 } XmaHwInterface;
 
 #endif
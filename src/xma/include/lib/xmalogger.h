@@ -94,20 +94,52 @@ void xma_actor_destroy(XmaActor *actor);
 int xma_actor_sendmsg(XmaActor *actor, void *msg, size_t msg_size);
 int xma_actor_recvmsg(XmaActor *actor, void *msg, size_t msg_size);
 
+/* Size in bytes of the per thread log record ring, must be a power of 2 */
+#define XMA_LOG_RING_SIZE            (1024 * 1024)
+
+/* Data structure for XmaLogRing
+ *
+ * Single producer, single consumer ring of variable length log records.
+ * head is advanced only by the thread owning the ring, tail only by the
+ * logger thread, both are accessed with atomic builtins.
+ */
+typedef struct XmaLogRing
+{
+    uint64_t            head __attribute__((aligned(64)));
+    uint64_t            tail __attribute__((aligned(64)));
+    uint8_t            *buf;
+    bool                orphaned;
+    struct XmaLogRing  *next;
+} XmaLogRing;
+
 /* Data structure for XmaLogger */
 typedef struct XmaLogger
 {
-    bool      use_stdout;
-    bool      use_fileout;
-    char      filename[PATH_MAX];
-    int32_t   fd;
-    int32_t   log_level;
-    XmaActor *actor;
+    bool            use_stdout;
+    bool            use_fileout;
+    char            filename[PATH_MAX];
+    int32_t         fd;
+    int32_t         log_level;
+    XmaThread      *thread;
+    XmaLogRing     *rings;
+    pthread_mutex_t rings_lock;
+    pthread_key_t   ring_key;
+    uint32_t        generation;
+    bool            stop;
+    pthread_mutex_t wake_lock;
+    pthread_cond_t  wake_cond;      /* records queued for sleeping logger */
+    bool            sleeping;
+    uint64_t        dropped;
+    int64_t         clock_offset;
 } XmaLogger;
 
 int32_t xma_logger_init(XmaLogger *logger);
 int32_t xma_logger_close(XmaLogger *logger);
 
+/* Number of messages dropped because the ring of the logging thread was
+   full or could not be allocated */
+uint64_t xma_logger_dropped(XmaLogger *logger);
+
 /** @} */
 #ifdef __cplusplus
 }
@@ -37,7 +37,11 @@ typedef struct XmaXclbinInfo
     XmaIpLayout ip_layout[MAX_KERNEL_CONFIGS];
 } XmaXclbinInfo;
 
+/* Map xclbin file read-only, the buffer must not be written to and
+ * must be released with xma_xclbin_file_close
+ */
 char *xma_xclbin_file_open(const char *xclbin_name);
+void xma_xclbin_file_close(char *buffer);
 int xma_xclbin_info_get(char *buffer, XmaXclbinInfo *info);
 
 #endif
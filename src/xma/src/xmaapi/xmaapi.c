@@ -52,20 +52,26 @@ int32_t xma_initialize(char *cfgfile)
     xma_logmsg(XMA_INFO_LOG, XMAAPI_MOD, "Probing hardware\n");
     ret = xma_hw_probe(&g_xma_singleton->hwcfg);
     if (ret != XMA_SUCCESS)
-        return ret;
+        goto close_logger;
 
     xma_logmsg(XMA_INFO_LOG, XMAAPI_MOD, "Checking hardware compatibility\n");
     rc = xma_hw_is_compatible(&g_xma_singleton->hwcfg,
                               &g_xma_singleton->systemcfg);
     if (!rc)
-        return XMA_ERROR_INVALID;
+    {
+        ret = XMA_ERROR_INVALID;
+        goto close_logger;
+    }
 
     xma_logmsg(XMA_INFO_LOG, XMAAPI_MOD,
                "Creating resource shared mem database\n");
     g_xma_singleton->shm_res_cfg = xma_res_shm_map(&g_xma_singleton->systemcfg);
 
     if (!g_xma_singleton->shm_res_cfg)
-        return XMA_ERROR;
+    {
+        ret = XMA_ERROR;
+        goto close_logger;
+    }
  
     xma_logmsg(XMA_INFO_LOG, XMAAPI_MOD, "Configure hardware\n");
     rc = xma_hw_configure(&g_xma_singleton->hwcfg,
@@ -122,7 +128,12 @@ int32_t xma_initialize(char *cfgfile)
 error:
     xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Error initalizing XMA\n");
     xma_res_shm_unmap(g_xma_singleton->shm_res_cfg);
-    return XMA_ERROR;
+    ret = XMA_ERROR;
+
+close_logger:
+    /* Write log messages queued before the failure */
+    xma_logger_close(&g_xma_singleton->logger);
+    return ret;
 }
 
 void xma_exit(void)
@@ -131,6 +142,9 @@ void xma_exit(void)
 
     if (!g_xma_singleton->shm_freed)
         xma_res_shm_unmap(g_xma_singleton->shm_res_cfg);
+
+    /* Write log messages still queued by the logging threads */
+    xma_logger_close(&g_xma_singleton->logger);
 }
 
 int32_t xma_cfg_img_cnt_get()
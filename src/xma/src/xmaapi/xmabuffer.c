@@ -16,12 +16,55 @@
  */
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 
 #include "app/xmabuffers.h"
+#include "app/xmaerror.h"
 #include "app/xmalogger.h"
+#include "lib/xmahw.h"
 
 #define XMA_BUFFER_MOD "xmabuffer"
 
+/* Alignment of frame planes */
+#define XMA_FRAME_ALIGN         64
+#define XMA_FRAME_ALIGN_UP(x)   (((x) + XMA_FRAME_ALIGN - 1) & ~((size_t)XMA_FRAME_ALIGN - 1))
+
+/* Number of pools shared by xma_frame_alloc() */
+#define XMA_MAX_FRAME_POOLS     16
+
+/* A pooled frame, planes are carved from a single allocation */
+typedef struct XmaFramePoolEntry
+{
+    XmaFrame                    frame;
+    uint8_t                    *data;
+    uint32_t                    b_handle;
+    uint64_t                    paddr;
+    struct XmaFramePoolEntry   *next;
+} XmaFramePoolEntry;
+
+struct XmaFramePool
+{
+    XmaFrameProperties  frame_props;
+    int32_t             num_planes;
+    size_t              plane_size[XMA_MAX_PLANES];
+    size_t              plane_offset[XMA_MAX_PLANES];
+    size_t              frame_size;
+    bool                use_device;
+    XmaHwSession        hw_session;
+    pthread_mutex_t     lock;
+    XmaFramePoolEntry  *free_list;
+    /* One reference for the creator plus one per frame in use */
+    int32_t             refcount;
+    bool                destroyed;
+};
+
+/* Pools used by xma_frame_alloc(), entries are published by
+   incrementing g_frame_pools_count and are never removed */
+static XmaFramePool    *g_frame_pools[XMA_MAX_FRAME_POOLS];
+static int32_t          g_frame_pools_count;
+static bool             g_frame_pools_enabled;
+static pthread_mutex_t  g_frame_pools_lock = PTHREAD_MUTEX_INITIALIZER;
+
 int32_t
 xma_frame_planes_get(XmaFrameProperties *frame_props)
 {
@@ -38,12 +81,90 @@ xma_frame_planes_get(XmaFrameProperties *frame_props)
     return frame_format_desc[frame_props->format].num_planes;
 }
 
+size_t
+xma_frame_plane_size_get(XmaFrameProperties *frame_props, int32_t plane)
+{
+    size_t width = frame_props->width;
+    size_t height = frame_props->height;
+    /* Samples wider than 8 bits are stored in 16 bits */
+    size_t bytes = frame_props->bits_per_pixel > 8 ? 2 : 1;
+
+    if (plane < 0 || plane >= xma_frame_planes_get(frame_props))
+        return 0;
+
+    switch (frame_props->format)
+    {
+        case XMA_YUV420_FMT_TYPE:
+            if (plane > 0)
+                return ((width + 1) / 2) * ((height + 1) / 2) * bytes;
+            return width * height * bytes;
+        case XMA_YUV422_FMT_TYPE:
+            if (plane > 0)
+                return ((width + 1) / 2) * height * bytes;
+            return width * height * bytes;
+        case XMA_RGB888_FMT_TYPE:
+            return width * height * 3;
+        default:
+            return width * height * bytes;
+    }
+}
+
+static bool
+xma_frame_props_equal(XmaFrameProperties *a, XmaFrameProperties *b)
+{
+    return a->format == b->format && a->width == b->width &&
+           a->height == b->height && a->bits_per_pixel == b->bits_per_pixel;
+}
+
+static XmaFramePool*
+xma_frame_pool_find(XmaFrameProperties *frame_props)
+{
+    XmaFramePool *pool;
+    int32_t       count;
+    int32_t       i;
+
+    count = __atomic_load_n(&g_frame_pools_count, __ATOMIC_ACQUIRE);
+    for (i = 0; i < count; i++)
+        if (xma_frame_props_equal(&g_frame_pools[i]->frame_props, frame_props))
+            return g_frame_pools[i];
+
+    pthread_mutex_lock(&g_frame_pools_lock);
+    for (pool = NULL; i < g_frame_pools_count && !pool; i++)
+        if (xma_frame_props_equal(&g_frame_pools[i]->frame_props, frame_props))
+            pool = g_frame_pools[i];
+    if (!pool && g_frame_pools_count < XMA_MAX_FRAME_POOLS)
+    {
+        pool = xma_frame_pool_create(frame_props, 0, NULL);
+        if (pool)
+        {
+            g_frame_pools[g_frame_pools_count] = pool;
+            __atomic_store_n(&g_frame_pools_count, g_frame_pools_count + 1,
+                             __ATOMIC_RELEASE);
+        }
+    }
+    pthread_mutex_unlock(&g_frame_pools_lock);
+
+    return pool;
+}
+
+void
+xma_frame_pool_enable(bool enable)
+{
+    xma_logmsg(XMA_DEBUG_LOG, XMA_BUFFER_MOD, "%s() %d\n", __func__, enable);
+    __atomic_store_n(&g_frame_pools_enabled, enable, __ATOMIC_RELEASE);
+}
+
 XmaFrame*
 xma_frame_alloc(XmaFrameProperties *frame_props)
 {
-    int32_t num_planes;
+    XmaFramePool *pool;
+    int32_t       num_planes;
 
     xma_logmsg(XMA_DEBUG_LOG, XMA_BUFFER_MOD, "%s()\n", __func__);
+    if (__atomic_load_n(&g_frame_pools_enabled, __ATOMIC_ACQUIRE) &&
+        (pool = xma_frame_pool_find(frame_props)) != NULL)
+        return xma_frame_pool_alloc(pool);
+
     XmaFrame *frame = malloc(sizeof(XmaFrame));
     memset(frame, 0, sizeof(XmaFrame));
     frame->frame_props = *frame_props;
@@ -54,14 +175,227 @@ xma_frame_alloc(XmaFrameProperties *frame_props)
         frame->data[i].refcount++;
         frame->data[i].buffer_type = XMA_HOST_BUFFER_TYPE;
         frame->data[i].is_clone = false;
-        // TODO: Get plane size for each plane
-        frame->data[i].buffer = malloc(frame_props->width *
-                                       frame_props->height);
+        if (posix_memalign(&frame->data[i].buffer, XMA_FRAME_ALIGN,
+                           xma_frame_plane_size_get(frame_props, i)))
+            frame->data[i].buffer = NULL;
     }
 
     return frame;
 }
 
+static XmaFramePoolEntry*
+xma_frame_pool_entry_alloc(XmaFramePool *pool)
+{
+    XmaFramePoolEntry *entry = malloc(sizeof(XmaFramePoolEntry));
+    void              *data = NULL;
+
+    if (!entry)
+        return NULL;
+    memset(entry, 0, sizeof(XmaFramePoolEntry));
+
+    if (pool->use_device)
+        data = xma_hw_buffer_map(&pool->hw_session, pool->frame_size,
+                                 &entry->b_handle, &entry->paddr);
+    else if (posix_memalign(&data, XMA_FRAME_ALIGN, pool->frame_size))
+        data = NULL;
+
+    if (!data)
+    {
+        xma_logmsg(XMA_ERROR_LOG, XMA_BUFFER_MOD,
+                   "%s() Could not allocate frame of size %lu\n",
+                   __func__, pool->frame_size);
+        free(entry);
+        return NULL;
+    }
+    entry->data = data;
+
+    return entry;
+}
+
+static void
+xma_frame_pool_entry_free(XmaFramePool *pool, XmaFramePoolEntry *entry)
+{
+    if (pool->use_device)
+        xma_hw_buffer_unmap(&pool->hw_session, entry->b_handle,
+                            entry->data, pool->frame_size);
+    else
+        free(entry->data);
+    free(entry);
+}
+
+/* Drop a reference to the pool, the last reference frees it */
+static void
+xma_frame_pool_put(XmaFramePool *pool)
+{
+    if (__atomic_sub_fetch(&pool->refcount, 1, __ATOMIC_ACQ_REL) > 0)
+        return;
+
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+}
+
+XmaFramePool*
+xma_frame_pool_create(XmaFrameProperties  *frame_props,
+                      int32_t              num_frames,
+                      struct XmaHwSession *hw_session)
+{
+    XmaFramePool      *pool;
+    XmaFramePoolEntry *entry;
+
+    xma_logmsg(XMA_DEBUG_LOG, XMA_BUFFER_MOD,
+               "%s() %dx%d format %d with %d frames\n", __func__,
+               frame_props->width, frame_props->height,
+               frame_props->format, num_frames);
+    pool = malloc(sizeof(XmaFramePool));
+    if (!pool)
+        return NULL;
+    memset(pool, 0, sizeof(XmaFramePool));
+    pool->frame_props = *frame_props;
+    pool->num_planes = xma_frame_planes_get(frame_props);
+    for (int32_t i = 0; i < pool->num_planes; i++)
+    {
+        pool->plane_size[i] = xma_frame_plane_size_get(frame_props, i);
+        pool->plane_offset[i] = pool->frame_size;
+        pool->frame_size += XMA_FRAME_ALIGN_UP(pool->plane_size[i]);
+    }
+    if (hw_session)
+    {
+        pool->use_device = true;
+        pool->hw_session = *hw_session;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pool->refcount = 1;
+
+    for (int32_t i = 0; i < num_frames; i++)
+    {
+        entry = xma_frame_pool_entry_alloc(pool);
+        if (!entry)
+        {
+            xma_frame_pool_destroy(pool);
+            return NULL;
+        }
+        entry->next = pool->free_list;
+        pool->free_list = entry;
+    }
+
+    return pool;
+}
+
+XmaFrame*
+xma_frame_pool_alloc(XmaFramePool *pool)
+{
+    XmaFramePoolEntry *entry;
+    XmaFrame          *frame;
+
+    pthread_mutex_lock(&pool->lock);
+    entry = pool->free_list;
+    if (entry)
+        pool->free_list = entry->next;
+    pthread_mutex_unlock(&pool->lock);
+
+    if (!entry)
+    {
+        entry = xma_frame_pool_entry_alloc(pool);
+        if (!entry)
+            return NULL;
+    }
+    __atomic_add_fetch(&pool->refcount, 1, __ATOMIC_RELAXED);
+
+    frame = &entry->frame;
+    memset(frame, 0, sizeof(XmaFrame));
+    frame->frame_props = pool->frame_props;
+    frame->pool = pool;
+    for (int32_t i = 0; i < pool->num_planes; i++)
+    {
+        frame->data[i].refcount = 1;
+        frame->data[i].buffer_type = pool->use_device ?
+            XMA_DEVICE_BUFFER_TYPE : XMA_HOST_BUFFER_TYPE;
+        frame->data[i].is_clone = false;
+        frame->data[i].buffer = entry->data + pool->plane_offset[i];
+    }
+
+    return frame;
+}
+
+void
+xma_frame_pool_destroy(XmaFramePool *pool)
+{
+    XmaFramePoolEntry *entry;
+
+    xma_logmsg(XMA_DEBUG_LOG, XMA_BUFFER_MOD,
+               "%s() Destroy pool %p\n", __func__, pool);
+    pthread_mutex_lock(&pool->lock);
+    pool->destroyed = true;
+    while ((entry = pool->free_list) != NULL)
+    {
+        pool->free_list = entry->next;
+        xma_frame_pool_entry_free(pool, entry);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    xma_frame_pool_put(pool);
+}
+
+/* Return a frame whose last reference was dropped to its pool */
+static void
+xma_frame_pool_release(XmaFrame *frame)
+{
+    XmaFramePool      *pool = frame->pool;
+    XmaFramePoolEntry *entry = (XmaFramePoolEntry*)frame;
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->destroyed)
+    {
+        xma_frame_pool_entry_free(pool, entry);
+    }
+    else
+    {
+        entry->next = pool->free_list;
+        pool->free_list = entry;
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    xma_frame_pool_put(pool);
+}
+
+uint64_t
+xma_frame_paddr_get(XmaFrame *frame, int32_t plane)
+{
+    XmaFramePoolEntry *entry = (XmaFramePoolEntry*)frame;
+
+    if (!frame->pool || !frame->pool->use_device ||
+        plane < 0 || plane >= frame->pool->num_planes)
+        return 0;
+
+    return entry->paddr + frame->pool->plane_offset[plane];
+}
+
+int32_t
+xma_frame_sync(XmaFrame *frame, bool to_device)
+{
+    XmaFramePoolEntry *entry = (XmaFramePoolEntry*)frame;
+
+    if (!frame->pool || !frame->pool->use_device)
+        return XMA_SUCCESS;
+
+    if (xma_hw_buffer_sync(&frame->pool->hw_session, entry->b_handle,
+                           frame->pool->frame_size, 0, to_device))
+        return XMA_ERROR;
+
+    return XMA_SUCCESS;
+}
+
+XmaFrame*
+xma_frame_ref(XmaFrame *frame)
+{
+    int32_t num_planes = xma_frame_planes_get(&frame->frame_props);
+
+    for (int32_t i = 0; i < num_planes; i++)
+        __atomic_add_fetch(&frame->data[i].refcount, 1, __ATOMIC_RELAXED);
+
+    return frame;
+}
+
 XmaFrame*
 xma_frame_from_buffers_clone(XmaFrameProperties *frame_props,
                              XmaFrameData       *frame_data)
@@ -96,12 +430,21 @@ xma_frame_free(XmaFrame *frame)
                "%s() Free frame %p\n", __func__, frame);
     num_planes = xma_frame_planes_get(&frame->frame_props);
 
-    for (int32_t i = 0; i < num_planes; i++)
-        frame->data[i].refcount--;
+    /* Plane 0 is released last, whoever drops its last reference
+       frees the frame */
+    for (int32_t i = num_planes - 1; i > 0; i--)
+        __atomic_sub_fetch(&frame->data[i].refcount, 1, __ATOMIC_ACQ_REL);
 
-    if (frame->data[0].refcount > 0)
+    if (num_planes > 0 &&
+        __atomic_sub_fetch(&frame->data[0].refcount, 1, __ATOMIC_ACQ_REL) > 0)
         return;
 
+    if (frame->pool)
+    {
+        xma_frame_pool_release(frame);
+        return;
+    }
+
     for (int32_t i = 0; i < num_planes && !frame->data[i].is_clone; i++)
         free(frame->data[i].buffer);
 
@@ -35,3 +35,21 @@ bool xma_hw_configure(XmaHwCfg *hwcfg, XmaSystemCfg *systemcfg, bool hw_cfg_stat
 {
     return hw_if.configure(hwcfg, systemcfg, hw_cfg_status);
 }
+
+void *xma_hw_buffer_map(XmaHwSession *s_handle, size_t size,
+                        uint32_t *b_handle, uint64_t *paddr)
+{
+    return hw_if.buffer_map(s_handle, size, b_handle, paddr);
+}
+
+void xma_hw_buffer_unmap(XmaHwSession *s_handle, uint32_t b_handle,
+                         void *data, size_t size)
+{
+    hw_if.buffer_unmap(s_handle, b_handle, data, size);
+}
+
+int32_t xma_hw_buffer_sync(XmaHwSession *s_handle, uint32_t b_handle,
+                           size_t size, size_t offset, bool to_device)
+{
+    return hw_if.buffer_sync(s_handle, b_handle, size, offset, to_device);
+}
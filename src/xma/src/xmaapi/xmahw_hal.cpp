@@ -22,6 +22,7 @@
 #include <vector>
 #include <fcntl.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include <xclhal2.h>
 //#include <xclbin.h>
@@ -202,6 +203,7 @@ bool hal_configure(XmaHwCfg *hwcfg, XmaSystemCfg *systemcfg, bool hw_configured)
         {
             xma_logmsg("Could not get info for xclbin file %s\n",
                        xclfullname.c_str());
+            xma_xclbin_file_close(buffer);
             return false;
         }
 
@@ -237,15 +239,62 @@ bool hal_configure(XmaHwCfg *hwcfg, XmaSystemCfg *systemcfg, bool hw_configured)
                 xma_logmsg("Could not download xclbin file %s to device %d\n",
                            xclfullname.c_str(),
                            systemcfg->imagecfg[i].device_id_map[d]);
+                xma_xclbin_file_close(buffer);
                 return false;
             }
         }
+        xma_xclbin_file_close(buffer);
     }
     return true;
 }
 
+void *hal_buffer_map(XmaHwSession *s_handle, size_t size,
+                     uint32_t *b_handle, uint64_t *paddr)
+{
+    xclDeviceHandle dev_handle = s_handle->dev_handle;
+    uint32_t        handle;
+    void           *data;
+
+    handle = xclAllocBO(dev_handle, size, XCL_BO_DEVICE_RAM, s_handle->ddr_bank);
+    if (handle == 0xffffffff)
+    {
+        xma_logmsg("Could not allocate device buffer of size %lu\n", size);
+        return NULL;
+    }
+
+    data = xclMapBO(dev_handle, handle, true);
+    if (!data)
+    {
+        xma_logmsg("Could not map device buffer %u\n", handle);
+        xclFreeBO(dev_handle, handle);
+        return NULL;
+    }
+
+    *b_handle = handle;
+    *paddr = xclGetDeviceAddr(dev_handle, handle);
+    return data;
+}
+
+void hal_buffer_unmap(XmaHwSession *s_handle, uint32_t b_handle,
+                      void *data, size_t size)
+{
+    munmap(data, size);
+    xclFreeBO(s_handle->dev_handle, b_handle);
+}
+
+int32_t hal_buffer_sync(XmaHwSession *s_handle, uint32_t b_handle,
+                        size_t size, size_t offset, bool to_device)
+{
+    return xclSyncBO(s_handle->dev_handle, b_handle,
+                     to_device ? XCL_BO_SYNC_BO_TO_DEVICE : XCL_BO_SYNC_BO_FROM_DEVICE,
+                     size, offset);
+}
+
 XmaHwInterface hw_if = {
     .probe         = hal_probe,
     .is_compatible = hal_is_compatible,
-    .configure     = hal_configure
+    .configure     = hal_configure,
+    .buffer_map    = hal_buffer_map,
+    .buffer_unmap  = hal_buffer_unmap,
+    .buffer_sync   = hal_buffer_sync
 };
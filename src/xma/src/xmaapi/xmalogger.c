@@ -55,8 +55,102 @@ XmaLogLevel2Str g_loglevel_tbl[] = {
     {XMA_DEBUG_LOG,    "DEBUG   "}
 };
 
-/* Prototype for the logger actor thread */
-void* xma_logger_actor(void *data);
+/* Log records are written by the logging thread into its own ring and
+ * formatted by the logger thread.  Record layout, 8 byte aligned:
+ *   uint32_t size, uint8_t level, uint8_t name_len, uint16_t msg_len,
+ *   uint64_t CLOCK_MONOTONIC time in ns, name, msg
+ * A record with level XMA_LOG_PAD fills the end of the ring when the
+ * next record does not fit before the ring wraps.
+ */
+typedef struct XmaLogRecord
+{
+    uint32_t    size;
+    uint8_t     level;
+    uint8_t     name_len;
+    uint16_t    msg_len;
+    uint64_t    time;
+} XmaLogRecord;
+
+#define XMA_LOG_PAD         0xff
+#define XMA_LOG_ALIGN(x)    (((x) + 7) & ~((size_t)7))
+#define XMA_LOG_RECORD_MAX  XMA_LOG_ALIGN(sizeof(XmaLogRecord) + XMA_MAX_LOGMSG_SIZE)
+#define XMA_LOG_NAME_MAX    39
+/* Length of "%Y-%m-%d %H:%M:%S.%03d " plus level string and space */
+#define XMA_LOG_PREFIX_LEN  33
+#define XMA_LOG_OUT_SIZE    (64 * 1024)
+/* Longest sleep of the idle logger thread, records wake it right away */
+#define XMA_LOG_IDLE_NSEC   (100 * 1000000)
+
+/* Ring of the calling thread and the logger generation it belongs to */
+static __thread XmaLogRing *t_ring;
+static __thread uint32_t    t_generation;
+
+/* Prototype for the logger thread */
+void* xma_logger_thread(void *data);
+
+static uint64_t xma_logger_clock(clockid_t clk)
+{
+    struct timespec ts;
+
+    clock_gettime(clk, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Called on exit of a thread with a ring, the logger thread frees the
+   ring once it has written the remaining records */
+static void xma_logger_ring_release(void *data)
+{
+    XmaLogRing *ring = (XmaLogRing*)data;
+
+    __atomic_store_n(&ring->orphaned, true, __ATOMIC_RELEASE);
+}
+
+static XmaLogRing *xma_logger_ring(XmaLogger *logger)
+{
+    XmaLogRing *ring;
+
+    if (t_ring && t_generation == logger->generation)
+        return t_ring;
+
+    ring = calloc(1, sizeof(XmaLogRing));
+    if (!ring)
+        return NULL;
+    ring->buf = malloc(XMA_LOG_RING_SIZE);
+    if (!ring->buf)
+    {
+        free(ring);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&logger->rings_lock);
+    ring->next = logger->rings;
+    __atomic_store_n(&logger->rings, ring, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&logger->rings_lock);
+    pthread_setspecific(logger->ring_key, ring);
+
+    t_ring = ring;
+    t_generation = logger->generation;
+
+    return ring;
+}
+
+static void xma_logger_ring_free(XmaLogRing *ring)
+{
+    free(ring->buf);
+    free(ring);
+}
+
+/* Wake the logger thread if it is sleeping, called after a record is
+   published */
+static void xma_logger_wake(XmaLogger *logger)
+{
+    if (!__atomic_load_n(&logger->sleeping, __ATOMIC_SEQ_CST))
+        return;
+
+    pthread_mutex_lock(&logger->wake_lock);
+    pthread_cond_signal(&logger->wake_cond);
+    pthread_mutex_unlock(&logger->wake_lock);
+}
 
 int xma_logger_init(XmaLogger *logger)
 {
@@ -93,127 +187,359 @@ int xma_logger_init(XmaLogger *logger)
     else
         logger->fd = -1;
 
-    /* Create logger actor */
-    logger->actor = xma_actor_create(xma_logger_actor,
-                                     XMA_MAX_LOGMSG_SIZE,
-                                     XMA_MAX_LOGMSG_Q_ENTRIES);
+    /* Records hold the monotonic time, the logger thread converts it
+       to wall clock time when the record is written */
+    logger->clock_offset = xma_logger_clock(CLOCK_REALTIME) -
+                           xma_logger_clock(CLOCK_MONOTONIC);
+
+    /* Rings of a previous logger instance are not reused */
+    logger->generation++;
+    logger->rings = NULL;
+    logger->stop = false;
+    logger->dropped = 0;
+    logger->sleeping = false;
+    pthread_mutex_init(&logger->rings_lock, NULL);
+    pthread_mutex_init(&logger->wake_lock, NULL);
+    pthread_cond_init(&logger->wake_cond, NULL);
+    if (pthread_key_create(&logger->ring_key, xma_logger_ring_release))
+    {
+        perror("XMA Logger thread key create failed: ");
+        return -1;
+    }
 
-    xma_actor_start(logger->actor);
+    /* Create logger thread */
+    logger->thread = xma_thread_create(xma_logger_thread, logger);
+    xma_thread_start(logger->thread);
 
     return 0;
 }
 
 int xma_logger_close(XmaLogger *logger)
 {
+    XmaLogRing *ring;
+    XmaThread  *thread;
+
     /* Verify parameters */
     assert(logger);
-    xma_actor_destroy(logger->actor);
+    thread = logger->thread;
+    if (!thread)
+        return 0;
+
+    /* Logger thread writes all queued records before exiting */
+    logger->thread = NULL;
+    pthread_mutex_lock(&logger->wake_lock);
+    __atomic_store_n(&logger->stop, true, __ATOMIC_RELEASE);
+    pthread_cond_signal(&logger->wake_cond);
+    pthread_mutex_unlock(&logger->wake_lock);
+    xma_thread_join(thread);
+    xma_thread_destroy(thread);
+
+    pthread_key_delete(logger->ring_key);
+    while ((ring = logger->rings) != NULL)
+    {
+        logger->rings = ring->next;
+        xma_logger_ring_free(ring);
+    }
+    pthread_mutex_destroy(&logger->rings_lock);
+    pthread_cond_destroy(&logger->wake_cond);
+    pthread_mutex_destroy(&logger->wake_lock);
 
     return 0;
 }
 
+uint64_t xma_logger_dropped(XmaLogger *logger)
+{
+    return __atomic_load_n(&logger->dropped, __ATOMIC_RELAXED);
+}
+
 void
 xma_logmsg(XmaLogLevelType level, const char *name, const char *msg, ...)
 {
     /* Handle variable arguments */
-    va_list ap;
-
-    /* Create message buffer on the stack */
-    char            msg_buff[XMA_MAX_LOGMSG_SIZE];
-    struct tm      *tm_info;
-    struct timeval  tv;
-    int32_t         millisec;
-    char            log_time[40];
-    char            log_name[40];
-    const char     *log_level;
-    int32_t         hdr_offset;
+    va_list         ap;
+    XmaLogRing     *ring;
+    XmaLogRecord   *rec;
+    uint64_t        head;
+    uint64_t        tail;
+    size_t          offset;
+    size_t          room;
+    size_t          need;
+    size_t          name_len;
+    int32_t         msg_len;
 
     /* Get XMA logger */
     XmaLogger *logger = &g_xma_singleton->logger;
 
-    memset(msg_buff, 0, sizeof(msg_buff));
+    if (level > logger->log_level)
+        return;
 
-    if ( level > logger->log_level)
+    if (!logger->thread || !(ring = xma_logger_ring(logger)))
+    {
+        __atomic_fetch_add(&logger->dropped, 1, __ATOMIC_RELAXED);
         return;
-    
-    /* Get time */
-    gettimeofday(&tv, NULL);
-    millisec = lrint(tv.tv_usec/1000.0);
-    if (millisec >= 1000)
+    }
+
+    /* Reserve space for the largest record, the actual size is known
+       once the message is formatted in place.  The logging thread never
+       blocks, a message that does not fit in a full ring is dropped. */
+    head = ring->head;
+    offset = head & (XMA_LOG_RING_SIZE - 1);
+    room = XMA_LOG_RING_SIZE - offset;
+    need = XMA_LOG_RECORD_MAX + (room < XMA_LOG_RECORD_MAX ? room : 0);
+    tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    if (head - tail + need > XMA_LOG_RING_SIZE)
     {
-        millisec -= 1000;
-        tv.tv_sec++;
+        __atomic_fetch_add(&logger->dropped, 1, __ATOMIC_RELAXED);
+        xma_logger_wake(logger);
+        return;
     }
-    tm_info = localtime(&tv.tv_sec);
-    strftime(log_time, sizeof(log_time), "%Y-%m-%d %H:%M:%S", tm_info);
+
+    if (room < XMA_LOG_RECORD_MAX)
+    {
+        rec = (XmaLogRecord*)&ring->buf[offset];
+        rec->size = room;
+        rec->level = XMA_LOG_PAD;
+        head += room;
+        offset = 0;
+    }
+
+    rec = (XmaLogRecord*)&ring->buf[offset];
 
     /* Set component name */
     if (name == NULL)
-        strncpy(log_name, "XMA-default", sizeof(log_name));
-    else
-        strncpy(log_name, name, sizeof(log_name));
+        name = "XMA-default";
+    name_len = strnlen(name, XMA_LOG_NAME_MAX);
+    memcpy(rec + 1, name, name_len);
 
-    log_level = g_loglevel_tbl[level].lvl_str;
-    
-    /* Format log message */
-    sprintf(msg_buff, "%s.%03d %s %s ", log_time, millisec, log_level, log_name);
-    hdr_offset = strlen(msg_buff);
+    /* Format log message, truncated as if prefixed by time, level and name */
     va_start(ap, msg); 
-    vsnprintf(&msg_buff[hdr_offset], (XMA_MAX_LOGMSG_SIZE - hdr_offset), msg, ap);
+    msg_len = vsnprintf((char*)(rec + 1) + name_len,
+                        XMA_MAX_LOGMSG_SIZE - XMA_LOG_PREFIX_LEN - name_len - 1,
+                        msg, ap);
     va_end(ap);
-
-    /* Send message buffer to logger Actor - 
-       will be copied to loggers message buffer */
-    xma_actor_sendmsg(logger->actor, msg_buff, sizeof(msg_buff));
+    if (msg_len < 0)
+        msg_len = 0;
+    else if (msg_len > XMA_MAX_LOGMSG_SIZE - XMA_LOG_PREFIX_LEN - name_len - 2)
+        msg_len = XMA_MAX_LOGMSG_SIZE - XMA_LOG_PREFIX_LEN - name_len - 2;
+
+    rec->size = XMA_LOG_ALIGN(sizeof(XmaLogRecord) + name_len + msg_len);
+    rec->level = level;
+    rec->name_len = name_len;
+    rec->msg_len = msg_len;
+    rec->time = xma_logger_clock(CLOCK_MONOTONIC);
+
+    /* Publish record to logger thread */
+    head += rec->size;
+    __atomic_store_n(&ring->head, head, __ATOMIC_SEQ_CST);
+    xma_logger_wake(logger);
 }
 
-void* xma_logger_actor(void *data)
+/* Output buffer of the logger thread and the cached wall clock seconds */
+typedef struct XmaLogOutput
 {
-    int32_t rc;
-    char logmsg[XMA_MAX_LOGMSG_SIZE];
-    XmaLogger *logger = &g_xma_singleton->logger;
-    XmaActor  *actor = (XmaActor*)data;
+    XmaLogger  *logger;
+    char        buf[XMA_LOG_OUT_SIZE];
+    size_t      len;
+    time_t      sec;
+    char        sec_str[40];
+    uint64_t    dropped;
+} XmaLogOutput;
+
+static void xma_logger_flush(XmaLogOutput *out)
+{
+    XmaLogger *logger = out->logger;
+    int32_t    rc;
 
-    if (!actor)
+    if (!out->len)
+        return;
+
+    if (logger->fd != -1)
     {
-        printf("XMA ERROR: XmaActor does not exist\n");
-        exit(-1);
+        rc = write(logger->fd, out->buf, out->len);
+        if (rc < 0)
+            perror("XMA Logger: could not write to file: ");
     }
+    if (logger->use_stdout)
+    {
+        fwrite(out->buf, 1, out->len, stdout);
+        fflush(stdout);
+    }
+    out->len = 0;
+}
 
-    printf("XMA Logger: Logging thread started\n");
-    while (1)
+static void xma_logger_format(XmaLogOutput *out, uint64_t time, int32_t level,
+                              const char *name, int32_t name_len,
+                              const char *msg, int32_t msg_len)
+{
+    struct tm   tm_info;
+    time_t      sec;
+    int32_t     millisec;
+    int32_t     len;
+
+    if (XMA_LOG_OUT_SIZE - out->len < XMA_MAX_LOGMSG_SIZE + 32)
+        xma_logger_flush(out);
+
+    /* Wall clock time, rounded to milliseconds */
+    time += out->logger->clock_offset;
+    sec = time / 1000000000ULL;
+    millisec = lrint((time % 1000000000ULL) / 1000 / 1000.0);
+    if (millisec >= 1000)
+    {
+        millisec -= 1000;
+        sec++;
+    }
+    if (sec != out->sec)
     {
-        memset(logmsg, 0, sizeof(logmsg));
-        rc = xma_actor_recvmsg(actor, logmsg, sizeof(logmsg));
-        if (rc == 0)
+        localtime_r(&sec, &tm_info);
+        strftime(out->sec_str, sizeof(out->sec_str), "%Y-%m-%d %H:%M:%S", &tm_info);
+        out->sec = sec;
+    }
+
+    len = sprintf(&out->buf[out->len], "%s.%03d %s %.*s %.*s",
+                  out->sec_str, millisec, g_loglevel_tbl[level].lvl_str,
+                  name_len, name, msg_len, msg);
+    out->len += len;
+}
+
+/* Write the records of all rings, frees rings of exited threads once empty.
+   Returns the number of records written. */
+static size_t xma_logger_drain(XmaLogOutput *out)
+{
+    XmaLogger    *logger = out->logger;
+    XmaLogRing   *ring;
+    XmaLogRing  **prev;
+    XmaLogRing   *next;
+    XmaLogRecord *rec;
+    uint64_t      head;
+    uint64_t      tail;
+    uint64_t      dropped;
+    bool          orphaned;
+    size_t        count = 0;
+    const char   *name;
+
+    prev = &logger->rings;
+    ring = __atomic_load_n(&logger->rings, __ATOMIC_ACQUIRE);
+    while (ring)
+    {
+        orphaned = __atomic_load_n(&ring->orphaned, __ATOMIC_ACQUIRE);
+        tail = ring->tail;
+        head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        while (tail != head)
         {
-            if (strncmp(logmsg, "shutdown", 8) == 0)
+            rec = (XmaLogRecord*)&ring->buf[tail & (XMA_LOG_RING_SIZE - 1)];
+            if (rec->level != XMA_LOG_PAD)
             {
-                printf("XMA logger: received shutdown\n");
-                break;
+                name = (const char*)(rec + 1);
+                xma_logger_format(out, rec->time, rec->level,
+                                  name, rec->name_len,
+                                  name + rec->name_len, rec->msg_len);
+                count++;
             }
-            if (logger->fd != -1)
-            {
-                rc = write(logger->fd, logmsg, strlen(logmsg));
-                if (rc < 0)
-                {
-                    perror("XMA Logger: could not write to file: ");
-                    break;
-                }
-            }
-            if (logger->use_stdout)
-                printf("%s", logmsg);
+            tail += rec->size;
+        }
+        __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+
+        /* No more records once the owning thread has exited, new rings
+           are only added at the list head */
+        if (orphaned)
+        {
+            next = ring->next;
+            pthread_mutex_lock(&logger->rings_lock);
+            while (*prev != ring)
+                prev = &(*prev)->next;
+            *prev = next;
+            pthread_mutex_unlock(&logger->rings_lock);
+            xma_logger_ring_free(ring);
+            ring = next;
+            continue;
+        }
+        prev = &ring->next;
+        ring = ring->next;
+    }
+
+    dropped = xma_logger_dropped(logger);
+    if (dropped != out->dropped)
+    {
+        if (XMA_LOG_OUT_SIZE - out->len < XMA_MAX_LOGMSG_SIZE + 32)
+            xma_logger_flush(out);
+        out->len += sprintf(&out->buf[out->len],
+                            "XMA Logger: %lu log messages dropped\n",
+                            (unsigned long)(dropped - out->dropped));
+        out->dropped = dropped;
+    }
+
+    return count;
+}
+
+static bool xma_logger_pending(XmaLogger *logger)
+{
+    XmaLogRing *ring;
+
+    ring = __atomic_load_n(&logger->rings, __ATOMIC_ACQUIRE);
+    for (; ring; ring = ring->next)
+        if (__atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) != ring->tail)
+            return true;
+    return false;
+}
+
+/* Sleep until a record is published, setting sleeping before checking
+   the rings pairs with the publishing thread checking sleeping after
+   storing head, so a record cannot be missed */
+static void xma_logger_sleep(XmaLogger *logger)
+{
+    struct timespec ts;
+
+    pthread_mutex_lock(&logger->wake_lock);
+    __atomic_store_n(&logger->sleeping, true, __ATOMIC_SEQ_CST);
+    if (!xma_logger_pending(logger) &&
+        !__atomic_load_n(&logger->stop, __ATOMIC_ACQUIRE))
+    {
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += XMA_LOG_IDLE_NSEC;
+        if (ts.tv_nsec >= 1000000000)
+        {
+            ts.tv_nsec -= 1000000000;
+            ts.tv_sec++;
         }
-        else
-            /* Logger has been shutdown - so return from thread */
-            break;
+        pthread_cond_timedwait(&logger->wake_cond, &logger->wake_lock, &ts);
     }
+    __atomic_store_n(&logger->sleeping, false, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&logger->wake_lock);
+}
+
+void* xma_logger_thread(void *data)
+{
+    XmaLogger    *logger = (XmaLogger*)data;
+    XmaLogOutput *out;
+    size_t        count;
+    bool          stop;
+
+    out = calloc(1, sizeof(XmaLogOutput));
+    if (!out)
+    {
+        printf("XMA ERROR: could not allocate logger output buffer\n");
+        exit(-1);
+    }
+    out->logger = logger;
+    out->sec = -1;
+
+    printf("XMA Logger: Logging thread started\n");
+    do
+    {
+        /* Records published before stop are written by the last drain */
+        stop = __atomic_load_n(&logger->stop, __ATOMIC_ACQUIRE);
+        count = xma_logger_drain(out);
+        xma_logger_flush(out);
+        if (!count && !stop)
+            xma_logger_sleep(logger);
+    } while (!stop);
+
     printf("XMA Logger: shutting down\n");
     if (logger->fd != -1)
         close(logger->fd);
+    free(out);
 
     return NULL;
-
 }
 
 /* XmaThread APIs */
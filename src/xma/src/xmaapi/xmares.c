@@ -98,10 +98,12 @@ typedef struct XmaKernelChan {
 typedef struct XmaKernelInstance {
     uint32_t kernel_id;
     pid_t client_id;
+    uint32_t chan_cnt; /**< channels in use */
     XmaKernelChan channels[MAX_KERNEL_CHANS];
 } XmaKernelInstance;
 
 typedef struct XmaDevice {
+    pthread_mutex_t lock; /**< protects device and its kernel instances */
     bool configured; /**< Indicates xclbin loaded */
     bool excl; /**< device locked for exclusive use */
     bool exists; /**< device exists within system */
@@ -109,13 +111,33 @@ typedef struct XmaDevice {
     uint32_t image_id;
     XmaKernelInstance kernels[MAX_KERNEL_CONFIGS];/**< each entry is a kernel instance */
     uint32_t kernel_cnt;
+    uint32_t chan_cnt; /**< channels in use on all kernel instances */
 } XmaDevice;
 
+typedef struct XmaKernelSlot {
+    int16_t dev_id;
+    int16_t kern_idx;
+    int32_t plugin_handle;
+} XmaKernelSlot;
+
+/* Kernel instances of all devices with the same function and vendor */
+typedef struct XmaKernelIndex {
+    enum XmaKernType type;
+    char vendor[NAME_MAX];
+    uint32_t slot_cnt;
+    XmaKernelSlot slots[MAX_XILINX_DEVICES * MAX_KERNEL_CONFIGS];
+} XmaKernelIndex;
+
 typedef struct XmaShmRes {
     XmaDevice devices[MAX_XILINX_DEVICES];
     XmaImage images[MAX_IMAGE_CONFIGS];
+    uint32_t index_cnt;
+    XmaKernelIndex index[MAX_KERNEL_CONFIGS];
 } XmaShmRes;
 
+/* lock protects the client list and (re)initialization of the database,
+ * each device has its own lock for device and kernel allocation.
+ * Lock order is lock before any device lock. */
 typedef struct XmaResConfig {
     XmaShmRes sys_res;
     pthread_mutex_t lock;
@@ -144,6 +166,21 @@ static int xma_shm_lock(XmaResConfig *xma_shm);
 
 static int xma_shm_unlock(XmaResConfig *xma_shm);
 
+static int xma_dev_lock(XmaDevice *dev);
+
+static int xma_dev_unlock(XmaDevice *dev);
+
+static void xma_init_shm_index(XmaResConfig *xma_shm);
+
+static enum XmaKernType xma_res_kern_type(const char *function);
+
+static bool xma_res_plugin_match(XmaKernReq *kern_props,
+                                 int32_t plugin_handle,
+                                 size_t *kernel_data_size,
+                                 int32_t (**alloc_chan)(XmaSession *p,
+                                                        XmaSession **s,
+                                                        uint32_t cnt));
+
 static int xma_verify_process_res(pid_t pid);
 
 static int xma_verify_shm_client_procs(XmaResConfig *xma_shm,
@@ -151,7 +188,9 @@ static int xma_verify_shm_client_procs(XmaResConfig *xma_shm,
 
 static int xma_alloc_next_dev(XmaResources shm_cfg, int *dev_handle, bool excl);
 
-static int xma_get_next_free_dev(XmaResConfig *xma_shm, int *dev_handle);
+static bool xma_dev_available(XmaDevice *dev, uint32_t dev_id);
+
+static bool xma_dev_registered(XmaDevice *dev, pid_t proc_id);
 
 static int xma_alloc_dev(XmaResConfig *xma_shm, int dev_handle, bool excl);
 
@@ -160,8 +199,7 @@ static int32_t xma_res_alloc_kernel(XmaResources shm_cfg,
                                     XmaKernReq *kern_props,
                                     enum XmaKernType type);
 
-static int xma_client_thread_kernel_alloc(XmaResources shm_cfg,
-                                          XmaDevice *dev,
+static int xma_client_thread_kernel_alloc(XmaDevice *dev,
                                           int dev_kern_idx,
                                           XmaSession *session,
                                           size_t kernel_data_size,
@@ -212,9 +250,10 @@ void xma_res_shm_unmap(XmaResources shm_cfg)
         return;
 
     xma_shm = (XmaResConfig *)g_xma_singleton->shm_res_cfg;
-    g_xma_singleton->shm_freed = true;
     xma_dec_ref_shm(xma_shm);
+    /* free before marking shm freed, xma_dev_lock checks shm_freed */
     xma_free_all_proc_res(xma_shm, getpid());
+    g_xma_singleton->shm_freed = true;
     rm_shm = xma_shm->ref_cnt ? false : true;
     xma_shm_unlock(xma_shm);
     xma_shm_close(xma_shm, rm_shm);
@@ -239,26 +278,32 @@ static int32_t xma_alloc_next_dev(XmaResources shm_cfg,
                                   bool excl)
 {
     XmaResConfig *xma_shm = (XmaResConfig *)shm_cfg;
+    XmaDevice *devices = xma_shm->sys_res.devices;
+    uint32_t dev_id;
 
-    while (*dev_handle < MAX_XILINX_DEVICES)
+    xma_logmsg(XMA_DEBUG_LOG, XMA_RES_MOD, "%s()\n", __func__);
+    /* start search from next device: *dev_handle + 1 */
+    for (dev_id = *dev_handle >= 0 ? *dev_handle + 1 : 0;
+         dev_id < MAX_XILINX_DEVICES; dev_id++)
     {
-        int ret;
-        if (xma_shm_lock(xma_shm))
+        int ret = XMA_ERROR_NO_DEV;
+
+        if (!devices[dev_id].exists)
+            continue;
+
+        if (xma_dev_lock(&devices[dev_id]))
             return XMA_ERROR;
-        ret = xma_get_next_free_dev(xma_shm, dev_handle);
-        if (ret < 0) {
-            xma_shm_unlock(xma_shm);
-            return ret;
-        }
-        ret = xma_alloc_dev(xma_shm, *dev_handle, excl);
-        xma_shm_unlock(xma_shm);
+        if (xma_dev_available(&devices[dev_id], dev_id))
+            ret = xma_alloc_dev(xma_shm, dev_id, excl);
+        xma_dev_unlock(&devices[dev_id]);
         if (ret < 0)
             continue;
 
+        *dev_handle = dev_id;
         return *dev_handle;
     }
 
-    return XMA_ERROR;
+    return XMA_ERROR_NO_DEV;
 }
 
 int32_t xma_res_alloc_dec_kernel(XmaResources shm_cfg, XmaDecoderType type,
@@ -367,11 +412,11 @@ int32_t xma_res_free_kernel(XmaResources shm_cfg, XmaKernelRes kern_res)
         return XMA_ERROR;
 
     dev = &xma_shm->sys_res.devices[dev_handle];
-    if (xma_shm_lock(xma_shm))
+    if (xma_dev_lock(dev))
         return XMA_ERROR;
     ret = xma_client_thread_kernel_free(dev, proc_id, thread_id,
                                         kern_handle, session);
-    xma_shm_unlock(xma_shm);
+    xma_dev_unlock(dev);
     free(kern_req);
     return ret;
 }
@@ -383,13 +428,13 @@ int32_t xma_res_free_dev(XmaResources shm_cfg, int32_t dev_handle)
 
     int32_t ret = 0;
 
-    if (!shm_cfg)
+    if (!shm_cfg || dev_handle < 0 || dev_handle >= MAX_XILINX_DEVICES)
         return XMA_ERROR_INVALID;
 
-    if (xma_shm_lock(xma_shm))
+    if (xma_dev_lock(&xma_shm->sys_res.devices[dev_handle]))
         return XMA_ERROR;
     ret = xma_free_dev(xma_shm, dev_handle, proc_id);
-    xma_shm_unlock(xma_shm);
+    xma_dev_unlock(&xma_shm->sys_res.devices[dev_handle]);
     return ret;
 }
 
@@ -592,6 +637,7 @@ static int xma_init_shm(XmaResConfig *xma_shm,
     int decoder_idx = 0;
     int encoder_idx = 0;
     int scaler_idx = 0;
+    pthread_mutexattr_t proc_shared_lock;
 
     xma_logmsg(XMA_DEBUG_LOG, XMA_RES_MOD, "%s()\n", __func__);
     img_cnt = xma_cfg_img_cnt_get();
@@ -606,6 +652,13 @@ static int xma_init_shm(XmaResConfig *xma_shm,
 
     memset(&xma_shm->sys_res, 0, sizeof(XmaShmRes));
 
+    pthread_mutexattr_init(&proc_shared_lock);
+    pthread_mutexattr_setpshared(&proc_shared_lock, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&proc_shared_lock, PTHREAD_MUTEX_ROBUST);
+    for (i = 0; i < MAX_XILINX_DEVICES; i++)
+        pthread_mutex_init(&shm_devices[i].lock, &proc_shared_lock);
+    pthread_mutexattr_destroy(&proc_shared_lock);
+
     /* init device data */
     for (i = 0, cfg_dev_idx = 0; i < dev_cnt; i++, cfg_dev_idx++) {
         shm_devices[cfg_dev_ids[cfg_dev_idx]].configured = true;
@@ -667,6 +720,7 @@ static int xma_init_shm(XmaResConfig *xma_shm,
             shm_devices[dev_id].kernel_cnt = tot_kerns;
         }
     }
+    xma_init_shm_index(xma_shm);
     xma_inc_ref_shm(xma_shm);
     if (!shm_locked)
         xma_shm_unlock(xma_shm);
@@ -706,43 +760,44 @@ static int xma_verify_process_res(pid_t pid)
     return XMA_SUCCESS;
 }
 
-static int xma_get_next_free_dev(XmaResConfig *xma_shm, int *dev_handle)
+/* call while holding device lock */
+static bool xma_dev_available(XmaDevice *dev, uint32_t dev_id)
 {
-    XmaDevice *devices = xma_shm->sys_res.devices;
     pid_t  proc_id = getpid();
-    uint32_t dev_id;
     int ret;
 
-    xma_logmsg(XMA_DEBUG_LOG, XMA_RES_MOD, "%s()\n", __func__);
-    /* start search from next device: *dev_handle + 1 */
-    for (dev_id = *dev_handle >= 0 ? *dev_handle + 1 : 0;
-         dev_id < MAX_XILINX_DEVICES; dev_id++) {
-        if (!devices[dev_id].exists)
-            continue;
+    if (!dev->exists)
+        return false;
 
-        if (devices[dev_id].excl) {
-            ret = xma_verify_process_res(devices[dev_id].client_procs[0]);
-            if (ret) {
-                xma_free_all_kernel_chan_res(&devices[dev_id], 0);
-                xma_logmsg(XMA_DEBUG_LOG, XMA_RES_MOD,
-                           "Resetting client id for exclusive use device %u\n",
-                           dev_id);
-                devices[dev_id].excl = false;
-                devices[dev_id].client_procs[0] = 0;
-                *dev_handle = dev_id;
-                return XMA_SUCCESS;
-            } else if (devices[dev_id].client_procs[0] == proc_id) {
-                xma_logmsg(XMA_DEBUG_LOG, XMA_RES_MOD,
-                           "Found free device id: %u\n", dev_id);
-                *dev_handle = dev_id;
-                return XMA_SUCCESS;
-            }
-            continue;
+    if (dev->excl) {
+        ret = xma_verify_process_res(dev->client_procs[0]);
+        if (ret) {
+            xma_free_all_kernel_chan_res(dev, 0);
+            xma_logmsg(XMA_DEBUG_LOG, XMA_RES_MOD,
+                       "Resetting client id for exclusive use device %u\n",
+                       dev_id);
+            dev->excl = false;
+            dev->client_procs[0] = 0;
+            return true;
+        } else if (dev->client_procs[0] == proc_id) {
+            xma_logmsg(XMA_DEBUG_LOG, XMA_RES_MOD,
+                       "Found free device id: %u\n", dev_id);
+            return true;
         }
-        *dev_handle = dev_id;
-        return XMA_SUCCESS;
+        return false;
     }
-    return XMA_ERROR_NO_DEV;
+    return true;
+}
+
+/* call while holding device lock */
+static bool xma_dev_registered(XmaDevice *dev, pid_t proc_id)
+{
+    int pid_idx;
+
+    for (pid_idx = 0; pid_idx < MAX_KERNEL_CONFIGS; pid_idx++)
+        if (dev->client_procs[pid_idx] == proc_id)
+            return true;
+    return false;
 }
 
 static int xma_alloc_dev(XmaResConfig *xma_shm, int dev_handle,
@@ -832,6 +887,109 @@ static int xma_free_dev(XmaResConfig *xma_shm, int32_t dev_handle,
     return XMA_ERROR_INVALID;
 }
 
+static enum XmaKernType xma_res_kern_type(const char *function)
+{
+    if (strcmp(function, XMA_CFG_FUNC_NM_SCALE) == 0)
+        return xma_res_scaler;
+    if (strcmp(function, XMA_CFG_FUNC_NM_ENC) == 0)
+        return xma_res_encoder;
+    if (strcmp(function, XMA_CFG_FUNC_NM_DEC) == 0)
+        return xma_res_decoder;
+    if (strcmp(function, XMA_CFG_FUNC_NM_FILTER) == 0)
+        return xma_res_filter;
+    if (strcmp(function, XMA_CFG_FUNC_NM_KERNEL) == 0)
+        return xma_res_kernel;
+    return 0;
+}
+
+/* call while holding lock */
+static void xma_init_shm_index(XmaResConfig *xma_shm)
+{
+    XmaShmRes *sys_res = &xma_shm->sys_res;
+    int dev_id, kern_idx, i;
+
+    sys_res->index_cnt = 0;
+    for (dev_id = 0; dev_id < MAX_XILINX_DEVICES; dev_id++)
+    {
+        XmaDevice *dev = &sys_res->devices[dev_id];
+
+        if (!dev->exists)
+            continue;
+
+        for (kern_idx = 0;
+             kern_idx < MAX_KERNEL_CONFIGS && kern_idx < dev->kernel_cnt;
+             kern_idx++)
+        {
+            int kern_id = dev->kernels[kern_idx].kernel_id;
+            XmaKernel *kernel = &sys_res->images[dev->image_id].kernels[kern_id];
+            enum XmaKernType type = xma_res_kern_type(kernel->function);
+            XmaKernelIndex *entry = NULL;
+
+            if (!type)
+                continue;
+
+            for (i = 0; i < sys_res->index_cnt; i++)
+                if (sys_res->index[i].type == type &&
+                    strcmp(sys_res->index[i].vendor, kernel->vendor) == 0) {
+                    entry = &sys_res->index[i];
+                    break;
+                }
+
+            if (!entry) {
+                if (sys_res->index_cnt == MAX_KERNEL_CONFIGS)
+                    continue;
+                entry = &sys_res->index[sys_res->index_cnt++];
+                entry->type = type;
+                strncpy(entry->vendor, kernel->vendor, (NAME_MAX-1));
+            }
+            entry->slots[entry->slot_cnt].dev_id = dev_id;
+            entry->slots[entry->slot_cnt].kern_idx = kern_idx;
+            entry->slots[entry->slot_cnt].plugin_handle = kernel->plugin_handle;
+            entry->slot_cnt++;
+        }
+    }
+}
+
+static bool xma_res_plugin_match(XmaKernReq *kern_props,
+                                 int32_t plugin_handle,
+                                 size_t *kernel_data_size,
+                                 int32_t (**alloc_chan)(XmaSession *p,
+                                                        XmaSession **s,
+                                                        uint32_t cnt))
+{
+    extern XmaSingleton *g_xma_singleton;
+    XmaScalerPlugin *scaler;
+    XmaDecoderPlugin *decoder;
+    XmaEncoderPlugin *encoder;
+    XmaFilterPlugin *filter;
+    XmaKernelPlugin *kernplg;
+
+    *alloc_chan = NULL;
+    *kernel_data_size = 0;
+    switch (kern_props->type) {
+    case xma_res_scaler:
+        scaler = &g_xma_singleton->scalercfg[plugin_handle];
+        *alloc_chan = scaler->alloc_chan;
+        return scaler->hwscaler_type == kern_props->kernel_spec.scal_type;
+    case xma_res_encoder:
+        encoder = &g_xma_singleton->encodercfg[plugin_handle];
+        *alloc_chan = encoder->alloc_chan;
+        *kernel_data_size = encoder->kernel_data_size;
+        return encoder->hwencoder_type == kern_props->kernel_spec.enc_type;
+    case xma_res_decoder:
+        decoder = &g_xma_singleton->decodercfg[plugin_handle];
+        return decoder->hwdecoder_type == kern_props->kernel_spec.dec_type;
+    case xma_res_filter:
+        filter = &g_xma_singleton->filtercfg[plugin_handle];
+        *alloc_chan = filter->alloc_chan;
+        return filter->hwfilter_type == kern_props->kernel_spec.filter_type;
+    case xma_res_kernel:
+        kernplg = &g_xma_singleton->kernelcfg[plugin_handle];
+        return kernplg->hwkernel_type == kern_props->kernel_spec.kernel_type;
+    }
+    return false;
+}
+
 static int32_t xma_res_alloc_kernel(XmaResources shm_cfg,
                                          XmaSession *session,
                                          XmaKernReq *kern_props,
@@ -841,120 +999,88 @@ static int32_t xma_res_alloc_kernel(XmaResources shm_cfg,
                                  XmaSession **current,
                                  uint32_t sess_cnt);
     XmaResConfig *xma_shm = (XmaResConfig *)shm_cfg;
+    XmaShmRes *sys_res = &xma_shm->sys_res;
+    XmaKernelIndex *entry = NULL;
+    XmaKernelSlot cands[MAX_XILINX_DEVICES * MAX_KERNEL_CONFIGS];
+    uint64_t loads[MAX_XILINX_DEVICES * MAX_KERNEL_CONFIGS];
     pid_t proc_id = getpid();
-    extern XmaSingleton *g_xma_singleton;
-    int kern_idx, dev_id;
-    bool kern_aquired = false;
+    int i, j, cand_cnt = 0;
     size_t kernel_data_size;
 
     xma_logmsg(XMA_DEBUG_LOG, XMA_RES_MOD, "%s()\n", __func__);
     if (!session)
         return XMA_ERROR_INVALID;
 
-    for (dev_id = -1; !kern_aquired && (dev_id < MAX_XILINX_DEVICES);)
-    {
-        XmaDevice *dev;
-        int ret = 0;
-        bool dev_exclusive = kern_props->dev_excl;
-
-        dev_id = xma_res_alloc_next_dev(shm_cfg, dev_id, dev_exclusive);
-        if (dev_id < 0)
+    for (i = 0; i < sys_res->index_cnt; i++)
+        if (sys_res->index[i].type == type &&
+            strcmp(sys_res->index[i].vendor, kern_props->vendor) == 0) {
+            entry = &sys_res->index[i];
             break;
+        }
 
-        dev = &xma_shm->sys_res.devices[dev_id];
-        /* JPM check to see if matching kernel is on allocated device */
-        /* if not, free device, increment dev count, re-loop */
-        for (kern_idx = 0;
-             kern_idx < MAX_KERNEL_CONFIGS &&
-             kern_idx < dev->kernel_cnt && !kern_aquired;
-             kern_idx++)
-        {
-            int str_cmp1 = -1, str_cmp2 = -1, type_cmp = false;
-            int kern_id = dev->kernels[kern_idx].kernel_id;
-            XmaKernel *kernel =
-                &xma_shm->sys_res.images[dev->image_id].kernels[kern_id];
-            XmaScalerPlugin *scaler;
-            XmaDecoderPlugin *decoder;
-            XmaEncoderPlugin *encoder;
-            XmaFilterPlugin *filter;
-            XmaKernelPlugin *kernplg;
-            plugin_alloc_chan = NULL;
-
-            str_cmp1 = strcmp(kernel->vendor, kern_props->vendor);
-            if (type == xma_res_scaler) {
-                scaler = &g_xma_singleton->scalercfg[kernel->plugin_handle];
-                str_cmp2 = strcmp(kernel->function, XMA_CFG_FUNC_NM_SCALE);
-                type_cmp = scaler->hwscaler_type ==
-                           kern_props->kernel_spec.scal_type ? true : false;
-                plugin_alloc_chan = scaler->alloc_chan;
-                kernel_data_size = 0;
-            } else if (type == xma_res_encoder) {
-                encoder = &g_xma_singleton->encodercfg[kernel->plugin_handle];
-                str_cmp2 = strcmp(kernel->function, XMA_CFG_FUNC_NM_ENC);
-                type_cmp = encoder->hwencoder_type ==
-                           kern_props->kernel_spec.enc_type ? true : false;
-                plugin_alloc_chan = encoder->alloc_chan;
-                kernel_data_size = encoder->kernel_data_size;
-            } else if (type == xma_res_decoder) {
-                decoder = &g_xma_singleton->decodercfg[kernel->plugin_handle];
-                str_cmp2 = strcmp(kernel->function, XMA_CFG_FUNC_NM_DEC);
-                type_cmp = decoder->hwdecoder_type ==
-                           kern_props->kernel_spec.dec_type ? true : false;
-                plugin_alloc_chan = NULL;
-                kernel_data_size = 0;
-            } else if (type == xma_res_filter) {
-                filter = &g_xma_singleton->filtercfg[kernel->plugin_handle];
-                str_cmp2 = strcmp(kernel->function, XMA_CFG_FUNC_NM_FILTER);
-                type_cmp = filter->hwfilter_type ==
-                           kern_props->kernel_spec.filter_type ? true : false;
-                plugin_alloc_chan = filter->alloc_chan;
-                kernel_data_size = 0;
-            } else if (type == xma_res_kernel) {
-                kernplg = &g_xma_singleton->kernelcfg[kernel->plugin_handle];
-                str_cmp2 = strcmp(kernel->function, XMA_CFG_FUNC_NM_KERNEL);
-                type_cmp = kernplg->hwkernel_type ==
-                           kern_props->kernel_spec.kernel_type ? true : false;
-                kernel_data_size = 0;
-            }
+    /* Candidate kernels ordered by load, least loaded first.  Loads are
+     * read without device locks and only order the search, the kernel
+     * is rechecked when allocated under the device lock. */
+    for (i = 0; entry && i < entry->slot_cnt; i++)
+    {
+        XmaKernelSlot *slot = &entry->slots[i];
+        XmaDevice *dev = &sys_res->devices[slot->dev_id];
+        XmaKernelInstance *kernel_inst = &dev->kernels[slot->kern_idx];
+        pid_t client_id = __atomic_load_n(&kernel_inst->client_id,
+                                          __ATOMIC_RELAXED);
+        uint64_t kern_chans = __atomic_load_n(&kernel_inst->chan_cnt,
+                                              __ATOMIC_RELAXED);
+        uint64_t load;
+
+        if (!xma_res_plugin_match(kern_props, slot->plugin_handle,
+                                  &kernel_data_size, &plugin_alloc_chan))
+            continue;
+        if (client_id && client_id != proc_id)
+            continue;
+        if (kern_chans && (!plugin_alloc_chan || kern_chans >= MAX_KERNEL_CHANS))
+            continue;
 
-            if (str_cmp1 == 0 && str_cmp2 == 0 && type_cmp) {
-                /* register client thread id with kernel */
-                    ret = xma_client_thread_kernel_alloc(shm_cfg, dev, kern_idx,
-                                                         session,
-                                                         kernel_data_size,
-                                                         plugin_alloc_chan);
-                    if (ret)
-                        continue;
-
-                    kern_props->dev_handle = dev_id;
-                    kern_props->kern_handle = kern_idx;
-                    kern_props->plugin_handle = kernel->plugin_handle;
-                    kern_props->session = session;
-                    kern_aquired = true;
-            }
+        load = kern_chans << 32 |
+               __atomic_load_n(&dev->chan_cnt, __ATOMIC_RELAXED);
+        for (j = cand_cnt; j > 0 && loads[j - 1] > load; j--) {
+            loads[j] = loads[j - 1];
+            cands[j] = cands[j - 1];
         }
+        loads[j] = load;
+        cands[j] = *slot;
+        cand_cnt++;
+    }
 
-        if (!kern_aquired) {
-            xma_logmsg(XMA_DEBUG_LOG, XMA_RES_MOD,
-                       "%s() Unable to locate requested %s kernel type\n",
-                        __func__,
-                        kern_props->kernel_spec.scal_type ? "scaler" :
-                        kern_props->kernel_spec.enc_type ? "encoder" :
-                        kern_props->kernel_spec.dec_type ? "decoder" :
-                        kern_props->kernel_spec.filter_type ? "filter" :
-                        "kernel"
-                        );
-            xma_logmsg(XMA_DEBUG_LOG, XMA_RES_MOD,
-                       "%s() from vendor %s on device %d\n",
-                        __func__, kern_props->vendor, dev_id);
-            ret = xma_free_dev(xma_shm, dev_id, proc_id);
-        }
+    for (i = 0; i < cand_cnt; i++)
+    {
+        XmaDevice *dev = &sys_res->devices[cands[i].dev_id];
+        bool registered;
+        int ret = XMA_ERROR_NO_DEV;
 
-        if (ret < 0) {
+        xma_res_plugin_match(kern_props, cands[i].plugin_handle,
+                             &kernel_data_size, &plugin_alloc_chan);
+        if (xma_dev_lock(dev))
             return XMA_ERROR;
+        registered = xma_dev_registered(dev, proc_id);
+        if (xma_dev_available(dev, cands[i].dev_id))
+            ret = xma_alloc_dev(xma_shm, cands[i].dev_id, kern_props->dev_excl);
+        if (ret == XMA_SUCCESS) {
+            /* register client thread id with kernel */
+            ret = xma_client_thread_kernel_alloc(dev, cands[i].kern_idx,
+                                                 session,
+                                                 kernel_data_size,
+                                                 plugin_alloc_chan);
+            if (ret && !registered)
+                xma_free_dev(xma_shm, cands[i].dev_id, proc_id);
         }
-    }
-    if (kern_aquired) {
+        xma_dev_unlock(dev);
+        if (ret)
+            continue;
+
+        kern_props->dev_handle = cands[i].dev_id;
+        kern_props->kern_handle = cands[i].kern_idx;
+        kern_props->plugin_handle = cands[i].plugin_handle;
+        kern_props->session = session;
         session->kern_res = (XmaKernelRes)kern_props;
         return XMA_SUCCESS;
     }
@@ -969,8 +1095,8 @@ static int32_t xma_res_alloc_kernel(XmaResources shm_cfg,
 
 }
 
-static int32_t xma_client_thread_kernel_alloc(XmaResources shm_cfg,
-                                              XmaDevice *dev,
+/* call while holding device lock */
+static int32_t xma_client_thread_kernel_alloc(XmaDevice *dev,
                                               int dev_kern_idx,
                                               XmaSession *session,
                                               size_t kernel_data_size,
@@ -980,24 +1106,16 @@ static int32_t xma_client_thread_kernel_alloc(XmaResources shm_cfg,
                                                              uint32_t sess_cnt))
 {
     XmaKernelInstance *kernel_inst = &dev->kernels[dev_kern_idx];
-    XmaResConfig *xma_shm = (XmaResConfig *)shm_cfg;
     XmaSession *sessions[MAX_KERNEL_CHANS];
     pthread_t thread_id = pthread_self();
     pid_t proc_id = getpid();
     int j, ret;
 
     xma_logmsg(XMA_DEBUG_LOG, XMA_RES_MOD, "%s()\n", __func__);
-    if (xma_shm_lock(xma_shm))
-        return XMA_ERROR;
-
-    if (kernel_inst->client_id && kernel_inst->client_id != proc_id) {
-        xma_shm_unlock(xma_shm);
+    if (kernel_inst->client_id && kernel_inst->client_id != proc_id)
         return XMA_ERROR_NO_KERNEL; /* some other process has this kernel */
-    }
 
-    kernel_inst->client_id = proc_id;
-
-    for (j = 0; kernel_inst->channels[j].thread_id && j < MAX_KERNEL_CHANS; j++)
+    for (j = 0; j < MAX_KERNEL_CHANS && kernel_inst->channels[j].thread_id; j++)
         sessions[j] = kernel_inst->channels[j].session;
 
     if (!j) { /* unused kernel */
@@ -1011,19 +1129,21 @@ static int32_t xma_client_thread_kernel_alloc(XmaResources shm_cfg,
             if (ret) {
                 xma_logmsg(XMA_DEBUG_LOG, XMA_RES_MOD,
                            "%s() Channel request rejected\n", __func__);
-                xma_shm_unlock(xma_shm);
+                if (kernel_data_size > 0) {
+                    free(session->kernel_data);
+                    session->kernel_data = NULL;
+                }
                 return ret;
             }
         }
+        kernel_inst->client_id = proc_id;
         kernel_inst->channels[j].session = session;
         kernel_inst->channels[j].thread_id = thread_id;
         session->chan_id = session->chan_id >= 0 ? session->chan_id : 0;
         xma_logmsg(XMA_DEBUG_LOG, XMA_RES_MOD,
                    "%s() Kernel aquired. Channel id %d\n",
                    __func__, session->chan_id);
-        xma_shm_unlock(xma_shm);
-        return XMA_SUCCESS;
-    } else if (j && j < MAX_KERNEL_CHANS && alloc_chan) {
+    } else if (j < MAX_KERNEL_CHANS && alloc_chan) {
         /* verify it can support another request */
         xma_logmsg(XMA_DEBUG_LOG, XMA_RES_MOD,
                    "%s() Kernel in-use and supports channels. Channel instance %d\n",
@@ -1031,23 +1151,19 @@ static int32_t xma_client_thread_kernel_alloc(XmaResources shm_cfg,
         if (kernel_data_size > 0)
             session->kernel_data = sessions[0]->kernel_data;
         ret = alloc_chan(session, sessions, j);
-        if (ret) {
-            xma_shm_unlock(xma_shm);
+        if (ret)
             return ret;
-        }
         kernel_inst->channels[j].session = session;
         kernel_inst->channels[j].thread_id = thread_id;
-        xma_shm_unlock(xma_shm);
-        return XMA_SUCCESS;
-    } else if (j && !alloc_chan) {
+    } else {
         /* kernel is in-use and doesn't support channels */
         xma_logmsg(XMA_DEBUG_LOG, XMA_RES_MOD,
                    "%s() All kernel channels in-use \n", __func__);
-        xma_shm_unlock(xma_shm);
         return XMA_ERROR_NO_KERNEL;
     }
-    xma_shm_unlock(xma_shm);
-    return XMA_ERROR;
+    __atomic_store_n(&kernel_inst->chan_cnt, j + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&dev->chan_cnt, dev->chan_cnt + 1, __ATOMIC_RELAXED);
+    return XMA_SUCCESS;
 }
 
 static int xma_client_thread_kernel_free(XmaDevice *dev,
@@ -1082,6 +1198,8 @@ static int xma_client_thread_kernel_free(XmaDevice *dev,
                                      kernel_inst->channels[i+1].session;
         }
         last_used_chan = !i ? true : false;
+        __atomic_store_n(&kernel_inst->chan_cnt, i, __ATOMIC_RELAXED);
+        __atomic_store_n(&dev->chan_cnt, dev->chan_cnt - 1, __ATOMIC_RELAXED);
         /* ensure last entry is cleared if not otherwise */
         if (!last_used_chan) {
             kernel_inst->channels[i].thread_id = 0;
@@ -1144,6 +1262,29 @@ static int xma_shm_unlock(XmaResConfig *xma_shm)
     return pthread_mutex_unlock(&xma_shm->lock);
 }
 
+static int xma_dev_lock(XmaDevice *dev)
+{
+    extern XmaSingleton *g_xma_singleton;
+    int ret;
+
+    if (g_xma_singleton->shm_freed || !dev)
+        return XMA_ERROR_INVALID;
+
+    ret = pthread_mutex_lock(&dev->lock);
+    if (ret == EOWNERDEAD) {
+        pthread_mutex_consistent(&dev->lock);
+        return XMA_SUCCESS;
+    }
+    return ret;
+}
+
+static int xma_dev_unlock(XmaDevice *dev)
+{
+    if (!dev)
+        return XMA_ERROR_INVALID;
+    return pthread_mutex_unlock(&dev->lock);
+}
+
 static void xma_free_all_kernel_chan_res(XmaDevice *dev, pid_t proc_id)
 {
     int i;
@@ -1163,6 +1304,9 @@ static void xma_free_all_kernel_chan_res(XmaDevice *dev, pid_t proc_id)
             kernel->channels[j].thread_id = 0;
             kernel->channels[j].session = NULL;
         }
+        __atomic_store_n(&dev->chan_cnt, dev->chan_cnt - kernel->chan_cnt,
+                         __ATOMIC_RELAXED);
+        __atomic_store_n(&kernel->chan_cnt, 0, __ATOMIC_RELAXED);
     }
 }
 
@@ -1264,7 +1408,7 @@ static int xma_inc_ref_shm(XmaResConfig *xma_shm)
     return XMA_SUCCESS;
 }
 
-/* call while holding lock */
+/* call while holding lock, takes each device lock */
 static void xma_free_all_proc_res(XmaResConfig *xma_shm, pid_t proc_id)
 {
     int i;
@@ -1272,8 +1416,13 @@ static void xma_free_all_proc_res(XmaResConfig *xma_shm, pid_t proc_id)
     xma_logmsg(XMA_DEBUG_LOG, XMA_RES_MOD, "%s()\n", __func__);
     for (i = 0; i < MAX_XILINX_DEVICES; i++)
     {
+        XmaDevice *dev = &xma_shm->sys_res.devices[i];
+
+        if (xma_dev_lock(dev))
+            continue;
         xma_free_dev(xma_shm, i, proc_id);
-        xma_free_all_kernel_chan_res(&xma_shm->sys_res.devices[i], proc_id);
+        xma_free_all_kernel_chan_res(dev, proc_id);
+        xma_dev_unlock(dev);
     }
     return;
 }
@@ -15,10 +15,13 @@
  * under the License.
  */
 #include <stdio.h>
-#include <fstream>
 #include <string.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 //#include <xclbin.h>
 #include "app/xmaerror.h"
 #include "lib/xmaxclbin.h"
@@ -32,19 +35,53 @@ char *xma_xclbin_file_open(const char *xclbin_name)
 {
     xma_logmsg("Loading %s\n", xclbin_name);
 
-    std::ifstream file(xclbin_name, std::ios::binary | std::ios::ate);
-    std::streamsize size = file.tellg();
-    file.seekg(0, std::ios::beg);
+    int fd = open(xclbin_name, O_RDONLY);
+    if (fd < 0)
+    {
+        xma_logmsg("Could not open file %s\n", xclbin_name);
+        return NULL;
+    }
 
-    char *buffer = (char*)malloc(size);
-    if (!file.read(buffer, size))
+    /* Map exactly the xclbin as given by its header, so that
+     * xma_xclbin_file_close can unmap it without tracking the size
+     */
+    axlf header;
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+        memcmp(header.m_magic, "xclbin2", 8) != 0 ||
+        header.m_header.m_length < sizeof(header) ||
+        header.m_header.m_length > (uint64_t)st.st_size)
     {
         xma_logmsg("Could not read file %s\n", xclbin_name);
-        free(buffer);
-        buffer = NULL;
+        close(fd);
+        return NULL;
+    }
+
+    /* Read-only mapping shares page cache pages between processes
+     * loading the same xclbin, populate it as the entire xclbin is
+     * downloaded to the device
+     */
+    size_t size = header.m_header.m_length;
+    void *addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+    {
+        xma_logmsg("Could not map file %s\n", xclbin_name);
+        return NULL;
     }
+    madvise(addr, size, MADV_WILLNEED);
 
-    return buffer;
+    return (char*)addr;
+}
+
+void xma_xclbin_file_close(char *buffer)
+{
+    if (!buffer)
+        return;
+
+    axlf *xclbin = reinterpret_cast<axlf *>(buffer);
+    munmap(buffer, xclbin->m_header.m_length);
 }
 
 int xma_xclbin_info_get(char *buffer, XmaXclbinInfo *info)
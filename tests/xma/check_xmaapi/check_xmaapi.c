@@ -18,7 +18,9 @@
 #include <sys/types.h>
 
 #include <fcntl.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <strings.h>
 #include <unistd.h>
 #include "xma.h"
@@ -42,6 +44,108 @@ static inline bool check_xmaapi_hw_configure(XmaHwCfg *hwcfg, XmaSystemCfg *syst
     return true;
 }
 
+#define CHECK(cond) do { if (!(cond)) { \
+        printf("check_xmaapi:%d: %s failed\n", __LINE__, #cond); \
+        failed++; } } while (0)
+
+static bool check_xmaapi_aligned(XmaFrame *frame, int32_t plane)
+{
+    return ((uintptr_t)frame->data[plane].buffer % 64) == 0;
+}
+
+/* Frame pool reuse, reference counting, plane layout and destroying a
+ * pool while frames are in use */
+static int check_xmaapi_frame_pool(void)
+{
+    XmaFrameProperties props;
+    XmaFramePool      *pool;
+    XmaFrame          *f1, *f2, *f3, *f4, *f5;
+    int                failed = 0;
+    int32_t            i;
+
+    memset(&props, 0, sizeof(props));
+    props.format = XMA_YUV420_FMT_TYPE;
+    props.width = 1921;
+    props.height = 1081;
+    props.bits_per_pixel = 8;
+
+    /* chroma planes of odd sizes round up, 16 bit samples above 8 bits */
+    CHECK(xma_frame_planes_get(&props) == 3);
+    CHECK(xma_frame_plane_size_get(&props, 0) == 1921 * 1081);
+    CHECK(xma_frame_plane_size_get(&props, 1) == 961 * 541);
+    CHECK(xma_frame_plane_size_get(&props, 2) == 961 * 541);
+    CHECK(xma_frame_plane_size_get(&props, 3) == 0);
+    props.bits_per_pixel = 10;
+    CHECK(xma_frame_plane_size_get(&props, 1) == 961 * 541 * 2);
+    props.bits_per_pixel = 8;
+
+    pool = xma_frame_pool_create(&props, 2, NULL);
+    CHECK(pool != NULL);
+    if (!pool)
+        return failed;
+
+    f1 = xma_frame_pool_alloc(pool);
+    f2 = xma_frame_pool_alloc(pool);
+    CHECK(f1 && f2 && f1 != f2);
+    if (!f1 || !f2)
+        return failed;
+    CHECK(f1->pool == pool);
+    for (i = 0; i < 3; i++)
+    {
+        CHECK(f1->data[i].refcount == 1);
+        CHECK(check_xmaapi_aligned(f1, i));
+        memset(f1->data[i].buffer, i, xma_frame_plane_size_get(&props, i));
+    }
+    CHECK((uint8_t*)f1->data[1].buffer - (uint8_t*)f1->data[0].buffer
+          >= 1921 * 1081);
+
+    /* freed frame is reused by the next allocation */
+    xma_frame_free(f1);
+    f3 = xma_frame_pool_alloc(pool);
+    CHECK(f3 == f1);
+    CHECK(f3->data[0].refcount == 1);
+
+    /* referenced frame stays in use until the last free */
+    CHECK(xma_frame_ref(f2) == f2);
+    CHECK(f2->data[0].refcount == 2 && f2->data[2].refcount == 2);
+    xma_frame_free(f2);
+    CHECK(f2->data[0].refcount == 1);
+    f4 = xma_frame_pool_alloc(pool);
+    CHECK(f4 && f4 != f2 && f4 != f3);
+    xma_frame_free(f2);
+    f5 = xma_frame_pool_alloc(pool);
+    CHECK(f5 == f2);
+
+    /* frames in use remain valid after destroy and are freed on release */
+    xma_frame_pool_destroy(pool);
+    if (f4)
+    {
+        for (i = 0; i < 3; i++)
+            memset(f4->data[i].buffer, 0x5a, xma_frame_plane_size_get(&props, i));
+        xma_frame_ref(f4);
+        xma_frame_free(f4);
+        CHECK(((uint8_t*)f4->data[2].buffer)[0] == 0x5a);
+        xma_frame_free(f4);
+    }
+    xma_frame_free(f3);
+    xma_frame_free(f5);
+
+    /* xma_frame_alloc shares a pool per frame properties when enabled */
+    xma_frame_pool_enable(true);
+    f1 = xma_frame_alloc(&props);
+    CHECK(f1 && f1->pool);
+    xma_frame_free(f1);
+    f2 = xma_frame_alloc(&props);
+    CHECK(f2 == f1);
+    xma_frame_free(f2);
+    xma_frame_pool_enable(false);
+    f3 = xma_frame_alloc(&props);
+    CHECK(f3 && !f3->pool && check_xmaapi_aligned(f3, 2));
+    xma_frame_free(f3);
+
+    return failed;
+}
+
 int main()
 {
     int number_failed = 0;
@@ -57,6 +161,8 @@ int main()
       number_failed++;
     }
 
+    number_failed += check_xmaapi_frame_pool();
+
     if (number_failed == 0) {
      printf("XMA check_xmaapi test completed successfully\n");
      return EXIT_SUCCESS;
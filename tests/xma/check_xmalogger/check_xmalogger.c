@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2018, Xilinx Inc - All rights reserved
+ * Xilinx SDAccel Media Accelerator API
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+/* Per message cost of xma_logmsg from concurrent threads, for messages
+ * that are logged (INFO) and messages filtered by the log level (DEBUG).
+ * Messages that do not fit in a full ring are dropped and counted, every
+ * message sent is either written to the log file or counted as dropped.
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "xma.h"
+#include "lib/xmaapi.h"
+
+#define CHECK_THREADS   32
+#define CHECK_MESSAGES  100000
+#define CHECK_FILE_MESSAGES 10000
+
+extern XmaSingleton *g_xma_singleton;
+
+static XmaLogLevelType check_level;
+static int32_t check_messages;
+static uint64_t check_thread_ns[CHECK_THREADS];
+
+static uint64_t check_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void *check_xmalogger_thread(void *data)
+{
+    int32_t  idx = (int32_t)(intptr_t)data;
+    uint64_t start;
+    int32_t  i;
+
+    start = check_now();
+    for (i = 0; i < check_messages; i++)
+        xma_logmsg(check_level, "check_xmalogger",
+                   "thread %d message %d of %d\n", idx, i, check_messages);
+    check_thread_ns[idx] = check_now() - start;
+
+    return NULL;
+}
+
+/* Returns average ns per message over all threads */
+static double check_xmalogger_run(XmaLogLevelType level, int32_t messages)
+{
+    pthread_t threads[CHECK_THREADS];
+    uint64_t  total = 0;
+    int32_t   i;
+
+    check_level = level;
+    check_messages = messages;
+    for (i = 0; i < CHECK_THREADS; i++)
+        pthread_create(&threads[i], NULL, check_xmalogger_thread, (void*)(intptr_t)i);
+    for (i = 0; i < CHECK_THREADS; i++)
+    {
+        pthread_join(threads[i], NULL);
+        total += check_thread_ns[i];
+    }
+
+    return (double)total / ((uint64_t)CHECK_THREADS * messages);
+}
+
+/* Number of lines of file containing str */
+static uint64_t check_count_lines(const char *filename, const char *str)
+{
+    char     line[XMA_MAX_LOGMSG_SIZE + 64];
+    uint64_t count = 0;
+    FILE    *fp;
+
+    fp = fopen(filename, "r");
+    if (!fp)
+        return 0;
+    while (fgets(line, sizeof(line), fp))
+        if (strstr(line, str))
+            count++;
+    fclose(fp);
+    return count;
+}
+
+int main()
+{
+    XmaLogger *logger;
+    uint64_t   dropped;
+    uint64_t   written;
+    double     ns;
+
+    /* Logger alone, writing to /dev/null at level INFO */
+    g_xma_singleton = calloc(1, sizeof(*g_xma_singleton));
+    g_xma_singleton->systemcfg.logger_initialized = true;
+    strcpy(g_xma_singleton->systemcfg.logfile, "/dev/null");
+    g_xma_singleton->systemcfg.loglevel = XMA_INFO_LOG;
+    logger = &g_xma_singleton->logger;
+    if (xma_logger_init(logger) != 0)
+    {
+        printf("ERROR: XMA check_xmalogger test failed\n");
+        return EXIT_FAILURE;
+    }
+
+    ns = check_xmalogger_run(XMA_INFO_LOG, CHECK_MESSAGES);
+    dropped = xma_logger_dropped(logger);
+    printf("INFO  logged    %8.1f ns/msg, %lu of %d dropped\n",
+           ns, (unsigned long)dropped, CHECK_THREADS * CHECK_MESSAGES);
+
+    ns = check_xmalogger_run(XMA_DEBUG_LOG, CHECK_MESSAGES);
+    printf("DEBUG filtered  %8.1f ns/msg\n", ns);
+
+    logger->log_level = XMA_DEBUG_LOG;
+    ns = check_xmalogger_run(XMA_DEBUG_LOG, CHECK_MESSAGES);
+    printf("DEBUG logged    %8.1f ns/msg, %lu of %d dropped\n",
+           ns, (unsigned long)(xma_logger_dropped(logger) - dropped),
+           CHECK_THREADS * CHECK_MESSAGES);
+
+    xma_logger_close(logger);
+
+    /* Logger writing to a file, each message is written or dropped */
+    snprintf(g_xma_singleton->systemcfg.logfile,
+             sizeof(g_xma_singleton->systemcfg.logfile),
+             "/tmp/check_xmalogger_%d.log", (int)getpid());
+    unlink(g_xma_singleton->systemcfg.logfile);
+    if (xma_logger_init(logger) != 0)
+    {
+        printf("ERROR: XMA check_xmalogger test failed\n");
+        return EXIT_FAILURE;
+    }
+    check_xmalogger_run(XMA_INFO_LOG, CHECK_FILE_MESSAGES);
+    dropped = xma_logger_dropped(logger);
+    xma_logger_close(logger);
+    written = check_count_lines(g_xma_singleton->systemcfg.logfile, "check_xmalogger");
+    unlink(g_xma_singleton->systemcfg.logfile);
+    printf("INFO  file      %lu written, %lu dropped of %d\n",
+           (unsigned long)written, (unsigned long)dropped,
+           CHECK_THREADS * CHECK_FILE_MESSAGES);
+
+    if (written + dropped != (uint64_t)CHECK_THREADS * CHECK_FILE_MESSAGES)
+    {
+        printf("ERROR: XMA check_xmalogger test failed, messages lost\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("XMA check_xmalogger test completed successfully\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,254 @@
+/*
+ * Copyright (C) 2018, Xilinx Inc - All rights reserved
+ * Xilinx SDAccel Media Accelerator API
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+/* Session creation rate of the resource manager with several processes
+ * allocating and freeing encoder kernels concurrently, and release of
+ * the kernels of a process that exits XMA while other processes still
+ * use the resource database.
+ */
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "xma.h"
+#include "lib/xmaapi.h"
+#include "lib/xmares.h"
+#include "lib/xmahw.h"
+#include "lib/xmahw_private.h"
+#include "plg/xmasess.h"
+
+#define CHECK_PROCS     4
+#define CHECK_SESSIONS  20000
+#define CHECK_MAX_HELD  1024
+
+typedef struct CheckResult
+{
+    uint64_t    created;
+    uint64_t    rejected;
+    uint64_t    ns;
+} CheckResult;
+
+static inline int32_t check_xmares_probe(XmaHwCfg *hwcfg) {
+    return 0;
+}
+
+static inline bool check_xmares_is_compatible(XmaHwCfg *hwcfg, XmaSystemCfg *systemcfg) {
+    return true;
+}
+
+static inline bool check_xmares_hw_configure(XmaHwCfg *hwcfg, XmaSystemCfg *systemcfg, bool hw_cfg_status) {
+    return true;
+}
+
+static uint64_t check_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Create and close encoder sessions once all processes are initialized */
+static int check_xmares_client(int ready_fd, int start_fd, int result_fd)
+{
+    extern XmaSingleton *g_xma_singleton;
+    CheckResult result = {0, 0, 0};
+    XmaSession  session;
+    uint64_t    start;
+    char        c = 0;
+    int32_t     rc;
+    int32_t     i;
+
+    rc = xma_initialize("../system_cfg/check_cfg.yaml");
+    if (rc != 0)
+        return EXIT_FAILURE;
+    g_xma_singleton->logger.log_level = XMA_INFO_LOG;
+
+    if (write(ready_fd, &c, 1) != 1 || read(start_fd, &c, 1) != 1)
+        return EXIT_FAILURE;
+
+    start = check_now();
+    for (i = 0; i < CHECK_SESSIONS; i++)
+    {
+        memset(&session, 0, sizeof(session));
+        session.session_type = XMA_ENCODER;
+        session.chan_id = -1;
+        rc = xma_res_alloc_enc_kernel(g_xma_singleton->shm_res_cfg,
+                                      XMA_COPY_ENCODER_TYPE, "Xilinx",
+                                      &session, false);
+        if (rc != 0)
+        {
+            result.rejected++;
+            continue;
+        }
+        result.created++;
+        xma_res_free_kernel(g_xma_singleton->shm_res_cfg, session.kern_res);
+    }
+    result.ns = check_now() - start;
+
+    if (write(result_fd, &result, sizeof(result)) != sizeof(result))
+        return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
+
+/* Allocate encoder sessions until rejected, sessions are not freed */
+static int32_t check_xmares_hold_all(XmaSession *sessions)
+{
+    extern XmaSingleton *g_xma_singleton;
+    int32_t held;
+
+    for (held = 0; held < CHECK_MAX_HELD; held++)
+    {
+        XmaSession *session = &sessions[held];
+
+        memset(session, 0, sizeof(*session));
+        session->session_type = XMA_ENCODER;
+        session->chan_id = -1;
+        if (xma_res_alloc_enc_kernel(g_xma_singleton->shm_res_cfg,
+                                     XMA_COPY_ENCODER_TYPE, "Xilinx",
+                                     session, false) != 0)
+            break;
+    }
+    return held;
+}
+
+/* Process holding all encoders unmaps (xma_exit), the encoders must then
+ * be available to the process that is still attached.
+ */
+static int check_xmares_unmap(void)
+{
+    static XmaSession sessions[CHECK_MAX_HELD];
+    int         to_owner[2], to_other[2];
+    int32_t     held, available;
+    int         status, failed = 0;
+    pid_t       owner;
+    char        c = 0;
+
+    if (pipe(to_owner) || pipe(to_other))
+        return 1;
+
+    fflush(stdout);
+    owner = fork();
+    if (owner == 0)
+    {
+        /* owner: wait for other process to attach, take all, exit xma */
+        if (xma_initialize("../system_cfg/check_cfg.yaml") != 0
+            || read(to_owner[0], &c, 1) != 1)
+            exit(EXIT_FAILURE);
+        held = check_xmares_hold_all(sessions);
+        if (write(to_other[1], &held, sizeof(held)) != sizeof(held)
+            || read(to_owner[0], &c, 1) != 1)
+            exit(EXIT_FAILURE);
+        xma_exit();
+        if (write(to_other[1], &c, 1) != 1
+            || read(to_owner[0], &c, 1) != 1)
+            exit(EXIT_FAILURE);
+        exit(EXIT_SUCCESS);
+    }
+
+    if (xma_initialize("../system_cfg/check_cfg.yaml") != 0
+        || write(to_owner[1], &c, 1) != 1
+        || read(to_other[0], &held, sizeof(held)) != sizeof(held))
+        return 1;
+
+    /* owner holds everything, nothing left for this process */
+    available = check_xmares_hold_all(sessions);
+    if (held <= 0 || available != 0)
+        failed++;
+
+    /* owner unmapped but is still alive */
+    if (write(to_owner[1], &c, 1) != 1 || read(to_other[0], &c, 1) != 1)
+        return failed + 1;
+    available = check_xmares_hold_all(sessions);
+    if (available != held)
+        failed++;
+
+    printf("unmap: %d encoder sessions held by exiting process, %d available after\n",
+           held, available);
+
+    if (write(to_owner[1], &c, 1) != 1)
+        failed++;
+    waitpid(owner, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+        failed++;
+    return failed;
+}
+
+int main()
+{
+    extern XmaHwInterface hw_if;
+    int         ready[2], start[2], results[2];
+    CheckResult result;
+    uint64_t    created = 0, rejected = 0, ns = 0;
+    int         number_failed = 0;
+    int         status;
+    char        c[CHECK_PROCS];
+    int32_t     i;
+
+    hw_if.is_compatible = check_xmares_is_compatible;
+    hw_if.configure = check_xmares_hw_configure;
+    hw_if.probe = check_xmares_probe;
+
+    if (pipe(ready) || pipe(start) || pipe(results))
+        return EXIT_FAILURE;
+
+    for (i = 0; i < CHECK_PROCS; i++)
+        if (fork() == 0)
+            exit(check_xmares_client(ready[1], start[0], results[1]));
+
+    for (i = 0; i < CHECK_PROCS; i++)
+        if (read(ready[0], &c[i], 1) != 1)
+            break;
+    if (i != CHECK_PROCS || write(start[1], c, CHECK_PROCS) != CHECK_PROCS)
+        number_failed++;
+
+    for (i = 0; i < CHECK_PROCS; i++)
+    {
+        if (read(results[0], &result, sizeof(result)) != sizeof(result))
+        {
+            number_failed++;
+            break;
+        }
+        created += result.created;
+        rejected += result.rejected;
+        ns = result.ns > ns ? result.ns : ns;
+    }
+    for (i = 0; i < CHECK_PROCS; i++)
+    {
+        wait(&status);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+            number_failed++;
+    }
+
+    printf("%d processes: %lu sessions created, %lu rejected, %.0f sessions/sec\n",
+           CHECK_PROCS, (unsigned long)created, (unsigned long)rejected,
+           ns ? (created + rejected) * 1e9 / ns : 0.0);
+
+    number_failed += check_xmares_unmap();
+
+    if (number_failed == 0 && created > 0) {
+     printf("XMA check_xmares test completed successfully\n");
+     return EXIT_SUCCESS;
+    } else {
+     printf("ERROR: XMA check_xmares test failed\n");
+     return EXIT_FAILURE;
+    }
+}